@@ -0,0 +1,812 @@
+/***************************************************************************
+                                DCCObject.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>DCCObject reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+/* splice() is a GNU extension */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#define _FILE_OFFSET_BITS 64
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#import "DCCObject.h"
+#import "NetMetrics.h"
+#import "NetHistogram.h"
+#import <Foundation/NSString.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSHost.h>
+#import <Foundation/NSValue.h>
+#import <Foundation/NSPathUtilities.h>
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#ifdef HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
+#ifndef HAVE_SOCKLEN_T
+typedef int socklen_t;
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+/* The most data moved with one call to sendfile() or splice(). */
+#define DCC_CHUNK_SIZE (4 * 1024 * 1024)
+/* The size of the buffer used when there is no sendfile() or splice(). */
+#define DCC_BUFFER_SIZE 65536
+
+NSString *DCCStatusListening = @"Listening";
+NSString *DCCStatusConnecting = @"Connecting";
+NSString *DCCStatusTransferring = @"Transferring";
+NSString *DCCStatusDone = @"Done";
+NSString *DCCStatusAborted = @"Aborted";
+NSString *DCCStatusError = @"Error";
+
+/* Sends up to count bytes of file from *offset, advancing *offset.
+ * Returns the number of bytes sent, or -1 with errno set. */
+static ssize_t send_file_chunk(int sock, int file, unsigned long long *offset,
+  size_t count)
+{
+#ifdef HAVE_SENDFILE
+	off_t position = *offset;
+	ssize_t sent;
+
+	sent = sendfile(sock, file, &position, count);
+	if (sent > 0)
+	{
+		*offset = position;
+	}
+	return sent;
+#else
+	char buffer[DCC_BUFFER_SIZE];
+	ssize_t length;
+	ssize_t sent;
+
+	if (count > sizeof(buffer))
+	{
+		count = sizeof(buffer);
+	}
+	length = pread(file, buffer, count, *offset);
+	if (length <= 0)
+	{
+		return length;
+	}
+	sent = write(sock, buffer, length);
+	if (sent > 0)
+	{
+		*offset += sent;
+	}
+	return sent;
+#endif
+}
+
+/* Moves up to count bytes from sock into file at *offset, advancing
+ * *offset.  pipes is used by splice() when it is not -1.  Returns the
+ * number of bytes moved, 0 at the end of the stream or -1 with errno
+ * set. */
+static ssize_t receive_file_chunk(int sock, int file, int *pipes,
+  unsigned long long *offset, size_t count)
+{
+	ssize_t length;
+	ssize_t written;
+	ssize_t left;
+#ifdef HAVE_SPLICE
+	loff_t position = *offset;
+
+	if (pipes[0] != -1)
+	{
+		length = splice(sock, NULL, pipes[1], NULL, count,
+		  SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (length <= 0)
+		{
+			return length;
+		}
+		for (left = length; left > 0; left -= written)
+		{
+			written = splice(pipes[0], NULL, file, &position, left,
+			  SPLICE_F_MOVE);
+			if (written <= 0)
+			{
+				return -1;
+			}
+		}
+		*offset = position;
+		return length;
+	}
+#endif
+	{
+		char buffer[DCC_BUFFER_SIZE];
+
+		length = read(sock, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			return length;
+		}
+		for (left = 0; left < length; left += written)
+		{
+			written = pwrite(file, buffer + left, length - left,
+			  *offset + left);
+			if (written <= 0)
+			{
+				return -1;
+			}
+		}
+		*offset += length;
+		return length;
+	}
+}
+
+@interface TCPSystem (DCCTCPSystem)
+- setErrorString: (NSString *)anError withErrno: (int)aErrno;
+@end
+
+/* Listens for the one connection of a DCCSendObject and hands it a
+ * DCCFileTransport. */
+@interface DCCPort : TCPPort
+	{
+		DCCSendObject *owner;
+	}
+- initWithOwner: (DCCSendObject *)anOwner onHost: (NSHost *)aHost
+   onPort: (uint16_t)aPort;
+- setOwner: (DCCSendObject *)anOwner;
+@end
+
+@interface DCCObject (InternalDCCObject)
+- setStatus: (NSString *)aStatus;
+- finishWithStatus: (NSString *)aStatus;
+- (BOOL)isFinished;
+@end
+
+@interface DCCSendObject (InternalDCCSendObject)
+- stopListening;
+@end
+
+@implementation DCCPort
+- initWithOwner: (DCCSendObject *)anOwner onHost: (NSHost *)aHost
+   onPort: (uint16_t)aPort
+{
+	if (!(self = [super initOnHost: aHost onPort: aPort])) return nil;
+
+	owner = anOwner;
+
+	return self;
+}
+- setOwner: (DCCSendObject *)anOwner
+{
+	owner = anOwner;
+	return self;
+}
+- newConnection
+{
+	struct sockaddr_in sin;
+	socklen_t temp = sizeof(sin);
+	DCCFileTransport *transport;
+	int newDesc;
+
+	if ((newDesc = accept(desc, (struct sockaddr *)&sin, &temp)) == -1)
+	{
+		[NSException raise: FatalNetException
+		  format: @"%s", strerror(errno)];
+	}
+	[[NetApplication sharedInstance] connectionAccepted];
+
+	transport = AUTORELEASE([[DCCFileTransport alloc]
+	  initWithAcceptedDesc: newDesc withRemoteHost: [[TCPSystem sharedInstance]
+	  hostFromNetworkOrderInteger: sin.sin_addr.s_addr]]);
+	if (!transport || !owner)
+	{
+		if (!transport) close(newDesc);
+		return self;
+	}
+
+	[owner connectionEstablished: transport];
+
+	return self;
+}
+@end
+
+@implementation DCCFileTransport
+- initWithDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
+{
+	if (!(self = [super initWithDesc: aDesc withRemoteHost: theAddress]))
+		return nil;
+
+	fileDesc = -1;
+	pipeDescs[0] = pipeDescs[1] = -1;
+
+	return self;
+}
+- (void)dealloc
+{
+	if (pipeDescs[0] != -1)
+	{
+		close(pipeDescs[0]);
+		close(pipeDescs[1]);
+	}
+	[super dealloc];
+}
+- sendFile: (int)aDesc fromOffset: (unsigned long long)anOffset
+   length: (unsigned long long)aLength
+{
+	int flags;
+
+	fileDesc = aDesc;
+	fileOffset = anOffset;
+	fileEnd = anOffset + aLength;
+	sending = YES;
+
+	if ((flags = fcntl(desc, F_GETFL)) != -1)
+	{
+		fcntl(desc, F_SETFL, flags | O_NONBLOCK);
+	}
+	[[NetApplication sharedInstance] transportNeedsToWrite: self];
+
+	return self;
+}
+- receiveToFile: (int)aDesc atOffset: (unsigned long long)anOffset
+{
+	fileDesc = aDesc;
+	fileOffset = anOffset;
+	receiving = YES;
+
+#ifdef HAVE_SPLICE
+	if (pipeDescs[0] == -1 && pipe(pipeDescs) == -1)
+	{
+		pipeDescs[0] = pipeDescs[1] = -1;
+	}
+#endif
+
+	return self;
+}
+- (unsigned long long)fileOffset
+{
+	return fileOffset;
+}
+- (BOOL)isFileSent
+{
+	return sending && fileOffset >= fileEnd;
+}
+- (BOOL)isDoneWriting
+{
+	return [super isDoneWriting] && (!sending || fileOffset >= fileEnd);
+}
+- writeData: (NSData *)aData
+{
+	ssize_t sent;
+	unsigned long long count;
+
+	if (aData || !sending || [writeBuffer length])
+	{
+		return [super writeData: aData];
+	}
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	eventsDispatched++;
+
+	if (fileOffset >= fileEnd)
+	{
+		return self;
+	}
+	count = fileEnd - fileOffset;
+	if (count > DCC_CHUNK_SIZE)
+	{
+		count = DCC_CHUNK_SIZE;
+	}
+
+	sent = send_file_chunk(desc, fileDesc, &fileOffset, count);
+	writeCalls++;
+	NetTransportTotals.writeCalls++;
+	if (sent == -1)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			return self;
+		}
+		[NSException raise: FatalNetException
+		  format: @"%s", strerror(errno)];
+	}
+	if (sent == 0)
+	{
+		[NSException raise: FatalNetException
+		  format: @"File ended before %llu bytes were sent", fileEnd];
+	}
+	bytesWritten += sent;
+	NetTransportTotals.bytesWritten += sent;
+
+	return self;
+}
+- (NSData *)readData: (int)maxDataSize
+{
+	ssize_t length;
+	fd_set readSet;
+	struct timeval zeroTime = { 0, 0 };
+	int loops = 8;
+
+	if (!receiving)
+	{
+		return [super readData: maxDataSize];
+	}
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	eventsDispatched++;
+
+	do
+	{
+		length = receive_file_chunk(desc, fileDesc, pipeDescs, &fileOffset,
+		  DCC_CHUNK_SIZE);
+		readCalls++;
+		NetTransportTotals.readCalls++;
+		if (length == 0)
+		{
+			[[NSException exceptionWithName: NetException
+			  reason: @"Socket closed" userInfo: nil] raise];
+		}
+		if (length == -1)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+			[NSException raise: FatalNetException
+			  format: @"%s", strerror(errno)];
+		}
+		bytesRead += length;
+		NetTransportTotals.bytesRead += length;
+
+		FD_ZERO(&readSet);
+		FD_SET(desc, &readSet);
+		select(desc + 1, &readSet, NULL, NULL, &zeroTime);
+		--loops;
+	} while (loops && FD_ISSET(desc, &readSet));
+
+	return [NSData data];
+}
+@end
+
+@implementation DCCObject (InternalDCCObject)
+- setStatus: (NSString *)aStatus
+{
+	ASSIGN(status, aStatus);
+	[self DCCStatusChanged: status];
+	return self;
+}
+- finishWithStatus: (NSString *)aStatus
+{
+	if ([self isFinished])
+	{
+		return self;
+	}
+	AUTORELEASE(RETAIN(self));
+
+	ASSIGN(status, aStatus);
+	endTime = NetMonotonicMicroseconds();
+	if (transport)
+	{
+		[[NetApplication sharedInstance] disconnectObject: self];
+	}
+	if (fileDesc != -1)
+	{
+		close(fileDesc);
+		fileDesc = -1;
+	}
+	[self DCCStatusChanged: status];
+
+	return self;
+}
+- (BOOL)isFinished
+{
+	return status == DCCStatusDone || status == DCCStatusAborted ||
+	  status == DCCStatusError;
+}
+@end
+
+@implementation DCCObject
+- init
+{
+	if (!(self = [super init])) return nil;
+
+	fileDesc = -1;
+
+	return self;
+}
+- (void)dealloc
+{
+	if (fileDesc != -1)
+	{
+		close(fileDesc);
+	}
+	RELEASE(transport);
+	RELEASE(status);
+	RELEASE(path);
+	RELEASE(fileName);
+	[super dealloc];
+}
+- (NSString *)status
+{
+	return status;
+}
+- (NSString *)path
+{
+	return path;
+}
+- (NSString *)fileName
+{
+	return fileName;
+}
+- (unsigned long long)size
+{
+	return size;
+}
+- (unsigned long long)startPosition
+{
+	return startPosition;
+}
+- (unsigned long long)position
+{
+	return position;
+}
+- (double)throughput
+{
+	uint64_t end = (endTime) ? endTime : NetMonotonicMicroseconds();
+
+	if (!startTime || end <= startTime)
+	{
+		return 0.0;
+	}
+	return (position - startPosition) / ((end - startTime) / 1000000.0);
+}
+- abort
+{
+	return [self finishWithStatus: DCCStatusAborted];
+}
+- (void)connectionLost
+{
+	DESTROY(transport);
+	[self finishWithStatus: DCCStatusError];
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	startTime = NetMonotonicMicroseconds();
+	[[NetApplication sharedInstance] connectObject: self];
+	[self setStatus: DCCStatusTransferring];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@implementation DCCObject (Callbacks)
+- DCCStatusChanged: (NSString *)aStatus
+{
+	return self;
+}
+- DCCProgress: (unsigned long long)aPosition
+{
+	return self;
+}
+@end
+
+@implementation DCCSendObject (InternalDCCSendObject)
+- stopListening
+{
+	if (!listener)
+	{
+		return self;
+	}
+	[listener setOwner: nil];
+	[[NetApplication sharedInstance] disconnectObject: listener];
+	[listener close];
+	AUTORELEASE(listener);
+	listener = nil;
+
+	return self;
+}
+@end
+
+@implementation DCCSendObject
+- initWithFile: (NSString *)aPath
+{
+	struct stat info;
+
+	if (!(self = [super init])) return nil;
+
+	fileDesc = open([aPath fileSystemRepresentation], O_RDONLY | O_CLOEXEC);
+	if (fileDesc == -1 || fstat(fileDesc, &info) == -1)
+	{
+		[[TCPSystem sharedInstance] setErrorString: [NSString
+		  stringWithFormat: @"%s", strerror(errno)] withErrno: errno];
+		[self release];
+		return nil;
+	}
+
+	path = RETAIN(aPath);
+	fileName = RETAIN([aPath lastPathComponent]);
+	size = info.st_size;
+
+	return self;
+}
+- (void)dealloc
+{
+	[self stopListening];
+	[super dealloc];
+}
+- listenOnHost: (NSHost *)aHost onPort: (uint16_t)aPort
+{
+	if (listener || transport || [self isFinished])
+	{
+		return nil;
+	}
+	listener = [[DCCPort alloc] initWithOwner: self onHost: aHost
+	  onPort: aPort];
+	if (!listener)
+	{
+		return nil;
+	}
+	[self setStatus: DCCStatusListening];
+
+	return self;
+}
+- (uint16_t)port
+{
+	return [listener port];
+}
+- setStartPosition: (unsigned long long)aPosition
+{
+	if (transport)
+	{
+		return self;
+	}
+	startPosition = position = (aPosition < size) ? aPosition : size;
+	return self;
+}
+- abort
+{
+	[self stopListening];
+	return [super abort];
+}
+- (void)connectionLost
+{
+	if (![self isFinished] && [transport isFileSent])
+	{
+		/* The receiver does not have to wait for the last
+		 * acknowledgement to be read. */
+		position = size;
+		DESTROY(transport);
+		[self finishWithStatus: DCCStatusDone];
+		return;
+	}
+	[super connectionLost];
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	[self stopListening];
+	[super connectionEstablished: aTransport];
+
+	if (startPosition >= size)
+	{
+		return [self finishWithStatus: DCCStatusDone];
+	}
+	[transport sendFile: fileDesc fromOffset: startPosition
+	  length: size - startPosition];
+
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	const unsigned char *bytes = [data bytes];
+	unsigned long long sentTo;
+	unsigned long long acked;
+	uint32_t ack = 0;
+	BOOL gotAck = NO;
+	unsigned x;
+
+	for (x = 0; x < [data length]; x++)
+	{
+		ackBytes[ackLength++] = bytes[x];
+		if (ackLength == 4)
+		{
+			memcpy(&ack, ackBytes, 4);
+			ack = ntohl(ack);
+			ackLength = 0;
+			gotAck = YES;
+		}
+	}
+	if (!gotAck)
+	{
+		return self;
+	}
+
+	/* Acknowledgements are the low 32 bits of the position, so put back
+	 * the high bits from what has been sent so far. */
+	sentTo = [transport fileOffset];
+	acked = (sentTo & ~0xffffffffULL) | ack;
+	if (acked > sentTo)
+	{
+		acked -= 0x100000000ULL;
+	}
+	if (acked > position)
+	{
+		position = acked;
+		[self DCCProgress: position];
+	}
+	if (position >= size)
+	{
+		[self finishWithStatus: DCCStatusDone];
+	}
+
+	return self;
+}
+@end
+
+@implementation DCCReceiveObject
+- initWithFileInfo: (NSDictionary *)fileInfo toPath: (NSString *)aPath
+   resume: (BOOL)resume
+{
+	struct stat info;
+	int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+
+	if (!(self = [super init])) return nil;
+
+	if (!resume)
+	{
+		flags |= O_TRUNC;
+	}
+	fileDesc = open([aPath fileSystemRepresentation], flags, 0644);
+	if (fileDesc == -1 || fstat(fileDesc, &info) == -1)
+	{
+		[[TCPSystem sharedInstance] setErrorString: [NSString
+		  stringWithFormat: @"%s", strerror(errno)] withErrno: errno];
+		[self release];
+		return nil;
+	}
+
+	path = RETAIN(aPath);
+	fileName = RETAIN([fileInfo objectForKey: @"FileName"]);
+	host = RETAIN([fileInfo objectForKey: @"Host"]);
+	port = [[fileInfo objectForKey: @"Port"] intValue];
+	size = [[fileInfo objectForKey: @"Size"] unsignedLongLongValue];
+	if (resume)
+	{
+		startPosition = position = info.st_size;
+	}
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(host);
+	[super dealloc];
+}
+- connect
+{
+	if (transport || connecting || [self isFinished])
+	{
+		return nil;
+	}
+	if (![[TCPSystem sharedInstance] connectNetObjectInBackground: self
+	  toHost: host onPort: port withTimeout: 30
+	  transportClass: [DCCFileTransport class]])
+	{
+		return nil;
+	}
+	[self setStatus: DCCStatusConnecting];
+
+	return self;
+}
+- connectingFailed: (NSString *)aError
+{
+	connecting = nil;
+	[self finishWithStatus: DCCStatusError];
+	return self;
+}
+- connectingStarted: (TCPConnecting *)aConnection
+{
+	connecting = aConnection;
+	return self;
+}
+- abort
+{
+	TCPConnecting *pending = connecting;
+
+	connecting = nil;
+	[super abort];
+	[pending abortConnection];
+
+	return self;
+}
+- (void)connectionLost
+{
+	if (![self isFinished] && transport)
+	{
+		position = [transport fileOffset];
+		if (size == 0 || position >= size)
+		{
+			/* The sender closed the connection after the last byte. */
+			DESTROY(transport);
+			[self finishWithStatus: DCCStatusDone];
+			return;
+		}
+	}
+	[super connectionLost];
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	connecting = nil;
+	[super connectionEstablished: aTransport];
+	[transport receiveToFile: fileDesc atOffset: startPosition];
+
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	uint32_t ack;
+
+	if ([transport fileOffset] == position)
+	{
+		return self;
+	}
+	position = [transport fileOffset];
+	ack = htonl((uint32_t)(position & 0xffffffffULL));
+	[transport writeData: [NSData dataWithBytes: &ack length: sizeof(ack)]];
+	[self DCCProgress: position];
+
+	if (size && position >= size)
+	{
+		[transport writeData: nil];
+		[self finishWithStatus: DCCStatusDone];
+	}
+
+	return self;
+}
+@end
@@ -0,0 +1,856 @@
+/***************************************************************************
+                                IRCBouncer.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>IRCBouncer reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#import "IRCBouncer.h"
+#import "NetBase.h"
+#import "NetTCP.h"
+#import <Foundation/NSArray.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSEnumerator.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSHost.h>
+#import <Foundation/NSString.h>
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#ifndef HAVE_SOCKLEN_T
+typedef int socklen_t;
+#endif
+
+/* Channel member status prefixes, used when the server sent no PREFIX. */
+static const char member_prefixes[] = "~&@%+";
+
+/* The longest list of names sent in one RPL_NAMREPLY when replaying. */
+#define NAMES_LENGTH 400
+
+static NSData *bouncer_new_line = nil;
+
+/* Finds the command of a raw IRC line without building any objects.
+ * Returns a pointer to it and its length in *length, or NULL. */
+static const char *line_command(const char *bytes, unsigned length,
+  unsigned *commandLength)
+{
+	const char *end = bytes + length;
+	const char *command;
+
+	while (bytes < end && *bytes == ' ') bytes++;
+	if (bytes < end && *bytes == ':')
+	{
+		while (bytes < end && *bytes != ' ') bytes++;
+		while (bytes < end && *bytes == ' ') bytes++;
+	}
+	if (bytes == end)
+	{
+		return NULL;
+	}
+	command = bytes;
+	while (bytes < end && *bytes != ' ') bytes++;
+	*commandLength = bytes - command;
+
+	return command;
+}
+
+static inline BOOL is_command(const char *command, unsigned length,
+  const char *aCommand)
+{
+	return (length == strlen(aCommand) &&
+	  strncasecmp(command, aCommand, length) == 0);
+}
+
+/* Returns the argument after the command, without a leading ':'. */
+static NSString *line_argument(const char *command, unsigned commandLength,
+  const char *end)
+{
+	const char *arg = command + commandLength;
+	const char *argEnd;
+
+	while (arg < end && *arg == ' ') arg++;
+	if (arg < end && *arg == ':')
+	{
+		arg++;
+		argEnd = end;
+	}
+	else
+	{
+		argEnd = arg;
+		while (argEnd < end && *argEnd != ' ') argEnd++;
+	}
+	if (arg == argEnd)
+	{
+		return nil;
+	}
+	return AUTORELEASE([[NSString alloc] initWithBytes: arg
+	  length: argEnd - arg encoding: NSUTF8StringEncoding]);
+}
+
+static inline BOOL is_member_prefix(unichar aChar)
+{
+	return (aChar && aChar < 128 && strchr(member_prefixes, aChar));
+}
+
+static inline NSString *member_nick(NSString *aMember)
+{
+	unsigned x = 0;
+
+	while (x < [aMember length] &&
+	  is_member_prefix([aMember characterAtIndex: x])) x++;
+
+	return (x) ? [aMember substringFromIndex: x] : aMember;
+}
+
+@interface IRCBouncerPort : TCPPort
+	{
+		IRCBouncer *owner;
+	}
+- initWithOwner: (IRCBouncer *)anOwner onHost: (NSHost *)aHost
+   onPort: (uint16_t)aPort;
+- setOwner: (IRCBouncer *)anOwner;
+@end
+
+@interface IRCBouncerUpstream (InternalIRCBouncerUpstream)
+- (NSMutableDictionary *)channelNamed: (NSString *)aChannel;
+- (int)indexOfMember: (NSString *)aNick inMembers: (NSArray *)members;
+- removeMember: (NSString *)aNick fromChannel: (NSString *)aChannel;
+- setPrefix: (char)aPrefix adding: (BOOL)adding
+   forMember: (NSString *)aNick inChannel: (NSString *)aChannel;
+- writeLine: (NSString *)aLine toClient: (IRCBouncerClient *)aClient;
+- forwardLine: (NSData *)aLine;
+- clearState;
+@end
+
+@interface IRCBouncerClient (InternalIRCBouncerClient)
+- attach;
+- disconnect;
+- writeLine: (NSString *)aLine;
+@end
+
+@implementation IRCBouncerPort
+- initWithOwner: (IRCBouncer *)anOwner onHost: (NSHost *)aHost
+   onPort: (uint16_t)aPort
+{
+	if (!(self = [super initOnHost: aHost onPort: aPort])) return nil;
+
+	owner = anOwner;
+
+	return self;
+}
+- setOwner: (IRCBouncer *)anOwner
+{
+	owner = anOwner;
+	return self;
+}
+- newConnection
+{
+	struct sockaddr_in sin;
+	socklen_t temp = sizeof(sin);
+	TCPTransport *transport;
+	int newDesc;
+
+	if ((newDesc = accept(desc, (struct sockaddr *)&sin, &temp)) == -1)
+	{
+		[NSException raise: FatalNetException
+		  format: @"%s", strerror(errno)];
+	}
+	[[NetApplication sharedInstance] connectionAccepted];
+
+	transport = [[transportClass alloc]
+	  initWithAcceptedDesc: newDesc withRemoteHost: [[TCPSystem sharedInstance]
+	  hostFromNetworkOrderInteger: sin.sin_addr.s_addr]];
+	if (!transport || !owner)
+	{
+		if (!transport) close(newDesc);
+		RELEASE(transport);
+		return self;
+	}
+
+	[AUTORELEASE([[IRCBouncerClient alloc] initWithBouncer: owner])
+	  connectionEstablished: transport];
+	RELEASE(transport);
+
+	return self;
+}
+@end
+
+@implementation IRCBouncerUpstream (InternalIRCBouncerUpstream)
+- (NSMutableDictionary *)channelNamed: (NSString *)aChannel
+{
+	return [channels objectForKey:
+	  [aChannel performSelector: [self lowercasingSelector]]];
+}
+- (int)indexOfMember: (NSString *)aNick inMembers: (NSArray *)members
+{
+	int x;
+
+	for (x = [members count] - 1; x >= 0; x--)
+	{
+		if ([self caseInsensitiveCompare: member_nick([members objectAtIndex: x])
+		  to: aNick] == NSOrderedSame)
+		{
+			return x;
+		}
+	}
+	return -1;
+}
+- removeMember: (NSString *)aNick fromChannel: (NSString *)aChannel
+{
+	NSMutableArray *members;
+	int x;
+
+	members = [[self channelNamed: aChannel] objectForKey: @"Members"];
+	if ((x = [self indexOfMember: aNick inMembers: members]) >= 0)
+	{
+		[members removeObjectAtIndex: x];
+	}
+	return self;
+}
+- setPrefix: (char)aPrefix adding: (BOOL)adding
+   forMember: (NSString *)aNick inChannel: (NSString *)aChannel
+{
+	NSMutableArray *members;
+	NSString *member;
+	const char *prefixes = [self serverSupport]->prefixChars;
+	unichar current;
+	int x;
+
+	members = [[self channelNamed: aChannel] objectForKey: @"Members"];
+	if ((x = [self indexOfMember: aNick inMembers: members]) < 0)
+	{
+		return self;
+	}
+	member = [members objectAtIndex: x];
+	current = ([member length] && is_member_prefix([member characterAtIndex: 0]))
+	  ? [member characterAtIndex: 0] : 0;
+
+	/* Only the highest prefix is kept, as in a NAMES reply without
+	 * multi-prefix.  Losing it leaves no prefix until the next NAMES. */
+	if (adding && (!current || !strchr(prefixes, current) ||
+	  strchr(prefixes, aPrefix) < strchr(prefixes, current)))
+	{
+		[members replaceObjectAtIndex: x withObject:
+		  [NSString stringWithFormat: @"%c%@", aPrefix, member_nick(member)]];
+	}
+	else if (!adding && current == aPrefix)
+	{
+		[members replaceObjectAtIndex: x withObject: member_nick(member)];
+	}
+	return self;
+}
+- writeLine: (NSString *)aLine toClient: (IRCBouncerClient *)aClient
+{
+	id <NetTransport> aTransport = [aClient transport];
+
+	[aTransport writeData: [aLine dataUsingEncoding: [self encoding]]];
+	[aTransport writeData: bouncer_new_line];
+	return self;
+}
+- forwardLine: (NSData *)aLine
+{
+	NSMutableData *data;
+	NSEnumerator *iter;
+	id object;
+
+	if ([clients count] == 0)
+	{
+		return self;
+	}
+
+	/* Every client is sent the same data, built once. */
+	data = [NSMutableData dataWithCapacity: [aLine length] + 2];
+	[data appendData: aLine];
+	[data appendData: bouncer_new_line];
+
+	iter = [clients objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[[object transport] writeData: data];
+		linesForwarded++;
+	}
+	return self;
+}
+- clearState
+{
+	[welcomeLines removeAllObjects];
+	[channels removeAllObjects];
+	DESTROY(serverName);
+	return self;
+}
+@end
+
+@implementation IRCBouncerUpstream
++ (void)initialize
+{
+	if (!bouncer_new_line)
+	{
+		bouncer_new_line = [[NSData alloc] initWithBytes: "\r\n" length: 2];
+	}
+}
+- initWithNickname: (NSString *)aNickname withUserName: (NSString *)aUser
+   withRealName: (NSString *)aRealName withPassword: (NSString *)aPassword
+{
+	if (!(self = [super initWithNickname: aNickname withUserName: aUser
+	  withRealName: aRealName withPassword: aPassword])) return nil;
+
+	clients = [NSMutableArray new];
+	welcomeLines = [NSMutableArray new];
+	channels = [NSMutableDictionary new];
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(clients);
+	RELEASE(welcomeLines);
+	RELEASE(channels);
+	RELEASE(serverName);
+	[super dealloc];
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	[self clearState];
+	return [super connectionEstablished: aTransport];
+}
+- (void)connectionLost
+{
+	NSEnumerator *iter;
+	id object;
+
+	iter = [clients objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[self writeLine: @"NOTICE * :Connection to the server lost"
+		  toClient: object];
+	}
+	[self clearState];
+	[super connectionLost];
+}
+- (NSArray *)clients
+{
+	return AUTORELEASE([clients copy]);
+}
+- attachClient: (IRCBouncerClient *)aClient
+{
+	NSEnumerator *iter;
+	NSDictionary *channel;
+	NSString *server, *me, *name, *topic;
+	NSMutableString *names;
+	NSString *member;
+	NSEnumerator *memberIter;
+	id object;
+
+	if ([clients indexOfObjectIdenticalTo: aClient] != NSNotFound)
+	{
+		return self;
+	}
+
+	iter = [welcomeLines objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[[aClient transport] writeData: object];
+		[[aClient transport] writeData: bouncer_new_line];
+	}
+	[clients addObject: aClient];
+
+	me = [self nick];
+	if ([welcomeLines count] == 0)
+	{
+		/* Not registered yet; the welcome will be forwarded. */
+		return self;
+	}
+	if ([aClient nick] &&
+	  [self caseInsensitiveCompare: [aClient nick] to: me] != NSOrderedSame)
+	{
+		[self writeLine: [NSString stringWithFormat: @":%@ NICK :%@",
+		  [aClient nick], me] toClient: aClient];
+	}
+
+	server = serverName ? serverName : @"bouncer";
+	iter = [channels objectEnumerator];
+	while ((channel = [iter nextObject]))
+	{
+		name = [channel objectForKey: @"Name"];
+		[self writeLine: [NSString stringWithFormat: @":%@ JOIN :%@",
+		  me, name] toClient: aClient];
+		if ((topic = [channel objectForKey: @"Topic"]))
+		{
+			[self writeLine: [NSString stringWithFormat: @":%@ %@ %@ %@ :%@",
+			  server, RPL_TOPIC, me, name, topic] toClient: aClient];
+		}
+
+		names = [NSMutableString string];
+		memberIter = [[channel objectForKey: @"Members"] objectEnumerator];
+		while ((member = [memberIter nextObject]))
+		{
+			if ([names length] + [member length] >= NAMES_LENGTH)
+			{
+				[self writeLine: [NSString stringWithFormat:
+				  @":%@ %@ %@ = %@ :%@", server, RPL_NAMREPLY, me, name, names]
+				  toClient: aClient];
+				[names setString: @""];
+			}
+			if ([names length])
+			{
+				[names appendString: @" "];
+			}
+			[names appendString: member];
+		}
+		if ([names length])
+		{
+			[self writeLine: [NSString stringWithFormat: @":%@ %@ %@ = %@ :%@",
+			  server, RPL_NAMREPLY, me, name, names] toClient: aClient];
+		}
+		[self writeLine: [NSString stringWithFormat:
+		  @":%@ %@ %@ %@ :End of /NAMES list.", server, RPL_ENDOFNAMES, me,
+		  name] toClient: aClient];
+	}
+
+	return self;
+}
+- detachClient: (IRCBouncerClient *)aClient
+{
+	[clients removeObjectIdenticalTo: aClient];
+	return self;
+}
+- (NSArray *)channels
+{
+	NSMutableArray *names = [NSMutableArray arrayWithCapacity: [channels count]];
+	NSEnumerator *iter;
+	id object;
+
+	iter = [channels objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[names addObject: [object objectForKey: @"Name"]];
+	}
+	return names;
+}
+- (NSArray *)membersOfChannel: (NSString *)aChannel
+{
+	return AUTORELEASE([[[self channelNamed: aChannel]
+	  objectForKey: @"Members"] copy]);
+}
+- (NSString *)topicOfChannel: (NSString *)aChannel
+{
+	return [[self channelNamed: aChannel] objectForKey: @"Topic"];
+}
+- (unsigned long long)linesForwarded
+{
+	return linesForwarded;
+}
+- lineReceived: (NSData *)aLine
+{
+	const char *command;
+	unsigned length;
+
+	/* Parsed once here; the callbacks below keep the channel state. */
+	[super lineReceived: aLine];
+
+	command = line_command([aLine bytes], [aLine length], &length);
+	if (!command || is_command(command, length, "PING") ||
+	  is_command(command, length, "PONG"))
+	{
+		return self;
+	}
+	if (length == 3 && command[0] == '0' && command[1] == '0' &&
+	  command[2] >= '1' && command[2] <= '5')
+	{
+		[welcomeLines addObject: aLine];
+	}
+
+	return [self forwardLine: aLine];
+}
+- pingReceivedWithArgument: (NSString *)anArgument from: (NSString *)aSender
+{
+	[self sendPongWithArgument: anArgument];
+	return self;
+}
+- numericCommandReceived: (NSString *)aCommand withParams: (NSArray *)paramList
+   from: (NSString *)aSender
+{
+	int count = [paramList count];
+
+	if ([aCommand isEqualToString: RPL_WELCOME])
+	{
+		[welcomeLines removeAllObjects];
+		ASSIGN(serverName, aSender);
+	}
+	else if ([aCommand isEqualToString: RPL_TOPIC] && count >= 2)
+	{
+		[[self channelNamed: [paramList objectAtIndex: 0]]
+		  setObject: [paramList objectAtIndex: 1] forKey: @"Topic"];
+	}
+	else if ([aCommand isEqualToString: RPL_NOTOPIC] && count >= 1)
+	{
+		[[self channelNamed: [paramList objectAtIndex: 0]]
+		  removeObjectForKey: @"Topic"];
+	}
+	return self;
+}
+- namesReceived: (IRCNameList *)aList forChannel: (NSString *)aChannel
+{
+	[[self channelNamed: aChannel] setObject:
+	  [NSMutableArray arrayWithArray: [aList members]] forKey: @"Members"];
+	return self;
+}
+- channelJoined: (NSString *)aChannel from: (NSString *)aJoiner
+{
+	NSString *joiner = ExtractIRCNick(aJoiner);
+	NSMutableDictionary *channel;
+
+	if ([self caseInsensitiveCompare: joiner to: [self nick]] == NSOrderedSame)
+	{
+		channel = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+		  aChannel, @"Name", [NSMutableArray array], @"Members", nil];
+		[channels setObject: channel forKey:
+		  [aChannel performSelector: [self lowercasingSelector]]];
+	}
+	[[[self channelNamed: aChannel] objectForKey: @"Members"]
+	  addObject: joiner];
+	return self;
+}
+- channelParted: (NSString *)aChannel withMessage: (NSString *)aMessage
+   from: (NSString *)aParter
+{
+	NSString *parter = ExtractIRCNick(aParter);
+
+	if ([self caseInsensitiveCompare: parter to: [self nick]] == NSOrderedSame)
+	{
+		[channels removeObjectForKey:
+		  [aChannel performSelector: [self lowercasingSelector]]];
+		return self;
+	}
+	return [self removeMember: parter fromChannel: aChannel];
+}
+- userKicked: (NSString *)aPerson outOf: (NSString *)aChannel
+   for: (NSString *)aReason from: (NSString *)aKicker
+{
+	if ([self caseInsensitiveCompare: aPerson to: [self nick]] == NSOrderedSame)
+	{
+		[channels removeObjectForKey:
+		  [aChannel performSelector: [self lowercasingSelector]]];
+		return self;
+	}
+	return [self removeMember: aPerson fromChannel: aChannel];
+}
+- quitIRCWithMessage: (NSString *)aMessage from: (NSString *)aQuitter
+{
+	NSString *quitter = ExtractIRCNick(aQuitter);
+	NSEnumerator *iter;
+	id object;
+
+	iter = [channels objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[self removeMember: quitter fromChannel: [object objectForKey: @"Name"]];
+	}
+	return self;
+}
+- nickChangedTo: (NSString *)newName from: (NSString *)aPerson
+{
+	NSString *oldName = ExtractIRCNick(aPerson);
+	NSMutableArray *members;
+	NSEnumerator *iter;
+	NSString *member;
+	id object;
+	int x;
+
+	iter = [channels objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		members = [object objectForKey: @"Members"];
+		if ((x = [self indexOfMember: oldName inMembers: members]) < 0)
+		{
+			continue;
+		}
+		member = [members objectAtIndex: x];
+		[members replaceObjectAtIndex: x withObject:
+		  [NSString stringWithFormat: @"%@%@", [member substringToIndex:
+		  [member length] - [member_nick(member) length]], newName]];
+	}
+	return self;
+}
+- topicChangedTo: (NSString *)aTopic in: (NSString *)aChannel
+   from: (NSString *)aPerson
+{
+	NSMutableDictionary *channel = [self channelNamed: aChannel];
+
+	if ([aTopic length])
+	{
+		[channel setObject: aTopic forKey: @"Topic"];
+	}
+	else
+	{
+		[channel removeObjectForKey: @"Topic"];
+	}
+	return self;
+}
+- modesChanged: (IRCModeChanges *)changes on: (NSString *)anObject
+   from: (NSString *)aPerson
+{
+	const IRCServerSupport *support = [self serverSupport];
+	const IRCModeChange *change = [changes changes];
+	unsigned count = [changes count];
+	const char *which;
+	unsigned x;
+
+	if (![self channelNamed: anObject])
+	{
+		return self;
+	}
+	for (x = 0; x < count; x++, change++)
+	{
+		if (change->mode && change->argument >= 0 &&
+		  (which = strchr(support->prefixModes, change->mode)))
+		{
+			[self setPrefix: support->prefixChars[which - support->prefixModes]
+			  adding: (change->sign == '+')
+			  forMember: [changes argumentAtIndex: x] inChannel: anObject];
+		}
+	}
+	return self;
+}
+@end
+
+@implementation IRCBouncerClient (InternalIRCBouncerClient)
+- attach
+{
+	upstream = [bouncer upstreamForIdentity: identity];
+	if (!upstream)
+	{
+		[self writeLine: @"ERROR :Unknown identity"];
+		return [self disconnect];
+	}
+	[upstream attachClient: self];
+	return self;
+}
+- disconnect
+{
+	AUTORELEASE(RETAIN(self));
+	[upstream detachClient: self];
+	upstream = nil;
+	[[NetApplication sharedInstance] disconnectObject: self];
+	return self;
+}
+- writeLine: (NSString *)aLine
+{
+	[transport writeData: [aLine dataUsingEncoding: NSUTF8StringEncoding]];
+	[transport writeData: bouncer_new_line];
+	return self;
+}
+@end
+
+@implementation IRCBouncerClient
++ (void)initialize
+{
+	if (!bouncer_new_line)
+	{
+		bouncer_new_line = [[NSData alloc] initWithBytes: "\r\n" length: 2];
+	}
+}
+- initWithBouncer: (IRCBouncer *)aBouncer
+{
+	if (!(self = [super init])) return nil;
+
+	bouncer = aBouncer;
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(nick);
+	RELEASE(identity);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	[upstream detachClient: self];
+	upstream = nil;
+	[super connectionLost];
+}
+- (NSString *)nick
+{
+	return nick;
+}
+- (IRCBouncerUpstream *)upstream
+{
+	return upstream;
+}
+- lineReceived: (NSData *)aLine
+{
+	const char *bytes = [aLine bytes];
+	const char *end = bytes + [aLine length];
+	const char *command;
+	unsigned length;
+	NSString *arg;
+	id <NetTransport> upstreamTransport;
+
+	command = line_command(bytes, [aLine length], &length);
+	if (!command)
+	{
+		return self;
+	}
+
+	if (is_command(command, length, "PING"))
+	{
+		arg = line_argument(command, length, end);
+		return [self writeLine: [NSString stringWithFormat: @"PONG :%@",
+		  arg ? arg : @"bouncer"]];
+	}
+	if (is_command(command, length, "QUIT"))
+	{
+		return [self disconnect];
+	}
+
+	if (!upstream)
+	{
+		if (is_command(command, length, "PASS"))
+		{
+			ASSIGN(identity, line_argument(command, length, end));
+		}
+		else if (is_command(command, length, "NICK"))
+		{
+			ASSIGN(nick, line_argument(command, length, end));
+		}
+		else if (is_command(command, length, "USER"))
+		{
+			gotUser = YES;
+		}
+		if (nick && gotUser)
+		{
+			[self attach];
+		}
+		return self;
+	}
+
+	/* Passed on as it is; the upstream echoes what changes its state. */
+	upstreamTransport = [upstream transport];
+	if (!upstreamTransport)
+	{
+		return [self writeLine: @"NOTICE * :Not connected to the server"];
+	}
+	[upstreamTransport writeData: aLine];
+	[upstreamTransport writeData: bouncer_new_line];
+
+	return self;
+}
+@end
+
+@implementation IRCBouncer
+- init
+{
+	if (!(self = [super init])) return nil;
+
+	upstreams = [NSMutableDictionary new];
+
+	return self;
+}
+- (void)dealloc
+{
+	[self stopListening];
+	RELEASE(upstreams);
+	[super dealloc];
+}
+- addUpstream: (IRCBouncerUpstream *)anUpstream
+   forIdentity: (NSString *)anIdentity
+{
+	if ([upstreams objectForKey: anIdentity])
+	{
+		[self removeUpstreamForIdentity: anIdentity];
+	}
+	[upstreams setObject: anUpstream forKey: anIdentity];
+	return self;
+}
+- removeUpstreamForIdentity: (NSString *)anIdentity
+{
+	IRCBouncerUpstream *upstream = [upstreams objectForKey: anIdentity];
+	NSEnumerator *iter;
+	id object;
+
+	if (!upstream)
+	{
+		return self;
+	}
+	iter = [[upstream clients] objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[object disconnect];
+	}
+	[upstreams removeObjectForKey: anIdentity];
+	return self;
+}
+- (IRCBouncerUpstream *)upstreamForIdentity: (NSString *)anIdentity
+{
+	if (!anIdentity)
+	{
+		return ([upstreams count] == 1) ?
+		  [[upstreams objectEnumerator] nextObject] : nil;
+	}
+	return [upstreams objectForKey: anIdentity];
+}
+- (NSArray *)identities
+{
+	return [upstreams allKeys];
+}
+- listenOnHost: (NSHost *)aHost onPort: (uint16_t)aPort
+{
+	[self stopListening];
+	listener = [[IRCBouncerPort alloc] initWithOwner: self onHost: aHost
+	  onPort: aPort];
+	if (!listener)
+	{
+		return nil;
+	}
+	return self;
+}
+- (uint16_t)port
+{
+	return [listener port];
+}
+- stopListening
+{
+	if (!listener)
+	{
+		return self;
+	}
+	[(IRCBouncerPort *)listener setOwner: nil];
+	[[NetApplication sharedInstance] disconnectObject: listener];
+	[listener close];
+	AUTORELEASE(listener);
+	listener = nil;
+
+	return self;
+}
+@end
@@ -37,6 +37,7 @@
 #import "NetBase.h"
 #import "NetTCP.h"
 #import "IRCObject.h"
+#import "NetMetrics.h"
 
 #import <Foundation/NSString.h>
 #import <Foundation/NSException.h>
@@ -51,19 +52,367 @@
 #import <Foundation/NSTimer.h>
 #import <Foundation/NSScanner.h>
 #import <Foundation/NSPathUtilities.h>
+#import <Foundation/NSHost.h>
 
 #include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 
 NSString *IRCException = @"IRCException";
 
+/* The longest host a server relays a line with. */
+#define HOST_LENGTH 63
+
 static NSMapTable *command_to_function = 0;
 static NSMapTable *ctcp_to_function = 0;
 
 static NSData *IRC_new_line = nil;
 
+/* Sets what is assumed until the server sends RPL_ISUPPORT. */
+static void reset_server_support(IRCServerSupport *support)
+{
+	memset(support, 0, sizeof(IRCServerSupport));
+	strcpy(support->channelTypes, "#&");
+	strcpy(support->prefixModes, "qaohv");
+	strcpy(support->prefixChars, "~&@%+");
+	strcpy(support->listModes, "beI");
+	strcpy(support->argumentModes, "k");
+	strcpy(support->setArgumentModes, "l");
+	strcpy(support->flagModes, "imnpst");
+	support->modes = 3;
+	support->maxTargets = 1;
+	support->nickLength = 9;
+}
+
+static void copy_support_string(char *destination, unsigned size,
+  const char *value, unsigned length)
+{
+	if (length >= size)
+	{
+		length = size - 1;
+	}
+	memcpy(destination, value, length);
+	destination[length] = 0;
+}
+
+unsigned IRCDecodeModes(const IRCServerSupport *support, BOOL onChannel,
+  const char *line, unsigned length, IRCModeChange *changes,
+  unsigned maxChanges)
+{
+	const char *end = line + length;
+	const char *modes = line;
+	const char *modesEnd, *argument, *argumentEnd;
+	char sign = '+';
+	char mode;
+	unsigned count = 0;
+	int words = 0;
+	BOOL takesArgument;
+
+	while (modes < end && *modes == ' ') modes++;
+	modesEnd = modes;
+	while (modesEnd < end && *modesEnd != ' ') modesEnd++;
+	argument = modesEnd;
+
+	for (; modes < modesEnd; modes++)
+	{
+		mode = *modes;
+		if (mode == '+' || mode == '-')
+		{
+			sign = mode;
+			continue;
+		}
+
+		takesArgument = (onChannel && mode &&
+		  (strchr(support->prefixModes, mode) ||
+		   strchr(support->listModes, mode) ||
+		   strchr(support->argumentModes, mode) ||
+		   (sign == '+' && strchr(support->setArgumentModes, mode))));
+
+		if (count < maxChanges)
+		{
+			changes[count].sign = sign;
+			changes[count].mode = mode;
+			changes[count].argument = takesArgument ? words : -1;
+			changes[count].argumentLocation = 0;
+			changes[count].argumentLength = 0;
+		}
+		if (takesArgument)
+		{
+			while (argument < end && *argument == ' ') argument++;
+			argumentEnd = argument;
+			while (argumentEnd < end && *argumentEnd != ' ') argumentEnd++;
+			if (count < maxChanges && argumentEnd > argument)
+			{
+				changes[count].argumentLocation = argument - line;
+				changes[count].argumentLength = argumentEnd - argument;
+			}
+			argument = argumentEnd;
+			words++;
+		}
+		count++;
+	}
+
+	return count;
+}
+
+typedef struct
+{
+	uint32_t offset;
+	uint16_t length;
+	uint8_t prefixLength;
+} name_entry;
+
+/* The filter of a listing started with
+ * -listChannelsWithMinimumUsers:nameMatching:topicContaining:batchSize:. */
+typedef struct
+{
+	unsigned minimumUsers;
+	unsigned batchSize;
+	char *pattern;
+	char *topic;
+} list_filter;
+
+/* Finds the command of a line without building any objects. */
+static inline const char *skip_IRC_prefix(const char *bytes, const char *end)
+{
+	if (bytes < end && *bytes == ':')
+	{
+		while (bytes < end && *bytes != ' ') bytes++;
+		while (bytes < end && *bytes == ' ') bytes++;
+	}
+	return bytes;
+}
+
+/* Returns YES if the command at <command> is the 3 digit <numeric>. */
+static inline BOOL is_raw_numeric(const char *command, const char *end,
+  const char *numeric)
+{
+	return (end - command >= 4 && memcmp(command, numeric, 3) == 0 &&
+	  command[3] == ' ');
+}
+
+/* Matches the glob <pattern> (* and ?) against <string> without regard
+ * to case. */
+static BOOL glob_match(const char *pattern, const char *string,
+  const char *end)
+{
+	const char *star = NULL;
+	const char *resume = NULL;
+
+	while (string < end)
+	{
+		if (*pattern == '*')
+		{
+			star = pattern++;
+			resume = string;
+		}
+		else if (*pattern && (*pattern == '?' ||
+		  tolower((unsigned char)*pattern) == tolower((unsigned char)*string)))
+		{
+			pattern++;
+			string++;
+		}
+		else if (star)
+		{
+			pattern = star + 1;
+			string = ++resume;
+		}
+		else
+		{
+			return NO;
+		}
+	}
+	while (*pattern == '*') pattern++;
+
+	return (*pattern == 0);
+}
+
+/* Returns YES if <string> contains <needle> without regard to case. */
+static BOOL contains_text(const char *string, const char *end,
+  const char *needle)
+{
+	unsigned length = strlen(needle);
+
+	for (; end - string >= (int)length; string++)
+	{
+		if (strncasecmp(string, needle, length) == 0)
+		{
+			return YES;
+		}
+	}
+	return NO;
+}
+
+static char *filter_string(NSString *aString, NSStringEncoding aEncoding)
+{
+	NSData *data;
+	char *result;
+
+	if ([aString length] == 0)
+	{
+		return NULL;
+	}
+	data = [aString dataUsingEncoding: aEncoding allowLossyConversion: YES];
+	result = malloc([data length] + 1);
+	memcpy(result, [data bytes], [data length]);
+	result[[data length]] = 0;
+
+	return result;
+}
+
+/* A subscription made with -subscribeToCommand:target:.  A NULL targets
+ * array means any target. */
+typedef struct
+{
+	char command[16];
+	unsigned length;
+	unsigned targetCount;
+	char **targets;
+} subscription;
+
+/* The commands IRCObject handles whatever the subscriptions. */
+static const char *always_handled[] =
+{
+	"PING", "ERROR", "NICK", "001", "005", "353", "366", "431", "432",
+	"433", "436", "461", "462", NULL
+};
+
+/* The casemappings of -lowercasingSelector, for comparing bytes. */
+typedef enum {
+	CaseMapASCII,
+	CaseMapStrictRFC1459,
+	CaseMapRFC1459
+} case_mapping;
+
+static case_mapping case_mapping_of(SEL aSelector)
+{
+	if (sel_isEqual(aSelector, @selector(lowercaseIRCString)))
+	{
+		return CaseMapRFC1459;
+	}
+	if (sel_isEqual(aSelector, @selector(lowercaseStrictRFC1459IRCString)))
+	{
+		return CaseMapStrictRFC1459;
+	}
+	return CaseMapASCII;
+}
+
+static inline char map_case(char c, case_mapping aMapping)
+{
+	if (c >= 'A' && c <= 'Z')
+	{
+		return c + ('a' - 'A');
+	}
+	if (aMapping == CaseMapASCII)
+	{
+		return c;
+	}
+	switch (c)
+	{
+		case '[': return '{';
+		case ']': return '}';
+		case '\\': return '|';
+		case '^': return (aMapping == CaseMapRFC1459) ? '~' : c;
+		default: return c;
+	}
+}
+
+/* Compares <var>length</var> bytes as IRC names under <var>aMapping</var>. */
+static BOOL names_equal(const char *a, const char *b, unsigned length,
+  case_mapping aMapping)
+{
+	unsigned x;
+
+	for (x = 0; x < length; x++)
+	{
+		if (map_case(a[x], aMapping) != map_case(b[x], aMapping))
+		{
+			return NO;
+		}
+	}
+	return YES;
+}
+
+/* Returns YES if the line with the command at <command> has been
+ * subscribed to.  Reads the first parameter only if it has to. */
+static BOOL is_subscribed(const subscription *entries, unsigned count,
+  const char *command, const char *end, case_mapping aMapping)
+{
+	const char *param, *paramEnd;
+	unsigned length = 0;
+	unsigned x, y;
+
+	while (command + length < end && command[length] != ' ') length++;
+	if (length == 0 || length >= sizeof(entries->command))
+	{
+		/* Let the parser complain about it. */
+		return YES;
+	}
+	for (x = 0; always_handled[x]; x++)
+	{
+		if (strlen(always_handled[x]) == length &&
+		  strncasecmp(always_handled[x], command, length) == 0)
+		{
+			return YES;
+		}
+	}
+
+	for (x = 0; x < count; x++)
+	{
+		if (entries[x].length != length ||
+		  strncasecmp(entries[x].command, command, length) != 0)
+		{
+			continue;
+		}
+		if (!entries[x].targets)
+		{
+			return YES;
+		}
+
+		param = command + length;
+		while (param < end && *param == ' ') param++;
+		if (param < end && *param == ':') param++;
+		paramEnd = param;
+		while (paramEnd < end && *paramEnd != ' ') paramEnd++;
+
+		for (y = 0; y < entries[x].targetCount; y++)
+		{
+			if (strlen(entries[x].targets[y]) == (unsigned)(paramEnd - param) &&
+			  names_equal(entries[x].targets[y], param, paramEnd - param,
+			  aMapping))
+			{
+				return YES;
+			}
+		}
+		return NO;
+	}
+	return NO;
+}
+
+static void free_subscription(subscription *entry)
+{
+	unsigned x;
+
+	for (x = 0; x < entry->targetCount; x++)
+	{
+		free(entry->targets[x]);
+	}
+	free(entry->targets);
+}
+
+static void free_list_filter(list_filter *filter)
+{
+	if (filter)
+	{
+		free(filter->pattern);
+		free(filter->topic);
+		free(filter);
+	}
+}
+
 @implementation NSString (IRCAddition)
 - (NSString *)uppercaseIRCString
 {
@@ -131,6 +480,28 @@ static NSData *IRC_new_line = nil;
 
 @interface IRCObject (InternalIRCObject)
 - setErrorString: (NSString *)anError;
+- supportParameter: (NSString *)aKey value: (NSString *)aValue;
+- withdrawSupportParameter: (NSString *)aKey;
+- namesReplyReceived: (const char *)bytes length: (unsigned)length;
+- endOfNamesReceived: (NSString *)aChannel;
+- listReplyReceived: (const char *)bytes length: (unsigned)length;
+- writeCommand: (NSString *)aCommand toTargets: (NSArray *)targets
+   withKeys: (NSArray *)keys trailing: (NSString *)aTrailing;
+- deliverListBatch;
+- endList;
+- writePostedString: (NSString *)aString;
+- (BOOL)decodesModes;
+@end
+
+@interface IRCNameList (InternalIRCNameList)
+- initWithEncoding: (NSStringEncoding)aEncoding;
+- addMember: (const char *)bytes length: (unsigned)length
+   prefixLength: (unsigned)prefixLength;
+@end
+
+@interface IRCModeChanges (InternalIRCModeChanges)
+- initWithModes: (NSString *)aModes arguments: (NSArray *)aArguments
+   support: (const IRCServerSupport *)aSupport onChannel: (BOOL)onChannel;
 @end
 	
 #define NEXT_SPACE(__y, __z, __string)\
@@ -331,35 +702,32 @@ inline NSArray *SeparateIRCNickAndHost(NSString *prefix)
 static void rec_isupport(IRCObject *client, NSArray *paramList)
 {
 	NSEnumerator *iter;
+	NSRange aRange;
 	id object;
 
 	iter = [paramList objectEnumerator];
 	while ((object = [iter nextObject]))
 	{
-		object = [object lowercaseString];
-		if ([object hasPrefix: @"casemapping="])
+		if (contains_a_space(object))
 		{
-			object = [object substringFromIndex: 12];
-			if ([object isEqualToString: @"rfc1459"])
-			{
-				[client setLowercasingSelector: @selector(lowercaseIRCString)];
-			} 
-			else if ([object isEqualToString: @"strict-rfc1459"])
-			{
-				[client setLowercasingSelector: 
-				  @selector(lowercaseStrictRFC1459IRCString)];
-			} 
-			else if ([object isEqualToString: @"ascii"])
-			{
-				[client setLowercasingSelector:
-				  @selector(lowercaseString)];
-			}
-			else
-			{
-				NSLog(@"Did not understand casemapping=%@", object);
-			}
-			break;
+			/* The "are supported by this server" at the end */
+			continue;
+		}
+		if ([object hasPrefix: @"-"])
+		{
+			[client withdrawSupportParameter:
+			  [[object substringFromIndex: 1] uppercaseString]];
+			continue;
+		}
+		aRange = [object rangeOfString: @"="];
+		if (aRange.location == NSNotFound)
+		{
+			[client supportParameter: [object uppercaseString] value: @""];
+			continue;
 		}
+		[client supportParameter:
+		  [[object substringToIndex: aRange.location] uppercaseString]
+		  value: [object substringFromIndex: NSMaxRange(aRange)]];
 	}
 }
 	
@@ -370,6 +738,15 @@ static void rec_numeric(IRCObject *client, NSString *command,
 	{
 		rec_isupport(client, paramList);
 	}
+	else if ([command isEqualToString: RPL_ENDOFNAMES] &&
+	  [paramList count] >= 1)
+	{
+		[client endOfNamesReceived: [paramList objectAtIndex: 0]];
+		if ([client suppressesNamesNumerics])
+		{
+			return;
+		}
+	}
 
 	[client numericCommandReceived: command withParams: paramList
 	  from: prefix];
@@ -400,6 +777,121 @@ static void rec_ccustom(IRCObject *client, NSString *prefix,
 	}
 }
 
+/* Splits the argument of a DCC request into the type, the file name
+ * (which may be quoted) and the remaining space separated words. */
+static NSArray *dcc_arguments(NSString *rest)
+{
+	NSMutableArray *args = [NSMutableArray array];
+	NSScanner *scanner;
+	NSString *word;
+
+	if (!rest)
+	{
+		return args;
+	}
+	scanner = [NSScanner scannerWithString: rest];
+
+	if (![scanner scanUpToString: @" " intoString: &word])
+	{
+		return args;
+	}
+	[args addObject: word];
+
+	if ([scanner scanString: @"\"" intoString: 0])
+	{
+		if (![scanner scanUpToString: @"\"" intoString: &word] ||
+		    ![scanner scanString: @"\"" intoString: 0])
+		{
+			return args;
+		}
+		[args addObject: word];
+	}
+	
+	while ([scanner scanUpToString: @" " intoString: &word])
+	{
+		[args addObject: word];
+	}
+
+	return args;
+}
+static void rec_cdcc(IRCObject *client, NSString *prefix,
+                     NSString *command, NSString *rest, NSString *to)
+{
+	NSArray *args = dcc_arguments(rest);
+	NSMutableDictionary *info;
+	NSString *type;
+	NSString *address;
+	NSHost *host;
+	int count = [args count];
+
+	if (![command isEqualToString: @"PRIVMSG"] || count < 4)
+	{
+		rec_ccustom(client, prefix, command, rest, to, @"DCC");
+		return;
+	}
+
+	type = [[args objectAtIndex: 0] uppercaseString];
+	info = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+	  [args objectAtIndex: 1], @"FileName", nil];
+
+	if ([type isEqualToString: @"SEND"])
+	{
+		address = [args objectAtIndex: 2];
+		if ([address rangeOfString: @"."].location != NSNotFound)
+		{
+			host = [NSHost hostWithAddress: address];
+		}
+		else
+		{
+			host = [[TCPSystem sharedInstance] hostFromHostOrderInteger:
+			  (uint32_t)strtoul([address cString], 0, 10)];
+		}
+		if (!host)
+		{
+			return;
+		}
+		[info setObject: host forKey: @"Host"];
+		[info setObject: [NSNumber numberWithInt: 
+		  [[args objectAtIndex: 3] intValue]] forKey: @"Port"];
+		if (count > 4)
+		{
+			[info setObject: [NSNumber numberWithUnsignedLongLong:
+			  strtoull([[args objectAtIndex: 4] cString], 0, 10)]
+			  forKey: @"Size"];
+		}
+		if (count > 5)
+		{
+			[info setObject: [args objectAtIndex: 5] forKey: @"Token"];
+		}
+		[client DCCSendRequestReceived: info from: prefix];
+	}
+	else if ([type isEqualToString: @"RESUME"] ||
+	         [type isEqualToString: @"ACCEPT"])
+	{
+		[info setObject: [NSNumber numberWithInt:
+		  [[args objectAtIndex: 2] intValue]] forKey: @"Port"];
+		[info setObject: [NSNumber numberWithUnsignedLongLong:
+		  strtoull([[args objectAtIndex: 3] cString], 0, 10)]
+		  forKey: @"Position"];
+		if (count > 4)
+		{
+			[info setObject: [args objectAtIndex: 4] forKey: @"Token"];
+		}
+		if ([type isEqualToString: @"RESUME"])
+		{
+			[client DCCResumeRequestReceived: info from: prefix];
+		}
+		else
+		{
+			[client DCCAcceptReceived: info from: prefix];
+		}
+	}
+	else
+	{
+		rec_ccustom(client, prefix, command, rest, to, @"DCC");
+	}
+}
+
 static void rec_nick(IRCObject *client, NSString *command,
                      NSString *prefix, NSArray *paramList)
 {
@@ -593,6 +1085,20 @@ static void rec_mode(IRCObject *client, NSString *command, NSString *prefix,
 	
 	[client modeChanged: [paramList objectAtIndex: 1] 
 	  on: [paramList objectAtIndex: 0] withParams: newParams from: prefix];
+
+	if ([client decodesModes])
+	{
+		const IRCServerSupport *support = [client serverSupport];
+		NSString *target = [paramList objectAtIndex: 0];
+		BOOL onChannel;
+
+		onChannel = ([target length] && [target characterAtIndex: 0] < 128 &&
+		  strchr(support->channelTypes, [target characterAtIndex: 0]));
+
+		[client modesChanged: AUTORELEASE([[IRCModeChanges alloc]
+		  initWithModes: [paramList objectAtIndex: 1] arguments: newParams
+		  support: support onChannel: onChannel]) on: target from: prefix];
+	}
 }
 static void rec_invite(IRCObject *client, NSString *command, NSString *prefix, 
                      NSArray *paramList)
@@ -639,44 +1145,740 @@ static void rec_ping(IRCObject *client, NSString *command, NSString *prefix,
 static void rec_pong(IRCObject *client, NSString *command, NSString *prefix,
                      NSArray *paramList)
 {
-	NSString *arg;
-	
-	arg = [paramList componentsJoinedByString: @" "];
-	
-	[client pongReceivedWithArgument: arg from: prefix];
+	NSString *arg;
+	
+	arg = [paramList componentsJoinedByString: @" "];
+	
+	[client pongReceivedWithArgument: arg from: prefix];
+}
+static void rec_wallops(IRCObject *client, NSString *command, NSString *prefix,
+                          NSArray *paramList)
+{
+	if (!prefix)
+	{
+		return;
+	}
+	if ([paramList count] < 1)
+	{
+		return;
+	}
+	
+	[client wallopsReceived: [paramList objectAtIndex: 0] from: prefix];
+}
+static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
+                        NSArray *paramList)
+{
+	if ([paramList count] < 1)
+	{
+		return;
+	}
+
+	[client errorReceived: [paramList objectAtIndex: 0]];
+}
+
+
+@implementation IRCObject (InternalIRCObject)
+- (BOOL)decodesModes
+{
+	return decodesModes;
+}
+- writePostedString: (NSString *)aString
+{
+	if (!transport)
+	{
+		return self;
+	}
+	return [self writeString: @"%@", aString];
+}
+- setErrorString: (NSString *)anError
+{
+	RELEASE(errorString);
+	errorString = RETAIN(anError);
+	return self;
+}
+- supportParameter: (NSString *)aKey value: (NSString *)aValue
+{
+	IRCServerSupport *support = &serverSupport;
+	const char *value = [aValue UTF8String];
+	const char *x, *y;
+	NSArray *groups;
+	unsigned count;
+
+	if (!value)
+	{
+		return self;
+	}
+
+	if ([aKey isEqualToString: @"CASEMAPPING"])
+	{
+		aValue = [aValue lowercaseString];
+		if ([aValue isEqualToString: @"rfc1459"])
+		{
+			[self setLowercasingSelector: @selector(lowercaseIRCString)];
+		} 
+		else if ([aValue isEqualToString: @"strict-rfc1459"])
+		{
+			[self setLowercasingSelector: 
+			  @selector(lowercaseStrictRFC1459IRCString)];
+		} 
+		else if ([aValue isEqualToString: @"ascii"])
+		{
+			[self setLowercasingSelector: @selector(lowercaseString)];
+		}
+		else
+		{
+			NSLog(@"Did not understand casemapping=%@", aValue);
+		}
+	}
+	else if ([aKey isEqualToString: @"PREFIX"])
+	{
+		/* (ov)@+, or nothing for no prefixes */
+		x = strchr(value, ')');
+		if (*value == '(' && x && strlen(x + 1) == (unsigned)(x - value - 1))
+		{
+			copy_support_string(support->prefixModes,
+			  sizeof(support->prefixModes), value + 1, x - value - 1);
+			copy_support_string(support->prefixChars,
+			  sizeof(support->prefixChars), x + 1, strlen(x + 1));
+		}
+		else if (!*value)
+		{
+			support->prefixModes[0] = support->prefixChars[0] = 0;
+		}
+	}
+	else if ([aKey isEqualToString: @"CHANMODES"])
+	{
+		groups = [aValue componentsSeparatedByString: @","];
+		count = [groups count];
+		if (count >= 4)
+		{
+			x = [[groups objectAtIndex: 0] UTF8String];
+			copy_support_string(support->listModes, sizeof(support->listModes),
+			  x, strlen(x));
+			x = [[groups objectAtIndex: 1] UTF8String];
+			copy_support_string(support->argumentModes,
+			  sizeof(support->argumentModes), x, strlen(x));
+			x = [[groups objectAtIndex: 2] UTF8String];
+			copy_support_string(support->setArgumentModes,
+			  sizeof(support->setArgumentModes), x, strlen(x));
+			x = [[groups objectAtIndex: 3] UTF8String];
+			copy_support_string(support->flagModes,
+			  sizeof(support->flagModes), x, strlen(x));
+		}
+	}
+	else if ([aKey isEqualToString: @"CHANTYPES"])
+	{
+		copy_support_string(support->channelTypes,
+		  sizeof(support->channelTypes), value, strlen(value));
+	}
+	else if ([aKey isEqualToString: @"MODES"])
+	{
+		support->modes = atoi(value);
+	}
+	else if ([aKey isEqualToString: @"MAXTARGETS"])
+	{
+		support->maxTargets = atoi(value);
+	}
+	else if ([aKey isEqualToString: @"NICKLEN"])
+	{
+		support->nickLength = atoi(value);
+	}
+	else if ([aKey isEqualToString: @"CHANNELLEN"])
+	{
+		support->channelLength = atoi(value);
+	}
+	else if ([aKey isEqualToString: @"TOPICLEN"])
+	{
+		support->topicLength = atoi(value);
+	}
+	else if ([aKey isEqualToString: @"TARGMAX"])
+	{
+		/* PRIVMSG:4,NOTICE:4,JOIN: */
+		support->targmaxCount = 0;
+		for (x = value; *x && support->targmaxCount < IRC_TARGMAX_ENTRIES;
+		  x = (*y) ? y + 1 : y)
+		{
+			const char *colon;
+
+			y = strchr(x, ',');
+			if (!y)
+			{
+				y = x + strlen(x);
+			}
+			colon = memchr(x, ':', y - x);
+			if (colon && colon > x)
+			{
+				copy_support_string(
+				  support->targmax[support->targmaxCount].command,
+				  sizeof(support->targmax[0].command), x, colon - x);
+				support->targmax[support->targmaxCount].maximum =
+				  atoi(colon + 1);
+				support->targmaxCount++;
+			}
+		}
+	}
+
+	return self;
+}
+- withdrawSupportParameter: (NSString *)aKey
+{
+	IRCServerSupport *support = &serverSupport;
+	IRCServerSupport defaults;
+
+	/* -PARAM puts back what is assumed when the server never sent it. */
+	reset_server_support(&defaults);
+	if ([aKey isEqualToString: @"CASEMAPPING"])
+	{
+		[self setLowercasingSelector: @selector(lowercaseIRCString)];
+	}
+	else if ([aKey isEqualToString: @"PREFIX"])
+	{
+		strcpy(support->prefixModes, defaults.prefixModes);
+		strcpy(support->prefixChars, defaults.prefixChars);
+	}
+	else if ([aKey isEqualToString: @"CHANMODES"])
+	{
+		strcpy(support->listModes, defaults.listModes);
+		strcpy(support->argumentModes, defaults.argumentModes);
+		strcpy(support->setArgumentModes, defaults.setArgumentModes);
+		strcpy(support->flagModes, defaults.flagModes);
+	}
+	else if ([aKey isEqualToString: @"CHANTYPES"])
+	{
+		strcpy(support->channelTypes, defaults.channelTypes);
+	}
+	else if ([aKey isEqualToString: @"MODES"])
+	{
+		support->modes = defaults.modes;
+	}
+	else if ([aKey isEqualToString: @"MAXTARGETS"])
+	{
+		support->maxTargets = defaults.maxTargets;
+	}
+	else if ([aKey isEqualToString: @"NICKLEN"])
+	{
+		support->nickLength = defaults.nickLength;
+	}
+	else if ([aKey isEqualToString: @"CHANNELLEN"])
+	{
+		support->channelLength = defaults.channelLength;
+	}
+	else if ([aKey isEqualToString: @"TOPICLEN"])
+	{
+		support->topicLength = defaults.topicLength;
+	}
+	else if ([aKey isEqualToString: @"TARGMAX"])
+	{
+		support->targmaxCount = 0;
+	}
+
+	return self;
+}
+- namesReplyReceived: (const char *)bytes length: (unsigned)length
+{
+	const char *end = bytes + length;
+	const char *channel = NULL;
+	const char *last = NULL;
+	const char *token;
+	unsigned channelLength = 0, lastLength = 0;
+	int middles = 0;
+	BOOL trailing = NO;
+	NSString *key;
+	IRCNameList *list;
+
+	/* 353 target [type] channel :names, where the names are the last
+	 * parameter whether or not it has a colon. */
+	while (1)
+	{
+		while (bytes < end && *bytes == ' ') bytes++;
+		if (bytes == end)
+		{
+			break;
+		}
+		if (*bytes == ':')
+		{
+			trailing = YES;
+			bytes++;
+			break;
+		}
+		token = bytes;
+		while (bytes < end && *bytes != ' ') bytes++;
+		channel = last;
+		channelLength = lastLength;
+		last = token;
+		lastLength = bytes - token;
+		middles++;
+	}
+	if (trailing)
+	{
+		channel = last;
+		channelLength = lastLength;
+	}
+	else
+	{
+		/* The names are the last middle parameter. */
+		bytes = last;
+		end = last + lastLength;
+		middles--;
+	}
+	if (middles < 2 || !channel)
+	{
+		return self;
+	}
+
+	key = AUTORELEASE([[NSString alloc] initWithBytes: channel
+	  length: channelLength encoding: defaultEncoding]);
+	key = [key performSelector: lowercasingSelector];
+	if (!(list = [pendingNames objectForKey: key]))
+	{
+		list = AUTORELEASE([[IRCNameList alloc]
+		  initWithEncoding: defaultEncoding]);
+		[pendingNames setObject: list forKey: key];
+	}
+
+	while (bytes < end)
+	{
+		unsigned prefixLength;
+		const char *nickEnd;
+
+		while (bytes < end && *bytes == ' ') bytes++;
+		token = bytes;
+		while (bytes < end && *bytes &&
+		  strchr(serverSupport.prefixChars, *bytes))
+		{
+			bytes++;
+		}
+		prefixLength = bytes - token;
+		while (bytes < end && *bytes != ' ' && *bytes != '!') bytes++;
+		nickEnd = bytes;
+		while (bytes < end && *bytes != ' ') bytes++;
+
+		if (nickEnd - token > (int)prefixLength)
+		{
+			[list addMember: token length: nickEnd - token
+			  prefixLength: prefixLength];
+		}
+	}
+
+	return self;
+}
+- endOfNamesReceived: (NSString *)aChannel
+{
+	NSString *key = [aChannel performSelector: lowercasingSelector];
+	IRCNameList *list;
+
+	list = AUTORELEASE(RETAIN([pendingNames objectForKey: key]));
+	if (!list)
+	{
+		list = AUTORELEASE([[IRCNameList alloc]
+		  initWithEncoding: defaultEncoding]);
+	}
+	[pendingNames removeObjectForKey: key];
+
+	[self namesReceived: list forChannel: aChannel];
+	return self;
+}
+- listReplyReceived: (const char *)bytes length: (unsigned)length
+{
+	list_filter *filter = listFilter;
+	const char *end = bytes + length;
+	const char *middles[3];
+	unsigned lengths[3];
+	const char *topic;
+	unsigned users;
+	int count = 0;
+	const char *x;
+	NSString *channel;
+
+	/* 322 target channel users :topic */
+	while (count < 3)
+	{
+		while (bytes < end && *bytes == ' ') bytes++;
+		if (bytes == end || *bytes == ':')
+		{
+			break;
+		}
+		middles[count] = bytes;
+		while (bytes < end && *bytes != ' ') bytes++;
+		lengths[count] = bytes - middles[count];
+		count++;
+	}
+	if (count < 3)
+	{
+		return self;
+	}
+	while (bytes < end && *bytes == ' ') bytes++;
+	if (bytes < end && *bytes == ':') bytes++;
+	topic = bytes;
+
+	for (users = 0, x = middles[2]; x < middles[2] + lengths[2] &&
+	  *x >= '0' && *x <= '9'; x++)
+	{
+		users = users * 10 + (*x - '0');
+	}
+	if (users < filter->minimumUsers)
+	{
+		return self;
+	}
+	if (filter->pattern && !glob_match(filter->pattern, middles[1],
+	  middles[1] + lengths[1]))
+	{
+		return self;
+	}
+	if (filter->topic && !contains_text(topic, end, filter->topic))
+	{
+		return self;
+	}
+
+	channel = AUTORELEASE([[NSString alloc] initWithBytes: middles[1]
+	  length: lengths[1] encoding: defaultEncoding]);
+	[listBatch addObject: [NSDictionary dictionaryWithObjectsAndKeys:
+	  channel, @"Channel",
+	  [NSNumber numberWithUnsignedInt: users], @"Users",
+	  AUTORELEASE([[NSString alloc] initWithBytes: topic length: end - topic
+	    encoding: defaultEncoding]), @"Topic",
+	  nil]];
+
+	if ([listBatch count] >= filter->batchSize)
+	{
+		[self deliverListBatch];
+	}
+	return self;
+}
+- writeCommand: (NSString *)aCommand toTargets: (NSArray *)targets
+   withKeys: (NSArray *)keys trailing: (NSString *)aTrailing
+{
+	NSMutableArray *lineTargets = [NSMutableArray array];
+	NSMutableArray *lineKeys = [NSMutableArray array];
+	unsigned maximum = [self maximumTargetsForCommand: aCommand];
+	unsigned fixed, prefix, targetBytes = 0, keyBytes = 0;
+	unsigned count = [targets count];
+	unsigned x, length, targetLength, keyLength;
+	NSString *target, *key;
+	NSMutableString *line;
+
+	/* The line as relayed, behind ":nick!user@host ", has to fit. */
+	prefix = ownPrefixLength;
+	if (!prefix)
+	{
+		prefix = strlen([nick UTF8String]) + 2 +
+		  strlen([userName UTF8String]) + 1 + HOST_LENGTH;
+	}
+	fixed = prefix + 2 + strlen([aCommand UTF8String]) + 1;
+	if (aTrailing)
+	{
+		fixed += 2 + [[aTrailing dataUsingEncoding: defaultEncoding
+		  allowLossyConversion: YES] length];
+	}
+
+	/* One past the last, to flush what is left. */
+	for (x = 0; x <= count; x++)
+	{
+		target = key = nil;
+		targetLength = keyLength = 0;
+		if (x < count)
+		{
+			target = [targets objectAtIndex: x];
+			key = (x < [keys count]) ? [keys objectAtIndex: x] : nil;
+			targetLength = [[target dataUsingEncoding: defaultEncoding
+			  allowLossyConversion: YES] length];
+			if ([key isKindOfClass: [NSString class]] && [key length])
+			{
+				keyLength = [[key dataUsingEncoding: defaultEncoding
+				  allowLossyConversion: YES] length];
+			}
+			else
+			{
+				key = nil;
+			}
+		}
+
+		/* Targets plus their commas, then a space and keys plus theirs. */
+		length = fixed + targetBytes + [lineTargets count] + targetLength;
+		if ([lineKeys count] || key)
+		{
+			length += 1 + keyBytes + [lineKeys count] + keyLength;
+		}
+
+		if ([lineTargets count] && (!target || length > 510 ||
+		  (maximum && [lineTargets count] >= maximum)))
+		{
+			line = [NSMutableString stringWithFormat: @"%@ %@", aCommand,
+			  [lineTargets componentsJoinedByString: @","]];
+			if ([lineKeys count])
+			{
+				[line appendFormat: @" %@",
+				  [lineKeys componentsJoinedByString: @","]];
+			}
+			if (aTrailing)
+			{
+				[line appendFormat: @" :%@", aTrailing];
+			}
+			[self writeString: @"%@", line];
+
+			[lineTargets removeAllObjects];
+			[lineKeys removeAllObjects];
+			targetBytes = keyBytes = 0;
+		}
+
+		if (target)
+		{
+			[lineTargets addObject: target];
+			targetBytes += targetLength;
+			if (key)
+			{
+				[lineKeys addObject: key];
+				keyBytes += keyLength;
+			}
+		}
+	}
+
+	return self;
+}
+- deliverListBatch
+{
+	NSArray *batch;
+
+	if ([listBatch count] == 0)
+	{
+		return self;
+	}
+	batch = AUTORELEASE([listBatch copy]);
+	[listBatch removeAllObjects];
+	[self listEntriesReceived: batch];
+
+	return self;
+}
+- endList
+{
+	free_list_filter(listFilter);
+	listFilter = NULL;
+	DESTROY(listBatch);
+	return self;
+}
+@end
+
+@implementation IRCNameList (InternalIRCNameList)
+- initWithEncoding: (NSStringEncoding)aEncoding
+{
+	if (!(self = [super init])) return nil;
+
+	names = [NSMutableData new];
+	entries = [NSMutableData new];
+	encoding = aEncoding;
+
+	return self;
+}
+- addMember: (const char *)bytes length: (unsigned)length
+   prefixLength: (unsigned)prefixLength
+{
+	name_entry entry;
+
+	if (length > 0xffff || prefixLength > 0xff)
+	{
+		return self;
+	}
+	entry.offset = [names length];
+	entry.length = length;
+	entry.prefixLength = prefixLength;
+	[names appendBytes: bytes length: length];
+	[entries appendBytes: &entry length: sizeof(entry)];
+
+	return self;
+}
+@end
+
+@implementation IRCModeChanges (InternalIRCModeChanges)
+- initWithModes: (NSString *)aModes arguments: (NSArray *)aArguments
+   support: (const IRCServerSupport *)aSupport onChannel: (BOOL)onChannel
+{
+	char buffer[128];
+	const char *modes = buffer;
+	unsigned length;
+	NSMutableData *decoded;
+	IRCModeChange *change;
+	unsigned count;
+	unsigned x;
+
+	if (!(self = [super init])) return nil;
+
+	arguments = RETAIN(aArguments);
+
+	/* Mode letters are ASCII; only an odd line needs a copy. */
+	if ([aModes getCString: buffer maxLength: sizeof(buffer)
+	  encoding: NSASCIIStringEncoding])
+	{
+		length = strlen(buffer);
+	}
+	else
+	{
+		NSData *data = [aModes dataUsingEncoding: NSASCIIStringEncoding
+		  allowLossyConversion: YES];
+		modes = [data bytes];
+		length = [data length];
+	}
+
+	/* There cannot be more changes than letters.  Decoding only the modes
+	 * gives every argument as an index into the arguments. */
+	decoded = [NSMutableData dataWithLength: length * sizeof(IRCModeChange)];
+	count = IRCDecodeModes(aSupport, onChannel, modes, length,
+	  [decoded mutableBytes], length);
+	change = [decoded mutableBytes];
+	for (x = 0; x < count; x++)
+	{
+		if (change[x].argument >= (int)[aArguments count])
+		{
+			change[x].argument = -1;
+		}
+	}
+	[decoded setLength: count * sizeof(IRCModeChange)];
+	changes = RETAIN(decoded);
+
+	return self;
+}
+@end
+
+@implementation IRCModeChanges
+- (void)dealloc
+{
+	RELEASE(arguments);
+	RELEASE(changes);
+	[super dealloc];
+}
+- (unsigned)count
+{
+	return [changes length] / sizeof(IRCModeChange);
+}
+- (const IRCModeChange *)changes
+{
+	return [changes bytes];
+}
+- (NSArray *)arguments
+{
+	return arguments;
+}
+- (BOOL)isSettingAtIndex: (unsigned)anIndex
+{
+	if (anIndex >= [self count])
+	{
+		[NSException raise: NSRangeException
+		  format: @"[IRCModeChanges isSettingAtIndex: %u] out of range",
+		  anIndex];
+	}
+	return ([self changes][anIndex].sign == '+');
+}
+- (char)modeAtIndex: (unsigned)anIndex
+{
+	if (anIndex >= [self count])
+	{
+		[NSException raise: NSRangeException
+		  format: @"[IRCModeChanges modeAtIndex: %u] out of range", anIndex];
+	}
+	return [self changes][anIndex].mode;
+}
+- (NSString *)argumentAtIndex: (unsigned)anIndex
+{
+	const IRCModeChange *change;
+
+	if (anIndex >= [self count])
+	{
+		[NSException raise: NSRangeException
+		  format: @"[IRCModeChanges argumentAtIndex: %u] out of range",
+		  anIndex];
+	}
+	change = [self changes] + anIndex;
+	if (change->argument < 0)
+	{
+		return nil;
+	}
+	return [arguments objectAtIndex: change->argument];
+}
+@end
+
+@implementation IRCNameList
+- init
+{
+	return [self initWithEncoding: [NSString defaultCStringEncoding]];
+}
+- (void)dealloc
+{
+	RELEASE(names);
+	RELEASE(entries);
+	[super dealloc];
+}
+- (unsigned)count
+{
+	return [entries length] / sizeof(name_entry);
 }
-static void rec_wallops(IRCObject *client, NSString *command, NSString *prefix,
-                          NSArray *paramList)
+- (NSString *)nickAtIndex: (unsigned)anIndex
 {
-	if (!prefix)
+	const name_entry *entry;
+
+	if (anIndex >= [self count])
 	{
-		return;
+		[NSException raise: NSRangeException
+		  format: @"[IRCNameList nickAtIndex: %u] out of range", anIndex];
 	}
-	if ([paramList count] < 1)
+	entry = (const name_entry *)[entries bytes] + anIndex;
+
+	return AUTORELEASE([[NSString alloc] initWithBytes:
+	  (const char *)[names bytes] + entry->offset + entry->prefixLength
+	  length: entry->length - entry->prefixLength encoding: encoding]);
+}
+- (NSString *)prefixesAtIndex: (unsigned)anIndex
+{
+	const name_entry *entry;
+
+	if (anIndex >= [self count])
 	{
-		return;
+		[NSException raise: NSRangeException
+		  format: @"[IRCNameList prefixesAtIndex: %u] out of range", anIndex];
 	}
-	
-	[client wallopsReceived: [paramList objectAtIndex: 0] from: prefix];
+	entry = (const name_entry *)[entries bytes] + anIndex;
+
+	return AUTORELEASE([[NSString alloc] initWithBytes:
+	  (const char *)[names bytes] + entry->offset
+	  length: entry->prefixLength encoding: NSASCIIStringEncoding]);
 }
-static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
-                        NSArray *paramList)
+- (BOOL)member: (unsigned)anIndex hasPrefix: (char)aPrefix
 {
-	if ([paramList count] < 1)
+	const name_entry *entry;
+
+	if (anIndex >= [self count])
 	{
-		return;
+		return NO;
 	}
+	entry = (const name_entry *)[entries bytes] + anIndex;
 
-	[client errorReceived: [paramList objectAtIndex: 0]];
+	return (memchr((const char *)[names bytes] + entry->offset, aPrefix,
+	  entry->prefixLength) != NULL);
 }
+- (NSArray *)nicks
+{
+	unsigned count = [self count];
+	NSMutableArray *array = [NSMutableArray arrayWithCapacity: count];
+	unsigned x;
 
-
-@implementation IRCObject (InternalIRCObject)
-- setErrorString: (NSString *)anError
+	for (x = 0; x < count; x++)
+	{
+		[array addObject: [self nickAtIndex: x]];
+	}
+	return array;
+}
+- (NSArray *)members
 {
-	RELEASE(errorString);
-	errorString = RETAIN(anError);
-	return self;
+	unsigned count = [self count];
+	NSMutableArray *array = [NSMutableArray arrayWithCapacity: count];
+	const name_entry *entry = [entries bytes];
+	unsigned x;
+
+	for (x = 0; x < count; x++, entry++)
+	{
+		[array addObject: AUTORELEASE([[NSString alloc] initWithBytes:
+		  (const char *)[names bytes] + entry->offset
+		  length: entry->length encoding: encoding])];
+	}
+	return array;
 }
 @end
 
@@ -707,6 +1909,7 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 	   NSIntMapValueCallBacks, 1);
 	
 	NSMapInsert(ctcp_to_function, @"\001ACTION", rec_caction);
+	NSMapInsert(ctcp_to_function, @"\001DCC", rec_cdcc);
 }
 - initWithNickname: (NSString *)aNickname withUserName: (NSString *)aUser
    withRealName: (NSString *)aRealName
@@ -716,6 +1919,9 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 	
 	lowercasingSelector = @selector(lowercaseIRCString);
 	defaultEncoding = [NSString defaultCStringEncoding];
+	decodesModes = ([self methodForSelector: @selector(modesChanged:on:from:)]
+	  != [IRCObject instanceMethodForSelector:
+	  @selector(modesChanged:on:from:)]);
 	
 	if (![self setNick: aNickname])
 	{
@@ -758,12 +1964,21 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 		return nil;
 	}
 
+	commandCounters = NetMetricsNewCommandCounters();
+
+	pendingNames = [NSMutableDictionary new];
+	reset_server_support(&serverSupport);
+
 	return self;
 }
 - (void)dealloc
 {
 	NSFreeMapTable(targetToEncoding);
+	NetMetricsFreeCommandCounters(commandCounters);
 	DESTROY(targetToOriginalTarget);
+	DESTROY(pendingNames);
+	[self endList];
+	[self removeAllSubscriptions];
 	DESTROY(nick);
 	DESTROY(userName);
 	DESTROY(realName);
@@ -775,6 +1990,7 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 - (void)connectionLost
 {
 	connected = NO;
+	[self endList];
 	[super connectionLost];
 }
 - setLowercasingSelector: (SEL)aSelector
@@ -908,6 +2124,12 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 }
 - connectionEstablished: (id <NetTransport>)aTransport
 {
+	linesIn = linesOut = linesSkipped = ownPrefixLength = 0;
+	NetMetricsFreeCommandCounters(commandCounters);
+	commandCounters = NetMetricsNewCommandCounters();
+	[pendingNames removeAllObjects];
+	reset_server_support(&serverSupport);
+
 	[super connectionEstablished: aTransport];
 	
 	[self setLowercasingSelector: @selector(lowercaseIRCString)];
@@ -968,6 +2190,163 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 {
 	return NSAllMapTableKeys(targetToEncoding);
 }
+- (const IRCServerSupport *)serverSupport
+{
+	return &serverSupport;
+}
+- (unsigned)maximumTargetsForCommand: (NSString *)aCommand
+{
+	const char *command = [aCommand UTF8String];
+	unsigned x;
+
+	for (x = 0; command && x < serverSupport.targmaxCount; x++)
+	{
+		if (strcasecmp(serverSupport.targmax[x].command, command) == 0)
+		{
+			return serverSupport.targmax[x].maximum;
+		}
+	}
+	if (command && (strcasecmp(command, "PRIVMSG") == 0 ||
+	  strcasecmp(command, "NOTICE") == 0))
+	{
+		return serverSupport.maxTargets;
+	}
+	return 1;
+}
+- (NSDictionary *)statistics
+{
+	NSMutableDictionary *dict;
+
+	dict = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: linesIn], @"LinesIn",
+	  [NSNumber numberWithUnsignedLongLong: linesOut], @"LinesOut",
+	  [NSNumber numberWithUnsignedLongLong: linesSkipped], @"LinesSkipped",
+	  NetMetricsCommandCounts(commandCounters, YES), @"LinesInByCommand",
+	  NetMetricsCommandCounts(commandCounters, NO), @"LinesOutByCommand",
+	  nil];
+
+	if ([(id)transport respondsToSelector: @selector(statistics)])
+	{
+		[dict setObject: [(id)transport statistics] forKey: @"Transport"];
+	}
+
+	return dict;
+}
+- setSuppressesNamesNumerics: (BOOL)aBool
+{
+	suppressesNamesNumerics = aBool;
+	return self;
+}
+- (BOOL)suppressesNamesNumerics
+{
+	return suppressesNamesNumerics;
+}
+- subscribeToCommand: (NSString *)aCommand
+{
+	return [self subscribeToCommand: aCommand target: nil];
+}
+- subscribeToCommand: (NSString *)aCommand target: (NSString *)aTarget
+{
+	const char *command = [aCommand cString];
+	subscription *entries;
+	subscription *entry = NULL;
+	unsigned count, x;
+	char *target = NULL;
+
+	if (!command || strlen(command) == 0 ||
+	  strlen(command) >= sizeof(entry->command))
+	{
+		[NSException raise: IRCException format:
+		  @"[IRCObject subscribeToCommand: '%@' target: '%@'] Unusable command",
+		  aCommand, aTarget];
+	}
+	if (aTarget && !(target = filter_string(aTarget, defaultEncoding)))
+	{
+		[NSException raise: IRCException format:
+		  @"[IRCObject subscribeToCommand: '%@' target: '%@'] Unusable target",
+		  aCommand, aTarget];
+	}
+	if (!subscriptions)
+	{
+		subscriptions = [NSMutableData new];
+	}
+
+	entries = [subscriptions mutableBytes];
+	count = [subscriptions length] / sizeof(subscription);
+	for (x = 0; x < count; x++)
+	{
+		if (strcasecmp(entries[x].command, command) == 0)
+		{
+			entry = entries + x;
+			break;
+		}
+	}
+	if (entry && (!entry->targets || !target))
+	{
+		/* Any target, now or from before. */
+		free_subscription(entry);
+		entry->targetCount = 0;
+		entry->targets = NULL;
+		free(target);
+		return self;
+	}
+	if (!entry)
+	{
+		[subscriptions increaseLengthBy: sizeof(subscription)];
+		entry = (subscription *)[subscriptions mutableBytes] + count;
+		strcpy(entry->command, command);
+		entry->length = strlen(command);
+		entry->targetCount = 0;
+		entry->targets = NULL;
+		if (!target)
+		{
+			return self;
+		}
+	}
+
+	entry->targets = realloc(entry->targets,
+	  (entry->targetCount + 1) * sizeof(char *));
+	entry->targets[entry->targetCount++] = target;
+
+	return self;
+}
+- unsubscribeFromCommand: (NSString *)aCommand
+{
+	const char *command = [aCommand cString];
+	subscription *entries = [subscriptions mutableBytes];
+	unsigned count = [subscriptions length] / sizeof(subscription);
+	unsigned x;
+
+	for (x = 0; command && x < count; x++)
+	{
+		if (strcasecmp(entries[x].command, command) == 0)
+		{
+			free_subscription(entries + x);
+			[subscriptions replaceBytesInRange: NSMakeRange(x *
+			  sizeof(subscription), sizeof(subscription)) withBytes: NULL
+			  length: 0];
+			break;
+		}
+	}
+	if ([subscriptions length] == 0)
+	{
+		DESTROY(subscriptions);
+	}
+	return self;
+}
+- removeAllSubscriptions
+{
+	subscription *entries = [subscriptions mutableBytes];
+	unsigned count = [subscriptions length] / sizeof(subscription);
+	unsigned x;
+
+	for (x = 0; x < count; x++)
+	{
+		free_subscription(entries + x);
+	}
+	DESTROY(subscriptions);
+	return self;
+}
 - changeNick: (NSString *)aNick
 {
 	if ([aNick length] > 0)
@@ -1055,6 +2434,78 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 
 	return self;
 }
+- joinChannels: (NSArray *)channels withPasswords: (NSArray *)passwords
+{
+	NSMutableArray *keyed = [NSMutableArray array];
+	NSMutableArray *keys = [NSMutableArray array];
+	NSMutableArray *unkeyed = [NSMutableArray array];
+	NSString *channel;
+	id password;
+	unsigned x;
+
+	for (x = 0; x < [channels count]; x++)
+	{
+		channel = [channels objectAtIndex: x];
+		password = (x < [passwords count]) ? [passwords objectAtIndex: x] : nil;
+		if ([channel length] == 0)
+		{
+			continue;
+		}
+		if ([(channel = string_to_string(channel, @" ")) length] == 0 ||
+		  [channel rangeOfString: @","].location != NSNotFound)
+		{
+			[NSException raise: IRCException
+			 format: @"[IRCObject joinChannels: '%@' ...] Unusable channel",
+			  channel];
+		}
+		if ([password isKindOfClass: [NSString class]] && [password length])
+		{
+			if ([(password = string_to_string(password, @" ")) length] == 0 ||
+			  [password rangeOfString: @","].location != NSNotFound)
+			{
+				[NSException raise: IRCException
+				 format: @"[IRCObject joinChannels: withPasswords: '%@'] "
+				  @"Unusable password", password];
+			}
+			[keyed addObject: channel];
+			[keys addObject: password];
+		}
+		else
+		{
+			[unkeyed addObject: channel];
+		}
+	}
+
+	[keyed addObjectsFromArray: unkeyed];
+	return [self writeCommand: @"JOIN" toTargets: keyed withKeys: keys
+	  trailing: nil];
+}
+- partChannels: (NSArray *)channels withMessage: (NSString *)aMessage
+{
+	NSMutableArray *targets = [NSMutableArray array];
+	NSEnumerator *iter;
+	NSString *channel;
+
+	iter = [channels objectEnumerator];
+	while ((channel = [iter nextObject]))
+	{
+		if ([channel length] == 0)
+		{
+			continue;
+		}
+		if ([(channel = string_to_string(channel, @" ")) length] == 0 ||
+		  [channel rangeOfString: @","].location != NSNotFound)
+		{
+			[NSException raise: IRCException
+			 format: @"[IRCObject partChannels: '%@' ...] Unusable channel",
+			  channel];
+		}
+		[targets addObject: channel];
+	}
+
+	return [self writeCommand: @"PART" toTargets: targets withKeys: nil
+	  trailing: ([aMessage length] > 0) ? aMessage : nil];
+}
 - sendCTCPReply: (NSString *)aCTCP withArgument: (NSString *)args
    to: (NSString *)aPerson
 {
@@ -1111,6 +2562,50 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 		
 	return self;
 }
+- sendDCCSendRequest: (NSString *)aFileName fromHost: (NSHost *)aHost
+   onPort: (uint16_t)aPort withSize: (unsigned long long)aSize
+   to: (NSString *)aPerson
+{
+	uint32_t address;
+
+	if ([aFileName length] == 0 || 
+	  ![[TCPSystem sharedInstance] hostOrderInteger: &address fromHost: aHost])
+	{
+		[NSException raise: IRCException format:
+		  @"[IRCObject sendDCCSendRequest: '%@' fromHost: '%@' ...] Unusable argument",
+		    aFileName, aHost];
+	}
+	if (contains_a_space(aFileName))
+	{
+		aFileName = [NSString stringWithFormat: @"\"%@\"", aFileName];
+	}
+
+	return [self sendCTCPRequest: @"DCC" withArgument:
+	  [NSString stringWithFormat: @"SEND %@ %lu %u %llu", aFileName,
+	    (unsigned long)address, (unsigned)aPort, aSize] to: aPerson];
+}
+- sendDCCResumeRequest: (NSString *)aFileName onPort: (uint16_t)aPort
+   atPosition: (unsigned long long)aPosition to: (NSString *)aPerson
+{
+	if (contains_a_space(aFileName))
+	{
+		aFileName = [NSString stringWithFormat: @"\"%@\"", aFileName];
+	}
+	return [self sendCTCPRequest: @"DCC" withArgument:
+	  [NSString stringWithFormat: @"RESUME %@ %u %llu", aFileName,
+	    (unsigned)aPort, aPosition] to: aPerson];
+}
+- sendDCCAccept: (NSString *)aFileName onPort: (uint16_t)aPort
+   atPosition: (unsigned long long)aPosition to: (NSString *)aPerson
+{
+	if (contains_a_space(aFileName))
+	{
+		aFileName = [NSString stringWithFormat: @"\"%@\"", aFileName];
+	}
+	return [self sendCTCPRequest: @"DCC" withArgument:
+	  [NSString stringWithFormat: @"ACCEPT %@ %u %llu", aFileName,
+	    (unsigned)aPort, aPosition] to: aPerson];
+}
 - sendMessage: (NSString *)aMessage to: (NSString *)aReceiver
 {
 	if ([aMessage length] == 0)
@@ -1153,6 +2648,66 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 	
 	return self;
 }
+- sendMessage: (NSString *)aMessage toReceivers: (NSArray *)receivers
+{
+	NSMutableArray *targets = [NSMutableArray array];
+	NSEnumerator *iter;
+	NSString *receiver;
+
+	if ([aMessage length] == 0)
+	{
+		return self;
+	}
+	iter = [receivers objectEnumerator];
+	while ((receiver = [iter nextObject]))
+	{
+		if ([receiver length] == 0)
+		{
+			continue;
+		}
+		if ([(receiver = string_to_string(receiver, @" ")) length] == 0 ||
+		  [receiver rangeOfString: @","].location != NSNotFound)
+		{
+			[NSException raise: IRCException
+			 format: @"[IRCObject sendMessage: '%@' toReceivers: '%@'] "
+			  @"Unusable receiver", aMessage, receiver];
+		}
+		[targets addObject: receiver];
+	}
+
+	return [self writeCommand: @"PRIVMSG" toTargets: targets withKeys: nil
+	  trailing: aMessage];
+}
+- sendNotice: (NSString *)aNotice toReceivers: (NSArray *)receivers
+{
+	NSMutableArray *targets = [NSMutableArray array];
+	NSEnumerator *iter;
+	NSString *receiver;
+
+	if ([aNotice length] == 0)
+	{
+		return self;
+	}
+	iter = [receivers objectEnumerator];
+	while ((receiver = [iter nextObject]))
+	{
+		if ([receiver length] == 0)
+		{
+			continue;
+		}
+		if ([(receiver = string_to_string(receiver, @" ")) length] == 0 ||
+		  [receiver rangeOfString: @","].location != NSNotFound)
+		{
+			[NSException raise: IRCException
+			 format: @"[IRCObject sendNotice: '%@' toReceivers: '%@'] "
+			  @"Unusable receiver", aNotice, receiver];
+		}
+		[targets addObject: receiver];
+	}
+
+	return [self writeCommand: @"NOTICE" toTargets: targets withKeys: nil
+	  trailing: aNotice];
+}
 - sendAction: (NSString *)anAction to: (NSString *)aReceiver
 {
 	if ([anAction length] == 0)
@@ -1706,6 +3261,35 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 	[self writeString: @"LIST %@ %@", aChannel, aServer];
 	return self;
 }
+- listChannelsWithMinimumUsers: (unsigned)aCount
+   nameMatching: (NSString *)aPattern topicContaining: (NSString *)aString
+   batchSize: (unsigned)aSize
+{
+	list_filter *filter;
+
+	if (listFilter)
+	{
+		[NSException raise: IRCException format:
+		  @"[IRCObject listChannelsWithMinimumUsers: %u nameMatching: '%@' "
+		  @"topicContaining: '%@' batchSize: %u] Already listing",
+		  aCount, aPattern, aString, aSize];
+	}
+
+	filter = malloc(sizeof(list_filter));
+	filter->minimumUsers = aCount;
+	filter->batchSize = (aSize > 0) ? aSize : 1;
+	filter->pattern = filter_string(aPattern, defaultEncoding);
+	filter->topic = filter_string(aString, defaultEncoding);
+	listFilter = filter;
+	listBatch = [[NSMutableArray alloc] initWithCapacity: filter->batchSize];
+
+	[self writeString: @"LIST"];
+	return self;
+}
+- (BOOL)isListing
+{
+	return (listFilter != NULL);
+}
 - invite: (NSString *)aPerson to: (NSString *)aChannel
 {
 	if ([aPerson length] == 0)
@@ -1819,6 +3403,19 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 {
 	return self;
 }
+- DCCSendRequestReceived: (NSDictionary *)fileInfo from: (NSString *)aPerson
+{
+	return self;
+}
+- DCCResumeRequestReceived: (NSDictionary *)fileInfo 
+   from: (NSString *)aPerson
+{
+	return self;
+}
+- DCCAcceptReceived: (NSDictionary *)fileInfo from: (NSString *)aPerson
+{
+	return self;
+}
 - errorReceived: (NSString *)anError
 {
 	return self;
@@ -1841,11 +3438,28 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 {
 	return self;
 }
+- modesChanged: (IRCModeChanges *)changes on: (NSString *)anObject
+   from: (NSString *)aPerson
+{
+	return self;
+}
 - numericCommandReceived: (NSString *)aCommand withParams: (NSArray *)paramList 
     from: (NSString *)aSender
 {
 	return self;
 }
+- namesReceived: (IRCNameList *)aList forChannel: (NSString *)aChannel
+{
+	return self;
+}
+- listEntriesReceived: (NSArray *)entries
+{
+	return self;
+}
+- listEnded
+{
+	return self;
+}
 - nickChangedTo: (NSString *)newName from: (NSString *)aPerson
 {
 	return self;
@@ -1908,7 +3522,69 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 	id object;
 	void (*function)(IRCObject *, NSString *, NSString *, NSArray *);
 	NSString *line, *orig;
+	const char *end = (const char *)[aLine bytes] + [aLine length];
+	const char *raw;
 	
+	/* LIST replies, subscriptions and NAMES replies are handled straight
+	 * from the bytes. */
+	raw = skip_IRC_prefix([aLine bytes], end);
+
+	/* Our own JOIN carries the nick!user@host others see us with. */
+	if (end - raw > 5 && memcmp(raw, "JOIN ", 5) == 0)
+	{
+		const char *own = [nick UTF8String];
+		const char *from = (const char *)[aLine bytes] + 1;
+		const char *space = memchr(from, ' ', end - from);
+		unsigned length = (own) ? strlen(own) : 0;
+
+		if (length && space && space < raw && space - from > length &&
+		  from[length] == '!' && strncasecmp(from, own, length) == 0)
+		{
+			ownPrefixLength = space - from;
+		}
+	}
+	if (listFilter && is_raw_numeric(raw, end, "322"))
+	{
+		linesIn++;
+		NetMetricsCountCommand(commandCounters, raw, end - raw, YES);
+		return [self listReplyReceived: raw + 3 length: end - raw - 3];
+	}
+	else if (listFilter && is_raw_numeric(raw, end, "321"))
+	{
+		linesIn++;
+		NetMetricsCountCommand(commandCounters, raw, end - raw, YES);
+		return self;
+	}
+	else if (listFilter && is_raw_numeric(raw, end, "323"))
+	{
+		linesIn++;
+		NetMetricsCountCommand(commandCounters, raw, end - raw, YES);
+		[self deliverListBatch];
+		[self endList];
+		[self listEnded];
+		return self;
+	}
+
+	if (subscriptions && !is_subscribed([subscriptions bytes],
+	  [subscriptions length] / sizeof(subscription), raw, end,
+	  case_mapping_of(lowercasingSelector)))
+	{
+		linesIn++;
+		linesSkipped++;
+		return self;
+	}
+
+	if (is_raw_numeric(raw, end, "353"))
+	{
+		[self namesReplyReceived: raw + 3 length: end - raw - 3];
+		if (suppressesNamesNumerics)
+		{
+			linesIn++;
+			NetMetricsCountCommand(commandCounters, raw, end - raw, YES);
+			return self;
+		}
+	}
+
 	orig = line = AUTORELEASE([[NSString alloc] initWithData: aLine
 	  encoding: defaultEncoding]);
 
@@ -1936,6 +3612,9 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 		 orig];
 	}
 
+	linesIn++;
+	NetMetricsCountCommand(commandCounters, raw, end - raw, YES);
+
 	while (1)
 	{
 		line = get_next_IRC_word(line, &object);
@@ -2003,13 +3682,20 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 - writeString: (NSString *)format, ...
 {
 	NSString *temp;
+	NSData *data;
 	va_list ap;
 
 	va_start(ap, format);
 	temp = AUTORELEASE([[NSString alloc] initWithFormat: format 
 	  arguments: ap]);
+	data = [temp dataUsingEncoding: defaultEncoding];
 
-	[(id <NetTransport>)transport writeData: [temp dataUsingEncoding: defaultEncoding]];
+	/* Sent from handlers on a NetWorkerPool as well as from the run loop
+	 * thread. */
+	__atomic_add_fetch(&linesOut, 1, __ATOMIC_RELAXED);
+	NetMetricsCountCommand(commandCounters, [data bytes], [data length], NO);
+
+	[(id <NetTransport>)transport writeData: data];
 	
 	if (![temp hasSuffix: @"\r\n"])
 	{
@@ -2017,6 +3703,16 @@ static void rec_error(IRCObject *client, NSString *command, NSString *prefix,
 	}
 	return self;
 }
+- postString: (NSString *)aString
+{
+	NSString *copy = [aString copy];
+
+	[[NetApplication sharedInstance] postMessage: @selector(writePostedString:)
+	  to: self withObject: copy];
+	RELEASE(copy);
+
+	return self;
+}
 @end
 
 NSString *RPL_WELCOME = @"001";
@@ -26,11 +26,15 @@
  */
 
 #import "LineObject.h"
+#import "NetPool.h"
 #import <Foundation/NSData.h>
 #import <Foundation/NSString.h>
 
 #include <string.h>
 
+/* The read buffer holds this much without growing. */
+#define READ_BUFFER_CAPACITY 2048
+
 static inline NSData *chomp_line(NSMutableData *data)
 {
 	char *memory = [data mutableBytes];
@@ -72,18 +76,24 @@ static inline NSData *chomp_line(NSMutableData *data)
 {
 	if (!(self = [super init])) return self;
 
-	_readData = [NSMutableData new];
+	_readData = [[NetBufferPool sharedPool]
+	  newBufferWithCapacity: READ_BUFFER_CAPACITY];
 
 	return self;
 }
 - (void)dealloc
 {
-	RELEASE(_readData);
+	/* A buffer grown by a long partial line goes back in the class it
+	 * grew to, or is freed. */
+	[[NetBufferPool sharedPool] recycleBuffer: _readData
+	  capacity: (_peakReadLength > READ_BUFFER_CAPACITY) ?
+	    _peakReadLength : READ_BUFFER_CAPACITY];
 	[super dealloc];
 }
 - (void)connectionLost
 {
 	[_readData setLength: 0];
+	_readingPaused = NO;
 	DESTROY(transport);
 }
 - connectionEstablished: (id <NetTransport>)aTransport
@@ -98,8 +108,15 @@ static inline NSData *chomp_line(NSMutableData *data)
 	id newLine;
 	
 	[_readData appendData: newData];
+	if ([_readData length] > _peakReadLength)
+	{
+		_peakReadLength = [_readData length];
+	}
 	
-	while (transport && (newLine = chomp_line(_readData))) [self lineReceived: newLine];
+	while (transport && !_readingPaused && (newLine = chomp_line(_readData)))
+	{
+		[self lineReceived: newLine];
+	}
 	
 	return self;
 }
@@ -107,6 +124,43 @@ static inline NSData *chomp_line(NSMutableData *data)
 {
 	return transport;
 }
+- pauseReading
+{
+	if (_readingPaused)
+	{
+		return self;
+	}
+	_readingPaused = YES;
+	if (transport)
+	{
+		[[NetApplication sharedInstance] pauseReadingObject: self];
+	}
+	return self;
+}
+- resumeReading
+{
+	id newLine;
+
+	if (!_readingPaused)
+	{
+		return self;
+	}
+	_readingPaused = NO;
+	if (transport)
+	{
+		[[NetApplication sharedInstance] resumeReadingObject: self];
+	}
+
+	while (transport && !_readingPaused && (newLine = chomp_line(_readData)))
+	{
+		[self lineReceived: newLine];
+	}
+	return self;
+}
+- (BOOL)isReadingPaused
+{
+	return _readingPaused;
+}
 - lineReceived: (NSData *)aLine
 {
 	return self;
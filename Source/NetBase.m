@@ -26,6 +26,10 @@
  */
 
 #import "NetBase.h"
+#import "NetHistogram.h"
+#import "NetWorkerPool.h"
+#import "NetUring.h"
+#import "NetPool.h"
 
 #import <Foundation/NSArray.h>
 #import <Foundation/NSMapTable.h>
@@ -35,17 +39,76 @@
 #import <Foundation/NSDate.h>
 #import <Foundation/NSException.h>
 #import <Foundation/NSAutoreleasePool.h>
+#import <Foundation/NSValue.h>
+#import <Foundation/NSTimer.h>
 
 #include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <fcntl.h>
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
 
 NSString *NetException = @"NetException";
 NSString *FatalNetException = @"FatalNetException";
 
 NetApplication *netApplication;
 
+static inline void count_accept(time_t *second, unsigned *thisSecond,
+  unsigned *lastSecond)
+{
+	time_t now = time(NULL);
+
+	if (now != *second)
+	{
+		*lastSecond = (now == *second + 1) ? *thisSecond : 0;
+		*thisSecond = 0;
+		*second = now;
+	}
+	(*thisSecond)++;
+}
+
+/* What is connected on a descriptor, worked out once by -connectObject:
+ * so that dispatching an event needs no protocol checks. */
+typedef enum {
+	NetKindPort = 1,
+	NetKindStream,
+	NetKindFilterable,
+	NetKindDatagram
+} net_kind;
+
+/* Added to the kind of a net object conforming to NetWritingObject. */
+#define NET_KIND_WATCHES_WRITES 0x100
+
+static net_kind kind_of(id anObject)
+{
+	id transport;
+
+	if ([anObject conformsToProtocol: @protocol(NetPort)])
+	{
+		return NetKindPort;
+	}
+	transport = [anObject transport];
+	if ([transport conformsToProtocol: @protocol(NetDatagramTransport)])
+	{
+		return NetKindDatagram;
+	}
+	if ([transport conformsToProtocol: @protocol(NetFilteredTransport)])
+	{
+		return NetKindFilterable;
+	}
+	return NetKindStream;
+}
+
+static inline BOOL is_filtered(net_kind aKind, id aTransport)
+{
+	return aKind == NetKindFilterable && [aTransport hasFilters];
+}
+
 #ifndef GNUSTEP
 #include <CoreFoundation/CoreFoundation.h>
 
@@ -239,6 +302,280 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 @end
 #endif
 
+#define LAG_PROBE_INTERVAL 0.1
+
+/* A write or message posted from another thread.  The queue is a stack
+ * pushed with compare-and-swap by any thread and taken whole by the run
+ * loop thread, so no node is ever popped while another thread looks at
+ * it.
+ */
+typedef struct post_node {
+	struct post_node *next;
+	id target;
+	id object;
+	SEL selector;      /* NULL for a write of object to the transport target */
+} post_node;
+
+/* Opens the descriptors that wake the run loop: one eventfd in both
+ * slots, or the read and write ends of a pipe.
+ */
+static int open_post_descs(int descs[2])
+{
+	int x;
+
+#ifdef HAVE_SYS_EVENTFD_H
+	descs[0] = descs[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (descs[0] >= 0)
+	{
+		return 0;
+	}
+#endif
+	if (pipe(descs) == -1)
+	{
+		descs[0] = descs[1] = -1;
+		return -1;
+	}
+	for (x = 0; x < 2; x++)
+	{
+		fcntl(descs[x], F_SETFL, fcntl(descs[x], F_GETFL) | O_NONBLOCK);
+		fcntl(descs[x], F_SETFD, FD_CLOEXEC);
+	}
+	return 0;
+}
+
+static void wake_post_descs(int descs[2])
+{
+	uint64_t one = 1;
+
+	/* A full pipe or a saturated eventfd already means a wakeup is due. */
+	if (write(descs[1], &one, sizeof(one)) == -1)
+	{
+		return;
+	}
+}
+
+static void clear_post_descs(int descs[2])
+{
+	char buffer[64];
+
+	while (read(descs[0], buffer, sizeof(buffer)) > 0);
+}
+
+static void free_post_nodes(post_node *node)
+{
+	post_node *next;
+
+	for (; node; node = next)
+	{
+		next = node->next;
+		RELEASE(node->target);
+		RELEASE(node->object);
+		free(node);
+	}
+}
+
+@interface NetApplication (InternalNetApplication)
+- (void)recordDispatchOf: (id)anObject since: (uint64_t)started;
+- lagTimerFired: (NSTimer *)aTimer;
+- postNode: (post_node *)aNode;
+- (void)drainPosted;
+- (void)endDispatch;
+- (void)flushTransports;
+- (void)lostObject: (id)anObject;
+@end
+
+/* The target of the lag timer.  A timer retains its target, so this
+ * stands in for NetApplication without retaining it, and the application
+ * can be deallocated while instrumentation is on. */
+@interface NetLagProbe : NSObject
+	{
+		NetApplication *application;
+	}
+- initWithApplication: (NetApplication *)anApplication;
+- fire: (NSTimer *)aTimer;
+@end
+
+@implementation NetLagProbe
+- initWithApplication: (NetApplication *)anApplication
+{
+	if (!(self = [super init])) return nil;
+
+	application = anApplication;
+
+	return self;
+}
+- fire: (NSTimer *)aTimer
+{
+	[application lagTimerFired: aTimer];
+	return self;
+}
+@end
+
+@implementation NetApplication (InternalNetApplication)
+- (void)recordDispatchOf: (id)anObject since: (uint64_t)started
+{
+	uint64_t elapsed = NetMonotonicMicroseconds() - started;
+	Class aClass = [anObject class];
+	NetHistogram *histogram;
+
+	[handlerHistogram recordValue: elapsed];
+
+	histogram = NSMapGet(classHistograms, aClass);
+	if (!histogram)
+	{
+		histogram = [NetHistogram new];
+		NSMapInsert(classHistograms, aClass, histogram);
+		RELEASE(histogram);
+	}
+	[histogram recordValue: elapsed];
+
+	if (slowTarget && slowThreshold && elapsed >= slowThreshold)
+	{
+		[slowTarget performSelector: slowSelector withObject: anObject
+		  withObject: [NSNumber numberWithDouble: elapsed / 1000000.0]];
+	}
+}
+- lagTimerFired: (NSTimer *)aTimer
+{
+	uint64_t now = NetMonotonicMicroseconds();
+	uint64_t expected;
+
+	expected = lagTimerFired + (uint64_t)(LAG_PROBE_INTERVAL * 1000000);
+	[lagHistogram recordValue: (now > expected) ? now - expected : 0];
+	lagTimerFired = now;
+
+	return self;
+}
+- (void)endDispatch
+{
+	dispatching = NO;
+	if ([flushQueue count])
+	{
+		[self flushTransports];
+	}
+}
+- (void)flushTransports
+{
+	TCPTransport *transport;
+
+	flushPerformPending = NO;
+	/* Taken off one at a time rather than from an autoreleased copy, so
+	 * the queue never holds a transport past its flush. */
+	while ([flushQueue count])
+	{
+		transport = RETAIN([flushQueue objectAtIndex: 0]);
+		[flushQueue removeObjectAtIndex: 0];
+		[transport flushWrites];
+		RELEASE(transport);
+	}
+}
+- postNode: (post_node *)aNode
+{
+	post_node *head;
+
+	head = __atomic_load_n((post_node **)&postHead, __ATOMIC_RELAXED);
+	do
+	{
+		aNode->next = head;
+	} while (!__atomic_compare_exchange_n((post_node **)&postHead, &head,
+	  aNode, YES, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+	/* Only the first post since the last drain has to wake the run loop;
+	 * the drain clears the flag before taking the queue, so a post it
+	 * misses always sees the flag clear. */
+	if (__atomic_exchange_n(&postWakeupPending, 1, __ATOMIC_SEQ_CST) == 0)
+	{
+		wake_post_descs(postDescs);
+	}
+	return self;
+}
+- (void)drainPosted
+{
+	post_node *list, *reversed = NULL, *node, **tail;
+	id target, object, netObject;
+	SEL selector;
+
+	clear_post_descs(postDescs);
+	postWakeups++;
+	__atomic_store_n(&postWakeupPending, 0, __ATOMIC_SEQ_CST);
+	list = __atomic_exchange_n((post_node **)&postHead, NULL,
+	  __ATOMIC_SEQ_CST);
+
+	/* The stack holds the newest post first. */
+	while (list)
+	{
+		node = list;
+		list = node->next;
+		node->next = reversed;
+		reversed = node;
+	}
+	/* Posts left over by a drain that raised go before the new ones. */
+	for (tail = (post_node **)&postBatch; *tail; tail = &(*tail)->next);
+	*tail = reversed;
+
+	while ((node = postBatch))
+	{
+		postBatch = node->next;
+		target = node->target;
+		object = node->object;
+		selector = node->selector;
+		free(node);
+		postsDelivered++;
+
+		NS_DURING
+			if (selector)
+			{
+				[target performSelector: selector withObject: object];
+			}
+			else if ([self netObjectForTransport: target])
+			{
+				[target writeData: object];
+			}
+		NS_HANDLER
+			if (([[localException name] isEqualToString:NetException]) ||
+			    ([[localException name] isEqualToString:FatalNetException]))
+			{
+				netObject = (selector) ? target :
+				  (id)[self netObjectForTransport: target];
+				if (netObject)
+				{
+					[self disconnectObject: netObject];
+				}
+			}
+			else
+			{
+				RELEASE(target);
+				RELEASE(object);
+				if (postBatch)
+				{
+					wake_post_descs(postDescs);
+				}
+				[self endDispatch];
+				[localException raise];
+			}
+		NS_ENDHANDLER
+
+		RELEASE(target);
+		RELEASE(object);
+	}
+}
+- (void)lostObject: (id)anObject
+{
+	NetWorkerPool *pool;
+
+	pool = (poolTable) ? NSMapGet(poolTable, anObject) : nil;
+	if (!pool)
+	{
+		[anObject connectionLost];
+		return;
+	}
+	RETAIN(pool);
+	NSMapRemove(poolTable, anObject);
+	[pool dispatch: @selector(connectionLost) to: anObject withObject: nil];
+	RELEASE(pool);
+}
+@end
+
 @implementation NetApplication
 + (int)netclassesMinorVersion
 {
@@ -266,6 +603,8 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 }
 - init
 {
+	const char *backend;
+
 	if (!(self = [super init])) return nil;
 	if (netApplication)
 	{
@@ -276,18 +615,73 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 	
 	descTable = NSCreateMapTable(NSIntMapKeyCallBacks, 
 	 NSNonRetainedObjectMapValueCallBacks, 100);
+	kindTable = NSCreateMapTable(NSIntMapKeyCallBacks, 
+	 NSIntMapValueCallBacks, 100);
+	transportTable = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+	 NSNonRetainedObjectMapValueCallBacks, 16);
+	pausedTable = NSCreateMapTable(NSIntMapKeyCallBacks,
+	 NSIntMapValueCallBacks, 16);
+	writerTable = NSCreateMapTable(NSObjectMapKeyCallBacks,
+	 NSIntMapValueCallBacks, 16);
 	
+	flushQueue = [NSMutableArray new];
 	portArray = [NSMutableArray new];
 	netObjectArray = [NSMutableArray new];
 	badDescs = [NSMutableArray new];
+
+	gettimeofday(&startTime, NULL);
+	acceptSecond = startTime.tv_sec;
+	runLoopThread = pthread_self();
+
+	if (open_post_descs(postDescs) == 0)
+	{
+		[[NSRunLoop currentRunLoop] addEvent: (void *)(intptr_t)postDescs[0]
+		 type: ET_RDESC watcher: self forMode: NSDefaultRunLoopMode];
+	}
+
+	backend = getenv("NETCLASSES_IO_BACKEND");
+	if (backend && strcmp(backend, "uring") == 0)
+	{
+		[self setIOBackend: NetUringBackend];
+	}
 	return self;
 }
 - (void)dealloc  // How in the world...
 {
+	[self setInstrumentationEnabled: NO];
+	RELEASE(handlerHistogram);
+	RELEASE(lagHistogram);
+	if (classHistograms) NSFreeMapTable(classHistograms);
+	RELEASE(flushQueue);
 	RELEASE(portArray);
 	RELEASE(netObjectArray);
 	RELEASE(badDescs);
 	NSFreeMapTable(descTable);
+	NSFreeMapTable(kindTable);
+	NSFreeMapTable(transportTable);
+	NSFreeMapTable(pausedTable);
+	NSFreeMapTable(writerTable);
+	if (poolTable) NSFreeMapTable(poolTable);
+
+	if (postDescs[0] >= 0)
+	{
+		[[NSRunLoop currentRunLoop] removeEvent: (void *)(intptr_t)postDescs[0]
+		 type: ET_RDESC forMode: NSDefaultRunLoopMode all: YES];
+		close(postDescs[0]);
+		if (postDescs[1] != postDescs[0])
+		{
+			close(postDescs[1]);
+		}
+	}
+	free_post_nodes((post_node *)postBatch);
+	free_post_nodes((post_node *)postHead);
+
+	if (uring)
+	{
+		[[NSRunLoop currentRunLoop] removeEvent: (void *)(intptr_t)[uring desc]
+		 type: ET_RDESC forMode: NSDefaultRunLoopMode all: YES];
+		RELEASE(uring);
+	}
 	
 	netApplication = nil;
 	[super dealloc];
@@ -304,15 +698,44 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
               forMode: (NSString *)mode
 {
 	id object;
+	net_kind kind;
+	uint64_t started = 0;
+
+	dispatching = YES;
+	if (type == ET_RDESC && postDescs[0] >= 0 &&
+	  data == (void *)(intptr_t)postDescs[0])
+	{
+		[self drainPosted];
+		[self endDispatch];
+		return;
+	}
+	if (type == ET_RDESC && uring && data == (void *)(intptr_t)[uring desc])
+	{
+		[uring handleCompletions];
+		[self endDispatch];
+		return;
+	}
 
 	object = (id)NSMapGet(descTable, data);
 	if (!object)
 	{
 		[[NSRunLoop currentRunLoop] removeEvent: data
 		 type: type forMode: NSDefaultRunLoopMode all: YES];
+		[self endDispatch];
 		return;
 	}
 	AUTORELEASE(RETAIN(object));
+	kind = (net_kind)((intptr_t)NSMapGet(kindTable, data) &
+	  ~NET_KIND_WATCHES_WRITES);
+
+	if ((unsigned)type < NET_EVENT_TYPE_COUNT)
+	{
+		eventCounts[type]++;
+	}
+	if (instrumented)
+	{
+		started = NetMonotonicMicroseconds();
+	}
 	
 	NS_DURING
 		switch(type)
@@ -320,9 +743,25 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 			default:
 				break;
 			case ET_RDESC:
-				if ([object conformsToProtocol: @protocol(NetObject)])
+				if (kind != NetKindPort)
 				{
-					[object dataReceived: [[object transport] readData: 0]];
+					id transport = [object transport];
+
+					if (kind == NetKindDatagram)
+					{
+						[transport receiveDatagramsFor: object];
+					}
+					else if (is_filtered(kind, transport))
+					{
+						[transport deliverData: [transport readData: 0]
+						  toObject: object];
+						[transport flushFilters];
+					}
+					else
+					{
+						[self passData: [transport readData: 0]
+						  toObject: object];
+					}
 				}
 				else
 				{
@@ -330,11 +769,16 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 				}
 				break;
 			case ET_WDESC:
+				if (is_filtered(kind, [object transport]))
+				{
+					[[object transport] flushFilters];
+				}
 				[[object transport] writeData: nil];
 				if ([[object transport] isDoneWriting])
 				{
 					[[NSRunLoop currentRunLoop] removeEvent: data
 					 type: ET_WDESC forMode: NSDefaultRunLoopMode all: YES];
+					[self transportFinishedWriting: [object transport]];
 				}
 				break;
 			case ET_EDESC:
@@ -352,16 +796,32 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 				  objectForKey: @"Data"];
 				if (data && ([data length] > 0))
 				{
-					[object dataReceived: data];
+					if (is_filtered(kind, [object transport]))
+					{
+						[[object transport] deliverData: data
+						  toObject: object];
+					}
+					else
+					{
+						[self passData: data toObject: object];
+					}
 				}
 			}	
 			[self disconnectObject: object];
 		}
 		else
 		{
+			[self endDispatch];
 			[localException raise];
 		}
 	NS_ENDHANDLER																
+
+	[self endDispatch];
+
+	if (instrumented)
+	{
+		[self recordDispatchOf: object since: started];
+	}
 }
 - connectObject: anObject
 {
@@ -378,6 +838,13 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 		desc = (void *)[[anObject transport] desc];
 		
 		[netObjectArray addObject: anObject];
+		totalConnections++;
+
+		if ((intptr_t)desc < 0)
+		{
+			NSMapInsert(transportTable, [anObject transport], anObject);
+			return self;
+		}
 	}
 	else
 	{		
@@ -387,6 +854,14 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 		    NSStringFromClass([anObject class])];
 	}
 	NSMapInsert(descTable, desc, anObject);
+	NSMapInsert(kindTable, desc, (void *)(intptr_t)(kind_of(anObject) |
+	  ([anObject conformsToProtocol: @protocol(NetWritingObject)] ?
+	  NET_KIND_WATCHES_WRITES : 0)));
+
+	if (ioBackend == NetUringBackend && [uring addObject: anObject])
+	{
+		return self;
+	}
 	
 	[[NSRunLoop currentRunLoop] addEvent: desc type: ET_EDESC
 	 watcher: self forMode: NSDefaultRunLoopMode];
@@ -401,6 +876,11 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 	id whichOne = nil;
 	
 	void *desc = 0;
+
+	if (!pthread_equal(pthread_self(), runLoopThread))
+	{
+		return [self postMessage: _cmd to: self withObject: anObject];
+	}
 	
 	if ([portArray containsObject: anObject])
 	{
@@ -413,14 +893,35 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 		whichOne = netObjectArray;
 		
 		desc = (void *)[[anObject transport] desc];
+
+		if ((intptr_t)desc < 0)
+		{
+			NSMapRemove(transportTable, [anObject transport]);
+			[flushQueue removeObjectIdenticalTo: [anObject transport]];
+
+			RETAIN(anObject);
+			[whichOne removeObject: anObject];
+			AUTORELEASE(anObject);
+
+			[self lostObject: anObject];
+
+			return self;
+		}
 		
 		[[NSRunLoop currentRunLoop] removeEvent: desc
 		 type: ET_WDESC forMode: NSDefaultRunLoopMode all: YES];
+		NSMapRemove(pausedTable, desc);
+		NSMapRemove(writerTable, [anObject transport]);
+		[flushQueue removeObjectIdenticalTo: [anObject transport]];
 	}	
 	else
 	{		
 		return self;
 	}
+	if ([uring handlesObject: anObject])
+	{
+		[uring removeObject: anObject];
+	}
 	[[NSRunLoop currentRunLoop] removeEvent: desc
 	 type: ET_RDESC forMode: NSDefaultRunLoopMode all: YES];
 		
@@ -428,12 +929,13 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 	 type: ET_EDESC forMode: NSDefaultRunLoopMode all: YES];
 	
 	NSMapRemove(descTable, desc);
+	NSMapRemove(kindTable, desc);
 
 	RETAIN(anObject);
 	[whichOne removeObject: anObject];
 	AUTORELEASE(anObject);
 		
-	[anObject connectionLost];
+	[self lostObject: anObject];
 	
 	return self;
 }
@@ -454,11 +956,32 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 	RELEASE(apr);
 	return self;
 }
+- flushTransportAfterDispatch: (TCPTransport *)aTransport
+{
+	[flushQueue addObject: aTransport];
+	if (!dispatching && !flushPerformPending)
+	{
+		flushPerformPending = YES;
+		[[NSRunLoop currentRunLoop] performSelector:
+		  @selector(flushTransports) target: self argument: nil order: 0
+		  modes: [NSArray arrayWithObject: NSDefaultRunLoopMode]];
+	}
+	return self;
+}
 - transportNeedsToWrite: (id <NetTransport>)aTransport
 {
 	int desc = [aTransport desc];
+	id object = (id)NSMapGet(descTable, (void *)desc);
 
-	if ((id)NSMapGet(descTable, (void *)desc))
+	if (object)
+	{
+		NSMapInsert(writerTable, aTransport, (void *)1);
+	}
+	if (object && [uring handlesObject: object])
+	{
+		[uring transportNeedsToWrite: (TCPTransport *)aTransport];
+	}
+	else if (object)
 	{
 		[[NSRunLoop currentRunLoop] addEvent: 
 		 (void *)desc type: ET_WDESC watcher: self 
@@ -466,6 +989,205 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 	}
 	return self;
 }
+- transportFinishedWriting: (id <NetTransport>)aTransport
+{
+	void *desc = (void *)(intptr_t)[aTransport desc];
+	id object = (id)NSMapGet(descTable, desc);
+
+	NSMapRemove(writerTable, aTransport);
+	if (object && ((intptr_t)NSMapGet(kindTable, desc) &
+	  NET_KIND_WATCHES_WRITES))
+	{
+		[object writingFinished];
+	}
+	return self;
+}
+- pauseReadingObject: (id <NetObject>)anObject
+{
+	void *desc;
+	intptr_t count;
+
+	if (!pthread_equal(pthread_self(), runLoopThread))
+	{
+		return [self postMessage: _cmd to: self withObject: anObject];
+	}
+	desc = (void *)(intptr_t)[[anObject transport] desc];
+
+	if ((intptr_t)desc < 0 || (id)NSMapGet(descTable, desc) != anObject)
+	{
+		return self;
+	}
+	count = (intptr_t)NSMapGet(pausedTable, desc);
+	if (count == 0 && [uring handlesObject: anObject])
+	{
+		[uring pauseReadingObject: anObject];
+	}
+	else if (count == 0)
+	{
+		[[NSRunLoop currentRunLoop] removeEvent: desc
+		 type: ET_RDESC forMode: NSDefaultRunLoopMode all: YES];
+	}
+	NSMapInsert(pausedTable, desc, (void *)(count + 1));
+	return self;
+}
+- resumeReadingObject: (id <NetObject>)anObject
+{
+	void *desc;
+	intptr_t count;
+
+	if (!pthread_equal(pthread_self(), runLoopThread))
+	{
+		return [self postMessage: _cmd to: self withObject: anObject];
+	}
+	desc = (void *)(intptr_t)[[anObject transport] desc];
+
+	if ((intptr_t)desc < 0 || (id)NSMapGet(descTable, desc) != anObject)
+	{
+		return self;
+	}
+	count = (intptr_t)NSMapGet(pausedTable, desc);
+	if (count > 1)
+	{
+		NSMapInsert(pausedTable, desc, (void *)(count - 1));
+	}
+	else if (count == 1)
+	{
+		NSMapRemove(pausedTable, desc);
+		if ([uring handlesObject: anObject])
+		{
+			[uring resumeReadingObject: anObject];
+		}
+		else
+		{
+			[[NSRunLoop currentRunLoop] addEvent: desc type: ET_RDESC
+			 watcher: self forMode: NSDefaultRunLoopMode];
+		}
+	}
+	return self;
+}
+- postWriteData: (NSData *)data toTransport: (id <NetTransport>)aTransport
+{
+	post_node *node;
+
+	if (!data || !aTransport)
+	{
+		return self;
+	}
+	if (postDescs[0] < 0 || !(node = malloc(sizeof(post_node))))
+	{
+		[NSException raise: NetException
+		  format: @"[NetApplication postWriteData:toTransport:] cannot post"];
+	}
+	node->target = RETAIN(aTransport);
+	node->object = RETAIN(data);
+	node->selector = NULL;
+
+	return [self postNode: node];
+}
+- postMessage: (SEL)aSelector to: (id)aTarget withObject: (id)anObject
+{
+	post_node *node;
+
+	if (!aSelector || !aTarget)
+	{
+		return self;
+	}
+	if (postDescs[0] < 0 || !(node = malloc(sizeof(post_node))))
+	{
+		[NSException raise: NetException
+		  format: @"[NetApplication postMessage:to:withObject:] cannot post"];
+	}
+	node->target = RETAIN(aTarget);
+	node->object = RETAIN(anObject);
+	node->selector = aSelector;
+
+	return [self postNode: node];
+}
+- (BOOL)isRunLoopThread
+{
+	return pthread_equal(pthread_self(), runLoopThread) ? YES : NO;
+}
+- (BOOL)setIOBackend: (NetIOBackend)aBackend
+{
+	if (aBackend == NetUringBackend && !uring)
+	{
+		if (!(uring = [NetUring new]))
+		{
+			ioBackend = NetReadinessBackend;
+			return NO;
+		}
+		[[NSRunLoop currentRunLoop] addEvent: (void *)(intptr_t)[uring desc]
+		 type: ET_RDESC watcher: self forMode: NSDefaultRunLoopMode];
+	}
+	ioBackend = aBackend;
+	return YES;
+}
+- (NetIOBackend)ioBackend
+{
+	return ioBackend;
+}
+- (unsigned long long)pendingWriteBytes: (unsigned *)aCount
+{
+	NSMutableArray *done = [NSMutableArray array];
+	unsigned long long total = 0;
+	unsigned count = 0;
+	NSMapEnumerator iter;
+	id transport;
+	void *value;
+	int x;
+
+	iter = NSEnumerateMapTable(writerTable);
+	while (NSNextMapEnumeratorPair(&iter, (void **)&transport, &value))
+	{
+		/* Transports drained by the io_uring backend or by an
+		 * immediate write are only found out here.  A closed transport
+		 * raises from -isDoneWriting, so it is looked up first. */
+		if (![self netObjectForTransport: transport] ||
+		  [transport isDoneWriting])
+		{
+			[done addObject: transport];
+		}
+		else if ([transport isKindOfClass: [TCPTransport class]])
+		{
+			total += [transport writeBufferLength];
+			count++;
+		}
+	}
+	NSEndMapTableEnumeration(&iter);
+
+	for (x = 0; x < (int)[done count]; x++)
+	{
+		NSMapRemove(writerTable, [done objectAtIndex: x]);
+	}
+	if (aCount)
+	{
+		*aCount = count;
+	}
+	return total;
+}
+- (void)connectionAccepted
+{
+	totalAccepts++;
+	count_accept(&acceptSecond, &acceptsThisSecond, &acceptsLastSecond);
+}
+- (id <NetObject>)netObjectForTransport: (id <NetTransport>)aTransport
+{
+	int desc = [aTransport desc];
+	id object;
+
+	if (desc < 0)
+	{
+		return (id)NSMapGet(transportTable, aTransport);
+	}
+
+	object = (id)NSMapGet(descTable, (void *)desc);
+	if ([object conformsToProtocol: @protocol(NetObject)] &&
+	  [object transport] == aTransport)
+	{
+		return object;
+	}
+	return nil;
+}
 - (NSArray *)netObjectArray
 {
 	return [NSArray arrayWithArray: netObjectArray];
@@ -474,5 +1196,139 @@ static void handle_cf_events(CFSocketRef s, CFSocketCallBackType callbackType,
 {
 	return [NSArray arrayWithArray: portArray];
 }
+- (NSDictionary *)statistics
+{
+	struct timeval now;
+	time_t second = time(NULL);
+	unsigned perSecond;
+	double uptime;
+	NSDictionary *events;
+	NSMutableDictionary *dict;
+
+	if (second == acceptSecond + 1)
+	{
+		perSecond = acceptsThisSecond;
+	}
+	else if (second == acceptSecond)
+	{
+		perSecond = acceptsLastSecond;
+	}
+	else
+	{
+		perSecond = 0;
+	}
+
+	gettimeofday(&now, NULL);
+	uptime = (now.tv_sec - startTime.tv_sec) + 
+	  (now.tv_usec - startTime.tv_usec) / 1000000.0;
+
+	events = [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: eventCounts[ET_RDESC]], 
+	    @"ET_RDESC",
+	  [NSNumber numberWithUnsignedLongLong: eventCounts[ET_WDESC]], 
+	    @"ET_WDESC",
+	  [NSNumber numberWithUnsignedLongLong: eventCounts[ET_RPORT]], 
+	    @"ET_RPORT",
+	  [NSNumber numberWithUnsignedLongLong: eventCounts[ET_EDESC]], 
+	    @"ET_EDESC",
+	  nil];
+
+	dict = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedInt: [netObjectArray count]], 
+	    @"Connections",
+	  [NSNumber numberWithUnsignedInt: [portArray count]], @"Ports",
+	  [NSNumber numberWithUnsignedLongLong: totalConnections], 
+	    @"TotalConnections",
+	  [NSNumber numberWithUnsignedLongLong: totalAccepts], @"Accepts",
+	  [NSNumber numberWithUnsignedInt: perSecond], @"AcceptsPerSecond",
+	  events, @"Events",
+	  [NSNumber numberWithDouble: uptime], @"Uptime",
+	  [NSNumber numberWithUnsignedLongLong: postsDelivered], @"Posted",
+	  [NSNumber numberWithUnsignedLongLong: postWakeups], @"PostWakeups",
+	  nil];
+	if (uring)
+	{
+		[dict setObject: [uring statistics] forKey: @"Uring"];
+	}
+	[dict setObject: [[NetBufferPool sharedPool] statistics]
+	  forKey: @"BufferPool"];
+	[dict setObject: [NetObjectPool statistics] forKey: @"ObjectPools"];
+	return dict;
+}
+- setInstrumentationEnabled: (BOOL)aFlag
+{
+	if (aFlag == instrumented)
+	{
+		return self;
+	}
+
+	if (aFlag)
+	{
+		if (!handlerHistogram)
+		{
+			handlerHistogram = [NetHistogram new];
+			lagHistogram = [NetHistogram new];
+			classHistograms = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+			  NSObjectMapValueCallBacks, 16);
+		}
+		lagTimerFired = NetMonotonicMicroseconds();
+		lagTimer = RETAIN([NSTimer scheduledTimerWithTimeInterval:
+		    LAG_PROBE_INTERVAL
+		  target: AUTORELEASE([[NetLagProbe alloc] initWithApplication: self])
+		  selector: @selector(fire:) userInfo: nil repeats: YES]);
+	}
+	else
+	{
+		[lagTimer invalidate];
+		DESTROY(lagTimer);
+	}
+
+	instrumented = aFlag;
+	return self;
+}
+- (BOOL)instrumentationEnabled
+{
+	return instrumented;
+}
+- (NetHistogram *)handlerHistogram
+{
+	return handlerHistogram;
+}
+- (NetHistogram *)lagHistogram
+{
+	return lagHistogram;
+}
+- (NSDictionary *)handlerHistogramsByClass
+{
+	NSMutableDictionary *dict;
+	NSMapEnumerator iter;
+	Class aClass;
+	NetHistogram *histogram;
+
+	dict = [NSMutableDictionary dictionary];
+	if (!classHistograms)
+	{
+		return dict;
+	}
+
+	iter = NSEnumerateMapTable(classHistograms);
+	while (NSNextMapEnumeratorPair(&iter, (void **)&aClass, 
+	  (void **)&histogram))
+	{
+		[dict setObject: histogram forKey: NSStringFromClass(aClass)];
+	}
+	NSEndMapTableEnumeration(&iter);
+
+	return dict;
+}
+- setSlowHandlerThreshold: (double)seconds target: (id)aTarget
+   selector: (SEL)aSelector
+{
+	slowThreshold = (seconds > 0) ? (uint64_t)(seconds * 1000000) : 0;
+	slowTarget = aTarget;
+	slowSelector = aSelector;
+
+	return self;
+}
 @end
 
@@ -0,0 +1,411 @@
+/***************************************************************************
+                                NetCapture.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetCapture reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#import "NetCapture.h"
+#import <Foundation/NSString.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSValue.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+/* The file starts with a capture_header, and the ring starts at
+ * CAPTURE_DATA_OFFSET.  head and tail are byte positions that only ever
+ * grow; a position's offset in the ring is the position modulo the
+ * capacity.  Everything from tail up to head is records.
+ *
+ * A record is a capture_record followed by its data, padded to a multiple
+ * of 8 bytes.  A record never wraps around the end of the ring: if it does
+ * not fit in what is left, that space is skipped, either with a record of
+ * type CAPTURE_SKIP or, if less than a capture_record is left, without
+ * one.
+ *
+ * The writer moves tail past any records it is about to overwrite before
+ * writing, and moves head past a record only once it has been written.  A
+ * reader copies a record and then checks that tail has not moved past it
+ * in the meantime.
+ */
+#define CAPTURE_MAGIC "NCCAP1"
+#define CAPTURE_VERSION 1
+#define CAPTURE_DATA_OFFSET 4096
+#define CAPTURE_MIN_CAPACITY 4096
+#define CAPTURE_SKIP 0xffff
+#define CAPTURE_TRUNCATED 1
+
+#define CAPTURE_ALIGN(x) (((x) + 7) & ~(uint64_t)7)
+
+typedef struct capture_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t dataOffset;
+	uint64_t capacity;
+	uint64_t head;
+	uint64_t tail;
+	uint64_t records;
+	uint64_t bytes;
+	uint64_t overwritten;
+	uint64_t truncated;
+} capture_header;
+
+typedef struct capture_record
+{
+	uint64_t time;
+	uint32_t connection;
+	uint16_t type;
+	uint16_t flags;
+	uint32_t length;
+	uint32_t check;
+} capture_record;
+
+NetCapture *NetActiveCapture = nil;
+
+static uint32_t next_connection = 0;
+
+uint32_t NetCaptureNextConnection(void)
+{
+	return __atomic_add_fetch(&next_connection, 1, __ATOMIC_RELAXED);
+}
+
+/* Returns the size in the ring of the record at position, which is at
+ * offset in the ring of header.  Skipped space counts as one record. */
+static uint64_t record_span(capture_header *header, char *ring,
+  uint64_t position)
+{
+	uint64_t offset = position % header->capacity;
+	uint64_t left = header->capacity - offset;
+	capture_record *record;
+
+	if (left < sizeof(capture_record))
+	{
+		return left;
+	}
+	record = (capture_record *)(ring + offset);
+	if (record->type == CAPTURE_SKIP)
+	{
+		return left;
+	}
+	return sizeof(capture_record) + CAPTURE_ALIGN(record->length);
+}
+
+@implementation NetCapture
++ (void)setActiveCapture: (NetCapture *)aCapture
+{
+	ASSIGN(NetActiveCapture, aCapture);
+}
++ (NetCapture *)activeCapture
+{
+	return NetActiveCapture;
+}
+- initWithFile: (NSString *)aPath size: (unsigned long long)aSize
+{
+	capture_header *header;
+	int fd;
+
+	if (!(self = [super init])) return nil;
+
+	aSize = CAPTURE_ALIGN(aSize);
+	if (aSize < CAPTURE_MIN_CAPACITY)
+	{
+		aSize = CAPTURE_MIN_CAPACITY;
+	}
+	mapLength = CAPTURE_DATA_OFFSET + aSize;
+
+	fd = open([aPath fileSystemRepresentation], O_RDWR | O_CREAT | O_TRUNC,
+	  0600);
+	if (fd == -1)
+	{
+		[self release];
+		return nil;
+	}
+	if (ftruncate(fd, mapLength) != 0)
+	{
+		close(fd);
+		[self release];
+		return nil;
+	}
+	map = mmap(NULL, mapLength, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		map = NULL;
+		[self release];
+		return nil;
+	}
+
+	header = map;
+	header->version = CAPTURE_VERSION;
+	header->dataOffset = CAPTURE_DATA_OFFSET;
+	header->capacity = aSize;
+	memcpy(header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+
+	path = RETAIN(aPath);
+	writable = YES;
+
+	return self;
+}
+- initForReadingFile: (NSString *)aPath
+{
+	capture_header *header;
+	struct stat info;
+	int fd;
+
+	if (!(self = [super init])) return nil;
+
+	fd = open([aPath fileSystemRepresentation], O_RDONLY);
+	if (fd == -1)
+	{
+		[self release];
+		return nil;
+	}
+	if (fstat(fd, &info) != 0 || info.st_size < CAPTURE_DATA_OFFSET)
+	{
+		close(fd);
+		[self release];
+		return nil;
+	}
+	mapLength = info.st_size;
+	map = mmap(NULL, mapLength, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		map = NULL;
+		[self release];
+		return nil;
+	}
+
+	header = map;
+	if (memcmp(header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 ||
+	  header->version != CAPTURE_VERSION ||
+	  header->dataOffset != CAPTURE_DATA_OFFSET ||
+	  header->capacity < CAPTURE_MIN_CAPACITY ||
+	  header->capacity % 8 != 0 ||
+	  header->capacity > mapLength - CAPTURE_DATA_OFFSET)
+	{
+		[self release];
+		return nil;
+	}
+
+	path = RETAIN(aPath);
+	[self rewind];
+
+	return self;
+}
+- (void)dealloc
+{
+	if (map)
+	{
+		munmap(map, mapLength);
+	}
+	RELEASE(path);
+
+	[super dealloc];
+}
+- (NSString *)path
+{
+	return path;
+}
+- (unsigned long long)capacity
+{
+	return ((capture_header *)map)->capacity;
+}
+- rewind
+{
+	cursor = __atomic_load_n(&((capture_header *)map)->tail, __ATOMIC_ACQUIRE);
+	return self;
+}
+- (NSDictionary *)nextRecord
+{
+	capture_header *header = map;
+	char *ring = (char *)map + CAPTURE_DATA_OFFSET;
+	capture_record record;
+	uint64_t head, tail, offset;
+	NSData *data;
+
+	while (1)
+	{
+		head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+		tail = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+		if (cursor < tail)
+		{
+			cursor = tail;
+		}
+		if (cursor >= head)
+		{
+			return nil;
+		}
+
+		offset = cursor % header->capacity;
+		if (header->capacity - offset < sizeof(record))
+		{
+			cursor += header->capacity - offset;
+			continue;
+		}
+		memcpy(&record, ring + offset, sizeof(record));
+		if (record.type == CAPTURE_SKIP)
+		{
+			cursor += header->capacity - offset;
+			continue;
+		}
+		if (record.check != (uint32_t)cursor ||
+		  sizeof(record) + record.length > header->capacity - offset)
+		{
+			/* Overwritten while we looked, or damaged. */
+			tail = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+			if (tail <= cursor)
+			{
+				return nil;
+			}
+			cursor = tail;
+			continue;
+		}
+
+		data = [NSData dataWithBytes: ring + offset + sizeof(record)
+		  length: record.length];
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		tail = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+		if (tail > cursor)
+		{
+			cursor = tail;
+			continue;
+		}
+
+		cursor += sizeof(record) + CAPTURE_ALIGN(record.length);
+
+		return [NSDictionary dictionaryWithObjectsAndKeys:
+		  [NSNumber numberWithUnsignedLongLong: record.time], @"Time",
+		  [NSNumber numberWithUnsignedInt: record.connection], @"Connection",
+		  [NSNumber numberWithInt: record.type], @"Type",
+		  data, @"Data",
+		  nil];
+	}
+}
+- (NSDictionary *)statistics
+{
+	capture_header *header = map;
+
+	return [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: header->records], @"Records",
+	  [NSNumber numberWithUnsignedLongLong: header->bytes], @"Bytes",
+	  [NSNumber numberWithUnsignedLongLong: header->overwritten],
+	    @"Overwritten",
+	  [NSNumber numberWithUnsignedLongLong: header->truncated], @"Truncated",
+	  [NSNumber numberWithUnsignedLongLong: header->capacity], @"Capacity",
+	  nil];
+}
+
+void NetCaptureRecord(NetCapture *aCapture, uint32_t connection,
+  NetCaptureType type, const void *bytes, unsigned length)
+{
+	capture_header *header;
+	capture_record *record;
+	char *ring;
+	uint64_t capacity, head, tail, offset, left, span, need;
+	uint16_t flags = 0;
+	struct timeval now;
+
+	if (!aCapture || !aCapture->writable)
+	{
+		return;
+	}
+	header = aCapture->map;
+	ring = (char *)aCapture->map + CAPTURE_DATA_OFFSET;
+	capacity = header->capacity;
+
+	/* A record may use at most a quarter of the ring, so one connection
+	 * can not wipe out everything else in one go. */
+	if (sizeof(capture_record) + CAPTURE_ALIGN(length) > capacity / 4)
+	{
+		length = capacity / 4 - sizeof(capture_record);
+		flags |= CAPTURE_TRUNCATED;
+		header->truncated++;
+	}
+	span = sizeof(capture_record) + CAPTURE_ALIGN(length);
+
+	head = header->head;
+	tail = header->tail;
+	offset = head % capacity;
+	left = capacity - offset;
+	need = (left < span) ? left + span : span;
+
+	/* Make room by dropping the oldest records.  tail is stored before
+	 * their space is written to so a reader can tell. */
+	if (head + need - tail > capacity)
+	{
+		while (head + need - tail > capacity)
+		{
+			tail += record_span(header, ring, tail);
+			header->overwritten++;
+		}
+		__atomic_store_n(&header->tail, tail, __ATOMIC_RELEASE);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	}
+
+	if (left < span)
+	{
+		if (left >= sizeof(capture_record))
+		{
+			record = (capture_record *)(ring + offset);
+			memset(record, 0, sizeof(capture_record));
+			record->type = CAPTURE_SKIP;
+			record->check = (uint32_t)head;
+		}
+		head += left;
+		offset = 0;
+	}
+
+	gettimeofday(&now, NULL);
+	record = (capture_record *)(ring + offset);
+	record->time = (uint64_t)now.tv_sec * 1000000 + now.tv_usec;
+	record->connection = connection;
+	record->type = type;
+	record->flags = flags;
+	record->length = length;
+	record->check = (uint32_t)head;
+	if (length)
+	{
+		memcpy(record + 1, bytes, length);
+	}
+
+	header->records++;
+	header->bytes += length;
+	__atomic_store_n(&header->head, head + span, __ATOMIC_RELEASE);
+}
+@end
@@ -0,0 +1,522 @@
+/***************************************************************************
+                                NetCompress.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>CompressedTransport reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#import "NetCompress.h"
+#import "NetMetrics.h"
+#import "NetBase.h"
+#import <Foundation/NSString.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSValue.h>
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/* The hello each end sends first: the magic, the mask of methods it
+ * offers and three reserved bytes. */
+#define HELLO_MAGIC "NCZ1"
+#define HELLO_LENGTH 8
+
+/* The least space added to a buffer before (de)compressing into it. */
+#define MIN_ROOM 4096
+
+@interface TCPSystem (CompressTCPSystem)
+- setErrorString: (NSString *)anError withErrno: (int)aErrno;
+@end
+
+static unsigned default_methods = ~0U;
+static int compression_level = 0;
+
+static unsigned available_methods(void)
+{
+	unsigned methods = 0;
+
+#ifdef HAVE_ZLIB
+	methods |= NetCompressionZlib;
+#endif
+#ifdef HAVE_ZSTD
+	methods |= NetCompressionZstd;
+#endif
+	return methods;
+}
+
+static NSString *method_name(NetCompressionMethod aMethod)
+{
+	switch (aMethod)
+	{
+		case NetCompressionZlib:
+			return @"zlib";
+		case NetCompressionZstd:
+			return @"zstd";
+		default:
+			return @"none";
+	}
+}
+
+/* Makes room for at least room more bytes at the end of data and returns
+ * where they start. */
+static char *grow(NSMutableData *data, unsigned room)
+{
+	unsigned length = [data length];
+
+	[data setLength: length + room];
+	return (char *)[data mutableBytes] + length;
+}
+
+@interface CompressedTransport (InternalCompressedTransport)
+- startMethod: (NetCompressionMethod)aMethod;
+- (NSData *)receivedHello: (NSData *)data;
+- (NSData *)decompress: (NSData *)data;
+- compressPlainBuffer;
+@end
+
+@implementation CompressedTransport (InternalCompressedTransport)
+- startMethod: (NetCompressionMethod)aMethod
+{
+	method = aMethod;
+	switch (method)
+	{
+#ifdef HAVE_ZLIB
+		case NetCompressionZlib:
+			compressor = calloc(1, sizeof(z_stream));
+			decompressor = calloc(1, sizeof(z_stream));
+			if (!compressor || !decompressor ||
+			  deflateInit(compressor, compression_level ? compression_level :
+			    Z_DEFAULT_COMPRESSION) != Z_OK ||
+			  inflateInit(decompressor) != Z_OK)
+			{
+				[NSException raise: FatalNetException
+				  format: @"Could not start zlib"];
+			}
+			break;
+#endif
+#ifdef HAVE_ZSTD
+		case NetCompressionZstd:
+			compressor = ZSTD_createCCtx();
+			decompressor = ZSTD_createDCtx();
+			if (!compressor || !decompressor)
+			{
+				[NSException raise: FatalNetException
+				  format: @"Could not start zstd"];
+			}
+			if (compression_level)
+			{
+				ZSTD_CCtx_setParameter(compressor, ZSTD_c_compressionLevel,
+				  compression_level);
+			}
+			break;
+#endif
+		default:
+			method = NetCompressionNone;
+			break;
+	}
+	return self;
+}
+- (NSData *)receivedHello: (NSData *)data
+{
+	const unsigned char *bytes;
+	unsigned take;
+	unsigned common;
+
+	take = HELLO_LENGTH - [hello length];
+	if (take > [data length])
+	{
+		take = [data length];
+	}
+	[hello appendBytes: [data bytes] length: take];
+	if ([hello length] < HELLO_LENGTH)
+	{
+		return [NSData data];
+	}
+
+	bytes = [hello bytes];
+	if (memcmp(bytes, HELLO_MAGIC, strlen(HELLO_MAGIC)) != 0)
+	{
+		[NSException raise: FatalNetException
+		  format: @"The other end does not speak CompressedTransport"];
+	}
+	common = offered & bytes[strlen(HELLO_MAGIC)];
+	DESTROY(hello);
+
+	if (common & NetCompressionZstd)
+	{
+		[self startMethod: NetCompressionZstd];
+	}
+	else if (common & NetCompressionZlib)
+	{
+		[self startMethod: NetCompressionZlib];
+	}
+	negotiated = YES;
+
+	if ([plainBuffer length])
+	{
+		[[NetApplication sharedInstance] transportNeedsToWrite: self];
+	}
+
+	return [data subdataWithRange: NSMakeRange(take, [data length] - take)];
+}
+- (NSData *)decompress: (NSData *)data
+{
+	NSMutableData *plain;
+	unsigned length = [data length];
+	unsigned produced = 0;
+	unsigned capacity;
+
+	if (!negotiated)
+	{
+		data = [self receivedHello: data];
+		length = [data length];
+		if (!negotiated || length == 0)
+		{
+			return data;
+		}
+	}
+	if (method == NetCompressionNone)
+	{
+		plainBytesRead += length;
+		return data;
+	}
+
+	capacity = (length * 4 > MIN_ROOM) ? length * 4 : MIN_ROOM;
+	plain = [NSMutableData dataWithLength: capacity];
+
+#ifdef HAVE_ZLIB
+	if (method == NetCompressionZlib)
+	{
+		z_stream *z = decompressor;
+		int result;
+
+		z->next_in = (Bytef *)[data bytes];
+		z->avail_in = length;
+		do
+		{
+			if (produced == capacity)
+			{
+				capacity *= 2;
+				[plain setLength: capacity];
+			}
+			z->next_out = (Bytef *)[plain mutableBytes] + produced;
+			z->avail_out = capacity - produced;
+			result = inflate(z, Z_SYNC_FLUSH);
+			if (result != Z_OK && result != Z_BUF_ERROR)
+			{
+				[NSException raise: FatalNetException
+				  format: @"zlib: %s", z->msg ? z->msg : "stream error"];
+			}
+			produced = capacity - z->avail_out;
+		} while (z->avail_in > 0 || z->avail_out == 0);
+	}
+#endif
+#ifdef HAVE_ZSTD
+	if (method == NetCompressionZstd)
+	{
+		ZSTD_inBuffer in = { [data bytes], length, 0 };
+		ZSTD_outBuffer out;
+		size_t result;
+
+		do
+		{
+			if (produced == capacity)
+			{
+				capacity *= 2;
+				[plain setLength: capacity];
+			}
+			out.dst = (char *)[plain mutableBytes] + produced;
+			out.size = capacity - produced;
+			out.pos = 0;
+			result = ZSTD_decompressStream(decompressor, &out, &in);
+			if (ZSTD_isError(result))
+			{
+				[NSException raise: FatalNetException
+				  format: @"zstd: %s", ZSTD_getErrorName(result)];
+			}
+			produced += out.pos;
+		} while (in.pos < in.size || out.pos == out.size);
+	}
+#endif
+
+	[plain setLength: produced];
+	plainBytesRead += produced;
+
+	return plain;
+}
+- compressPlainBuffer
+{
+	unsigned length = [plainBuffer length];
+
+	if (method == NetCompressionNone)
+	{
+		[writeBuffer appendData: plainBuffer];
+	}
+#ifdef HAVE_ZLIB
+	if (method == NetCompressionZlib)
+	{
+		z_stream *z = compressor;
+		unsigned room;
+
+		z->next_in = (Bytef *)[plainBuffer mutableBytes];
+		z->avail_in = length;
+		do
+		{
+			room = deflateBound(z, z->avail_in);
+			if (room < MIN_ROOM) room = MIN_ROOM;
+			z->next_out = (Bytef *)grow(writeBuffer, room);
+			z->avail_out = room;
+			if (deflate(z, Z_SYNC_FLUSH) == Z_STREAM_ERROR)
+			{
+				[NSException raise: FatalNetException
+				  format: @"zlib: %s", z->msg ? z->msg : "stream error"];
+			}
+			[writeBuffer setLength: [writeBuffer length] - z->avail_out];
+		} while (z->avail_out == 0);
+	}
+#endif
+#ifdef HAVE_ZSTD
+	if (method == NetCompressionZstd)
+	{
+		ZSTD_inBuffer in = { [plainBuffer bytes], length, 0 };
+		ZSTD_outBuffer out;
+		size_t remaining;
+
+		do
+		{
+			out.size = ZSTD_compressBound(in.size - in.pos);
+			if (out.size < MIN_ROOM) out.size = MIN_ROOM;
+			out.dst = grow(writeBuffer, out.size);
+			out.pos = 0;
+			remaining = ZSTD_compressStream2(compressor, &out, &in,
+			  ZSTD_e_flush);
+			if (ZSTD_isError(remaining))
+			{
+				[NSException raise: FatalNetException
+				  format: @"zstd: %s", ZSTD_getErrorName(remaining)];
+			}
+			[writeBuffer setLength: [writeBuffer length] - out.size + out.pos];
+		} while (remaining != 0);
+	}
+#endif
+
+	plainBytesWritten += length;
+	[plainBuffer setLength: 0];
+	if ([writeBuffer length] > peakWriteBufferLength)
+	{
+		peakWriteBufferLength = [writeBuffer length];
+	}
+	return self;
+}
+@end
+
+@implementation CompressedTransport
++ (unsigned)availableMethods
+{
+	return available_methods();
+}
++ (void)setDefaultMethods: (unsigned)aMask
+{
+	default_methods = aMask;
+}
++ (unsigned)defaultMethods
+{
+	return default_methods & available_methods();
+}
++ (void)setCompressionLevel: (int)aLevel
+{
+	compression_level = aLevel;
+}
+- initWithDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
+{
+	unsigned char bytes[HELLO_LENGTH];
+
+	if (!(self = [super initWithDesc: aDesc withRemoteHost: theAddress]))
+	{
+		return nil;
+	}
+
+	offered = [CompressedTransport defaultMethods];
+	plainBuffer = [NSMutableData new];
+	hello = [[NSMutableData alloc] initWithCapacity: HELLO_LENGTH];
+
+	/* The socket buffer of a new connection always has room for this. */
+	memset(bytes, 0, sizeof(bytes));
+	memcpy(bytes, HELLO_MAGIC, strlen(HELLO_MAGIC));
+	bytes[strlen(HELLO_MAGIC)] = offered;
+	if (write(desc, bytes, sizeof(bytes)) != sizeof(bytes))
+	{
+		[[TCPSystem sharedInstance]
+		  setErrorString: [NSString stringWithFormat: @"%s",
+		  strerror(errno)] withErrno: errno];
+		[self release];
+		return nil;
+	}
+	bytesWritten += sizeof(bytes);
+	NetTransportTotals.bytesWritten += sizeof(bytes);
+	writeCalls++;
+	NetTransportTotals.writeCalls++;
+
+	return self;
+}
+- (void)dealloc
+{
+	switch (method)
+	{
+#ifdef HAVE_ZLIB
+		case NetCompressionZlib:
+			if (compressor) deflateEnd(compressor);
+			if (decompressor) inflateEnd(decompressor);
+			free(compressor);
+			free(decompressor);
+			break;
+#endif
+#ifdef HAVE_ZSTD
+		case NetCompressionZstd:
+			ZSTD_freeCCtx(compressor);
+			ZSTD_freeDCtx(decompressor);
+			break;
+#endif
+		default:
+			break;
+	}
+	RELEASE(plainBuffer);
+	RELEASE(hello);
+	[super dealloc];
+}
+- (NSData *)readData: (int)maxDataSize
+{
+	NSData *data = nil;
+
+	NS_DURING
+		data = [super readData: maxDataSize];
+	NS_HANDLER
+		id partial = [[localException userInfo] objectForKey: @"Data"];
+
+		if (partial && [partial length] > 0)
+		{
+			[[NSException exceptionWithName: [localException name]
+			  reason: [localException reason]
+			  userInfo: [NSDictionary dictionaryWithObjectsAndKeys:
+			    [self decompress: partial], @"Data", nil]] raise];
+		}
+		[localException raise];
+	NS_ENDHANDLER
+
+	return [self decompress: data];
+}
+- (BOOL)isDoneWriting
+{
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	if ([writeBuffer length])
+	{
+		return NO;
+	}
+	return (negotiated && [plainBuffer length]) ? NO : YES;
+}
+- bufferBytes: (const char *)bytes length: (unsigned)length
+{
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	if (length == 0)
+	{
+		return self;
+	}
+	if (negotiated && [plainBuffer length] == 0 &&
+	  [writeBuffer length] == 0)
+	{
+		[[NetApplication sharedInstance] transportNeedsToWrite: self];
+	}
+	[plainBuffer appendBytes: bytes length: length];
+	if ([plainBuffer length] > peakWriteBufferLength)
+	{
+		peakWriteBufferLength = [plainBuffer length];
+	}
+	return self;
+}
+- writeData: (NSData *)aData
+{
+	if (aData)
+	{
+		return [super writeData: aData];
+	}
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	if (negotiated && [plainBuffer length])
+	{
+		[self compressPlainBuffer];
+	}
+	return [super writeData: nil];
+}
+- (BOOL)isNegotiated
+{
+	return negotiated;
+}
+- (NetCompressionMethod)method
+{
+	return method;
+}
+- (NSDictionary *)statistics
+{
+	NSMutableDictionary *statistics;
+	unsigned long long wire = bytesRead + bytesWritten;
+
+	statistics = [NSMutableDictionary dictionaryWithDictionary:
+	  [super statistics]];
+	[statistics setObject: method_name(method) forKey: @"Method"];
+	[statistics setObject:
+	  [NSNumber numberWithUnsignedLongLong: plainBytesRead]
+	  forKey: @"UncompressedBytesRead"];
+	[statistics setObject:
+	  [NSNumber numberWithUnsignedLongLong: plainBytesWritten]
+	  forKey: @"UncompressedBytesWritten"];
+	[statistics setObject: [NSNumber numberWithDouble: (wire) ?
+	  (double)(plainBytesRead + plainBytesWritten) / wire : 0.0]
+	  forKey: @"CompressionRatio"];
+
+	return statistics;
+}
+@end
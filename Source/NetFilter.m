@@ -0,0 +1,394 @@
+/***************************************************************************
+                                NetFilter.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetFilter reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#import "NetFilter.h"
+#import "NetBase.h"
+#import "NetHistogram.h"
+#import "NetWorkerPool.h"
+#import <Foundation/NSArray.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSTimer.h>
+
+#include <string.h>
+
+/* How often NetRateFilter passes on held data, in seconds. */
+#define RATE_INTERVAL 0.01
+
+@interface NetFilter (InternalNetFilter)
+- setTransport: (TCPTransport *)aTransport above: (NetFilter *)aboveFilter
+   below: (NetFilter *)belowFilter;
+@end
+
+@interface TCPTransport (InternalFilters)
+- relinkFilters;
+- filteredBytesReceived: (const char *)bytes length: (unsigned)length;
+@end
+
+@implementation NetFilter (InternalNetFilter)
+- setTransport: (TCPTransport *)aTransport above: (NetFilter *)aboveFilter
+   below: (NetFilter *)belowFilter
+{
+	transport = aTransport;
+	above = aboveFilter;
+	below = belowFilter;
+	return self;
+}
+@end
+
+@implementation NetFilter
+- (TCPTransport *)transport
+{
+	return transport;
+}
+- receiveBytes: (const char *)bytes length: (unsigned)length
+{
+	return [self passUpBytes: bytes length: length];
+}
+- sendBytes: (const char *)bytes length: (unsigned)length
+{
+	return [self passDownBytes: bytes length: length];
+}
+- passUpBytes: (const char *)bytes length: (unsigned)length
+{
+	if (above)
+	{
+		[above receiveBytes: bytes length: length];
+	}
+	else
+	{
+		[transport filteredBytesReceived: bytes length: length];
+	}
+	return self;
+}
+- passDownBytes: (const char *)bytes length: (unsigned)length
+{
+	if (below)
+	{
+		[below sendBytes: bytes length: length];
+	}
+	else
+	{
+		[transport bufferBytes: bytes length: length];
+	}
+	return self;
+}
+- flush
+{
+	return self;
+}
+- pauseReading
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	id object;
+
+	if (readingPaused || !transport)
+	{
+		return self;
+	}
+	object = [net netObjectForTransport: transport];
+	if (object)
+	{
+		[net pauseReadingObject: object];
+		readingPaused = YES;
+	}
+	return self;
+}
+- resumeReading
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	id object;
+
+	if (!readingPaused)
+	{
+		return self;
+	}
+	readingPaused = NO;
+	object = [net netObjectForTransport: transport];
+	if (object)
+	{
+		[net resumeReadingObject: object];
+	}
+	return self;
+}
+- (BOOL)isReadingPaused
+{
+	return readingPaused;
+}
+- removedFromTransport
+{
+	return [self resumeReading];
+}
+@end
+
+@implementation TCPTransport (InternalFilters)
+- relinkFilters
+{
+	int count = [filters count];
+	int x;
+
+	for (x = 0; x < count; x++)
+	{
+		[[filters objectAtIndex: x] setTransport: self
+		  above: (x + 1 < count) ? [filters objectAtIndex: x + 1] : nil
+		  below: (x > 0) ? [filters objectAtIndex: x - 1] : nil];
+	}
+	return self;
+}
+- filteredBytesReceived: (const char *)bytes length: (unsigned)length
+{
+	id object = filterObject;
+	NSData *data;
+
+	if (length == 0)
+	{
+		return self;
+	}
+	if (!object)
+	{
+		/* Passed up outside of -deliverData:toObject:, from a timer. */
+		object = [[NetApplication sharedInstance]
+		  netObjectForTransport: self];
+		if (!object)
+		{
+			return self;
+		}
+	}
+
+	if (filterInput && bytes == [filterInput bytes] &&
+	  length == [filterInput length])
+	{
+		data = filterInput;
+	}
+	else
+	{
+		data = [NSData dataWithBytes: bytes length: length];
+	}
+	[[NetApplication sharedInstance] passData: data toObject: object];
+
+	return self;
+}
+@end
+
+@implementation TCPTransport (Filters)
+- pushFilter: (NetFilter *)aFilter
+{
+	if ([aFilter transport])
+	{
+		[NSException raise: NetException
+		  format: @"[TCPTransport pushFilter:] filter already in use"];
+	}
+	if (!filters)
+	{
+		filters = [NSMutableArray new];
+	}
+	[filters addObject: aFilter];
+	return [self relinkFilters];
+}
+- removeFilter: (NetFilter *)aFilter
+{
+	if ([aFilter transport] != self)
+	{
+		return self;
+	}
+	[aFilter removedFromTransport];
+	[aFilter setTransport: nil above: nil below: nil];
+	[filters removeObjectIdenticalTo: aFilter];
+	if ([filters count] == 0)
+	{
+		DESTROY(filters);
+	}
+	return [self relinkFilters];
+}
+- (NSArray *)filters
+{
+	return filters;
+}
+- (BOOL)hasFilters
+{
+	return (filters != nil);
+}
+- deliverData: (NSData *)data toObject: (id <NetObject>)anObject
+{
+	if (!filters)
+	{
+		[[NetApplication sharedInstance] passData: data toObject: anObject];
+		return self;
+	}
+	if ([data length] == 0)
+	{
+		return self;
+	}
+
+	filterObject = anObject;
+	filterInput = data;
+	NS_DURING
+		[[filters objectAtIndex: 0] receiveBytes: [data bytes]
+		  length: [data length]];
+	NS_HANDLER
+		filterObject = nil;
+		filterInput = nil;
+		[localException raise];
+	NS_ENDHANDLER
+	filterObject = nil;
+	filterInput = nil;
+
+	return self;
+}
+- flushFilters
+{
+	int x;
+
+	for (x = [filters count] - 1; x >= 0; x--)
+	{
+		[[filters objectAtIndex: x] flush];
+	}
+	return self;
+}
+@end
+
+@interface NetRateFilter (InternalNetRateFilter)
+- (void)refill;
+- passHeld;
+- timerFired: (NSTimer *)aTimer;
+@end
+
+@implementation NetRateFilter (InternalNetRateFilter)
+- (void)refill
+{
+	uint64_t now = NetMonotonicMicroseconds();
+	double burst = (rate * RATE_INTERVAL * 10 > 1) ?
+	  rate * RATE_INTERVAL * 10 : 1;
+
+	credit += rate * (now - refilled) / 1000000.0;
+	if (credit > burst)
+	{
+		credit = burst;
+	}
+	refilled = now;
+}
+- passHeld
+{
+	unsigned length = [held length];
+	unsigned count;
+
+	[self refill];
+	count = (credit < length) ? (unsigned)credit : length;
+	if (count)
+	{
+		credit -= count;
+		[self passDownBytes: [held bytes] length: count];
+		[held replaceBytesInRange: NSMakeRange(0, count) withBytes: NULL
+		  length: 0];
+	}
+
+	if ([held length] < highWaterMark / 2)
+	{
+		[self resumeReading];
+	}
+	if ([held length] == 0 && timer)
+	{
+		[timer invalidate];
+		DESTROY(timer);
+	}
+	return self;
+}
+- timerFired: (NSTimer *)aTimer
+{
+	return [self passHeld];
+}
+@end
+
+@implementation NetRateFilter
+- initWithBytesPerSecond: (double)bytesPerSecond
+{
+	if (!(self = [super init])) return nil;
+
+	rate = bytesPerSecond;
+	held = [NSMutableData new];
+	highWaterMark = (rate > 1) ? (unsigned)rate : 1;
+	refilled = NetMonotonicMicroseconds();
+
+	return self;
+}
+- (void)dealloc
+{
+	[timer invalidate];
+	RELEASE(timer);
+	RELEASE(held);
+	[super dealloc];
+}
+- setHighWaterMark: (unsigned)aLength
+{
+	highWaterMark = aLength;
+	return self;
+}
+- (unsigned)heldLength
+{
+	return [held length];
+}
+- sendBytes: (const char *)bytes length: (unsigned)length
+{
+	unsigned count = 0;
+
+	if ([held length] == 0)
+	{
+		[self refill];
+		count = (credit < length) ? (unsigned)credit : length;
+		if (count)
+		{
+			credit -= count;
+			[self passDownBytes: bytes length: count];
+		}
+	}
+	if (count == length)
+	{
+		return self;
+	}
+
+	[held appendBytes: bytes + count length: length - count];
+	if ([held length] > highWaterMark)
+	{
+		[self pauseReading];
+	}
+	if (!timer)
+	{
+		/* The timer retains the filter until the held data is gone or
+		 * the filter is removed. */
+		timer = RETAIN([NSTimer scheduledTimerWithTimeInterval: RATE_INTERVAL
+		  target: self selector: @selector(timerFired:) userInfo: nil
+		  repeats: YES]);
+	}
+	return self;
+}
+- removedFromTransport
+{
+	[timer invalidate];
+	DESTROY(timer);
+	return [super removedFromTransport];
+}
+@end
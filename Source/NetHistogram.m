@@ -0,0 +1,193 @@
+/***************************************************************************
+                                NetHistogram.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetHistogram reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#import "NetHistogram.h"
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSValue.h>
+
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+uint64_t NetMonotonicMicroseconds(void)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec now;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &now) == 0)
+	{
+		return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+	}
+#endif
+	{
+		struct timeval tv;
+
+		gettimeofday(&tv, NULL);
+		return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+	}
+}
+
+static inline int highest_bit(uint64_t value)
+{
+#ifdef __GNUC__
+	return 63 - __builtin_clzll(value);
+#else
+	int bit = 0;
+
+	while (value >>= 1) bit++;
+	return bit;
+#endif
+}
+
+static inline int bucket_for_value(uint64_t value)
+{
+	int exponent;
+	int index;
+
+	if (value < NET_HISTOGRAM_SUB_BUCKETS)
+	{
+		return (int)value;
+	}
+
+	exponent = highest_bit(value);
+	index = (exponent - 3) * NET_HISTOGRAM_SUB_BUCKETS +
+	  (int)(value >> (exponent - 4)) - NET_HISTOGRAM_SUB_BUCKETS;
+
+	return (index < NET_HISTOGRAM_BUCKETS) ? index : NET_HISTOGRAM_BUCKETS - 1;
+}
+
+static inline uint64_t highest_value_in_bucket(int index)
+{
+	int exponent;
+	uint64_t lowest;
+
+	if (index < NET_HISTOGRAM_SUB_BUCKETS)
+	{
+		return index;
+	}
+
+	exponent = index / NET_HISTOGRAM_SUB_BUCKETS + 3;
+	lowest = (uint64_t)(NET_HISTOGRAM_SUB_BUCKETS +
+	  index % NET_HISTOGRAM_SUB_BUCKETS) << (exponent - 4);
+
+	return lowest + ((uint64_t)1 << (exponent - 4)) - 1;
+}
+
+@implementation NetHistogram
+- (void)recordValue: (uint64_t)aValue
+{
+	counts[bucket_for_value(aValue)]++;
+
+	if (total == 0 || aValue < minValue)
+	{
+		minValue = aValue;
+	}
+	if (aValue > maxValue)
+	{
+		maxValue = aValue;
+	}
+	total++;
+	sum += aValue;
+}
+- (uint64_t)count
+{
+	return total;
+}
+- (uint64_t)minValue
+{
+	return minValue;
+}
+- (uint64_t)maxValue
+{
+	return maxValue;
+}
+- (double)mean
+{
+	return (total) ? sum / total : 0.0;
+}
+- (uint64_t)valueAtPercentile: (double)aPercentile
+{
+	uint64_t wanted;
+	uint64_t seen = 0;
+	uint64_t value;
+	int x;
+
+	if (total == 0)
+	{
+		return 0;
+	}
+	if (aPercentile >= 100.0)
+	{
+		return maxValue;
+	}
+	if (aPercentile < 0.0)
+	{
+		aPercentile = 0.0;
+	}
+
+	wanted = (uint64_t)(aPercentile / 100.0 * total + 0.5);
+	if (wanted == 0)
+	{
+		wanted = 1;
+	}
+
+	for (x = 0; x < NET_HISTOGRAM_BUCKETS; x++)
+	{
+		seen += counts[x];
+		if (seen >= wanted)
+		{
+			value = highest_value_in_bucket(x);
+			return (value < maxValue) ? value : maxValue;
+		}
+	}
+
+	return maxValue;
+}
+- (void)reset
+{
+	memset(counts, 0, sizeof(counts));
+	total = minValue = maxValue = 0;
+	sum = 0.0;
+}
+- (NSDictionary *)summary
+{
+	return [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: total], @"Count",
+	  [NSNumber numberWithUnsignedLongLong: minValue], @"Min",
+	  [NSNumber numberWithUnsignedLongLong: maxValue], @"Max",
+	  [NSNumber numberWithDouble: [self mean]], @"Mean",
+	  [NSNumber numberWithUnsignedLongLong:
+	    [self valueAtPercentile: 50.0]], @"P50",
+	  [NSNumber numberWithUnsignedLongLong:
+	    [self valueAtPercentile: 90.0]], @"P90",
+	  [NSNumber numberWithUnsignedLongLong:
+	    [self valueAtPercentile: 99.0]], @"P99",
+	  [NSNumber numberWithUnsignedLongLong:
+	    [self valueAtPercentile: 99.9]], @"P999",
+	  nil];
+}
+@end
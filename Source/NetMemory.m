@@ -0,0 +1,517 @@
+/***************************************************************************
+                                NetMemory.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetMemory reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#import "NetMemory.h"
+
+#import <Foundation/NSArray.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSString.h>
+#import <Foundation/NSValue.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSAutoreleasePool.h>
+
+#include <string.h>
+
+/* A piece of data on its way to a transport and the time it arrives. */
+@interface MemorySegment : NSObject
+	{
+		@public
+		NSData *data;
+		uint64_t arrival;
+	}
+@end
+
+@implementation MemorySegment
+- (void)dealloc
+{
+	RELEASE(data);
+	[super dealloc];
+}
+@end
+
+@interface MemoryTransport (InternalMemoryTransport)
+- initWithDriver: (MemoryDriver *)aDriver name: (NSString *)aName;
+- setPeer: (MemoryTransport *)aPeer;
+- setPeerClosed;
+- segmentRead: (unsigned)length;
+- receiveData: (NSData *)aData at: (uint64_t)arrival;
+- (BOOL)sendBuffered;
+- (BOOL)canSend;
+@end
+
+@interface MemoryDriver (InternalMemoryDriver)
+- addTransport: (MemoryTransport *)aTransport;
+- removeTransport: (MemoryTransport *)aTransport;
+- (uint64_t)nextArrivalAfter: (uint64_t)aTime;
+@end
+
+@implementation MemoryTransport (InternalMemoryTransport)
+- initWithDriver: (MemoryDriver *)aDriver name: (NSString *)aName
+{
+	if (!(self = [super init])) return nil;
+
+	driver = RETAIN(aDriver);
+	name = RETAIN(aName);
+	segments = [NSMutableArray new];
+	writeBuffer = [NSMutableData new];
+	connected = YES;
+
+	[driver addTransport: self];
+
+	return self;
+}
+- setPeer: (MemoryTransport *)aPeer
+{
+	peer = aPeer;
+	return self;
+}
+- setPeerClosed
+{
+	peerClosed = YES;
+	peer = nil;
+	return self;
+}
+- segmentRead: (unsigned)length
+{
+	inFlight = (length < inFlight) ? inFlight - length : 0;
+	return self;
+}
+- receiveData: (NSData *)aData at: (uint64_t)arrival
+{
+	MemorySegment *segment = AUTORELEASE([MemorySegment new]);
+
+	segment->data = RETAIN(aData);
+	segment->arrival = arrival;
+	[segments addObject: segment];
+
+	return self;
+}
+- (BOOL)sendBuffered
+{
+	BOOL sent = NO;
+	unsigned length;
+	unsigned remaining;
+	uint64_t start;
+	char *bytes;
+
+	while ([self canSend])
+	{
+		bytes = [writeBuffer mutableBytes];
+		length = [writeBuffer length];
+		if (chunkSize && length > chunkSize)
+		{
+			length = chunkSize;
+		}
+		if (window && length > window - inFlight)
+		{
+			length = window - inFlight;
+		}
+
+		start = [driver currentTime];
+		if (linkFree > start)
+		{
+			start = linkFree;
+		}
+		linkFree = start;
+		if (bandwidth > 0)
+		{
+			linkFree += (uint64_t)(length * 1000000.0 / bandwidth);
+		}
+
+		[peer receiveData: [NSData dataWithBytes: bytes length: length]
+		  at: linkFree + latency];
+		inFlight += length;
+		sent = YES;
+
+		remaining = [writeBuffer length] - length;
+		memmove(bytes, bytes + length, remaining);
+		[writeBuffer setLength: remaining];
+	}
+
+	return sent;
+}
+- (BOOL)canSend
+{
+	return connected && peer && [writeBuffer length] &&
+	  (window == 0 || inFlight < window);
+}
+@end
+
+@implementation MemoryTransport
+- (void)dealloc
+{
+	[self close];
+	[driver removeTransport: self];
+	RELEASE(driver);
+	RELEASE(name);
+	RELEASE(segments);
+	RELEASE(writeBuffer);
+	[super dealloc];
+}
+- setChunkSize: (unsigned)aSize
+{
+	chunkSize = aSize;
+	return self;
+}
+- (unsigned)chunkSize
+{
+	return chunkSize;
+}
+- setLatency: (uint64_t)microseconds
+{
+	latency = microseconds;
+	return self;
+}
+- (uint64_t)latency
+{
+	return latency;
+}
+- setBandwidth: (double)bytesPerSecond
+{
+	bandwidth = bytesPerSecond;
+	return self;
+}
+- (double)bandwidth
+{
+	return bandwidth;
+}
+- setWindow: (unsigned)aSize
+{
+	window = aSize;
+	return self;
+}
+- (unsigned)window
+{
+	return window;
+}
+- (MemoryTransport *)peer
+{
+	return peer;
+}
+- (unsigned)writeBufferLength
+{
+	return [writeBuffer length];
+}
+- (BOOL)hasDataAvailable
+{
+	MemorySegment *segment;
+
+	if (!connected || [segments count] == 0)
+	{
+		return NO;
+	}
+	segment = [segments objectAtIndex: 0];
+
+	return segment->arrival <= [driver currentTime];
+}
+- (BOOL)isAtEnd
+{
+	return connected && peerClosed && [segments count] == 0;
+}
+- (uint64_t)nextArrival
+{
+	if ([segments count] == 0)
+	{
+		return 0;
+	}
+	return ((MemorySegment *)[segments objectAtIndex: 0])->arrival;
+}
+- (NSData *)readData: (int)maxDataSize
+{
+	MemorySegment *segment;
+	NSData *data;
+	unsigned length;
+
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+
+	if (![self hasDataAvailable])
+	{
+		if ([self isAtEnd])
+		{
+			[[NSException exceptionWithName: NetException
+			  reason: @"Socket closed" userInfo:
+			  [NSDictionary dictionaryWithObjectsAndKeys:
+			    [NSData data], @"Data", nil]] raise];
+		}
+		return [NSData data];
+	}
+
+	segment = [segments objectAtIndex: 0];
+	length = [segment->data length];
+	if (maxDataSize > 0 && length > (unsigned)maxDataSize)
+	{
+		data = [segment->data subdataWithRange:
+		  NSMakeRange(0, maxDataSize)];
+		ASSIGN(segment->data, [segment->data subdataWithRange:
+		  NSMakeRange(maxDataSize, length - maxDataSize)]);
+		length = maxDataSize;
+	}
+	else
+	{
+		data = AUTORELEASE(RETAIN(segment->data));
+		[segments removeObjectAtIndex: 0];
+	}
+	[peer segmentRead: length];
+
+	return data;
+}
+- (BOOL)isDoneWriting
+{
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	return ([writeBuffer length]) ? NO : YES;
+}
+- writeData: (NSData *)aData
+{
+	if (aData)
+	{
+		if ([aData length] == 0)
+		{
+			return self;
+		}
+		[writeBuffer appendData: aData];
+		[self sendBuffered];
+		return self;
+	}
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	if (peerClosed)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Connection closed by peer"];
+	}
+	[self sendBuffered];
+
+	return self;
+}
+- (id)localHost
+{
+	return name;
+}
+- (id)remoteHost
+{
+	return [peer localHost];
+}
+- (int)desc
+{
+	return -1;
+}
+- (void)close
+{
+	if (!connected)
+		return;
+	connected = NO;
+	[peer setPeerClosed];
+	peer = nil;
+	[segments removeAllObjects];
+	[writeBuffer setLength: 0];
+}
+@end
+
+@implementation MemoryDriver (InternalMemoryDriver)
+- addTransport: (MemoryTransport *)aTransport
+{
+	[transports addObject: [NSValue valueWithNonretainedObject: aTransport]];
+	return self;
+}
+- removeTransport: (MemoryTransport *)aTransport
+{
+	int x;
+
+	for (x = [transports count] - 1; x >= 0; x--)
+	{
+		if ([[transports objectAtIndex: x] nonretainedObjectValue] ==
+		  aTransport)
+		{
+			[transports removeObjectAtIndex: x];
+			break;
+		}
+	}
+	return self;
+}
+- (uint64_t)nextArrivalAfter: (uint64_t)aTime
+{
+	uint64_t next = 0;
+	uint64_t arrival;
+	int x;
+
+	for (x = 0; x < (int)[transports count]; x++)
+	{
+		arrival = [[[transports objectAtIndex: x] nonretainedObjectValue]
+		  nextArrival];
+		if (arrival > aTime && (next == 0 || arrival < next))
+		{
+			next = arrival;
+		}
+	}
+	return next;
+}
+@end
+
+@implementation MemoryDriver
+- init
+{
+	if (!(self = [super init])) return nil;
+
+	transports = [NSMutableArray new];
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(transports);
+	[super dealloc];
+}
+- (NSArray *)createTransportPair
+{
+	MemoryTransport *first;
+	MemoryTransport *second;
+
+	pairs++;
+	first = AUTORELEASE([[MemoryTransport alloc] initWithDriver: self
+	  name: [NSString stringWithFormat: @"memory:%u:a", pairs]]);
+	second = AUTORELEASE([[MemoryTransport alloc] initWithDriver: self
+	  name: [NSString stringWithFormat: @"memory:%u:b", pairs]]);
+
+	[first setPeer: second];
+	[second setPeer: first];
+
+	return [NSArray arrayWithObjects: first, second, nil];
+}
+- (uint64_t)currentTime
+{
+	return now;
+}
+- (BOOL)pump
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	NSMutableArray *snapshot;
+	MemoryTransport *transport;
+	id object;
+	BOOL worked = NO;
+	int x;
+
+	snapshot = [NSMutableArray arrayWithCapacity: [transports count]];
+	for (x = 0; x < (int)[transports count]; x++)
+	{
+		[snapshot addObject: [[transports objectAtIndex: x]
+		  nonretainedObjectValue]];
+	}
+
+	for (x = 0; x < (int)[snapshot count]; x++)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+
+		transport = [snapshot objectAtIndex: x];
+		if ([transport canSend] && [transport sendBuffered])
+		{
+			worked = YES;
+		}
+
+		object = [net netObjectForTransport: transport];
+		if (object && ([transport hasDataAvailable] || [transport isAtEnd]))
+		{
+			worked = YES;
+			dispatches++;
+			NS_DURING
+				[object dataReceived: [transport readData: 0]];
+			NS_HANDLER
+				if (([[localException name] isEqualToString: NetException]) ||
+				    ([[localException name] isEqualToString: FatalNetException]))
+				{
+					id data;
+					data = [[localException userInfo]
+					  objectForKey: @"Data"];
+					if (data && ([data length] > 0))
+					{
+						[object dataReceived: data];
+					}
+					[net disconnectObject: object];
+				}
+				else
+				{
+					[localException raise];
+				}
+			NS_ENDHANDLER
+		}
+
+		RELEASE(apr);
+	}
+
+	return worked;
+}
+- runUntilIdle
+{
+	while ([self pump]);
+
+	return self;
+}
+- advanceTime: (uint64_t)microseconds
+{
+	uint64_t target = now + microseconds;
+	uint64_t next;
+
+	[self runUntilIdle];
+	while ((next = [self nextArrivalAfter: now]) && next <= target)
+	{
+		now = next;
+		[self runUntilIdle];
+	}
+	now = target;
+	[self runUntilIdle];
+
+	return self;
+}
+- runUntilQuiet
+{
+	uint64_t next;
+
+	[self runUntilIdle];
+	while ((next = [self nextArrivalAfter: now]))
+	{
+		now = next;
+		[self runUntilIdle];
+	}
+
+	return self;
+}
+- (unsigned long long)dispatchCount
+{
+	return dispatches;
+}
+@end
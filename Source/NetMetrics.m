@@ -0,0 +1,592 @@
+/***************************************************************************
+                                NetMetrics.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetMetrics reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#import "NetMetrics.h"
+#import "NetHistogram.h"
+#import "NetPool.h"
+#import <Foundation/NSString.h>
+#import <Foundation/NSArray.h>
+#import <Foundation/NSCharacterSet.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSTimer.h>
+#import <Foundation/NSValue.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+
+/* The largest request read before giving up on it. */
+#define MAX_REQUEST_LENGTH 8192
+/* How long, in seconds, a response may take to be written before the
+ * connection is closed anyway. */
+#define CLOSE_TIMEOUT 10.0
+
+NetTransportCounters NetTransportTotals;
+BOOL NetMetricsCountsCommands = NO;
+
+/* The commands counted by name.  The slot after the last counts every
+ * other command, so the counters cannot grow with what servers send. */
+static const char *known_commands[] =
+{
+	"PRIVMSG", "NOTICE", "JOIN", "PART", "QUIT", "NICK", "MODE",
+	"TOPIC", "KICK", "INVITE", "PING", "PONG", "ERROR", "WALLOPS",
+	"PASS", "USER", "AWAY", "WHO", "WHOIS", "LIST", "NAMES",
+	"ISON", "USERHOST", "CAP", "AUTHENTICATE",
+	"001", "002", "003", "004", "005", "321", "322", "323",
+	"332", "333", "353", "366", "372", "375", "376", "433"
+};
+#define KNOWN_COMMANDS (sizeof(known_commands) / sizeof(known_commands[0]))
+#define OTHER_COMMAND KNOWN_COMMANDS
+
+struct NetCommandCounters
+{
+	struct NetCommandCounters *next;
+	struct NetCommandCounters *previous;
+	BOOL listed;
+	unsigned long long lines[2][KNOWN_COMMANDS + 1];
+};
+
+static pthread_mutex_t command_lock = PTHREAD_MUTEX_INITIALIZER;
+static NetCommandCounters *live_counters = NULL;
+static unsigned long long removed_lines[2][KNOWN_COMMANDS + 1];
+static unsigned long long scrapes = 0;
+static unsigned metrics_servers = 0;
+
+/* Returns the slot of the command of <length> bytes at <command>. */
+static unsigned command_slot(const char *command, unsigned length)
+{
+	unsigned x;
+
+	for (x = 0; x < KNOWN_COMMANDS; x++)
+	{
+		if (strncasecmp(known_commands[x], command, length) == 0 &&
+		  known_commands[x][length] == '\0')
+		{
+			return x;
+		}
+	}
+	return OTHER_COMMAND;
+}
+
+/* Adds <counters> to the ones summed for the metrics. */
+static void list_counters(NetCommandCounters *counters)
+{
+	pthread_mutex_lock(&command_lock);
+	if (!counters->listed)
+	{
+		__atomic_store_n(&counters->listed, YES, __ATOMIC_RELEASE);
+		counters->next = live_counters;
+		if (live_counters)
+		{
+			live_counters->previous = counters;
+		}
+		live_counters = counters;
+	}
+	pthread_mutex_unlock(&command_lock);
+}
+
+NetCommandCounters *NetMetricsNewCommandCounters(void)
+{
+	return calloc(1, sizeof(NetCommandCounters));
+}
+
+void NetMetricsFreeCommandCounters(NetCommandCounters *counters)
+{
+	unsigned x;
+
+	if (!counters)
+	{
+		return;
+	}
+
+	if (counters->listed)
+	{
+		pthread_mutex_lock(&command_lock);
+		for (x = 0; x <= KNOWN_COMMANDS; x++)
+		{
+			removed_lines[0][x] += counters->lines[0][x];
+			removed_lines[1][x] += counters->lines[1][x];
+		}
+		if (counters->previous)
+		{
+			counters->previous->next = counters->next;
+		}
+		else
+		{
+			live_counters = counters->next;
+		}
+		if (counters->next)
+		{
+			counters->next->previous = counters->previous;
+		}
+		pthread_mutex_unlock(&command_lock);
+	}
+
+	free(counters);
+}
+
+void NetMetricsCountCommand(NetCommandCounters *counters,
+  const char *command, unsigned length, BOOL inbound)
+{
+	unsigned x;
+
+	if (!counters)
+	{
+		return;
+	}
+	for (x = 0; x < length && command[x] != ' ' && command[x] != '\r' &&
+	  command[x] != '\n'; x++);
+
+	/* Handlers on a NetWorkerPool count while the run loop thread counts
+	 * what its timers send, so the counts are atomic. */
+	__atomic_add_fetch(&counters->lines[(inbound) ? 0 : 1]
+	  [command_slot(command, x)], 1, __ATOMIC_RELAXED);
+	if (__atomic_load_n(&NetMetricsCountsCommands, __ATOMIC_ACQUIRE) &&
+	  !__atomic_load_n(&counters->listed, __ATOMIC_ACQUIRE))
+	{
+		list_counters(counters);
+	}
+}
+
+NSDictionary *NetMetricsCommandCounts(NetCommandCounters *counters,
+  BOOL inbound)
+{
+	NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+	unsigned long long count;
+	unsigned x;
+
+	for (x = 0; counters && x <= KNOWN_COMMANDS; x++)
+	{
+		count = __atomic_load_n(&counters->lines[(inbound) ? 0 : 1][x],
+		  __ATOMIC_RELAXED);
+		if (count)
+		{
+			[dict setObject: [NSNumber numberWithUnsignedLongLong: count]
+			  forKey: (x < KNOWN_COMMANDS) ? [NSString stringWithUTF8String:
+			  known_commands[x]] : @"other"];
+		}
+	}
+	return dict;
+}
+
+/* Label values are quoted, so backslashes, quotes and newlines are
+ * escaped. */
+static NSString *label_value(NSString *aValue)
+{
+	NSMutableString *escaped;
+
+	if ([aValue rangeOfCharacterFromSet: [NSCharacterSet
+	  characterSetWithCharactersInString: @"\\\"\n"]].location == NSNotFound)
+	{
+		return aValue;
+	}
+	escaped = [NSMutableString stringWithString: aValue];
+	[escaped replaceOccurrencesOfString: @"\\" withString: @"\\\\"
+	  options: 0 range: NSMakeRange(0, [escaped length])];
+	[escaped replaceOccurrencesOfString: @"\"" withString: @"\\\""
+	  options: 0 range: NSMakeRange(0, [escaped length])];
+	[escaped replaceOccurrencesOfString: @"\n" withString: @"\\n"
+	  options: 0 range: NSMakeRange(0, [escaped length])];
+	return escaped;
+}
+
+static void add_header(NSMutableString *out, NSString *name, NSString *type,
+  NSString *help)
+{
+	[out appendFormat: @"# HELP %@ %@\n# TYPE %@ %@\n", name, help, name,
+	  type];
+}
+
+static void add_value(NSMutableString *out, NSString *name, NSString *type,
+  NSString *help, unsigned long long value)
+{
+	add_header(out, name, type, help);
+	[out appendFormat: @"%@ %llu\n", name, value];
+}
+
+static void add_summary(NSMutableString *out, NSString *name,
+  NSString *help, NetHistogram *aHistogram)
+{
+	double quantiles[] = { 0.5, 0.9, 0.99 };
+	int x;
+
+	add_header(out, name, @"summary", help);
+	for (x = 0; x < 3; x++)
+	{
+		[out appendFormat: @"%@{quantile=\"%g\"} %llu\n", name, quantiles[x],
+		  (unsigned long long)[aHistogram valueAtPercentile:
+		  quantiles[x] * 100.0]];
+	}
+	[out appendFormat: @"%@_sum %.0f\n%@_count %llu\n", name,
+	  [aHistogram mean] * [aHistogram count], name,
+	  (unsigned long long)[aHistogram count]];
+}
+
+static void add_commands(NSMutableString *out)
+{
+	unsigned long long lines[2][KNOWN_COMMANDS + 1];
+	NSString *directions[] = { @"in", @"out" };
+	NetCommandCounters *counters;
+	unsigned x, y;
+
+	/* Only the sum is taken under the lock. */
+	pthread_mutex_lock(&command_lock);
+	memcpy(lines, removed_lines, sizeof(lines));
+	for (counters = live_counters; counters; counters = counters->next)
+	{
+		for (x = 0; x <= KNOWN_COMMANDS; x++)
+		{
+			lines[0][x] += __atomic_load_n(&counters->lines[0][x],
+			  __ATOMIC_RELAXED);
+			lines[1][x] += __atomic_load_n(&counters->lines[1][x],
+			  __ATOMIC_RELAXED);
+		}
+	}
+	pthread_mutex_unlock(&command_lock);
+
+	for (y = 0; y < 2; y++)
+	{
+		for (x = 0; x <= KNOWN_COMMANDS; x++)
+		{
+			[out appendFormat:
+			  @"netclasses_irc_lines_total{direction=\"%@\",command=\"%s\"} "
+			  @"%llu\n", directions[y],
+			  (x < KNOWN_COMMANDS) ? known_commands[x] : "other",
+			  lines[y][x]];
+		}
+	}
+}
+
+static unsigned long long number(NSDictionary *aDict, NSString *aKey)
+{
+	return [[aDict objectForKey: aKey] unsignedLongLongValue];
+}
+
+static void add_pools(NSMutableString *out, NSDictionary *pools,
+  NSString *key, NSString *name, NSString *type, NSString *help)
+{
+	NSEnumerator *iter;
+	NSString *className;
+
+	add_header(out, name, type, help);
+	iter = [[pools allKeys] objectEnumerator];
+	while ((className = [iter nextObject]))
+	{
+		[out appendFormat: @"%@{class=\"%@\"} %llu\n", name,
+		  label_value(className),
+		  number([pools objectForKey: className], key)];
+	}
+}
+
+@interface NetMetricsConnection (InternalNetMetricsConnection)
+- respondWithStatus: (int)aStatus reason: (NSString *)aReason
+   body: (NSString *)aBody;
+- closeTimedOut: (NSTimer *)aTimer;
+@end
+
+@implementation NetMetricsConnection (InternalNetMetricsConnection)
+- respondWithStatus: (int)aStatus reason: (NSString *)aReason
+   body: (NSString *)aBody
+{
+	NSData *body = [aBody dataUsingEncoding: NSUTF8StringEncoding];
+	NSString *header;
+
+	header = [NSString stringWithFormat: @"HTTP/1.0 %d %@\r\n"
+	  @"Content-Type: %@\r\n"
+	  @"Content-Length: %u\r\n"
+	  @"Connection: close\r\n\r\n",
+	  aStatus, aReason,
+	  (aStatus == 200) ? @"text/plain; version=0.0.4; charset=utf-8" :
+	    @"text/plain; charset=utf-8",
+	  (unsigned)[body length]];
+
+	DESTROY(request);
+	[transport writeData: [header dataUsingEncoding: NSASCIIStringEncoding]];
+	[transport writeData: body];
+
+	/* HTTP/1.0 ends the response by closing, once it is written: now,
+	 * or when -writingFinished says the rest has gone out. */
+	if ([transport isDoneWriting])
+	{
+		[[NetApplication sharedInstance] disconnectObject: self];
+		return self;
+	}
+	closeTimer = RETAIN([NSTimer scheduledTimerWithTimeInterval:
+	  CLOSE_TIMEOUT target: self selector: @selector(closeTimedOut:)
+	  userInfo: nil repeats: NO]);
+	return self;
+}
+- closeTimedOut: (NSTimer *)aTimer
+{
+	DESTROY(closeTimer);
+	[[NetApplication sharedInstance] disconnectObject: self];
+	return self;
+}
+@end
+
+@implementation NetMetricsConnection
+- (void)dealloc
+{
+	[closeTimer invalidate];
+	RELEASE(closeTimer);
+	RELEASE(request);
+	RELEASE(transport);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	[closeTimer invalidate];
+	DESTROY(closeTimer);
+	DESTROY(request);
+	[transport close];
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	transport = RETAIN(aTransport);
+	request = [NSMutableData new];
+	if ([(id)transport isKindOfClass: [TCPTransport class]])
+	{
+		[(TCPTransport *)transport setWriteStrategy: NetWriteImmediate];
+	}
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	const char *bytes;
+	unsigned length, x, lineEnd = 0;
+	BOOL complete = NO;
+	NSString *line;
+	NSArray *words;
+	NSString *path;
+	NSRange query;
+
+	if (!request)
+	{
+		return self;
+	}
+	[request appendData: data];
+
+	bytes = [request bytes];
+	length = [request length];
+	for (x = 0; x < length && !complete; x++)
+	{
+		if (bytes[x] != '\n')
+		{
+			continue;
+		}
+		if (!lineEnd)
+		{
+			lineEnd = x;
+		}
+		complete = (x >= 1 && bytes[x - 1] == '\n') ||
+		  (x >= 2 && bytes[x - 1] == '\r' && bytes[x - 2] == '\n');
+	}
+	if (!complete)
+	{
+		if (length > MAX_REQUEST_LENGTH)
+		{
+			return [self respondWithStatus: 400 reason: @"Bad Request"
+			  body: @"Bad Request\n"];
+		}
+		return self;
+	}
+
+	line = AUTORELEASE([[NSString alloc] initWithBytes: bytes
+	  length: lineEnd encoding: NSASCIIStringEncoding]);
+	line = [line stringByTrimmingCharactersInSet:
+	  [NSCharacterSet whitespaceAndNewlineCharacterSet]];
+	words = [line componentsSeparatedByString: @" "];
+	if ([words count] < 2)
+	{
+		return [self respondWithStatus: 400 reason: @"Bad Request"
+		  body: @"Bad Request\n"];
+	}
+	if (![[words objectAtIndex: 0] isEqualToString: @"GET"])
+	{
+		return [self respondWithStatus: 405 reason: @"Method Not Allowed"
+		  body: @"Method Not Allowed\n"];
+	}
+
+	path = [words objectAtIndex: 1];
+	query = [path rangeOfString: @"?"];
+	if (query.location != NSNotFound)
+	{
+		path = [path substringToIndex: query.location];
+	}
+	if (![path isEqualToString: @"/metrics"] && ![path isEqualToString: @"/"])
+	{
+		return [self respondWithStatus: 404 reason: @"Not Found"
+		  body: @"Not Found\n"];
+	}
+
+	scrapes++;
+	return [self respondWithStatus: 200 reason: @"OK"
+	  body: [NetMetricsServer renderMetrics]];
+}
+- writingFinished
+{
+	/* The request is dropped once the response is written. */
+	if (!request && transport)
+	{
+		[[NetApplication sharedInstance] disconnectObject: self];
+	}
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@implementation NetMetricsServer
++ (NSString *)renderMetrics
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	NSDictionary *stats = [net statistics];
+	NSDictionary *events = [stats objectForKey: @"Events"];
+	NSDictionary *buffers;
+	NSDictionary *pools;
+	NSMutableString *out = [NSMutableString stringWithCapacity: 8192];
+	NSString *types[] = { @"ET_RDESC", @"ET_WDESC", @"ET_RPORT", @"ET_EDESC" };
+	unsigned long long pending;
+	unsigned writers;
+	int x;
+
+	add_value(out, @"netclasses_connections", @"gauge",
+	  @"Net objects currently connected.",
+	  number(stats, @"Connections"));
+	add_value(out, @"netclasses_ports", @"gauge",
+	  @"Ports currently listening.", number(stats, @"Ports"));
+	add_value(out, @"netclasses_connections_total", @"counter",
+	  @"Net objects connected since startup.",
+	  number(stats, @"TotalConnections"));
+	add_value(out, @"netclasses_accepts_total", @"counter",
+	  @"Connections accepted by all ports.", number(stats, @"Accepts"));
+
+	add_header(out, @"netclasses_events_total", @"counter",
+	  @"Run loop events dispatched, by type.");
+	for (x = 0; x < 4; x++)
+	{
+		[out appendFormat: @"netclasses_events_total{type=\"%@\"} %llu\n",
+		  types[x], number(events, types[x])];
+	}
+	add_value(out, @"netclasses_posted_total", @"counter",
+	  @"Writes and messages posted from other threads.",
+	  number(stats, @"Posted"));
+	add_value(out, @"netclasses_post_wakeups_total", @"counter",
+	  @"Times the run loop was woken for posted work.",
+	  number(stats, @"PostWakeups"));
+
+	add_value(out, @"netclasses_read_bytes_total", @"counter",
+	  @"Bytes read by all TCP transports.", NetTransportTotals.bytesRead);
+	add_value(out, @"netclasses_written_bytes_total", @"counter",
+	  @"Bytes written by all TCP transports.",
+	  NetTransportTotals.bytesWritten);
+	add_value(out, @"netclasses_read_calls_total", @"counter",
+	  @"Reads made by all TCP transports.", NetTransportTotals.readCalls);
+	add_value(out, @"netclasses_write_calls_total", @"counter",
+	  @"Writes made by all TCP transports.",
+	  NetTransportTotals.writeCalls);
+
+	pending = [net pendingWriteBytes: &writers];
+	add_value(out, @"netclasses_write_buffer_bytes", @"gauge",
+	  @"Bytes waiting in the write buffers of TCP transports.", pending);
+	add_value(out, @"netclasses_write_buffer_connections", @"gauge",
+	  @"TCP transports with data waiting to be written.", writers);
+
+	buffers = [stats objectForKey: @"BufferPool"];
+	add_value(out, @"netclasses_buffer_pool_hits_total", @"counter",
+	  @"Buffers handed out from the buffer pool.",
+	  number(buffers, @"Hits"));
+	add_value(out, @"netclasses_buffer_pool_misses_total", @"counter",
+	  @"Buffers allocated because the buffer pool had none.",
+	  number(buffers, @"Misses"));
+	add_value(out, @"netclasses_buffer_pool_idle_bytes", @"gauge",
+	  @"Bytes of buffers waiting in the buffer pool.",
+	  number(buffers, @"IdleBytes"));
+	pools = [stats objectForKey: @"ObjectPools"];
+	add_pools(out, pools, @"Hits", @"netclasses_object_pool_hits_total",
+	  @"counter", @"Objects reused from the pool of their class.");
+	add_pools(out, pools, @"Misses", @"netclasses_object_pool_misses_total",
+	  @"counter", @"Objects allocated because their pool had none.");
+	add_pools(out, pools, @"Kept", @"netclasses_object_pool_kept",
+	  @"gauge", @"Objects kept by the pool of their class.");
+
+	if ([net instrumentationEnabled])
+	{
+		add_summary(out, @"netclasses_loop_lag_microseconds",
+		  @"How late the run loop serviced a timer.", [net lagHistogram]);
+		add_summary(out, @"netclasses_handler_duration_microseconds",
+		  @"Time taken by each dispatched handler.", [net handlerHistogram]);
+	}
+
+	add_header(out, @"netclasses_irc_lines_total", @"counter",
+	  @"IRC lines received and sent by all IRCObjects, by command.");
+	add_commands(out);
+
+	add_value(out, @"netclasses_metrics_scrapes_total", @"counter",
+	  @"Requests answered with these metrics.", scrapes);
+
+	return out;
+}
+- initOnHost: (NSHost *)aHost onPort: (uint16_t)aPort
+   socketOptions: (TCPSocketOptions *)options
+{
+	if (!(self = [super initOnHost: aHost onPort: aPort
+	  socketOptions: options])) return nil;
+
+	[self setNetObject: [NetMetricsConnection class]];
+
+	pthread_mutex_lock(&command_lock);
+	metrics_servers++;
+	__atomic_store_n(&NetMetricsCountsCommands, YES, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&command_lock);
+	countsCommands = YES;
+
+	return self;
+}
+- (void)dealloc
+{
+	/* Counters already listed stay in the metrics, but connections
+	 * established from now on are no longer added. */
+	if (countsCommands)
+	{
+		pthread_mutex_lock(&command_lock);
+		if (--metrics_servers == 0)
+		{
+			__atomic_store_n(&NetMetricsCountsCommands, NO,
+			  __ATOMIC_RELEASE);
+		}
+		pthread_mutex_unlock(&command_lock);
+	}
+	[super dealloc];
+}
+@end
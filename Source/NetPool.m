@@ -0,0 +1,386 @@
+/***************************************************************************
+                                NetPool.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetPool reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#import "NetPool.h"
+#import <Foundation/NSArray.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSMapTable.h>
+#import <Foundation/NSString.h>
+#import <Foundation/NSValue.h>
+
+#define DEFAULT_LIMIT 256
+
+static const unsigned class_sizes[NET_BUFFER_CLASSES] =
+  { 2048, 16384, 131072 };
+
+static NetBufferPool *default_buffer_pool = nil;
+
+static pthread_mutex_t pools_lock = PTHREAD_MUTEX_INITIALIZER;
+static NSMapTable *pools = 0;
+
+static double hit_rate(unsigned long long hits, unsigned long long misses)
+{
+	return (hits + misses) ? (double)hits / (hits + misses) : 0.0;
+}
+
+@implementation NetBufferPool
++ (NetBufferPool *)sharedPool
+{
+	pthread_mutex_lock(&pools_lock);
+	if (!default_buffer_pool)
+	{
+		default_buffer_pool = [NetBufferPool new];
+	}
+	pthread_mutex_unlock(&pools_lock);
+	return default_buffer_pool;
+}
+- init
+{
+	int x;
+
+	if (!(self = [super init])) return nil;
+
+	pthread_mutex_init(&lock, NULL);
+	for (x = 0; x < NET_BUFFER_CLASSES; x++)
+	{
+		idle[x] = [NSMutableArray new];
+	}
+	limit = DEFAULT_LIMIT;
+
+	return self;
+}
+- (void)dealloc
+{
+	int x;
+
+	for (x = 0; x < NET_BUFFER_CLASSES; x++)
+	{
+		RELEASE(idle[x]);
+	}
+	pthread_mutex_destroy(&lock);
+	[super dealloc];
+}
+- (NSMutableData *)newBufferWithCapacity: (unsigned)aCapacity
+{
+	NSMutableData *buffer = nil;
+	int x;
+
+	for (x = 0; x < NET_BUFFER_CLASSES; x++)
+	{
+		if (class_sizes[x] >= aCapacity)
+		{
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&lock);
+	if (x < NET_BUFFER_CLASSES && [idle[x] count])
+	{
+		buffer = RETAIN([idle[x] lastObject]);
+		[idle[x] removeLastObject];
+		hits++;
+	}
+	else
+	{
+		misses++;
+	}
+	pthread_mutex_unlock(&lock);
+
+	if (!buffer)
+	{
+		buffer = [[NSMutableData alloc] initWithCapacity:
+		  (x < NET_BUFFER_CLASSES) ? class_sizes[x] : aCapacity];
+	}
+	return buffer;
+}
+- (void)recycleBuffer: (NSMutableData *)aBuffer capacity: (unsigned)aCapacity
+{
+	int x;
+
+	if (!aBuffer)
+	{
+		return;
+	}
+	/* A buffer goes in the smallest class that covers all it may hold,
+	 * so no idle buffer is larger than its class. */
+	for (x = 0; x < NET_BUFFER_CLASSES; x++)
+	{
+		if (class_sizes[x] >= aCapacity)
+		{
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&lock);
+	if (x < NET_BUFFER_CLASSES && [idle[x] count] < limit)
+	{
+		[aBuffer setLength: 0];
+		[idle[x] addObject: aBuffer];
+		recycled++;
+	}
+	else
+	{
+		discarded++;
+	}
+	pthread_mutex_unlock(&lock);
+
+	/* Released outside of the lock, or by the array if it was kept. */
+	RELEASE(aBuffer);
+}
+- setLimit: (unsigned)aLimit
+{
+	int x;
+
+	pthread_mutex_lock(&lock);
+	limit = aLimit;
+	for (x = 0; x < NET_BUFFER_CLASSES; x++)
+	{
+		while ([idle[x] count] > limit)
+		{
+			[idle[x] removeLastObject];
+			discarded++;
+		}
+	}
+	pthread_mutex_unlock(&lock);
+	return self;
+}
+- (unsigned)limit
+{
+	return limit;
+}
+- (NSDictionary *)statistics
+{
+	NSDictionary *dict;
+	unsigned count = 0;
+	unsigned long long bytes = 0;
+	int x;
+
+	pthread_mutex_lock(&lock);
+	for (x = 0; x < NET_BUFFER_CLASSES; x++)
+	{
+		count += [idle[x] count];
+		bytes += (unsigned long long)[idle[x] count] * class_sizes[x];
+	}
+	dict = [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: hits], @"Hits",
+	  [NSNumber numberWithUnsignedLongLong: misses], @"Misses",
+	  [NSNumber numberWithDouble: hit_rate(hits, misses)], @"HitRate",
+	  [NSNumber numberWithUnsignedLongLong: recycled], @"Recycled",
+	  [NSNumber numberWithUnsignedLongLong: discarded], @"Discarded",
+	  [NSNumber numberWithUnsignedInt: count], @"Idle",
+	  [NSNumber numberWithUnsignedLongLong: bytes], @"IdleBytes",
+	  [NSNumber numberWithUnsignedInt: limit], @"Limit",
+	  nil];
+	pthread_mutex_unlock(&lock);
+
+	return dict;
+}
+@end
+
+@implementation NetObjectPool
++ (NetObjectPool *)poolForClass: (Class)aClass
+{
+	NetObjectPool *pool;
+
+	pthread_mutex_lock(&pools_lock);
+	if (!pools)
+	{
+		pools = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+		  NSObjectMapValueCallBacks, 8);
+	}
+	pool = NSMapGet(pools, aClass);
+	if (!pool)
+	{
+		pool = [[NetObjectPool alloc] initWithClass: aClass];
+		NSMapInsert(pools, aClass, pool);
+		RELEASE(pool);
+	}
+	pthread_mutex_unlock(&pools_lock);
+
+	return pool;
+}
++ (BOOL)recyclesInstancesOfClass: (Class)aClass
+{
+	return [aClass conformsToProtocol: @protocol(NetRecycling)] &&
+	  [aClass recyclesInstances];
+}
++ (id)allocInstanceOfClass: (Class)aClass
+{
+	if (![self recyclesInstancesOfClass: aClass])
+	{
+		return [aClass alloc];
+	}
+	return [[self poolForClass: aClass] allocObject];
+}
++ (void)recycleInstance: (id)anObject
+{
+	Class aClass = [anObject class];
+
+	if (anObject && [self recyclesInstancesOfClass: aClass])
+	{
+		[[self poolForClass: aClass] recycleObject: anObject];
+	}
+	else
+	{
+		RELEASE(anObject);
+	}
+}
++ (NSDictionary *)statistics
+{
+	NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+	NSMapEnumerator iter;
+	Class aClass;
+	NetObjectPool *pool;
+
+	pthread_mutex_lock(&pools_lock);
+	if (pools)
+	{
+		iter = NSEnumerateMapTable(pools);
+		while (NSNextMapEnumeratorPair(&iter, (void **)&aClass,
+		  (void **)&pool))
+		{
+			[dict setObject: [pool statistics]
+			  forKey: NSStringFromClass(aClass)];
+		}
+		NSEndMapTableEnumeration(&iter);
+	}
+	pthread_mutex_unlock(&pools_lock);
+
+	return dict;
+}
+- init
+{
+	return [self initWithClass: Nil];
+}
+- initWithClass: (Class)aClass
+{
+	if (!(self = [super init])) return nil;
+
+	pthread_mutex_init(&lock, NULL);
+	objectClass = aClass;
+	objects = [NSMutableArray new];
+	limit = DEFAULT_LIMIT;
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(objects);
+	pthread_mutex_destroy(&lock);
+	[super dealloc];
+}
+- (id)allocObject
+{
+	id object = nil;
+
+	pthread_mutex_lock(&lock);
+	/* The most recently recycled is the likeliest to still be cached. */
+	if ([objects count])
+	{
+		object = RETAIN([objects lastObject]);
+		[objects removeLastObject];
+		hits++;
+	}
+	else
+	{
+		misses++;
+	}
+	pthread_mutex_unlock(&lock);
+
+	if (!object)
+	{
+		return [objectClass alloc];
+	}
+	return object;
+}
+- (void)recycleObject: (id)anObject
+{
+	if (!anObject)
+	{
+		return;
+	}
+
+	/* Emptied before it is kept, so an idle object holds nothing. */
+	[anObject prepareForReuse];
+
+	pthread_mutex_lock(&lock);
+	if ([objects count] < limit)
+	{
+		[objects addObject: anObject];
+		recycled++;
+	}
+	else
+	{
+		discarded++;
+	}
+	pthread_mutex_unlock(&lock);
+
+	/* The pool keeps its own reference if it kept the object; the one
+	 * handed over is released outside of the lock, where the object may
+	 * be freed. */
+	RELEASE(anObject);
+}
+- setLimit: (unsigned)aLimit
+{
+	NSMutableArray *dropped = [NSMutableArray array];
+
+	pthread_mutex_lock(&lock);
+	limit = aLimit;
+	while ([objects count] > limit)
+	{
+		[dropped addObject: [objects objectAtIndex: 0]];
+		[objects removeObjectAtIndex: 0];
+		discarded++;
+	}
+	pthread_mutex_unlock(&lock);
+
+	return self;
+}
+- (unsigned)limit
+{
+	return limit;
+}
+- (NSDictionary *)statistics
+{
+	NSDictionary *dict;
+
+	pthread_mutex_lock(&lock);
+	dict = [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: hits], @"Hits",
+	  [NSNumber numberWithUnsignedLongLong: misses], @"Misses",
+	  [NSNumber numberWithDouble: hit_rate(hits, misses)], @"HitRate",
+	  [NSNumber numberWithUnsignedLongLong: recycled], @"Recycled",
+	  [NSNumber numberWithUnsignedLongLong: discarded], @"Discarded",
+	  [NSNumber numberWithUnsignedInt: [objects count]], @"Kept",
+	  [NSNumber numberWithUnsignedInt: limit], @"Limit",
+	  nil];
+	pthread_mutex_unlock(&lock);
+
+	return dict;
+}
+@end
@@ -30,6 +30,10 @@
 #endif
 
 #import "NetTCP.h"
+#import "NetCapture.h"
+#import "NetMetrics.h"
+#import "NetFilter.h"
+#import "NetPool.h"
 #import <Foundation/NSString.h>
 #import <Foundation/NSData.h>
 #import <Foundation/NSDictionary.h>
@@ -37,6 +41,7 @@
 #import <Foundation/NSTimer.h>
 #import <Foundation/NSException.h>
 #import <Foundation/NSHost.h>
+#import <Foundation/NSValue.h>
 
 #include <string.h>
 #include <errno.h>
@@ -48,6 +53,8 @@
 #include <fcntl.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
 
 #ifndef HAVE_SOCKLEN_T 
 typedef int socklen_t;
@@ -62,6 +69,8 @@ static TCPSystem *default_system = nil;
 @interface TCPSystem (InternalTCPSystem)
 - (int)openPort: (uint16_t)portNumber;
 - (int)openPort: (uint16_t)portNumber onHost: (NSHost *)aHost;
+- (int)openPort: (uint16_t)portNumber onHost: (NSHost *)aHost
+   withOptions: (TCPSocketOptions *)options;
 
 - (int)connectToHost: (NSHost *)aHost onPort: (uint16_t)portNumber
          withTimeout: (int)timeout inBackground: (BOOL)background;
@@ -69,8 +78,16 @@ static TCPSystem *default_system = nil;
 - setErrorString: (NSString *)anError withErrno: (int)aErrno;
 @end
 
+@interface TCPTransport (InternalTCPTransport)
+- (unsigned)sendBytes: (const char *)bytes length: (unsigned)length;
+- (void)scheduleFlush;
+- (void)setCorked: (BOOL)aFlag;
+- (void)recycleWriteBuffer;
+@end
+
 @interface TCPConnecting (InternalTCPConnecting)
-- initWithNetObject: (id <NetObject>)netObject withTimeout: (int)aTimeout;
+- initWithNetObject: (id <NetObject>)netObject withTimeout: (int)aTimeout
+   transportClass: (Class)aClass;
 - connectingFailed: (NSString *)error;
 - connectingSucceeded;
 - timeoutReceived: (NSTimer *)aTimer;
@@ -199,10 +216,12 @@ static TCPSystem *default_system = nil;
 
 @implementation TCPConnecting (InternalTCPConnecting)
 - initWithNetObject: (id <NetObject>)aNetObject withTimeout: (int)aTimeout
+   transportClass: (Class)aClass
 {
 	if (!(self = [super init])) return nil;
 	
 	netObject = RETAIN(aNetObject);
+	transportClass = aClass;
 	if (aTimeout > 0)
 	{
 		timeout = RETAIN([NSTimer scheduledTimerWithTimeInterval:
@@ -227,18 +246,26 @@ static TCPSystem *default_system = nil;
 }
 - connectingSucceeded
 {
-	TCPTransport *newTrans = AUTORELEASE([[TCPTransport alloc] initWithDesc:
+	TCPTransport *newTrans = [[transportClass alloc] initWithDesc:
 	    dup([transport desc])
-	  withRemoteHost: [transport remoteHost]]);
+	  withRemoteHost: [transport remoteHost]];
 	id buffer = RETAIN([(TCPConnectingTransport *)transport writeBuffer]);
 	
 	[timeout invalidate];
+
+	if (!newTrans)
+	{
+		RELEASE(buffer);
+		return [self connectingFailed: 
+		  [[TCPSystem sharedInstance] errorString]];
+	}
 	
 	[[NetApplication sharedInstance] disconnectObject: self];
 	[netObject connectionEstablished: newTrans];
 
 	[newTrans writeData: buffer];
 	RELEASE(buffer);
+	RELEASE(newTrans);
 
 	return self;
 }
@@ -295,12 +322,226 @@ static TCPSystem *default_system = nil;
 }
 @end
 
+/* The option names that are missing from some systems. */
+#ifndef TCP_NOTSENT_LOWAT
+#define TCP_NOTSENT_LOWAT -1
+#endif
+#if !defined(TCP_KEEPIDLE) && defined(TCP_KEEPALIVE)
+#define TCP_KEEPIDLE TCP_KEEPALIVE
+#endif
+#ifndef TCP_KEEPIDLE
+#define TCP_KEEPIDLE -1
+#endif
+#ifndef TCP_KEEPINTVL
+#define TCP_KEEPINTVL -1
+#endif
+#ifndef TCP_KEEPCNT
+#define TCP_KEEPCNT -1
+#endif
+#ifndef TCP_USER_TIMEOUT
+#define TCP_USER_TIMEOUT -1
+#endif
+#ifndef TCP_DEFER_ACCEPT
+#define TCP_DEFER_ACCEPT -1
+#endif
+#ifndef TCP_FASTOPEN
+#define TCP_FASTOPEN -1
+#endif
+
+static BOOL set_option(int aDesc, int level, int name, int value)
+{
+	if (value < 0)
+	{
+		return YES;
+	}
+	if (name == -1)
+	{
+		errno = ENOPROTOOPT;
+	}
+	else if (setsockopt(aDesc, level, name, &value, sizeof(value)) == 0)
+	{
+		return YES;
+	}
+	[[TCPSystem sharedInstance] setErrorString: [NSString stringWithFormat: 
+	  @"%s", strerror(errno)] withErrno: errno];
+	return NO;
+}
+
+static inline int override(int value, int overriding)
+{
+	return (overriding >= 0) ? overriding : value;
+}
+
+@implementation TCPSocketOptions
++ (TCPSocketOptions *)options
+{
+	return AUTORELEASE([self new]);
+}
+- init
+{
+	if (!(self = [super init])) return nil;
+
+	noDelay = sendBufferSize = receiveBufferSize = notSentLowWater = -1;
+	keepAlive = keepAliveIdle = keepAliveInterval = keepAliveCount = -1;
+	userTimeout = deferAccept = fastOpen = -1;
+
+	return self;
+}
+- copyWithZone: (NSZone *)aZone
+{
+	return RETAIN([[TCPSocketOptions options] optionsOverriddenBy: self]);
+}
+- setNoDelay: (BOOL)aFlag
+{
+	noDelay = (aFlag) ? 1 : 0;
+	return self;
+}
+- (int)noDelay
+{
+	return noDelay;
+}
+- setSendBufferSize: (int)aSize
+{
+	sendBufferSize = aSize;
+	return self;
+}
+- (int)sendBufferSize
+{
+	return sendBufferSize;
+}
+- setReceiveBufferSize: (int)aSize
+{
+	receiveBufferSize = aSize;
+	return self;
+}
+- (int)receiveBufferSize
+{
+	return receiveBufferSize;
+}
+- setNotSentLowWater: (int)aCount
+{
+	notSentLowWater = aCount;
+	return self;
+}
+- (int)notSentLowWater
+{
+	return notSentLowWater;
+}
+- setKeepAlive: (BOOL)aFlag
+{
+	keepAlive = (aFlag) ? 1 : 0;
+	return self;
+}
+- (int)keepAlive
+{
+	return keepAlive;
+}
+- setKeepAliveIdle: (int)idle interval: (int)interval count: (int)count
+{
+	keepAliveIdle = idle;
+	keepAliveInterval = interval;
+	keepAliveCount = count;
+	return self;
+}
+- (int)keepAliveIdle
+{
+	return keepAliveIdle;
+}
+- (int)keepAliveInterval
+{
+	return keepAliveInterval;
+}
+- (int)keepAliveCount
+{
+	return keepAliveCount;
+}
+- setUserTimeout: (int)milliseconds
+{
+	userTimeout = milliseconds;
+	return self;
+}
+- (int)userTimeout
+{
+	return userTimeout;
+}
+- setDeferAccept: (int)seconds
+{
+	deferAccept = seconds;
+	return self;
+}
+- (int)deferAccept
+{
+	return deferAccept;
+}
+- setFastOpen: (int)aLength
+{
+	fastOpen = aLength;
+	return self;
+}
+- (int)fastOpen
+{
+	return fastOpen;
+}
+- (TCPSocketOptions *)optionsOverriddenBy: (TCPSocketOptions *)overrides
+{
+	TCPSocketOptions *options = [TCPSocketOptions options];
+
+	if (!overrides)
+	{
+		overrides = options;
+	}
+	options->noDelay = override(noDelay, overrides->noDelay);
+	options->sendBufferSize = override(sendBufferSize, 
+	  overrides->sendBufferSize);
+	options->receiveBufferSize = override(receiveBufferSize,
+	  overrides->receiveBufferSize);
+	options->notSentLowWater = override(notSentLowWater,
+	  overrides->notSentLowWater);
+	options->keepAlive = override(keepAlive, overrides->keepAlive);
+	options->keepAliveIdle = override(keepAliveIdle, 
+	  overrides->keepAliveIdle);
+	options->keepAliveInterval = override(keepAliveInterval,
+	  overrides->keepAliveInterval);
+	options->keepAliveCount = override(keepAliveCount,
+	  overrides->keepAliveCount);
+	options->userTimeout = override(userTimeout, overrides->userTimeout);
+	options->deferAccept = override(deferAccept, overrides->deferAccept);
+	options->fastOpen = override(fastOpen, overrides->fastOpen);
+
+	return options;
+}
+- (BOOL)applyToDesc: (int)aDesc
+{
+	return set_option(aDesc, IPPROTO_TCP, TCP_NODELAY, noDelay) &&
+	  set_option(aDesc, SOL_SOCKET, SO_SNDBUF, sendBufferSize) &&
+	  set_option(aDesc, SOL_SOCKET, SO_RCVBUF, receiveBufferSize) &&
+	  set_option(aDesc, IPPROTO_TCP, TCP_NOTSENT_LOWAT, notSentLowWater) &&
+	  set_option(aDesc, SOL_SOCKET, SO_KEEPALIVE, keepAlive) &&
+	  set_option(aDesc, IPPROTO_TCP, TCP_KEEPIDLE, keepAliveIdle) &&
+	  set_option(aDesc, IPPROTO_TCP, TCP_KEEPINTVL, keepAliveInterval) &&
+	  set_option(aDesc, IPPROTO_TCP, TCP_KEEPCNT, keepAliveCount) &&
+	  set_option(aDesc, IPPROTO_TCP, TCP_USER_TIMEOUT, userTimeout);
+}
+- (BOOL)applyToListeningDesc: (int)aDesc
+{
+	return [self applyToDesc: aDesc] &&
+	  set_option(aDesc, IPPROTO_TCP, TCP_DEFER_ACCEPT, deferAccept) &&
+	  set_option(aDesc, IPPROTO_TCP, TCP_FASTOPEN, fastOpen);
+}
+@end
+
 @implementation TCPSystem (InternalTCPSystem)
 - (int)openPort: (uint16_t)portNumber
 {
 	return [self openPort: portNumber onHost: nil];
 }
 - (int)openPort: (uint16_t)portNumber onHost: (NSHost *)aHost
+{
+	return [self openPort: portNumber onHost: aHost
+	  withOptions: defaultOptions];
+}
+- (int)openPort: (uint16_t)portNumber onHost: (NSHost *)aHost
+   withOptions: (TCPSocketOptions *)options
 {
 	struct sockaddr_in sin;
 	int temp;
@@ -356,6 +597,11 @@ static TCPSystem *default_system = nil;
 		  strerror(errno)] withErrno: errno];
 		return -1;
 	}
+	if (options && ![options applyToListeningDesc: myDesc])
+	{
+		close(myDesc);
+		return -1;
+	}
 	if (listen(myDesc, 5) == -1)
 	{
 		close(myDesc);
@@ -397,6 +643,12 @@ static TCPSystem *default_system = nil;
 	}
 	memset(&(destAddr.sin_zero), 0, sizeof(destAddr.sin_zero));
 
+	if (defaultOptions && ![defaultOptions applyToDesc: myDesc])
+	{
+		close(myDesc);
+		return -1;
+	}
+
 	if (timeout > 0 || bck)
 	{
 		if (fcntl(myDesc, F_SETFL, O_NONBLOCK) == -1)
@@ -480,6 +732,15 @@ static TCPSystem *default_system = nil;
 }
 @end		
 	
+/* Hosts made by -hostFromNetworkOrderInteger:, by address. */
+#define HOST_CACHE_SIZE 64
+
+static pthread_mutex_t host_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+	uint32_t ip;
+	NSHost *host;
+} host_cache[HOST_CACHE_SIZE];
+
 @implementation TCPSystem
 + sharedInstance
 {
@@ -506,8 +767,32 @@ static TCPSystem *default_system = nil;
 {
 	return errorNumber;
 }
+- setDefaultSocketOptions: (TCPSocketOptions *)options
+{
+	RELEASE(defaultOptions);
+	defaultOptions = [options copy];
+	return self;
+}
+- (TCPSocketOptions *)defaultSocketOptions
+{
+	return defaultOptions;
+}
 - (id <NetObject>)connectNetObject: (id <NetObject>)netObject toHost: (NSHost *)aHost
                 onPort: (uint16_t)aPort withTimeout: (int)aTimeout
+{
+	return [self connectNetObject: netObject toHost: aHost onPort: aPort
+	  withTimeout: aTimeout transportClass: [TCPTransport class]];
+}
+- (TCPConnecting *)connectNetObjectInBackground: (id <NetObject>)netObject 
+    toHost: (NSHost *)aHost onPort: (uint16_t)aPort withTimeout: (int)aTimeout
+{
+	return [self connectNetObjectInBackground: netObject toHost: aHost
+	  onPort: aPort withTimeout: aTimeout 
+	  transportClass: [TCPTransport class]];
+}
+- (id <NetObject>)connectNetObject: (id <NetObject>)netObject 
+    toHost: (NSHost *)aHost onPort: (uint16_t)aPort 
+    withTimeout: (int)aTimeout transportClass: (Class)aClass
 {
 	int desc;
 	id transport;
@@ -518,8 +803,7 @@ static TCPSystem *default_system = nil;
 	{
 		return nil;
 	}
-	transport = AUTORELEASE([[TCPTransport alloc] initWithDesc: desc 
-	 withRemoteHost: aHost]);
+	transport = [[aClass alloc] initWithDesc: desc withRemoteHost: aHost];
 	
 	if (!(transport))
 	{
@@ -528,11 +812,13 @@ static TCPSystem *default_system = nil;
 	}
 
 	[netObject connectionEstablished: transport];
+	RELEASE(transport);
 	
 	return netObject;
 }
-- (TCPConnecting *)connectNetObjectInBackground: (id <NetObject>)netObject 
-    toHost: (NSHost *)aHost onPort: (uint16_t)aPort withTimeout: (int)aTimeout
+- (TCPConnecting *)connectNetObjectInBackground: (id <NetObject>)netObject
+    toHost: (NSHost *)aHost onPort: (uint16_t)aPort 
+    withTimeout: (int)aTimeout transportClass: (Class)aClass
 {
 	int desc;
 	id transport;
@@ -547,7 +833,7 @@ static TCPSystem *default_system = nil;
 	}
 	
 	object = AUTORELEASE([[TCPConnecting alloc] initWithNetObject: netObject
-	   withTimeout: aTimeout]);
+	   withTimeout: aTimeout transportClass: aClass]);
 	transport = AUTORELEASE([[TCPConnectingTransport alloc] initWithDesc: desc 
 	  withRemoteHost: aHost withOwner: object]);
 	
@@ -561,6 +847,60 @@ static TCPSystem *default_system = nil;
 	
 	return object;
 }
+- (id <NetObject>)adoptDescriptor: (int)aDesc 
+    withNetObjectClass: (Class)aClass
+{
+	return [self adoptDescriptor: aDesc withNetObjectClass: aClass
+	  transportClass: [TCPTransport class]];
+}
+- (id <NetObject>)adoptDescriptor: (int)aDesc 
+    withNetObjectClass: (Class)aClass transportClass: (Class)transportClass
+{
+	struct sockaddr_in sin;
+	socklen_t temp = sizeof(sin);
+	NSHost *address = nil;
+	id transport;
+	id object;
+
+	if (![aClass conformsToProtocol: @protocol(NetObject)])
+	{
+		[NSException raise: FatalNetException
+		  format: @"%@ does not conform to < NetObject >",
+		    NSStringFromClass(aClass)];
+	}
+	if (transportClass != [TCPTransport class] &&
+	  ![transportClass isSubclassOfClass: [TCPTransport class]])
+	{
+		[NSException raise: FatalNetException
+		  format: @"%@ is not a subclass of TCPTransport",
+		    NSStringFromClass(transportClass)];
+	}
+
+	memset(&sin, 0, sizeof(sin));
+	if (getpeername(aDesc, (struct sockaddr *)&sin, &temp) == -1)
+	{
+		[self setErrorString: [NSString stringWithFormat: @"%s",
+		  strerror(errno)] withErrno: errno];
+		return nil;
+	}
+	if (sin.sin_family == AF_INET)
+	{
+		address = [self hostFromNetworkOrderInteger: sin.sin_addr.s_addr];
+	}
+
+	transport = [[transportClass alloc] initWithAcceptedDesc: aDesc
+	  withRemoteHost: address];
+	if (!transport)
+	{
+		return nil;
+	}
+
+	object = AUTORELEASE([aClass new]);
+	[object connectionEstablished: transport];
+	RELEASE(transport);
+
+	return object;
+}
 - (BOOL)hostOrderInteger: (uint32_t *)aNumber fromHost: (NSHost *)aHost
 {
 	struct in_addr addr;
@@ -600,17 +940,35 @@ static TCPSystem *default_system = nil;
 - (NSHost *)hostFromNetworkOrderInteger: (uint32_t)ip
 {
 	struct in_addr addr;
-	char *temp;
+	char temp[INET_ADDRSTRLEN];
+	unsigned slot = (ip ^ (ip >> 16)) % HOST_CACHE_SIZE;
+	NSHost *host;
 	
+	/* Every connection from the same address gets the same host, rather
+	 * than a new one per accept. */
+	pthread_mutex_lock(&host_cache_lock);
+	if (host_cache[slot].host && host_cache[slot].ip == ip)
+	{
+		host = AUTORELEASE(RETAIN(host_cache[slot].host));
+		pthread_mutex_unlock(&host_cache_lock);
+		return host;
+	}
+	pthread_mutex_unlock(&host_cache_lock);
+
 	addr.s_addr = ip;
 
-	temp = inet_ntoa(addr);
-	if (temp)
+	if (!inet_ntop(AF_INET, &addr, temp, sizeof(temp)))
 	{
-		return [NSHost hostWithAddress: [NSString stringWithCString: temp]];
+		return nil;
 	}
+	host = [NSHost hostWithAddress: [NSString stringWithCString: temp]];
 
-	return nil;
+	pthread_mutex_lock(&host_cache_lock);
+	ASSIGN(host_cache[slot].host, host);
+	host_cache[slot].ip = ip;
+	pthread_mutex_unlock(&host_cache_lock);
+
+	return host;
 }
 - (NSHost *)hostFromHostOrderInteger: (uint32_t)ip
 {
@@ -631,13 +989,20 @@ static TCPSystem *default_system = nil;
 
 @implementation TCPPort
 - initOnHost: (NSHost *)aHost onPort: (uint16_t)aPort
+{
+	return [self initOnHost: aHost onPort: aPort
+	  socketOptions: [[TCPSystem sharedInstance] defaultSocketOptions]];
+}
+- initOnHost: (NSHost *)aHost onPort: (uint16_t)aPort
+   socketOptions: (TCPSocketOptions *)options
 {
 	struct sockaddr_in x;
 	socklen_t address_length = sizeof(x);
 	
 	if (!(self = [super init])) return nil;
 	
-	desc = [[TCPSystem sharedInstance] openPort: aPort onHost: aHost];
+	desc = [[TCPSystem sharedInstance] openPort: aPort onHost: aHost
+	  withOptions: options];
 
 	if (desc < 0)
 	{
@@ -653,6 +1018,8 @@ static TCPSystem *default_system = nil;
 		return nil;
 	}
 	connected = YES;
+	transportClass = [TCPTransport class];
+	socketOptions = [options copy];
 	
 	port = ntohs(x.sin_port);
 
@@ -675,6 +1042,37 @@ static TCPSystem *default_system = nil;
 	netObjectClass = aClass;
 	return self;
 }
+- setTransportClass: (Class)aClass
+{
+	if (aClass != [TCPTransport class] &&
+	  ![aClass isSubclassOfClass: [TCPTransport class]])
+	{
+		[NSException raise: FatalNetException
+		  format: @"%@ is not a subclass of TCPTransport",
+		    NSStringFromClass(aClass)];
+	}
+
+	transportClass = aClass;
+	return self;
+}
+- (Class)transportClass
+{
+	return transportClass;
+}
+- (BOOL)setSocketOptions: (TCPSocketOptions *)options
+{
+	if (options && ![options applyToListeningDesc: desc])
+	{
+		return NO;
+	}
+	RELEASE(socketOptions);
+	socketOptions = [options copy];
+	return YES;
+}
+- (TCPSocketOptions *)socketOptions
+{
+	return socketOptions;
+}
 - (int)desc
 {
 	return desc;
@@ -694,8 +1092,6 @@ static TCPSystem *default_system = nil;
 	int newDesc;
 	struct sockaddr_in sin;
 	unsigned temp;
-	TCPTransport *transport;
-	NSHost *newAddress;
 	
 	temp = sizeof(struct sockaddr_in);
 	
@@ -705,21 +1101,47 @@ static TCPSystem *default_system = nil;
 		[NSException raise: FatalNetException
 		  format: @"%s", strerror(errno)];
 	}
+	[[NetApplication sharedInstance] connectionAccepted];
 	
+	return [self newConnectionWithDesc: newDesc fromAddress: &sin];
+}
+- newConnectionWithDesc: (int)newDesc
+   fromAddress: (const struct sockaddr_in *)anAddress
+{
+	struct sockaddr_in sin;
+	socklen_t temp = sizeof(sin);
+	TCPTransport *transport;
+	NSHost *newAddress;
+
+	if (!anAddress)
+	{
+		if (getpeername(newDesc, (struct sockaddr *)&sin, &temp) == -1)
+		{
+			close(newDesc);
+			return self;
+		}
+		anAddress = &sin;
+	}
+
 	newAddress = [[TCPSystem sharedInstance] 
-	  hostFromNetworkOrderInteger: sin.sin_addr.s_addr];	
+	  hostFromNetworkOrderInteger: anAddress->sin_addr.s_addr];	
 
-	transport = AUTORELEASE([[TCPTransport alloc] 
-	  initWithDesc: newDesc
-	  withRemoteHost: newAddress]);
+	transport = [[transportClass alloc] initWithAcceptedDesc: newDesc
+	  withRemoteHost: newAddress];
 	
 	if (!transport)
 	{
 		close(newDesc);
 		return self;
 	}
+	if (socketOptions && ![transport setSocketOptions: socketOptions])
+	{
+		RELEASE(transport);
+		return self;
+	}
 	
 	[AUTORELEASE([netObjectClass new]) connectionEstablished: transport];
+	RELEASE(transport);
 	
 	return self;
 }
@@ -730,17 +1152,102 @@ static TCPSystem *default_system = nil;
 - (void)dealloc
 {
 	[self close];
+	RELEASE(socketOptions);
 	[super dealloc];
 }
 @end
 
 static NetApplication *net_app = nil; 
+static NetWriteStrategy default_write_strategy = NetWriteDeferred;
+
+/* The write buffer of a new transport holds this much without growing. */
+#define WRITE_BUFFER_CAPACITY 2048
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+@implementation TCPTransport (InternalTCPTransport)
+/* Sends what it can without blocking and returns how much that was.
+ * Errors are left for the next write, which reports them. */
+- (unsigned)sendBytes: (const char *)bytes length: (unsigned)length
+{
+#ifdef MSG_DONTWAIT
+	ssize_t sent;
+
+	sent = send(desc, bytes, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+	writeCalls++;
+	NetTransportTotals.writeCalls++;
+	if (sent <= 0)
+	{
+		return 0;
+	}
+	bytesWritten += sent;
+	NetTransportTotals.bytesWritten += sent;
+	if (NetActiveCapture)
+	{
+		NetCaptureRecord(NetActiveCapture, captureConnection,
+		  NetCaptureOutbound, bytes, sent);
+	}
+	return (unsigned)sent;
+#else
+	return 0;
+#endif
+}
+- (void)scheduleFlush
+{
+	if (flushScheduled)
+	{
+		return;
+	}
+	flushScheduled = YES;
+	if (corksWrites)
+	{
+		[self setCorked: YES];
+	}
+	[net_app flushTransportAfterDispatch: self];
+}
+- (void)setCorked: (BOOL)aFlag
+{
+#ifdef TCP_CORK
+	int value = (aFlag) ? 1 : 0;
+
+	if (connected &&
+	  setsockopt(desc, IPPROTO_TCP, TCP_CORK, &value, sizeof(value)) == 0)
+	{
+		corked = aFlag;
+	}
+#endif
+}
+/* Returns the write buffer to the pool.  It holds at least what it was
+ * created with and the most it has held since. */
+- (void)recycleWriteBuffer
+{
+	if (!writeBuffer)
+	{
+		return;
+	}
+	[[NetBufferPool sharedPool] recycleBuffer: writeBuffer
+	  capacity: (peakWriteBufferLength > WRITE_BUFFER_CAPACITY) ?
+	  peakWriteBufferLength : WRITE_BUFFER_CAPACITY];
+	writeBuffer = nil;
+}
+@end
+
 
 @implementation TCPTransport
 + (void)initialize
 {
 	net_app = RETAIN([NetApplication sharedInstance]);
 }
++ (void)setDefaultWriteStrategy: (NetWriteStrategy)aStrategy
+{
+	default_write_strategy = aStrategy;
+}
++ (NetWriteStrategy)defaultWriteStrategy
+{
+	return default_write_strategy;
+}
 - initWithDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
 {
 	struct sockaddr_in x;
@@ -750,7 +1257,8 @@ static NetApplication *net_app = nil;
 	
 	desc = aDesc;
 	
-	writeBuffer = RETAIN([NSMutableData dataWithCapacity: 2000]);
+	writeBuffer = [[NetBufferPool sharedPool]
+	  newBufferWithCapacity: WRITE_BUFFER_CAPACITY];
 	remoteHost = RETAIN(theAddress);
 	
 	if (getsockname(desc, (struct sockaddr *)&x, &address_length) != 0) 
@@ -766,15 +1274,35 @@ static NetApplication *net_app = nil;
 	  hostFromNetworkOrderInteger: x.sin_addr.s_addr]);
 	
 	connected = YES;
+	writeStrategy = default_write_strategy;
+	gettimeofday(&connectTime, NULL);
+	
+	captureConnection = NetCaptureNextConnection();
+	if (NetActiveCapture)
+	{
+		const char *address = [[remoteHost address] UTF8String];
+
+		NetCaptureRecord(NetActiveCapture, captureConnection, NetCaptureOpen,
+		  address, address ? strlen(address) : 0);
+	}
 	
 	return self;
 }
+- initWithAcceptedDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
+{
+	return [self initWithDesc: aDesc withRemoteHost: theAddress];
+}
 - (void)dealloc
 {
 	[self close];
-	RELEASE(writeBuffer);
+	[self recycleWriteBuffer];
 	RELEASE(localHost);
 	RELEASE(remoteHost);
+	RELEASE(socketOptions);
+	while ([filters count])
+	{
+		[self removeFilter: [filters lastObject]];
+	}
 
 	[super dealloc];
 }
@@ -815,6 +1343,7 @@ static NetApplication *net_app = nil;
 		  format: @"%s", strerror(errno)];
 	}
 	data = [NSMutableData dataWithCapacity: bufsize];
+	eventsDispatched++;
 	
 	do
 	{
@@ -828,6 +1357,8 @@ static NetApplication *net_app = nil;
 		}
 
 		readReturn = read(desc, buffer, toRead); 
+		readCalls++;
+		NetTransportTotals.readCalls++;
 		if (readReturn == 0)
 		{
 			id except;
@@ -853,6 +1384,13 @@ static NetApplication *net_app = nil;
 		}
 
 		[data appendBytes: buffer length: readReturn];
+		bytesRead += readReturn;
+		NetTransportTotals.bytesRead += readReturn;
+		if (NetActiveCapture)
+		{
+			NetCaptureRecord(NetActiveCapture, captureConnection,
+			  NetCaptureInbound, buffer, readReturn);
+		}
 		
 		if (readReturn < bufsize)
 		{
@@ -886,7 +1424,7 @@ static NetApplication *net_app = nil;
 		[NSException raise: FatalNetException
 		  format: @"Not connected"];
 	}
-	return ([writeBuffer length]) ? NO : YES;
+	return ([writeBuffer length] || writeInFlight) ? NO : YES;
 }
 - writeData: (NSData *)aData
 {
@@ -900,18 +1438,26 @@ static NetApplication *net_app = nil;
 		{
 			return self;
 		}
-		if ([writeBuffer length] == 0)
+		if (![net_app isRunLoopThread])
 		{
-			[net_app transportNeedsToWrite: self];
+			/* Written by a handler on a NetWorkerPool. */
+			[net_app postWriteData: aData toTransport: self];
+			return self;
 		}
-		[writeBuffer appendData: aData];
-		return self;
+		if (filters)
+		{
+			[[filters lastObject] sendBytes: [aData bytes]
+			  length: [aData length]];
+			return self;
+		}
+		return [self bufferBytes: [aData bytes] length: [aData length]];
 	}
 	if (!connected)
 	{
 		[NSException raise: FatalNetException
 		  format: @"Not connected"];
 	}
+	eventsDispatched++;
 	
 	if ([writeBuffer length] == 0)
 	{
@@ -920,6 +1466,8 @@ static NetApplication *net_app = nil;
 	
 	writeReturn = 
 	  write(desc, [writeBuffer mutableBytes], [writeBuffer length]);
+	writeCalls++;
+	NetTransportTotals.writeCalls++;
 
 	if (writeReturn == -1)
 	{
@@ -930,8 +1478,15 @@ static NetApplication *net_app = nil;
 	{
 		return self;
 	}
+	bytesWritten += writeReturn;
+	NetTransportTotals.bytesWritten += writeReturn;
 	
 	bytes = (char *)[writeBuffer mutableBytes];
+	if (NetActiveCapture)
+	{
+		NetCaptureRecord(NetActiveCapture, captureConnection,
+		  NetCaptureOutbound, bytes, writeReturn);
+	}
 	length = [writeBuffer length] - writeReturn;
 	
 	memmove(bytes, bytes + writeReturn, length);
@@ -939,6 +1494,117 @@ static NetApplication *net_app = nil;
 	
 	return self;
 }
+- bufferBytes: (const char *)bytes length: (unsigned)length
+{
+	unsigned sent;
+
+	/* A closed transport has given its buffer back, and its descriptor
+	 * may already belong to another connection. */
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	if (length == 0)
+	{
+		return self;
+	}
+	if ([writeBuffer length] == 0)
+	{
+		if (writeStrategy == NetWriteImmediate && !writeInFlight)
+		{
+			sent = [self sendBytes: bytes length: length];
+			if (sent == length)
+			{
+				return self;
+			}
+			bytes += sent;
+			length -= sent;
+		}
+		if (writeStrategy == NetWriteEndOfDispatch && !writeInFlight)
+		{
+			[self scheduleFlush];
+		}
+		else
+		{
+			[net_app transportNeedsToWrite: self];
+		}
+	}
+	[writeBuffer appendBytes: bytes length: length];
+	if ([writeBuffer length] > peakWriteBufferLength)
+	{
+		peakWriteBufferLength = [writeBuffer length];
+	}
+	return self;
+}
+- (unsigned)writeBufferLength
+{
+	return [writeBuffer length] + bytesInFlight;
+}
+- setWriteStrategy: (NetWriteStrategy)aStrategy
+{
+	writeStrategy = aStrategy;
+	return self;
+}
+- (NetWriteStrategy)writeStrategy
+{
+	return writeStrategy;
+}
+- setCorksWrites: (BOOL)aFlag
+{
+	corksWrites = aFlag;
+	return self;
+}
+- (BOOL)corksWrites
+{
+	return corksWrites;
+}
+- flushWrites
+{
+	unsigned length = [writeBuffer length];
+	unsigned sent;
+	char *bytes;
+
+	flushScheduled = NO;
+	if (connected && length > 0 && !writeInFlight)
+	{
+		bytes = (char *)[writeBuffer mutableBytes];
+		sent = [self sendBytes: bytes length: length];
+		memmove(bytes, bytes + sent, length - sent);
+		[writeBuffer setLength: length - sent];
+	}
+	if (corked)
+	{
+		[self setCorked: NO];
+	}
+	if (connected && [writeBuffer length] > 0)
+	{
+		[net_app transportNeedsToWrite: self];
+	}
+	return self;
+}
+- (BOOL)setSocketOptions: (TCPSocketOptions *)options
+{
+	if (!options)
+	{
+		return YES;
+	}
+	if (![options applyToDesc: desc])
+	{
+		return NO;
+	}
+	if (socketOptions)
+	{
+		options = [socketOptions optionsOverriddenBy: options];
+	}
+	RELEASE(socketOptions);
+	socketOptions = [options copy];
+	return YES;
+}
+- (TCPSocketOptions *)socketOptions
+{
+	return socketOptions;
+}
 - (id)localHost
 {
 	return localHost;	
@@ -957,6 +1623,36 @@ static NetApplication *net_app = nil;
 		return;
 	connected = NO;
 	close(desc);
+	[self recycleWriteBuffer];
+	[filters makeObjectsPerformSelector: @selector(removedFromTransport)];
+	if (NetActiveCapture)
+	{
+		NetCaptureRecord(NetActiveCapture, captureConnection, NetCaptureClose,
+		  0, 0);
+	}
+}
+- (NSDictionary *)statistics
+{
+	struct timeval now;
+	double timeConnected;
+
+	gettimeofday(&now, NULL);
+	timeConnected = (now.tv_sec - connectTime.tv_sec) +
+	  (now.tv_usec - connectTime.tv_usec) / 1000000.0;
+
+	return [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: bytesRead], @"BytesRead",
+	  [NSNumber numberWithUnsignedLongLong: bytesWritten], @"BytesWritten",
+	  [NSNumber numberWithUnsignedLongLong: readCalls], @"ReadCalls",
+	  [NSNumber numberWithUnsignedLongLong: writeCalls], @"WriteCalls",
+	  [NSNumber numberWithUnsignedLongLong: eventsDispatched], 
+	    @"EventsDispatched",
+	  [NSNumber numberWithUnsignedInt: [writeBuffer length]], 
+	    @"WriteBufferLength",
+	  [NSNumber numberWithUnsignedInt: peakWriteBufferLength], 
+	    @"PeakWriteBufferLength",
+	  [NSNumber numberWithDouble: timeConnected], @"TimeConnected",
+	  nil];
 }
 @end	
 
@@ -0,0 +1,641 @@
+/***************************************************************************
+                                NetTLS.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetTLS reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#import "NetTLS.h"
+#import "NetHistogram.h"
+#import "NetCapture.h"
+#import "NetMetrics.h"
+#import <Foundation/NSString.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSHost.h>
+#import <Foundation/NSMapTable.h>
+#import <Foundation/NSValue.h>
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#ifdef HAVE_OPENSSL
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+NSString *NetclassesErrorNoTLS = @"TLS support not available";
+
+@interface TCPSystem (TLSTCPSystem)
+- setErrorString: (NSString *)anError withErrno: (int)aErrno;
+@end
+
+#ifdef HAVE_OPENSSL
+
+#define TLS_READ_BLOCK_SIZE 16384
+#define TLS_READ_BLOCKS 8
+
+static SSL_CTX *client_ctx = 0;
+static SSL_CTX *server_ctx = 0;
+static NSMapTable *session_cache = 0;
+
+@interface TLSTransport (InternalTLSTransport)
+- (BOOL)startHandshakeAsServer: (BOOL)isServer;
+- (BOOL)continueHandshake;
+- (NSString *)sessionKey;
+@end
+
+static NSString *tls_error_string(void)
+{
+	unsigned long error = ERR_get_error();
+	char buffer[256];
+
+	if (!error)
+	{
+		return [NSString stringWithCString: strerror(errno)];
+	}
+	ERR_clear_error();
+	ERR_error_string_n(error, buffer, sizeof(buffer));
+
+	return [NSString stringWithCString: buffer];
+}
+
+static int new_session(SSL *ssl, SSL_SESSION *session)
+{
+	TLSTransport *transport = (TLSTransport *)SSL_get_app_data(ssl);
+	NSString *key = [transport sessionKey];
+	SSL_SESSION *old;
+
+	if (!key)
+	{
+		return 0;
+	}
+
+	old = NSMapGet(session_cache, key);
+	if (old)
+	{
+		SSL_SESSION_free(old);
+	}
+	NSMapInsert(session_cache, key, session);
+
+	return 1;
+}
+
+static SSL_CTX *make_context(BOOL isServer)
+{
+	SSL_CTX *ctx;
+
+	ctx = SSL_CTX_new(isServer ? TLS_server_method() : TLS_client_method());
+	if (!ctx)
+	{
+		return 0;
+	}
+
+	SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+	SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE |
+	  SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_RELEASE_BUFFERS);
+
+	if (isServer)
+	{
+		SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+		SSL_CTX_set_session_id_context(ctx,
+		  (const unsigned char *)"netclasses", 10);
+	}
+	else
+	{
+		SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT |
+		  SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_sess_set_new_cb(ctx, new_session);
+		SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
+	}
+
+	return ctx;
+}
+
+@implementation TLSTransport (InternalTLSTransport)
+- (BOOL)startHandshakeAsServer: (BOOL)isServer
+{
+	struct sockaddr_in sin;
+	socklen_t length = sizeof(sin);
+	SSL_CTX *ctx = (isServer) ? server_ctx : client_ctx;
+	SSL_SESSION *session;
+	int flags;
+
+	server = isServer;
+	if (!ctx)
+	{
+		[[TCPSystem sharedInstance] setErrorString:
+		  @"TLS context is not set up" withErrno: 0];
+		return NO;
+	}
+
+	flags = fcntl(desc, F_GETFL, 0);
+	if (flags == -1 || fcntl(desc, F_SETFL, flags | O_NONBLOCK) == -1)
+	{
+		[[TCPSystem sharedInstance] setErrorString:
+		  [NSString stringWithCString: strerror(errno)] withErrno: errno];
+		return NO;
+	}
+
+	ssl = SSL_new(ctx);
+	if (!ssl || !SSL_set_fd(ssl, desc))
+	{
+		[[TCPSystem sharedInstance] setErrorString: tls_error_string()
+		  withErrno: 0];
+		return NO;
+	}
+	SSL_set_app_data(ssl, self);
+
+	if (server)
+	{
+		SSL_set_accept_state(ssl);
+	}
+	else
+	{
+		if (getpeername(desc, (struct sockaddr *)&sin, &length) == 0)
+		{
+			sessionKey = RETAIN(([NSString stringWithFormat: @"%s:%d",
+			  inet_ntoa(sin.sin_addr), ntohs(sin.sin_port)]));
+			session = NSMapGet(session_cache, sessionKey);
+			if (session)
+			{
+				SSL_set_session(ssl, session);
+			}
+		}
+		if ([remoteHost name] &&
+		  ![[remoteHost name] isEqualToString: [remoteHost address]])
+		{
+			SSL_set_tlsext_host_name(ssl, [[remoteHost name] cString]);
+			if (SSL_CTX_get_verify_mode(ctx) != SSL_VERIFY_NONE)
+			{
+				SSL_set1_host(ssl, [[remoteHost name] cString]);
+			}
+		}
+		SSL_set_connect_state(ssl);
+	}
+
+	handshaking = YES;
+	handshakeStarted = NetMonotonicMicroseconds();
+
+	NS_DURING
+		[self continueHandshake];
+	NS_HANDLER
+		[[TCPSystem sharedInstance] setErrorString: [localException reason]
+		  withErrno: 0];
+		NS_VALUERETURN(NO, BOOL);
+	NS_ENDHANDLER
+
+	return YES;
+}
+- (BOOL)continueHandshake
+{
+	int result;
+
+	result = SSL_do_handshake(ssl);
+	if (result == 1)
+	{
+		handshaking = NO;
+		handshakeWantsWrite = NO;
+		handshakeTime = NetMonotonicMicroseconds() - handshakeStarted;
+		if ([writeBuffer length])
+		{
+			[[NetApplication sharedInstance] transportNeedsToWrite: self];
+		}
+		return YES;
+	}
+
+	switch (SSL_get_error(ssl, result))
+	{
+		case SSL_ERROR_WANT_READ:
+			handshakeWantsWrite = NO;
+			return NO;
+		case SSL_ERROR_WANT_WRITE:
+			handshakeWantsWrite = YES;
+			[[NetApplication sharedInstance] transportNeedsToWrite: self];
+			return NO;
+		default:
+			[NSException raise: FatalNetException
+			  format: @"TLS handshake failed: %@", tls_error_string()];
+	}
+
+	return NO;
+}
+- (NSString *)sessionKey
+{
+	return sessionKey;
+}
+@end
+
+@implementation TLSTransport
++ (void)initialize
+{
+	if (session_cache) return;
+
+	SSL_library_init();
+	SSL_load_error_strings();
+
+	session_cache = NSCreateMapTable(NSObjectMapKeyCallBacks,
+	  NSNonOwnedPointerMapValueCallBacks, 16);
+	client_ctx = make_context(NO);
+}
++ (BOOL)setCertificateFile: (NSString *)aCertFile
+   privateKeyFile: (NSString *)aKeyFile
+{
+	SSL_CTX *ctx = make_context(YES);
+
+	if (!ctx ||
+	  SSL_CTX_use_certificate_chain_file(ctx, [aCertFile cString]) != 1 ||
+	  SSL_CTX_use_PrivateKey_file(ctx, [aKeyFile cString],
+	    SSL_FILETYPE_PEM) != 1 ||
+	  SSL_CTX_check_private_key(ctx) != 1)
+	{
+		[[TCPSystem sharedInstance] setErrorString: tls_error_string()
+		  withErrno: 0];
+		if (ctx) SSL_CTX_free(ctx);
+		return NO;
+	}
+
+	if (server_ctx)
+	{
+		SSL_CTX_free(server_ctx);
+	}
+	server_ctx = ctx;
+
+	return YES;
+}
++ (BOOL)setCAFile: (NSString *)aFile verifyPeer: (BOOL)verify
+{
+	if (aFile &&
+	  SSL_CTX_load_verify_locations(client_ctx, [aFile cString], NULL) != 1)
+	{
+		[[TCPSystem sharedInstance] setErrorString: tls_error_string()
+		  withErrno: 0];
+		return NO;
+	}
+	SSL_CTX_set_verify(client_ctx,
+	  (verify) ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, NULL);
+
+	return YES;
+}
++ (void)flushSessionCache
+{
+	NSMapEnumerator iter = NSEnumerateMapTable(session_cache);
+	void *key;
+	void *session;
+
+	while (NSNextMapEnumeratorPair(&iter, &key, &session))
+	{
+		SSL_SESSION_free((SSL_SESSION *)session);
+	}
+	NSEndMapTableEnumeration(&iter);
+	NSResetMapTable(session_cache);
+}
++ (unsigned)sessionCacheCount
+{
+	return NSCountMapTable(session_cache);
+}
+- initWithAcceptedDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
+{
+	if (!(self = [super initWithDesc: aDesc withRemoteHost: theAddress]))
+	{
+		return nil;
+	}
+	if (![self startHandshakeAsServer: YES])
+	{
+		connected = NO;
+		[self release];
+		return nil;
+	}
+	return self;
+}
+- initWithDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
+{
+	if (!(self = [super initWithDesc: aDesc withRemoteHost: theAddress]))
+	{
+		return nil;
+	}
+	if (![self startHandshakeAsServer: NO])
+	{
+		connected = NO;
+		[self release];
+		return nil;
+	}
+	return self;
+}
+- (void)dealloc
+{
+	[self close];
+	RELEASE(sessionKey);
+	[super dealloc];
+}
+- (NSData *)readData: (int)maxDataSize
+{
+	NSMutableData *data;
+	char *bytes;
+	int capacity;
+	int total = 0;
+	int result;
+	int blocks = 1;
+
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	eventsDispatched++;
+
+	if (handshaking && ![self continueHandshake])
+	{
+		return [NSData data];
+	}
+	if (writeWantsRead)
+	{
+		writeWantsRead = NO;
+		[[NetApplication sharedInstance] transportNeedsToWrite: self];
+	}
+
+	capacity = (maxDataSize > 0 && maxDataSize < TLS_READ_BLOCK_SIZE) ?
+	  maxDataSize : TLS_READ_BLOCK_SIZE;
+	data = [NSMutableData dataWithLength: capacity];
+	bytes = [data mutableBytes];
+
+	while (1)
+	{
+		if (total == capacity)
+		{
+			/* Whatever is left of the current record must be read now,
+			 * the socket may not become readable again for it.
+			 */
+			if ((maxDataSize > 0 && total >= maxDataSize) ||
+			  (blocks >= TLS_READ_BLOCKS && SSL_pending(ssl) == 0))
+			{
+				break;
+			}
+			capacity += TLS_READ_BLOCK_SIZE;
+			blocks++;
+			[data setLength: capacity];
+			bytes = [data mutableBytes];
+		}
+
+		result = SSL_read(ssl, bytes + total, capacity - total);
+		readCalls++;
+		NetTransportTotals.readCalls++;
+		if (result > 0)
+		{
+			if (NetActiveCapture)
+			{
+				NetCaptureRecord(NetActiveCapture, captureConnection,
+				  NetCaptureInbound, bytes + total, result);
+			}
+			total += result;
+			bytesRead += result;
+			NetTransportTotals.bytesRead += result;
+			continue;
+		}
+
+		switch (SSL_get_error(ssl, result))
+		{
+			case SSL_ERROR_WANT_READ:
+				break;
+			case SSL_ERROR_WANT_WRITE:
+				[[NetApplication sharedInstance] transportNeedsToWrite: self];
+				break;
+			case SSL_ERROR_ZERO_RETURN:
+				[data setLength: total];
+				[[NSException exceptionWithName: NetException
+				  reason: @"Socket closed" userInfo:
+				  [NSDictionary dictionaryWithObjectsAndKeys:
+				    data, @"Data", nil]] raise];
+			case SSL_ERROR_SYSCALL:
+				if (result < 0 && errno == EAGAIN)
+				{
+					break;
+				}
+			default:
+				[data setLength: total];
+				[[NSException exceptionWithName: NetException
+				  reason: (result == 0) ? @"Socket closed" : tls_error_string()
+				  userInfo: [NSDictionary dictionaryWithObjectsAndKeys:
+				    data, @"Data", nil]] raise];
+		}
+		break;
+	}
+
+	[data setLength: total];
+	return data;
+}
+#undef TLS_READ_BLOCK_SIZE
+#undef TLS_READ_BLOCKS
+- (BOOL)isDoneWriting
+{
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	if (handshaking)
+	{
+		return !handshakeWantsWrite;
+	}
+	if (writeWantsRead)
+	{
+		return YES;
+	}
+	return ([writeBuffer length]) ? NO : YES;
+}
+- writeData: (NSData *)aData
+{
+	char *bytes;
+	int length;
+	int result;
+
+	if (aData)
+	{
+		return [super writeData: aData];
+	}
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	eventsDispatched++;
+
+	if (handshaking && ![self continueHandshake])
+	{
+		return self;
+	}
+
+	while ([writeBuffer length])
+	{
+		bytes = [writeBuffer mutableBytes];
+		length = [writeBuffer length];
+
+		result = SSL_write(ssl, bytes, length);
+		writeCalls++;
+		NetTransportTotals.writeCalls++;
+		if (result <= 0)
+		{
+			switch (SSL_get_error(ssl, result))
+			{
+				case SSL_ERROR_WANT_WRITE:
+					return self;
+				case SSL_ERROR_WANT_READ:
+					writeWantsRead = YES;
+					return self;
+				default:
+					[NSException raise: FatalNetException
+					  format: @"%@", tls_error_string()];
+			}
+		}
+		bytesWritten += result;
+		NetTransportTotals.bytesWritten += result;
+		if (NetActiveCapture)
+		{
+			NetCaptureRecord(NetActiveCapture, captureConnection,
+			  NetCaptureOutbound, bytes, result);
+		}
+
+		length -= result;
+		memmove(bytes, bytes + result, length);
+		[writeBuffer setLength: length];
+	}
+
+	return self;
+}
+- (void)close
+{
+	if (ssl)
+	{
+		if (connected && !handshaking)
+		{
+			SSL_shutdown(ssl);
+		}
+		SSL_free(ssl);
+		ssl = 0;
+	}
+	[super close];
+}
+- (BOOL)isHandshakeComplete
+{
+	return ssl && !handshaking;
+}
+- (BOOL)isSessionReused
+{
+	return [self isHandshakeComplete] && SSL_session_reused(ssl);
+}
+- (NSString *)cipherName
+{
+	if (![self isHandshakeComplete])
+	{
+		return nil;
+	}
+	return [NSString stringWithCString: SSL_get_cipher_name(ssl)];
+}
+- (NSString *)protocolVersion
+{
+	if (![self isHandshakeComplete])
+	{
+		return nil;
+	}
+	return [NSString stringWithCString: SSL_get_version(ssl)];
+}
+- (NSDictionary *)statistics
+{
+	NSMutableDictionary *dict;
+
+	dict = [NSMutableDictionary dictionaryWithDictionary:
+	  [super statistics]];
+	if ([self isHandshakeComplete])
+	{
+		[dict setObject: [self cipherName] forKey: @"Cipher"];
+		[dict setObject: [self protocolVersion] forKey: @"Protocol"];
+		[dict setObject: [NSNumber numberWithBool: [self isSessionReused]]
+		  forKey: @"SessionReused"];
+		[dict setObject: [NSNumber numberWithDouble:
+		  handshakeTime / 1000000.0] forKey: @"HandshakeTime"];
+	}
+	return dict;
+}
+@end
+
+#else /* HAVE_OPENSSL */
+
+@implementation TLSTransport
++ (BOOL)setCertificateFile: (NSString *)aCertFile
+   privateKeyFile: (NSString *)aKeyFile
+{
+	[[TCPSystem sharedInstance] setErrorString: NetclassesErrorNoTLS
+	  withErrno: 0];
+	return NO;
+}
++ (BOOL)setCAFile: (NSString *)aFile verifyPeer: (BOOL)verify
+{
+	[[TCPSystem sharedInstance] setErrorString: NetclassesErrorNoTLS
+	  withErrno: 0];
+	return NO;
+}
++ (void)flushSessionCache
+{
+}
++ (unsigned)sessionCacheCount
+{
+	return 0;
+}
+- initWithAcceptedDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
+{
+	return [self initWithDesc: aDesc withRemoteHost: theAddress];
+}
+- initWithDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
+{
+	[[TCPSystem sharedInstance] setErrorString: NetclassesErrorNoTLS
+	  withErrno: 0];
+	[self release];
+	return nil;
+}
+- (BOOL)isHandshakeComplete
+{
+	return NO;
+}
+- (BOOL)isSessionReused
+{
+	return NO;
+}
+- (NSString *)cipherName
+{
+	return nil;
+}
+- (NSString *)protocolVersion
+{
+	return nil;
+}
+@end
+
+#endif /* HAVE_OPENSSL */
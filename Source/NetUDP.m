@@ -0,0 +1,671 @@
+/***************************************************************************
+                                NetUDP.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetUDP reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+/* recvmmsg() and sendmmsg() are GNU extensions */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#import "NetUDP.h"
+#import "NetTCP.h"
+#import <Foundation/NSString.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSHost.h>
+#import <Foundation/NSValue.h>
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+
+#ifndef HAVE_SOCKLEN_T
+typedef int socklen_t;
+#endif
+
+/* The most batches -receiveDatagramsFor: reads before returning to the
+ * run loop. */
+#define UDP_RECEIVE_BATCHES 4
+
+/* A set of receive buffers, one per datagram of a batch.  Batches are kept
+ * on a free list and reused, so receiving does not allocate once the first
+ * one exists. */
+typedef struct udp_batch
+{
+	struct udp_batch *next;
+	struct sockaddr_in from[NET_UDP_BATCH];
+	struct iovec iov[NET_UDP_BATCH];
+#ifdef HAVE_RECVMMSG
+	struct mmsghdr msgs[NET_UDP_BATCH];
+#endif
+	char buffers[NET_UDP_BATCH][NET_UDP_MAX_DATAGRAM];
+} udp_batch;
+
+/* A datagram waiting to be sent. */
+typedef struct udp_datagram
+{
+	struct sockaddr_in to;
+	NSData *data;
+} udp_datagram;
+
+static udp_batch *free_batches = NULL;
+static UDPSystem *default_udp_system = nil;
+static NetApplication *net_app = nil;
+
+static udp_batch *get_batch(void)
+{
+	udp_batch *batch;
+
+	if (free_batches)
+	{
+		batch = free_batches;
+		free_batches = batch->next;
+		return batch;
+	}
+
+	batch = malloc(sizeof(udp_batch));
+	if (!batch)
+	{
+		[NSException raise: NSMallocException
+		  format: @"%s", strerror(errno)];
+	}
+	return batch;
+}
+
+static void put_batch(udp_batch *batch)
+{
+	batch->next = free_batches;
+	free_batches = batch;
+}
+
+/* Receives up to NET_UDP_BATCH datagrams into batch, storing their lengths
+ * in lengths.  Returns the number received, 0 if none were waiting, or -1
+ * on error. */
+static int receive_batch(int desc, udp_batch *batch, unsigned *lengths)
+{
+	int x;
+	int count;
+#ifdef HAVE_RECVMMSG
+	for (x = 0; x < NET_UDP_BATCH; x++)
+	{
+		batch->iov[x].iov_base = batch->buffers[x];
+		batch->iov[x].iov_len = NET_UDP_MAX_DATAGRAM;
+		memset(&batch->msgs[x].msg_hdr, 0, sizeof(struct msghdr));
+		batch->msgs[x].msg_hdr.msg_name = &batch->from[x];
+		batch->msgs[x].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		batch->msgs[x].msg_hdr.msg_iov = &batch->iov[x];
+		batch->msgs[x].msg_hdr.msg_iovlen = 1;
+	}
+
+	count = recvmmsg(desc, batch->msgs, NET_UDP_BATCH, MSG_DONTWAIT, NULL);
+	if (count == -1)
+	{
+		return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+	}
+	for (x = 0; x < count; x++)
+	{
+		lengths[x] = batch->msgs[x].msg_len;
+	}
+#else
+	ssize_t length;
+	socklen_t fromLength;
+
+	for (count = 0; count < NET_UDP_BATCH; count++)
+	{
+		fromLength = sizeof(struct sockaddr_in);
+		length = recvfrom(desc, batch->buffers[count], NET_UDP_MAX_DATAGRAM,
+		  MSG_DONTWAIT, (struct sockaddr *)&batch->from[count], &fromLength);
+		if (length == -1)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+			return (count) ? count : -1;
+		}
+		lengths[count] = length;
+	}
+	x = 0;
+#endif
+	return count;
+}
+
+@interface UDPSystem (InternalUDPSystem)
+- (int)openSocketOnHost: (NSHost *)aHost onPort: (uint16_t)aPort;
+- setErrorString: (NSString *)anError withErrno: (int)aErrno;
+@end
+
+@interface UDPTransport (InternalUDPTransport)
+- setPeerAddress: (const struct sockaddr_in *)anAddress;
+- (int)sendQueued;
+- removeQueued: (unsigned)count;
+@end
+
+@implementation UDPSystem (InternalUDPSystem)
+- (int)openSocketOnHost: (NSHost *)aHost onPort: (uint16_t)aPort
+{
+	struct sockaddr_in sin;
+	int myDesc;
+
+	if (aHost)
+	{
+		if (![self getAddress: &sin forHost: aHost onPort: aPort])
+		{
+			return -1;
+		}
+	}
+	else
+	{
+		memset(&sin, 0, sizeof(sin));
+		sin.sin_family = AF_INET;
+		sin.sin_addr.s_addr = htonl(INADDR_ANY);
+		sin.sin_port = htons(aPort);
+	}
+
+	if ((myDesc = socket(AF_INET, SOCK_DGRAM, 0)) == -1)
+	{
+		[self setErrorString: [NSString stringWithFormat: @"%s",
+		  strerror(errno)] withErrno: errno];
+		return -1;
+	}
+	if (bind(myDesc, (struct sockaddr *)&sin, sizeof(sin)) == -1)
+	{
+		[self setErrorString: [NSString stringWithFormat: @"%s",
+		  strerror(errno)] withErrno: errno];
+		close(myDesc);
+		return -1;
+	}
+
+	return myDesc;
+}
+- setErrorString: (NSString *)anError withErrno: (int)aErrno
+{
+	errorNumber = aErrno;
+
+	if (anError == errorString) return self;
+
+	RELEASE(errorString);
+	errorString = RETAIN(anError);
+
+	return self;
+}
+@end
+
+@implementation UDPSystem
++ sharedInstance
+{
+	return (default_udp_system) ? default_udp_system : [[self alloc] init];
+}
+- init
+{
+	if (!(self = [super init])) return nil;
+
+	if (default_udp_system)
+	{
+		[self release];
+		return nil;
+	}
+	default_udp_system = RETAIN(self);
+
+	return self;
+}
+- (NSString *)errorString
+{
+	return errorString;
+}
+- (int)errorNumber
+{
+	return errorNumber;
+}
+- (id <NetDatagramObject>)bindNetObject: (id <NetDatagramObject>)netObject
+    onHost: (NSHost *)aHost onPort: (uint16_t)aPort
+{
+	int desc;
+	id transport;
+
+	if ((desc = [self openSocketOnHost: aHost onPort: aPort]) < 0)
+	{
+		return nil;
+	}
+
+	transport = AUTORELEASE([[UDPTransport alloc] initWithDesc: desc]);
+	if (!transport)
+	{
+		close(desc);
+		return nil;
+	}
+
+	[netObject connectionEstablished: transport];
+
+	return netObject;
+}
+- (id <NetDatagramObject>)connectNetObject: (id <NetDatagramObject>)netObject
+    toHost: (NSHost *)aHost onPort: (uint16_t)aPort
+{
+	struct sockaddr_in sin;
+	int desc;
+	id transport;
+
+	if (![self getAddress: &sin forHost: aHost onPort: aPort])
+	{
+		return nil;
+	}
+	if ((desc = [self openSocketOnHost: nil onPort: 0]) < 0)
+	{
+		return nil;
+	}
+	if (connect(desc, (struct sockaddr *)&sin, sizeof(sin)) == -1)
+	{
+		[self setErrorString: [NSString stringWithFormat: @"%s",
+		  strerror(errno)] withErrno: errno];
+		close(desc);
+		return nil;
+	}
+
+	transport = AUTORELEASE([[UDPTransport alloc] initWithDesc: desc]);
+	if (!transport)
+	{
+		close(desc);
+		return nil;
+	}
+	[transport setPeerAddress: &sin];
+
+	[netObject connectionEstablished: transport];
+
+	return netObject;
+}
+- (BOOL)getAddress: (struct sockaddr_in *)anAddress
+    forHost: (NSHost *)aHost onPort: (uint16_t)aPort
+{
+	memset(anAddress, 0, sizeof(struct sockaddr_in));
+
+	if (!aHost || inet_aton([[aHost address] cString],
+	    &anAddress->sin_addr) == 0)
+	{
+		[self setErrorString: NetclassesErrorBadAddress withErrno: 0];
+		return NO;
+	}
+	anAddress->sin_family = AF_INET;
+	anAddress->sin_port = htons(aPort);
+
+	return YES;
+}
+- (void)dealloc
+{
+	RELEASE(errorString);
+	[super dealloc];
+}
+@end
+
+@implementation UDPTransport (InternalUDPTransport)
+- setPeerAddress: (const struct sockaddr_in *)anAddress
+{
+	peerAddress = *anAddress;
+	hasPeer = YES;
+	return self;
+}
+- (int)sendQueued
+{
+	udp_datagram *datagrams = queue;
+	int count;
+	int x;
+#ifdef HAVE_SENDMMSG
+	struct mmsghdr msgs[NET_UDP_BATCH];
+	struct iovec iov[NET_UDP_BATCH];
+
+	count = (queueLength < NET_UDP_BATCH) ? queueLength : NET_UDP_BATCH;
+	memset(msgs, 0, sizeof(struct mmsghdr) * count);
+	for (x = 0; x < count; x++)
+	{
+		iov[x].iov_base = (void *)[datagrams[x].data bytes];
+		iov[x].iov_len = [datagrams[x].data length];
+		msgs[x].msg_hdr.msg_iov = &iov[x];
+		msgs[x].msg_hdr.msg_iovlen = 1;
+		msgs[x].msg_hdr.msg_name = &datagrams[x].to;
+		msgs[x].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+	}
+
+	count = sendmmsg(desc, msgs, count, MSG_DONTWAIT);
+	sendCalls++;
+	if (count == -1)
+	{
+		return -1;
+	}
+	for (x = 0; x < count; x++)
+	{
+		bytesSent += msgs[x].msg_len;
+	}
+#else
+	ssize_t sent;
+
+	for (count = 0; count < (int)queueLength && count < NET_UDP_BATCH;
+	  count++)
+	{
+		sent = sendto(desc, [datagrams[count].data bytes],
+		  [datagrams[count].data length], MSG_DONTWAIT,
+		  (struct sockaddr *)&datagrams[count].to,
+		  sizeof(struct sockaddr_in));
+		sendCalls++;
+		if (sent == -1)
+		{
+			if (count == 0)
+			{
+				return -1;
+			}
+			break;
+		}
+		bytesSent += sent;
+	}
+	x = 0;
+#endif
+	datagramsSent += count;
+	[self removeQueued: count];
+
+	return count;
+}
+- removeQueued: (unsigned)count
+{
+	udp_datagram *datagrams = queue;
+	unsigned x;
+
+	for (x = 0; x < count; x++)
+	{
+		RELEASE(datagrams[x].data);
+	}
+	queueLength -= count;
+	memmove(datagrams, datagrams + count,
+	  queueLength * sizeof(udp_datagram));
+
+	return self;
+}
+@end
+
+@implementation UDPTransport
++ (void)initialize
+{
+	net_app = RETAIN([NetApplication sharedInstance]);
+}
+- initWithDesc: (int)aDesc
+{
+	socklen_t length = sizeof(localAddress);
+	int flags;
+
+	if (!(self = [super init])) return nil;
+
+	desc = aDesc;
+
+	if (getsockname(desc, (struct sockaddr *)&localAddress, &length) != 0 ||
+	  (flags = fcntl(desc, F_GETFL)) == -1 ||
+	  fcntl(desc, F_SETFL, flags | O_NONBLOCK) == -1)
+	{
+		[[UDPSystem sharedInstance]
+		  setErrorString: [NSString stringWithFormat: @"%s",
+		  strerror(errno)] withErrno: errno];
+		[self release];
+		return nil;
+	}
+
+	connected = YES;
+
+	return self;
+}
+- (void)dealloc
+{
+	[self close];
+	[self removeQueued: queueLength];
+	free(queue);
+	[super dealloc];
+}
+- sendData: (NSData *)aData to: (const struct sockaddr_in *)anAddress
+{
+	udp_datagram *datagrams;
+
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	if (queueLength == queueCapacity)
+	{
+		queueCapacity = (queueCapacity) ? queueCapacity * 2 : NET_UDP_BATCH;
+		datagrams = realloc(queue, queueCapacity * sizeof(udp_datagram));
+		if (!datagrams)
+		{
+			[NSException raise: NSMallocException
+			  format: @"%s", strerror(errno)];
+		}
+		queue = datagrams;
+	}
+	if (queueLength == 0)
+	{
+		[net_app transportNeedsToWrite: self];
+	}
+
+	datagrams = queue;
+	datagrams[queueLength].to = *anAddress;
+	datagrams[queueLength].data = RETAIN(aData);
+	queueLength++;
+
+	return self;
+}
+- writeData: (NSData *)aData
+{
+	if (aData)
+	{
+		if (!hasPeer)
+		{
+			[NSException raise: NetException
+			  format: @"No default destination"];
+		}
+		return [self sendData: aData to: &peerAddress];
+	}
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+
+	while (queueLength)
+	{
+		if ([self sendQueued] == -1)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK ||
+			  errno == ENOBUFS)
+			{
+				break;
+			}
+			/* The first datagram can never be sent (too long, refused
+			 * by the peer, ...), drop it and go on with the rest. */
+			sendErrors++;
+			[self removeQueued: 1];
+		}
+	}
+
+	return self;
+}
+- (BOOL)isDoneWriting
+{
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	return (queueLength) ? NO : YES;
+}
+- (NSData *)readData: (int)maxDataSize
+{
+	udp_batch *batch;
+	struct sockaddr_in from;
+	socklen_t fromLength = sizeof(from);
+	ssize_t length;
+	NSData *data;
+
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+
+	batch = get_batch();
+	length = recvfrom(desc, batch->buffers[0], NET_UDP_MAX_DATAGRAM,
+	  MSG_DONTWAIT, (struct sockaddr *)&from, &fromLength);
+	receiveCalls++;
+	if (length == -1)
+	{
+		put_batch(batch);
+		if (errno == EAGAIN || errno == EWOULDBLOCK ||
+		  errno == ECONNREFUSED)
+		{
+			return [NSData data];
+		}
+		[NSException raise: NetException
+		  format: @"%s", strerror(errno)];
+	}
+	if (maxDataSize > 0 && length > maxDataSize)
+	{
+		length = maxDataSize;
+	}
+	data = [NSData dataWithBytes: batch->buffers[0] length: length];
+	put_batch(batch);
+
+	datagramsReceived++;
+	bytesReceived += length;
+
+	return data;
+}
+- (int)receiveDatagramsFor: (id <NetDatagramObject>)anObject
+{
+	unsigned lengths[NET_UDP_BATCH];
+	udp_batch *batch;
+	volatile int total = 0;
+	int count;
+	int loops;
+	int x;
+
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+
+	batch = get_batch();
+	NS_DURING
+		for (loops = 0; loops < UDP_RECEIVE_BATCHES; loops++)
+		{
+			count = receive_batch(desc, batch, lengths);
+			receiveCalls++;
+			if (count == -1)
+			{
+				/* An ICMP error from an earlier send is reported here on a
+				 * connected socket; it says nothing about this socket. */
+				if (errno == ECONNREFUSED)
+				{
+					continue;
+				}
+				[NSException raise: NetException
+				  format: @"%s", strerror(errno)];
+			}
+			for (x = 0; x < count; x++)
+			{
+				datagramsReceived++;
+				bytesReceived += lengths[x];
+				[anObject datagramReceived: batch->buffers[x]
+				  length: lengths[x] from: &batch->from[x]];
+			}
+			total += count;
+			if (count < NET_UDP_BATCH || !connected)
+			{
+				break;
+			}
+		}
+	NS_HANDLER
+		put_batch(batch);
+		[localException raise];
+	NS_ENDHANDLER
+	put_batch(batch);
+
+	return total;
+}
+- (uint16_t)port
+{
+	return ntohs(localAddress.sin_port);
+}
+- (const struct sockaddr_in *)localAddress
+{
+	return &localAddress;
+}
+- (id)localHost
+{
+	return [[TCPSystem sharedInstance]
+	  hostFromNetworkOrderInteger: localAddress.sin_addr.s_addr];
+}
+- (id)remoteHost
+{
+	if (!hasPeer)
+	{
+		return nil;
+	}
+	return [[TCPSystem sharedInstance]
+	  hostFromNetworkOrderInteger: peerAddress.sin_addr.s_addr];
+}
+- (int)desc
+{
+	return desc;
+}
+- (void)close
+{
+	if (!connected)
+		return;
+	connected = NO;
+	close(desc);
+}
+- (NSDictionary *)statistics
+{
+	return [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: datagramsReceived],
+	    @"DatagramsReceived",
+	  [NSNumber numberWithUnsignedLongLong: datagramsSent],
+	    @"DatagramsSent",
+	  [NSNumber numberWithUnsignedLongLong: bytesReceived], @"BytesReceived",
+	  [NSNumber numberWithUnsignedLongLong: bytesSent], @"BytesSent",
+	  [NSNumber numberWithUnsignedLongLong: receiveCalls], @"ReceiveCalls",
+	  [NSNumber numberWithUnsignedLongLong: sendCalls], @"SendCalls",
+	  [NSNumber numberWithUnsignedLongLong: sendErrors], @"SendErrors",
+	  [NSNumber numberWithUnsignedInt: queueLength], @"QueueLength",
+	  nil];
+}
+@end
@@ -0,0 +1,642 @@
+/***************************************************************************
+                                NetUnix.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetUnix reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#import "NetUnix.h"
+#import "NetCapture.h"
+#import "NetMetrics.h"
+#import <Foundation/NSString.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSValue.h>
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#ifndef HAVE_SOCKLEN_T
+typedef int socklen_t;
+#endif
+
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif
+
+/* The most descriptors accepted with a single read. */
+#define UNIX_MAX_DESCRIPTORS 16
+
+/* A descriptor waiting to be sent along with the byte at offset in the
+ * stream of data written. */
+typedef struct unix_pending
+{
+	int desc;
+	unsigned long long offset;
+} unix_pending;
+
+static BOOL make_address(struct sockaddr_un *address, NSString *aPath)
+{
+	const char *cPath = [aPath fileSystemRepresentation];
+
+	memset(address, 0, sizeof(struct sockaddr_un));
+	if (strlen(cPath) >= sizeof(address->sun_path))
+	{
+		errno = ENAMETOOLONG;
+		return NO;
+	}
+	address->sun_family = AF_UNIX;
+	strcpy(address->sun_path, cPath);
+
+	return YES;
+}
+
+@interface TCPSystem (UnixTCPSystem)
+- setErrorString: (NSString *)anError withErrno: (int)aErrno;
+@end
+
+@interface UnixTransport (InternalUnixTransport)
+- addReceivedDescriptors: (struct msghdr *)aMessage;
+- removePendingDescriptor;
+@end
+
+@implementation TCPSystem (UnixSystem)
+- (id <NetObject>)connectNetObject: (id <NetObject>)netObject
+    toPath: (NSString *)aPath
+{
+	struct sockaddr_un address;
+	int desc;
+	id transport;
+
+	if (!make_address(&address, aPath) ||
+	  (desc = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+	{
+		[self setErrorString: [NSString stringWithFormat: @"%s",
+		  strerror(errno)] withErrno: errno];
+		return nil;
+	}
+	if (connect(desc, (struct sockaddr *)&address, sizeof(address)) == -1)
+	{
+		[self setErrorString: [NSString stringWithFormat: @"%s",
+		  strerror(errno)] withErrno: errno];
+		close(desc);
+		return nil;
+	}
+
+	transport = AUTORELEASE([[UnixTransport alloc] initWithDesc: desc
+	  withPath: aPath]);
+	if (!transport)
+	{
+		close(desc);
+		return nil;
+	}
+
+	[netObject connectionEstablished: transport];
+
+	return netObject;
+}
+@end
+
+@implementation UnixPort
+- initWithPath: (NSString *)aPath
+{
+	struct sockaddr_un address;
+	struct stat info;
+
+	if (!(self = [super init])) return nil;
+
+	if (!make_address(&address, aPath) ||
+	  (desc = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+	{
+		[[TCPSystem sharedInstance] setErrorString: [NSString
+		  stringWithFormat: @"%s", strerror(errno)] withErrno: errno];
+		[self release];
+		return nil;
+	}
+
+	if (lstat(address.sun_path, &info) == 0 && S_ISSOCK(info.st_mode))
+	{
+		unlink(address.sun_path);
+	}
+	if (bind(desc, (struct sockaddr *)&address, sizeof(address)) == -1 ||
+	  listen(desc, SOMAXCONN) == -1)
+	{
+		[[TCPSystem sharedInstance] setErrorString: [NSString
+		  stringWithFormat: @"%s", strerror(errno)] withErrno: errno];
+		close(desc);
+		[self release];
+		return nil;
+	}
+
+	path = RETAIN(aPath);
+	connected = YES;
+	transportClass = [UnixTransport class];
+
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- (NSString *)path
+{
+	return path;
+}
+- setNetObject: (Class)aClass
+{
+	if (![aClass conformsToProtocol: @protocol(NetObject)])
+	{
+		[NSException raise: FatalNetException
+		  format: @"%@ does not conform to < NetObject >",
+		    NSStringFromClass(aClass)];
+	}
+
+	netObjectClass = aClass;
+	return self;
+}
+- setTransportClass: (Class)aClass
+{
+	if (aClass != [UnixTransport class] &&
+	  ![aClass isSubclassOfClass: [UnixTransport class]])
+	{
+		[NSException raise: FatalNetException
+		  format: @"%@ is not a subclass of UnixTransport",
+		    NSStringFromClass(aClass)];
+	}
+
+	transportClass = aClass;
+	return self;
+}
+- (Class)transportClass
+{
+	return transportClass;
+}
+- (int)desc
+{
+	return desc;
+}
+- (void)close
+{
+	if (!connected)
+		return;
+	close(desc);
+	unlink([path fileSystemRepresentation]);
+	connected = NO;
+}
+- (void)connectionLost
+{
+}
+- newConnection
+{
+	int newDesc;
+	UnixTransport *transport;
+
+	if ((newDesc = accept(desc, NULL, NULL)) == -1)
+	{
+		[NSException raise: FatalNetException
+		  format: @"%s", strerror(errno)];
+	}
+	[[NetApplication sharedInstance] connectionAccepted];
+
+	transport = AUTORELEASE([[transportClass alloc] initWithDesc: newDesc
+	  withPath: path]);
+	if (!transport)
+	{
+		close(newDesc);
+		return self;
+	}
+
+	[AUTORELEASE([netObjectClass new]) connectionEstablished: transport];
+
+	return self;
+}
+- (void)dealloc
+{
+	[self close];
+	RELEASE(path);
+	[super dealloc];
+}
+@end
+
+@implementation UnixTransport (InternalUnixTransport)
+- addReceivedDescriptors: (struct msghdr *)aMessage
+{
+	struct cmsghdr *control;
+	int *descs;
+	int count;
+	int x;
+
+	for (control = CMSG_FIRSTHDR(aMessage); control;
+	  control = CMSG_NXTHDR(aMessage, control))
+	{
+		if (control->cmsg_level != SOL_SOCKET ||
+		  control->cmsg_type != SCM_RIGHTS)
+		{
+			continue;
+		}
+		descs = (int *)CMSG_DATA(control);
+		count = (control->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+		if (receivedCount + count > receivedCapacity)
+		{
+			int *temp;
+
+			receivedCapacity = receivedCount + count + 8;
+			temp = realloc(receivedDescriptors,
+			  receivedCapacity * sizeof(int));
+			if (!temp)
+			{
+				for (x = 0; x < count; x++)
+				{
+					close(descs[x]);
+				}
+				[NSException raise: NSMallocException
+				  format: @"%s", strerror(errno)];
+			}
+			receivedDescriptors = temp;
+		}
+		for (x = 0; x < count; x++)
+		{
+			receivedDescriptors[receivedCount++] = descs[x];
+		}
+		descriptorsReceived += count;
+	}
+
+	return self;
+}
+- removePendingDescriptor
+{
+	unix_pending *pending = pendingDescriptors;
+
+	close(pending[0].desc);
+	pendingCount--;
+	memmove(pending, pending + 1, pendingCount * sizeof(unix_pending));
+
+	return self;
+}
+@end
+
+@implementation UnixTransport
+- initWithDesc: (int)aDesc withPath: (NSString *)aPath
+{
+	if (!(self = [super initWithDesc: aDesc withRemoteHost: nil]))
+		return nil;
+
+	path = RETAIN(aPath);
+
+	return self;
+}
+- initWithDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress
+{
+	return [self initWithDesc: aDesc withPath: nil];
+}
+- (void)dealloc
+{
+	while (pendingCount)
+	{
+		[self removePendingDescriptor];
+	}
+	while (receivedCount)
+	{
+		close(receivedDescriptors[--receivedCount]);
+	}
+	free(pendingDescriptors);
+	free(receivedDescriptors);
+	RELEASE(path);
+	[super dealloc];
+}
+- sendDescriptor: (int)aDesc withData: (NSData *)aData
+{
+	unix_pending *pending;
+	int newDesc;
+
+	if ([aData length] == 0)
+	{
+		[NSException raise: NetException
+		  format: @"A descriptor must be sent with data"];
+	}
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	if (pendingCount == pendingCapacity)
+	{
+		pendingCapacity = (pendingCapacity) ? pendingCapacity * 2 : 8;
+		pending = realloc(pendingDescriptors,
+		  pendingCapacity * sizeof(unix_pending));
+		if (!pending)
+		{
+			[NSException raise: NSMallocException
+			  format: @"%s", strerror(errno)];
+		}
+		pendingDescriptors = pending;
+	}
+	if ((newDesc = fcntl(aDesc, F_DUPFD_CLOEXEC, 0)) == -1)
+	{
+		[NSException raise: NetException
+		  format: @"%s", strerror(errno)];
+	}
+
+	pending = pendingDescriptors;
+	pending[pendingCount].desc = newDesc;
+	pending[pendingCount].offset = bytesWritten + [writeBuffer length];
+	pendingCount++;
+
+	return [self writeData: aData];
+}
+- (int)takeReceivedDescriptor
+{
+	int aDesc;
+
+	if (receivedCount == 0)
+	{
+		return -1;
+	}
+	aDesc = receivedDescriptors[0];
+	receivedCount--;
+	memmove(receivedDescriptors, receivedDescriptors + 1,
+	  receivedCount * sizeof(int));
+
+	return aDesc;
+}
+- (unsigned)receivedDescriptorCount
+{
+	return receivedCount;
+}
+- (unsigned)pendingDescriptorCount
+{
+	return pendingCount;
+}
+- (NSString *)path
+{
+	return path;
+}
+- (id)localHost
+{
+	return path;
+}
+- (id)remoteHost
+{
+	return path;
+}
+#define READ_BLOCK_SIZE 65530
+- (NSData *)readData: (int)maxDataSize
+{
+	union
+	{
+		struct cmsghdr align;
+		char buffer[CMSG_SPACE(sizeof(int) * UNIX_MAX_DESCRIPTORS)];
+	} control;
+	struct msghdr message;
+	struct iovec iov;
+	char *buffer;
+	ssize_t readReturn;
+	NSMutableData *data;
+	int remaining;
+	int bufsize;
+	int toRead;
+	int flags = MSG_CMSG_CLOEXEC;
+	int loops = 8;
+
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+
+	if (maxDataSize <= 0)
+	{
+		remaining = -1;
+		bufsize = READ_BLOCK_SIZE;
+	}
+	else
+	{
+		remaining = maxDataSize;
+		bufsize = (READ_BLOCK_SIZE < remaining ? READ_BLOCK_SIZE : remaining);
+	}
+
+	buffer = malloc(bufsize);
+	if (!buffer)
+	{
+		[NSException raise: NSMallocException
+		  format: @"%s", strerror(errno)];
+	}
+	data = [NSMutableData dataWithCapacity: bufsize];
+	eventsDispatched++;
+
+	do
+	{
+		if (remaining == -1)
+		{
+			toRead = bufsize;
+		}
+		else
+		{
+			toRead = bufsize < remaining ? bufsize : remaining;
+		}
+
+		iov.iov_base = buffer;
+		iov.iov_len = toRead;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = &iov;
+		message.msg_iovlen = 1;
+		message.msg_control = control.buffer;
+		message.msg_controllen = sizeof(control.buffer);
+
+		readReturn = recvmsg(desc, &message, flags);
+		readCalls++;
+		NetTransportTotals.readCalls++;
+
+		if (readReturn == -1 && (flags & MSG_DONTWAIT) &&
+		  (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			break;
+		}
+		if (readReturn <= 0)
+		{
+			id except;
+			free(buffer);
+			except = [NSException exceptionWithName: NetException
+			  reason: (readReturn == 0) ? @"Socket closed" :
+			    [NSString stringWithCString: strerror(errno)]
+			  userInfo: [NSDictionary dictionaryWithObjectsAndKeys:
+			    data, @"Data", nil]];
+
+			[except raise];
+		}
+
+		[self addReceivedDescriptors: &message];
+		[data appendBytes: buffer length: readReturn];
+		bytesRead += readReturn;
+		NetTransportTotals.bytesRead += readReturn;
+		if (NetActiveCapture)
+		{
+			NetCaptureRecord(NetActiveCapture, captureConnection,
+			  NetCaptureInbound, buffer, readReturn);
+		}
+
+		if (readReturn < toRead)
+		{
+			break;
+		}
+
+		if (remaining != -1)
+		{
+			remaining -= readReturn;
+			if (remaining == 0)
+			{
+				break;
+			}
+		}
+
+		flags |= MSG_DONTWAIT;
+		--loops;
+	} while (loops);
+
+	free(buffer);
+
+	return data;
+}
+#undef READ_BLOCK_SIZE
+- writeData: (NSData *)aData
+{
+	unix_pending *pending = pendingDescriptors;
+	union
+	{
+		struct cmsghdr align;
+		char buffer[CMSG_SPACE(sizeof(int))];
+	} control;
+	struct cmsghdr *header;
+	struct msghdr message;
+	struct iovec iov;
+	ssize_t writeReturn;
+	unsigned length;
+	char *bytes;
+	BOOL withDescriptor;
+
+	if (aData || pendingCount == 0)
+	{
+		return [super writeData: aData];
+	}
+	if (!connected)
+	{
+		[NSException raise: FatalNetException
+		  format: @"Not connected"];
+	}
+	eventsDispatched++;
+
+	if ([writeBuffer length] == 0)
+	{
+		return self;
+	}
+
+	/* Write up to the next byte carrying a descriptor, or send that byte
+	 * and its descriptor with the data up to the one after it. */
+	bytes = [writeBuffer mutableBytes];
+	length = [writeBuffer length];
+	withDescriptor = (pending[0].offset == bytesWritten);
+	if (!withDescriptor)
+	{
+		if (pending[0].offset - bytesWritten < length)
+		{
+			length = pending[0].offset - bytesWritten;
+		}
+		writeReturn = write(desc, bytes, length);
+	}
+	else
+	{
+		if (pendingCount > 1 && pending[1].offset - bytesWritten < length)
+		{
+			length = pending[1].offset - bytesWritten;
+		}
+		iov.iov_base = bytes;
+		iov.iov_len = length;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = &iov;
+		message.msg_iovlen = 1;
+		message.msg_control = control.buffer;
+		message.msg_controllen = sizeof(control.buffer);
+		header = CMSG_FIRSTHDR(&message);
+		header->cmsg_level = SOL_SOCKET;
+		header->cmsg_type = SCM_RIGHTS;
+		header->cmsg_len = CMSG_LEN(sizeof(int));
+		memcpy(CMSG_DATA(header), &pending[0].desc, sizeof(int));
+
+		writeReturn = sendmsg(desc, &message, 0);
+	}
+	writeCalls++;
+	NetTransportTotals.writeCalls++;
+
+	if (writeReturn == -1)
+	{
+		[NSException raise: FatalNetException
+		  format: @"%s", strerror(errno)];
+	}
+	if (writeReturn == 0)
+	{
+		return self;
+	}
+	if (withDescriptor)
+	{
+		[self removePendingDescriptor];
+		descriptorsSent++;
+	}
+	bytesWritten += writeReturn;
+	NetTransportTotals.bytesWritten += writeReturn;
+	if (NetActiveCapture)
+	{
+		NetCaptureRecord(NetActiveCapture, captureConnection,
+		  NetCaptureOutbound, bytes, writeReturn);
+	}
+
+	length = [writeBuffer length] - writeReturn;
+	memmove(bytes, bytes + writeReturn, length);
+	[writeBuffer setLength: length];
+
+	return self;
+}
+- (NSDictionary *)statistics
+{
+	NSMutableDictionary *statistics;
+
+	statistics = [NSMutableDictionary dictionaryWithDictionary:
+	  [super statistics]];
+	[statistics setObject: [NSNumber numberWithUnsignedLongLong:
+	  descriptorsSent] forKey: @"DescriptorsSent"];
+	[statistics setObject: [NSNumber numberWithUnsignedLongLong:
+	  descriptorsReceived] forKey: @"DescriptorsReceived"];
+
+	return statistics;
+}
+@end
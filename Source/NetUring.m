@@ -0,0 +1,842 @@
+/***************************************************************************
+                                NetUring.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetUring reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#import "NetUring.h"
+#import "NetFilter.h"
+#import "NetCapture.h"
+#import "NetMetrics.h"
+#import "NetWorkerPool.h"
+#import <Foundation/NSArray.h>
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSRunLoop.h>
+#import <Foundation/NSValue.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#ifdef HAVE_LIBURING
+
+#include <liburing.h>
+#include <sys/eventfd.h>
+
+@interface TCPTransport (UringTransport)
+- (NSData *)uringReceivedBytes: (const char *)bytes length: (unsigned)length;
+- (NSMutableData *)uringSwapWriteBuffer: (NSMutableData *)aBuffer;
+- uringSent: (NSData *)data written: (unsigned)length;
+- (BOOL)uringHasDataToWrite;
+@end
+
+@implementation TCPTransport (UringTransport)
+- (NSData *)uringReceivedBytes: (const char *)bytes length: (unsigned)length
+{
+	eventsDispatched++;
+	readCalls++;
+	NetTransportTotals.readCalls++;
+	bytesRead += length;
+	NetTransportTotals.bytesRead += length;
+	if (NetActiveCapture)
+	{
+		NetCaptureRecord(NetActiveCapture, captureConnection,
+		  NetCaptureInbound, bytes, length);
+	}
+	return [NSData dataWithBytes: bytes length: length];
+}
+/* Hands the write buffer, and ownership of it, to the caller, and takes
+ * ownership of the empty <var>aBuffer</var> in its place. */
+- (NSMutableData *)uringSwapWriteBuffer: (NSMutableData *)aBuffer
+{
+	NSMutableData *buffer = writeBuffer;
+
+	[aBuffer setLength: 0];
+	writeBuffer = aBuffer;
+	writeInFlight = YES;
+	bytesInFlight = [buffer length];
+	return buffer;
+}
+- uringSent: (NSData *)data written: (unsigned)length
+{
+	writeInFlight = NO;
+	bytesInFlight = 0;
+	eventsDispatched++;
+	writeCalls++;
+	NetTransportTotals.writeCalls++;
+	bytesWritten += length;
+	NetTransportTotals.bytesWritten += length;
+	if (NetActiveCapture)
+	{
+		NetCaptureRecord(NetActiveCapture, captureConnection,
+		  NetCaptureOutbound, [data bytes], length);
+	}
+	if (length < [data length])
+	{
+		/* What was not sent goes before anything written since. */
+		[writeBuffer replaceBytesInRange: NSMakeRange(0, 0)
+		  withBytes: (const char *)[data bytes] + length
+		  length: [data length] - length];
+	}
+	return self;
+}
+- (BOOL)uringHasDataToWrite
+{
+	return connected && [writeBuffer length] > 0;
+}
+@end
+
+#define URING_ENTRIES 1024
+#define URING_BUFFER_COUNT 512
+#define URING_BUFFER_SIZE 16384
+#define URING_BUFFER_GROUP 0
+
+/* The operation of a request, kept in the low bits of its user data. */
+enum { OP_ACCEPT = 0, OP_RECEIVE = 1, OP_SEND = 2, OP_CANCEL = 3 };
+#define OP_MASK 3
+
+typedef struct uring_buffers {
+	struct io_uring_buf_ring *ring;
+	char *memory;
+	int mask;
+} uring_buffers;
+
+/* A port or net object using the ring.  Requests in flight point at the
+ * entry, so it is only freed once it is closing and the last of them has
+ * completed. */
+typedef struct uring_entry {
+	struct uring_entry *nextSend;
+	id object;
+	TCPTransport *transport;
+	int desc;
+	unsigned outstanding;
+	BOOL isPort;
+	BOOL armed;
+	BOOL paused;
+	BOOL closing;
+	BOOL queued;
+	NSMutableData *sending;
+	NSMutableData *spare;
+} uring_entry;
+
+static inline BOOL is_net_exception(NSException *anException)
+{
+	return [[anException name] isEqualToString: NetException] ||
+	  [[anException name] isEqualToString: FatalNetException];
+}
+
+static BOOL same_method(Class aClass, Class original, SEL aSelector)
+{
+	return [aClass instanceMethodForSelector: aSelector] ==
+	  [original instanceMethodForSelector: aSelector];
+}
+
+@interface NetUring (InternalNetUring)
+- (struct io_uring_sqe *)nextRequest;
+- (void)scheduleFlush;
+- (void)armEntry: (uring_entry *)entry;
+- (void)cancelEntry: (uring_entry *)entry;
+- (void)releaseEntry: (uring_entry *)entry;
+- (void)accepted: (int)result flags: (unsigned)flags
+   entry: (uring_entry *)entry;
+- (void)received: (int)result flags: (unsigned)flags
+   entry: (uring_entry *)entry;
+- (void)sent: (int)result entry: (uring_entry *)entry;
+- (void)deliverData: (NSData *)data entry: (uring_entry *)entry;
+@end
+
+@implementation NetUring (InternalNetUring)
+- (struct io_uring_sqe *)nextRequest
+{
+	struct io_uring_sqe *sqe;
+
+	if (!(sqe = io_uring_get_sqe(ring)))
+	{
+		io_uring_submit(ring);
+		submits++;
+		if (!(sqe = io_uring_get_sqe(ring)))
+		{
+			[NSException raise: NetException
+			  format: @"[NetUring nextRequest] submission queue full"];
+		}
+	}
+	needsSubmit = YES;
+	return sqe;
+}
+- (void)scheduleFlush
+{
+	if (flushScheduled)
+	{
+		return;
+	}
+	flushScheduled = YES;
+	[[NSRunLoop currentRunLoop] performSelector: @selector(flush)
+	  target: self argument: nil order: 0
+	  modes: [NSArray arrayWithObject: NSDefaultRunLoopMode]];
+}
+- (void)armEntry: (uring_entry *)entry
+{
+	struct io_uring_sqe *sqe = [self nextRequest];
+
+	if (entry->isPort)
+	{
+		io_uring_prep_multishot_accept(sqe, entry->desc, NULL, NULL, 0);
+		io_uring_sqe_set_data64(sqe, (uintptr_t)entry | OP_ACCEPT);
+	}
+	else
+	{
+		io_uring_prep_recv_multishot(sqe, entry->desc, NULL, 0, 0);
+		sqe->flags |= IOSQE_BUFFER_SELECT;
+		sqe->buf_group = URING_BUFFER_GROUP;
+		io_uring_sqe_set_data64(sqe, (uintptr_t)entry | OP_RECEIVE);
+	}
+	entry->armed = YES;
+	entry->outstanding++;
+}
+- (void)cancelEntry: (uring_entry *)entry
+{
+	struct io_uring_sqe *sqe = [self nextRequest];
+
+	io_uring_prep_cancel64(sqe,
+	  (uintptr_t)entry | (entry->isPort ? OP_ACCEPT : OP_RECEIVE), 0);
+	io_uring_sqe_set_data64(sqe, (uintptr_t)entry | OP_CANCEL);
+	entry->outstanding++;
+}
+- (void)releaseEntry: (uring_entry *)entry
+{
+	if (entry->closing && entry->outstanding == 0 && !entry->queued)
+	{
+		RELEASE(entry->sending);
+		RELEASE(entry->spare);
+		free(entry);
+	}
+}
+- (void)accepted: (int)result flags: (unsigned)flags
+   entry: (uring_entry *)entry
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	BOOL final = !(flags & IORING_CQE_F_MORE);
+
+	if (final)
+	{
+		entry->armed = NO;
+	}
+	if (result >= 0)
+	{
+		accepts++;
+		[net connectionAccepted];
+		if (entry->closing)
+		{
+			close(result);
+		}
+		else
+		{
+			NS_DURING
+				[entry->object newConnectionWithDesc: result fromAddress: NULL];
+			NS_HANDLER
+				if (!is_net_exception(localException))
+				{
+					[localException raise];
+				}
+				[net disconnectObject: entry->object];
+			NS_ENDHANDLER
+		}
+	}
+	else if (result != -ECANCELED && !entry->closing)
+	{
+		[net disconnectObject: entry->object];
+	}
+
+	if (!entry->armed && !entry->closing)
+	{
+		[self armEntry: entry];
+	}
+	if (final)
+	{
+		entry->outstanding--;
+	}
+	[self releaseEntry: entry];
+}
+- (void)received: (int)result flags: (unsigned)flags
+   entry: (uring_entry *)entry
+{
+	uring_buffers *pool = buffers;
+	BOOL final = !(flags & IORING_CQE_F_MORE);
+	NSData *data = nil;
+	char *buffer;
+	unsigned bid;
+
+	if (final)
+	{
+		entry->armed = NO;
+	}
+	if (result > 0 && (flags & IORING_CQE_F_BUFFER))
+	{
+		receives++;
+		bid = flags >> IORING_CQE_BUFFER_SHIFT;
+		buffer = pool->memory + (size_t)bid * URING_BUFFER_SIZE;
+		if (!entry->closing)
+		{
+			data = [entry->transport uringReceivedBytes: buffer length: result];
+		}
+		io_uring_buf_ring_add(pool->ring, buffer, URING_BUFFER_SIZE, bid,
+		  pool->mask, 0);
+		io_uring_buf_ring_advance(pool->ring, 1);
+		if (data)
+		{
+			[self deliverData: data entry: entry];
+		}
+	}
+	else if (result == -ENOBUFS)
+	{
+		/* Buffers go back as their completions are handled, so the
+		 * receive can start again right away. */
+		bufferShortages++;
+	}
+	else if (result != -ECANCELED && !entry->closing)
+	{
+		/* Zero is the end of the stream, like a read of zero bytes. */
+		[[NetApplication sharedInstance] disconnectObject: entry->object];
+	}
+
+	if (!entry->armed && !entry->closing && !entry->paused)
+	{
+		[self armEntry: entry];
+	}
+	if (final)
+	{
+		entry->outstanding--;
+	}
+	[self releaseEntry: entry];
+}
+- (void)sent: (int)result entry: (uring_entry *)entry
+{
+	NSMutableData *sending = entry->sending;
+	TCPTransport *transport = entry->transport;
+
+	entry->sending = nil;
+	if (!entry->closing)
+	{
+		if (result >= 0)
+		{
+			sends++;
+			[transport uringSent: sending written: result];
+			if ([transport uringHasDataToWrite])
+			{
+				[self transportNeedsToWrite: transport];
+			}
+			else
+			{
+				[[NetApplication sharedInstance]
+				  transportFinishedWriting: transport];
+			}
+		}
+		else
+		{
+			[[NetApplication sharedInstance] disconnectObject: entry->object];
+		}
+	}
+
+	if (entry->spare)
+	{
+		RELEASE(sending);
+	}
+	else
+	{
+		entry->spare = sending;
+	}
+	entry->outstanding--;
+	[self releaseEntry: entry];
+}
+- (void)deliverData: (NSData *)data entry: (uring_entry *)entry
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	id object = entry->object;
+	TCPTransport *transport = entry->transport;
+
+	AUTORELEASE(RETAIN(object));
+	NS_DURING
+		if ([transport hasFilters])
+		{
+			[transport deliverData: data toObject: object];
+			[transport flushFilters];
+		}
+		else
+		{
+			[net passData: data toObject: object];
+		}
+	NS_HANDLER
+		if (!is_net_exception(localException))
+		{
+			[localException raise];
+		}
+		[net disconnectObject: object];
+	NS_ENDHANDLER
+}
+@end
+
+@implementation NetUring
++ (BOOL)isAvailable
+{
+	static int available = -1;
+	struct io_uring probeRing;
+	struct io_uring_probe *probe;
+
+	if (available >= 0)
+	{
+		return available ? YES : NO;
+	}
+
+	/* Ask the kernel rather than trusting its version, which says nothing
+	 * of seccomp filters, containers or backports.  Multishot receive has
+	 * no opcode of its own; zero copy send came with it in Linux 6.0. */
+	available = 0;
+	if (io_uring_queue_init(2, &probeRing, 0) < 0)
+	{
+		return NO;
+	}
+	probe = io_uring_get_probe_ring(&probeRing);
+	if (probe &&
+	  io_uring_opcode_supported(probe, IORING_OP_ACCEPT) &&
+	  io_uring_opcode_supported(probe, IORING_OP_RECV) &&
+	  io_uring_opcode_supported(probe, IORING_OP_SEND) &&
+	  io_uring_opcode_supported(probe, IORING_OP_ASYNC_CANCEL) &&
+	  io_uring_opcode_supported(probe, IORING_OP_SEND_ZC))
+	{
+		available = 1;
+	}
+	io_uring_free_probe(probe);
+	io_uring_queue_exit(&probeRing);
+
+	return available ? YES : NO;
+}
+- init
+{
+	struct io_uring *newRing;
+	uring_buffers *pool;
+	int result;
+	int x;
+
+	if (!(self = [super init])) return nil;
+
+	eventDesc = -1;
+	if (![NetUring isAvailable])
+	{
+		[self release];
+		return nil;
+	}
+
+	newRing = calloc(1, sizeof(struct io_uring));
+	if (!newRing || io_uring_queue_init(URING_ENTRIES, newRing, 0) < 0)
+	{
+		free(newRing);
+		[self release];
+		return nil;
+	}
+	ring = newRing;
+
+	buffers = pool = calloc(1, sizeof(uring_buffers));
+	if (!pool ||
+	  !(pool->memory = malloc((size_t)URING_BUFFER_COUNT * URING_BUFFER_SIZE)))
+	{
+		[self release];
+		return nil;
+	}
+	pool->ring = io_uring_setup_buf_ring(ring, URING_BUFFER_COUNT,
+	  URING_BUFFER_GROUP, 0, &result);
+	if (!pool->ring)
+	{
+		[self release];
+		return nil;
+	}
+	pool->mask = io_uring_buf_ring_mask(URING_BUFFER_COUNT);
+	for (x = 0; x < URING_BUFFER_COUNT; x++)
+	{
+		io_uring_buf_ring_add(pool->ring,
+		  pool->memory + (size_t)x * URING_BUFFER_SIZE, URING_BUFFER_SIZE, x,
+		  pool->mask, x);
+	}
+	io_uring_buf_ring_advance(pool->ring, URING_BUFFER_COUNT);
+
+	eventDesc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (eventDesc < 0 || io_uring_register_eventfd(ring, eventDesc) < 0)
+	{
+		[self release];
+		return nil;
+	}
+
+	entries = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+	  NSNonOwnedPointerMapValueCallBacks, 64);
+	transportEntries = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+	  NSNonOwnedPointerMapValueCallBacks, 64);
+
+	return self;
+}
+- (void)dealloc
+{
+	uring_buffers *pool = buffers;
+	NSMapEnumerator iter;
+	void *key;
+	uring_entry *entry;
+
+	if (entries)
+	{
+		iter = NSEnumerateMapTable(entries);
+		while (NSNextMapEnumeratorPair(&iter, &key, (void **)&entry))
+		{
+			RELEASE(entry->sending);
+			RELEASE(entry->spare);
+			free(entry);
+		}
+		NSEndMapTableEnumeration(&iter);
+		NSFreeMapTable(entries);
+		NSFreeMapTable(transportEntries);
+	}
+	if (pool)
+	{
+		if (pool->ring)
+		{
+			io_uring_free_buf_ring(ring, pool->ring, URING_BUFFER_COUNT,
+			  URING_BUFFER_GROUP);
+		}
+		free(pool->memory);
+		free(pool);
+	}
+	if (ring)
+	{
+		io_uring_queue_exit(ring);
+		free(ring);
+	}
+	if (eventDesc >= 0)
+	{
+		close(eventDesc);
+	}
+	[super dealloc];
+}
+- (int)desc
+{
+	return eventDesc;
+}
+- (BOOL)canHandleObject: (id)anObject
+{
+	id transport;
+	Class aClass;
+
+	if ([anObject isKindOfClass: [TCPPort class]])
+	{
+		return same_method([anObject class], [TCPPort class],
+		  @selector(newConnection));
+	}
+	if (![anObject conformsToProtocol: @protocol(NetObject)])
+	{
+		return NO;
+	}
+	transport = [anObject transport];
+	if (![transport isKindOfClass: [TCPTransport class]] ||
+	  [transport desc] < 0)
+	{
+		return NO;
+	}
+	aClass = [transport class];
+	return same_method(aClass, [TCPTransport class], @selector(readData:)) &&
+	  same_method(aClass, [TCPTransport class], @selector(writeData:)) &&
+	  same_method(aClass, [TCPTransport class],
+	    @selector(bufferBytes:length:));
+}
+- (BOOL)addObject: (id)anObject
+{
+	uring_entry *entry;
+
+	if (NSMapGet(entries, anObject) || ![self canHandleObject: anObject])
+	{
+		return NO;
+	}
+	if (!(entry = calloc(1, sizeof(uring_entry))))
+	{
+		return NO;
+	}
+
+	entry->object = anObject;
+	entry->isPort = [anObject isKindOfClass: [TCPPort class]];
+	if (entry->isPort)
+	{
+		entry->desc = [anObject desc];
+	}
+	else
+	{
+		entry->transport = (TCPTransport *)[anObject transport];
+		entry->desc = [entry->transport desc];
+		NSMapInsert(transportEntries, entry->transport, entry);
+	}
+	NSMapInsert(entries, anObject, entry);
+
+	[self armEntry: entry];
+	[self scheduleFlush];
+	return YES;
+}
+- removeObject: (id)anObject
+{
+	uring_entry *entry = NSMapGet(entries, anObject);
+
+	if (!entry)
+	{
+		return self;
+	}
+	NSMapRemove(entries, anObject);
+	if (entry->transport)
+	{
+		NSMapRemove(transportEntries, entry->transport);
+	}
+
+	entry->closing = YES;
+	entry->object = nil;
+	entry->transport = nil;
+	if (entry->armed)
+	{
+		[self cancelEntry: entry];
+		[self scheduleFlush];
+	}
+	[self releaseEntry: entry];
+	return self;
+}
+- (BOOL)handlesObject: (id)anObject
+{
+	return NSMapGet(entries, anObject) ? YES : NO;
+}
+- transportNeedsToWrite: (TCPTransport *)aTransport
+{
+	uring_entry *entry = NSMapGet(transportEntries, aTransport);
+
+	if (!entry || entry->queued)
+	{
+		return self;
+	}
+	entry->queued = YES;
+	entry->nextSend = sendQueue;
+	sendQueue = entry;
+	[self scheduleFlush];
+	return self;
+}
+- pauseReadingObject: (id <NetObject>)anObject
+{
+	uring_entry *entry = NSMapGet(entries, anObject);
+
+	if (!entry || entry->paused)
+	{
+		return self;
+	}
+	entry->paused = YES;
+	if (entry->armed)
+	{
+		[self cancelEntry: entry];
+		[self scheduleFlush];
+	}
+	return self;
+}
+- resumeReadingObject: (id <NetObject>)anObject
+{
+	uring_entry *entry = NSMapGet(entries, anObject);
+
+	if (!entry || !entry->paused)
+	{
+		return self;
+	}
+	entry->paused = NO;
+	/* If the cancelled receive has not ended yet, it starts again when
+	 * it does. */
+	if (!entry->armed)
+	{
+		[self armEntry: entry];
+		[self scheduleFlush];
+	}
+	return self;
+}
+- handleCompletions
+{
+	struct io_uring_cqe *cqe;
+	uint64_t count;
+	uint64_t data;
+	uring_entry *entry;
+	unsigned flags;
+	int result;
+
+	if (read(eventDesc, &count, sizeof(count)) == -1 && errno != EAGAIN)
+	{
+		NSLog(@"NetUring: %s", strerror(errno));
+	}
+
+	while (io_uring_peek_cqe(ring, &cqe) == 0)
+	{
+		data = io_uring_cqe_get_data64(cqe);
+		result = cqe->res;
+		flags = cqe->flags;
+		io_uring_cqe_seen(ring, cqe);
+		completions++;
+
+		entry = (uring_entry *)(uintptr_t)(data & ~(uint64_t)OP_MASK);
+		switch (data & OP_MASK)
+		{
+			case OP_ACCEPT:
+				[self accepted: result flags: flags entry: entry];
+				break;
+			case OP_RECEIVE:
+				[self received: result flags: flags entry: entry];
+				break;
+			case OP_SEND:
+				[self sent: result entry: entry];
+				break;
+			case OP_CANCEL:
+				entry->outstanding--;
+				[self releaseEntry: entry];
+				break;
+		}
+	}
+
+	return [self flush];
+}
+- flush
+{
+	struct io_uring_sqe *sqe;
+	uring_entry *list = sendQueue;
+	uring_entry *entry;
+	NSMutableData *spare;
+
+	flushScheduled = NO;
+	sendQueue = NULL;
+	while ((entry = list))
+	{
+		list = entry->nextSend;
+		entry->queued = NO;
+		if (entry->closing)
+		{
+			[self releaseEntry: entry];
+			continue;
+		}
+		/* A transport with a send in flight is queued again when it
+		 * completes. */
+		if (entry->sending || ![entry->transport uringHasDataToWrite])
+		{
+			continue;
+		}
+
+		spare = (entry->spare) ? entry->spare : [NSMutableData new];
+		entry->spare = nil;
+		entry->sending = [entry->transport uringSwapWriteBuffer: spare];
+
+		sqe = [self nextRequest];
+		io_uring_prep_send(sqe, entry->desc, [entry->sending bytes],
+		  [entry->sending length], MSG_NOSIGNAL);
+		io_uring_sqe_set_data64(sqe, (uintptr_t)entry | OP_SEND);
+		entry->outstanding++;
+	}
+
+	if (needsSubmit)
+	{
+		needsSubmit = NO;
+		io_uring_submit(ring);
+		submits++;
+	}
+	return self;
+}
+- (NSDictionary *)statistics
+{
+	return [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithUnsignedLongLong: submits], @"Submits",
+	  [NSNumber numberWithUnsignedLongLong: completions], @"Completions",
+	  [NSNumber numberWithUnsignedLongLong: accepts], @"Accepts",
+	  [NSNumber numberWithUnsignedLongLong: receives], @"Receives",
+	  [NSNumber numberWithUnsignedLongLong: sends], @"Sends",
+	  [NSNumber numberWithUnsignedLongLong: bufferShortages],
+	    @"BufferShortages",
+	  nil];
+}
+@end
+
+#else /* HAVE_LIBURING */
+
+@implementation NetUring
++ (BOOL)isAvailable
+{
+	return NO;
+}
+- init
+{
+	[self release];
+	return nil;
+}
+- (int)desc
+{
+	return -1;
+}
+- (BOOL)canHandleObject: (id)anObject
+{
+	return NO;
+}
+- (BOOL)addObject: (id)anObject
+{
+	return NO;
+}
+- removeObject: (id)anObject
+{
+	return self;
+}
+- (BOOL)handlesObject: (id)anObject
+{
+	return NO;
+}
+- transportNeedsToWrite: (TCPTransport *)aTransport
+{
+	return self;
+}
+- pauseReadingObject: (id <NetObject>)anObject
+{
+	return self;
+}
+- resumeReadingObject: (id <NetObject>)anObject
+{
+	return self;
+}
+- handleCompletions
+{
+	return self;
+}
+- flush
+{
+	return self;
+}
+- (NSDictionary *)statistics
+{
+	return [NSDictionary dictionary];
+}
+@end
+
+#endif /* HAVE_LIBURING */
@@ -0,0 +1,409 @@
+/***************************************************************************
+                                NetWorkerPool.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * <title>NetWorkerPool reference</title>
+ * <author name="Andrew Ruder">
+ * 	<email address="aeruder@ksu.edu" />
+ * 	<url url="http://www.aeruder.net" />
+ * </author>
+ * <version>Revision 1</version>
+ * <date>October 19, 2026</date>
+ * <copy>Andrew Ruder</copy>
+ */
+
+#import "NetWorkerPool.h"
+#import <Foundation/NSData.h>
+#import <Foundation/NSDictionary.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSAutoreleasePool.h>
+#import <Foundation/NSThread.h>
+#import <Foundation/NSValue.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Messages a queue runs before it goes to the back of the ready list. */
+#define WORKER_BATCH 16
+
+typedef struct work_item {
+	struct work_item *next;
+	SEL selector;
+	id object;
+} work_item;
+
+/* The messages of one target.  A queue only exists while it has messages
+ * waiting or running, and is then either on one ready list or taken off
+ * it by the thread running it, which puts it back or frees it. */
+typedef struct work_queue {
+	struct work_queue *nextReady;
+	id target;
+	work_item *head;
+	work_item *tail;
+	unsigned pending;
+	BOOL paused;
+} work_queue;
+
+typedef struct ready_list {
+	work_queue *head;
+	work_queue *tail;
+} ready_list;
+
+static inline void push_ready(ready_list *list, work_queue *queue)
+{
+	queue->nextReady = NULL;
+	if (list->tail)
+	{
+		list->tail->nextReady = queue;
+	}
+	else
+	{
+		list->head = queue;
+	}
+	list->tail = queue;
+}
+
+static inline work_queue *pop_ready(ready_list *list)
+{
+	work_queue *queue = list->head;
+
+	if (queue)
+	{
+		list->head = queue->nextReady;
+		if (!list->head)
+		{
+			list->tail = NULL;
+		}
+	}
+	return queue;
+}
+
+@interface NetWorkerPool (InternalNetWorkerPool)
+- runWorker: (NSNumber *)anIndex;
+- (void)send: (work_item *)anItem to: (id)aTarget;
+@end
+
+@implementation NetWorkerPool (InternalNetWorkerPool)
+- runWorker: (NSNumber *)anIndex
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	ready_list *lists = readyLists;
+	int index = [anIndex intValue];
+	work_queue *queue;
+	work_item *item;
+	id target;
+	BOOL resume;
+	int x;
+
+	pthread_mutex_lock(&lock);
+	while (1)
+	{
+		queue = pop_ready(&lists[index]);
+		for (x = 1; !queue && x < threadCount; x++)
+		{
+			if ((queue = pop_ready(&lists[(index + x) % threadCount])))
+			{
+				stolen++;
+			}
+		}
+		if (!queue)
+		{
+			if (stopping)
+			{
+				break;
+			}
+			threadsIdle++;
+			pthread_cond_wait(&wakeup, &lock);
+			threadsIdle--;
+			continue;
+		}
+
+		target = queue->target;
+		for (x = 0; x < WORKER_BATCH && (item = queue->head); x++)
+		{
+			queue->head = item->next;
+			if (!queue->head)
+			{
+				queue->tail = NULL;
+			}
+			queue->pending--;
+			handled++;
+			resume = NO;
+			if (queue->paused && queue->pending <= maximumPending / 2)
+			{
+				queue->paused = NO;
+				resume = YES;
+			}
+			pthread_mutex_unlock(&lock);
+
+			if (resume)
+			{
+				[net resumeReadingObject: target];
+			}
+			[self send: item to: target];
+
+			pthread_mutex_lock(&lock);
+		}
+
+		if (queue->head)
+		{
+			push_ready(&lists[index], queue);
+			if (threadsIdle)
+			{
+				pthread_cond_signal(&wakeup);
+			}
+		}
+		else
+		{
+			NSMapRemove(queues, target);
+			free(queue);
+			pthread_mutex_unlock(&lock);
+			RELEASE(target);
+			pthread_mutex_lock(&lock);
+		}
+	}
+
+	threadsRunning--;
+	if (threadsRunning == 0)
+	{
+		pthread_cond_broadcast(&finished);
+	}
+	pthread_mutex_unlock(&lock);
+
+	return self;
+}
+- (void)send: (work_item *)anItem to: (id)aTarget
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NetApplication *net;
+
+	NS_DURING
+		[aTarget performSelector: anItem->selector withObject: anItem->object];
+	NS_HANDLER
+		if ((([[localException name] isEqualToString: NetException]) ||
+		  ([[localException name] isEqualToString: FatalNetException])) &&
+		  [aTarget conformsToProtocol: @protocol(NetObject)])
+		{
+			net = [NetApplication sharedInstance];
+			[net postMessage: @selector(disconnectObject:) to: net
+			  withObject: aTarget];
+		}
+		else
+		{
+			/* Raised again on the run loop thread, as it would have been
+			 * had the handler run there. */
+			net = [NetApplication sharedInstance];
+			[net postMessage: @selector(raise) to: localException
+			  withObject: nil];
+		}
+	NS_ENDHANDLER
+
+	RELEASE(anItem->object);
+	free(anItem);
+	RELEASE(apr);
+}
+@end
+
+@implementation NetWorkerPool
+- init
+{
+	return [self initWithThreads: 0];
+}
+- initWithThreads: (int)aCount
+{
+	int x;
+
+	if (!(self = [super init])) return nil;
+
+	if (aCount <= 0)
+	{
+		aCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (aCount <= 0)
+	{
+		aCount = 1;
+	}
+
+	pthread_mutex_init(&lock, NULL);
+	pthread_cond_init(&wakeup, NULL);
+	pthread_cond_init(&finished, NULL);
+	queues = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+	  NSNonOwnedPointerMapValueCallBacks, 64);
+	readyLists = calloc(aCount, sizeof(ready_list));
+	maximumPending = 1024;
+	threadCount = aCount;
+	threadsRunning = aCount;
+
+	for (x = 0; x < aCount; x++)
+	{
+		[NSThread detachNewThreadSelector: @selector(runWorker:)
+		  toTarget: self withObject: [NSNumber numberWithInt: x]];
+	}
+
+	return self;
+}
+- (void)dealloc
+{
+	NSFreeMapTable(queues);
+	free(readyLists);
+	pthread_cond_destroy(&finished);
+	pthread_cond_destroy(&wakeup);
+	pthread_mutex_destroy(&lock);
+	[super dealloc];
+}
+- (int)threadCount
+{
+	return threadCount;
+}
+- setMaximumPending: (unsigned)aCount
+{
+	pthread_mutex_lock(&lock);
+	maximumPending = aCount;
+	pthread_mutex_unlock(&lock);
+	return self;
+}
+- dispatch: (SEL)aSelector to: (id)aTarget withObject: (id)anObject
+{
+	work_queue *queue;
+	work_item *item;
+	BOOL pause = NO;
+
+	if (!(item = malloc(sizeof(work_item))))
+	{
+		[NSException raise: NetException
+		  format: @"[NetWorkerPool dispatch:to:withObject:] out of memory"];
+	}
+	item->next = NULL;
+	item->selector = aSelector;
+	item->object = RETAIN(anObject);
+
+	pthread_mutex_lock(&lock);
+	if (stopping)
+	{
+		pthread_mutex_unlock(&lock);
+		RELEASE(item->object);
+		free(item);
+		[NSException raise: NetException
+		  format: @"[NetWorkerPool dispatch:to:withObject:] pool stopped"];
+	}
+
+	queue = NSMapGet(queues, aTarget);
+	if (!queue)
+	{
+		queue = calloc(1, sizeof(work_queue));
+		queue->target = RETAIN(aTarget);
+		NSMapInsert(queues, aTarget, queue);
+		push_ready(&((ready_list *)readyLists)[nextList++ % threadCount],
+		  queue);
+		if (threadsIdle)
+		{
+			pthread_cond_signal(&wakeup);
+		}
+	}
+	if (queue->tail)
+	{
+		queue->tail->next = item;
+	}
+	else
+	{
+		queue->head = item;
+	}
+	queue->tail = item;
+	queue->pending++;
+
+	if (maximumPending && !queue->paused &&
+	  queue->pending >= maximumPending &&
+	  [aTarget conformsToProtocol: @protocol(NetObject)])
+	{
+		queue->paused = YES;
+		pause = YES;
+	}
+	pthread_mutex_unlock(&lock);
+
+	if (pause)
+	{
+		[[NetApplication sharedInstance] pauseReadingObject: aTarget];
+	}
+	return self;
+}
+- stop
+{
+	pthread_mutex_lock(&lock);
+	stopping = YES;
+	pthread_cond_broadcast(&wakeup);
+	while (threadsRunning > 0)
+	{
+		pthread_cond_wait(&finished, &lock);
+	}
+	pthread_mutex_unlock(&lock);
+	return self;
+}
+- (NSDictionary *)statistics
+{
+	NSDictionary *dict;
+
+	pthread_mutex_lock(&lock);
+	dict = [NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithInt: threadCount], @"Threads",
+	  [NSNumber numberWithUnsignedLongLong: handled], @"Handled",
+	  [NSNumber numberWithUnsignedLongLong: stolen], @"Stolen",
+	  [NSNumber numberWithUnsignedInt: NSCountMapTable(queues)], @"Queues",
+	  nil];
+	pthread_mutex_unlock(&lock);
+
+	return dict;
+}
+@end
+
+@implementation NetApplication (WorkerPool)
+- setWorkerPool: (NetWorkerPool *)aPool forObject: (id <NetObject>)anObject
+{
+	if (!aPool)
+	{
+		if (poolTable)
+		{
+			NSMapRemove(poolTable, anObject);
+		}
+		return self;
+	}
+	if (!poolTable)
+	{
+		poolTable = NSCreateMapTable(NSNonOwnedPointerMapKeyCallBacks,
+		  NSObjectMapValueCallBacks, 16);
+	}
+	NSMapInsert(poolTable, anObject, aPool);
+	return self;
+}
+- (NetWorkerPool *)workerPoolForObject: (id <NetObject>)anObject
+{
+	return (poolTable) ? NSMapGet(poolTable, anObject) : nil;
+}
+- passData: (NSData *)data toObject: (id <NetObject>)anObject
+{
+	NetWorkerPool *pool;
+
+	pool = (poolTable) ? NSMapGet(poolTable, anObject) : nil;
+	if (pool)
+	{
+		[pool dispatch: @selector(dataReceived:) to: anObject withObject: data];
+	}
+	else
+	{
+		[anObject dataReceived: data];
+	}
+	return self;
+}
+@end
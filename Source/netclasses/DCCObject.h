@@ -0,0 +1,243 @@
+/***************************************************************************
+                                DCCObject.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class DCCObject, DCCSendObject, DCCReceiveObject, DCCFileTransport;
+
+#ifndef DCC_OBJECT_H
+#define DCC_OBJECT_H
+
+#import "NetTCP.h"
+
+@class NSString, NSDictionary, NSHost, TCPPort;
+
+/**
+ * The status of a [DCCObject] that is waiting for the other side to
+ * connect.
+ */
+extern NSString *DCCStatusListening;
+/**
+ * The status of a [DCCObject] that is connecting to the other side.
+ */
+extern NSString *DCCStatusConnecting;
+/**
+ * The status of a [DCCObject] while the file is being transferred.
+ */
+extern NSString *DCCStatusTransferring;
+/**
+ * The status of a [DCCObject] once the whole file has been transferred.
+ */
+extern NSString *DCCStatusDone;
+/**
+ * The status of a [DCCObject] whose transfer was stopped with
+ * [DCCObject-abort].
+ */
+extern NSString *DCCStatusAborted;
+/**
+ * The status of a [DCCObject] whose connection failed or was closed before
+ * the whole file was transferred.
+ */
+extern NSString *DCCStatusError;
+
+/**
+ * A [TCPTransport] that moves file data between the socket and a file
+ * descriptor without copying it through user space.  When sending, the
+ * file is written with sendfile(2) each time [NetApplication] reports the
+ * socket writable.  When receiving, data is moved from the socket into the
+ * file with splice(2) through a pipe, and -readData: returns an empty
+ * NSData; use -fileOffset to see how far the file has got.  Where
+ * sendfile(2) or splice(2) are not available, the data goes through a
+ * buffer instead.  The file descriptor is not closed by the transport.
+ */
+@interface DCCFileTransport : TCPTransport
+	{
+		int fileDesc;
+		int pipeDescs[2];
+		BOOL sending;
+		BOOL receiving;
+		unsigned long long fileOffset;
+		unsigned long long fileEnd;
+	}
+/**
+ * Sends <var>aLength</var> bytes of the file <var>aDesc</var> starting at
+ * <var>anOffset</var> once anything already in the write buffer has been
+ * written.  The socket is made non-blocking.
+ */
+- sendFile: (int)aDesc fromOffset: (unsigned long long)anOffset
+   length: (unsigned long long)aLength;
+/**
+ * Writes everything received into the file <var>aDesc</var> starting at
+ * <var>anOffset</var>.
+ */
+- receiveToFile: (int)aDesc atOffset: (unsigned long long)anOffset;
+/**
+ * Returns the offset in the file of the next byte to be sent or received.
+ */
+- (unsigned long long)fileOffset;
+/**
+ * Returns YES if all of the file given to -sendFile:fromOffset:length: has
+ * been sent.
+ */
+- (BOOL)isFileSent;
+@end
+
+/**
+ * The base class of a DCC file transfer.  The transfer reports what it is
+ * doing through the callbacks in [DCCObject(Callbacks)], which can be
+ * overridden in a subclass.
+ */
+@interface DCCObject : NSObject < NetObject >
+	{
+		DCCFileTransport *transport;
+		NSString *status;
+		NSString *path;
+		NSString *fileName;
+		int fileDesc;
+		unsigned long long size;
+		unsigned long long startPosition;
+		unsigned long long position;
+		uint64_t startTime;
+		uint64_t endTime;
+	}
+/**
+ * Returns the current status, one of DCCStatusListening,
+ * DCCStatusConnecting, DCCStatusTransferring, DCCStatusDone,
+ * DCCStatusAborted and DCCStatusError.
+ */
+- (NSString *)status;
+/**
+ * Returns the path of the local file.
+ */
+- (NSString *)path;
+/**
+ * Returns the name of the file as given in the DCC request.
+ */
+- (NSString *)fileName;
+/**
+ * Returns the size of the whole file.
+ */
+- (unsigned long long)size;
+/**
+ * Returns the position the transfer started at, zero unless it was
+ * resumed.
+ */
+- (unsigned long long)startPosition;
+/**
+ * Returns the position in the file the other side has confirmed (when
+ * sending) or that has been written (when receiving).
+ */
+- (unsigned long long)position;
+/**
+ * Returns the average throughput of the transfer so far in bytes per
+ * second.
+ */
+- (double)throughput;
+/**
+ * Stops the transfer and sets the status to DCCStatusAborted.
+ */
+- abort;
+- (void)connectionLost;
+- connectionEstablished: (id <NetTransport>)aTransport;
+- dataReceived: (NSData *)data;
+- (id <NetTransport>)transport;
+@end
+
+/**
+ * The callbacks of [DCCObject].  They all do nothing by default.
+ */
+@interface DCCObject (Callbacks)
+/**
+ * Called when the status changes to <var>aStatus</var>.
+ */
+- DCCStatusChanged: (NSString *)aStatus;
+/**
+ * Called from the event loop as the transfer progresses, with the new
+ * -position.
+ */
+- DCCProgress: (unsigned long long)aPosition;
+@end
+
+/**
+ * Sends a file over DCC.  Create it with -initWithFile:, call
+ * -listenOnHost:onPort: and offer the file with
+ * [IRCObject-sendDCCSendRequest:fromHost:onPort:withSize:to:].  When the
+ * other side connects, the file is sent with sendfile(2) and the transfer
+ * is done once the other side has confirmed every byte.
+ */
+@interface DCCSendObject : DCCObject
+	{
+		TCPPort *listener;
+		unsigned char ackBytes[4];
+		int ackLength;
+	}
+/**
+ * Opens the file at <var>aPath</var> for sending.  Returns nil if it can
+ * not be opened.
+ */
+- initWithFile: (NSString *)aPath;
+/**
+ * Listens for the connection from the receiver on port <var>aPort</var> of
+ * <var>aHost</var> (all addresses if nil, any free port if zero).  Only
+ * the first connection is accepted.  Returns nil and sets the [TCPSystem]
+ * error string if an error occurs.
+ */
+- listenOnHost: (NSHost *)aHost onPort: (uint16_t)aPort;
+/**
+ * Returns the port being listened on, or zero.
+ */
+- (uint16_t)port;
+/**
+ * Sets the position the file is sent from, for a DCC RESUME.  Has no
+ * effect once the transfer has started.
+ */
+- setStartPosition: (unsigned long long)aPosition;
+@end
+
+/**
+ * Receives a file over DCC into a local file, using splice(2) to move the
+ * data from the socket into the file.
+ */
+@interface DCCReceiveObject : DCCObject < TCPConnecting >
+	{
+		NSHost *host;
+		uint16_t port;
+		TCPConnecting *connecting;
+	}
+/**
+ * Opens <var>aPath</var> to receive the file offered in
+ * <var>fileInfo</var>, as given to
+ * [IRCObject-DCCSendRequestReceived:from:].  If <var>resume</var> is YES,
+ * the data already in the file is kept and the transfer starts at its end
+ * (send a DCC RESUME with -startPosition and wait for the DCC ACCEPT
+ * before calling -connect), otherwise the file is truncated.  Returns nil
+ * if the file can not be opened.
+ */
+- initWithFileInfo: (NSDictionary *)fileInfo toPath: (NSString *)aPath
+   resume: (BOOL)resume;
+/**
+ * Connects to the sender in the background.  Returns nil and sets the
+ * [TCPSystem] error string if the connection can not be started.
+ */
+- connect;
+/**
+ * Called if the connection to the sender fails.  Sets the status to
+ * DCCStatusError.
+ */
+- connectingFailed: (NSString *)aError;
+- connectingStarted: (TCPConnecting *)aConnection;
+@end
+
+#endif
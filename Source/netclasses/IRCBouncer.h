@@ -0,0 +1,166 @@
+/***************************************************************************
+                                IRCBouncer.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class IRCBouncer, IRCBouncerUpstream, IRCBouncerClient;
+
+#ifndef IRC_BOUNCER_H
+#define IRC_BOUNCER_H
+
+#import "IRCObject.h"
+#import "LineObject.h"
+
+@class NSString, NSArray, NSMutableArray, NSMutableDictionary, NSHost;
+@class TCPPort;
+
+/**
+ * The upstream side of an [IRCBouncer]: one [IRCObject] connected to an
+ * IRC server, shared by any number of [IRCBouncerClient] connections.
+ * Each line from the server is parsed once, by [IRCObject], and the same
+ * NSData holding the line is written to every attached client.  PING and
+ * PONG are answered here and not passed on.
+ * <p>
+ * The upstream keeps the state a newly attached client needs: the
+ * registration replies (001 to 005), and the topic and members of every
+ * channel it is in.  It keeps this up to date from the callbacks of
+ * [IRCObject(Callbacks)], so a subclass overriding one of them must call
+ * the implementation of IRCBouncerUpstream.
+ * </p>
+ * <p>
+ * Create it like any [IRCObject], connect it with [TCPSystem] and add it
+ * to a bouncer with [IRCBouncer-addUpstream:forIdentity:].
+ * </p>
+ */
+@interface IRCBouncerUpstream : IRCObject
+	{
+		NSMutableArray *clients;
+		NSMutableArray *welcomeLines;
+		NSMutableDictionary *channels;
+		NSString *serverName;
+		unsigned long long linesForwarded;
+	}
+/**
+ * Returns the clients attached to this upstream.
+ */
+- (NSArray *)clients;
+/**
+ * Attaches <var>aClient</var>: the registration replies and the state of
+ * every channel are sent to it, and from then on it receives everything
+ * the server sends.
+ */
+- attachClient: (IRCBouncerClient *)aClient;
+/**
+ * Detaches <var>aClient</var>.  The upstream connection stays up.
+ */
+- detachClient: (IRCBouncerClient *)aClient;
+/**
+ * Returns the names of the channels the upstream is in.
+ */
+- (NSArray *)channels;
+/**
+ * Returns the members of <var>aChannel</var>, each with its status
+ * prefix (such as @ or +), or nil if the upstream is not in it.
+ */
+- (NSArray *)membersOfChannel: (NSString *)aChannel;
+/**
+ * Returns the topic of <var>aChannel</var>, or nil if there is none.
+ */
+- (NSString *)topicOfChannel: (NSString *)aChannel;
+/**
+ * Returns the number of lines written to clients, counting each client
+ * separately.
+ */
+- (unsigned long long)linesForwarded;
+@end
+
+/**
+ * A client connected to an [IRCBouncer].  It registers as it would with
+ * a server (PASS, NICK and USER); the PASS argument names the identity
+ * to attach to and can be left out when the bouncer has only one.  Once
+ * attached, everything it sends is passed to the upstream, except PING,
+ * which the bouncer answers, and QUIT, which only disconnects the client.
+ */
+@interface IRCBouncerClient : LineObject
+	{
+		IRCBouncer *bouncer;
+		IRCBouncerUpstream *upstream;
+		NSString *nick;
+		NSString *identity;
+		BOOL gotUser;
+	}
+/**
+ * Initializes a client accepted by <var>aBouncer</var>.
+ */
+- initWithBouncer: (IRCBouncer *)aBouncer;
+/**
+ * Returns the nickname the client registered with.
+ */
+- (NSString *)nick;
+/**
+ * Returns the upstream the client is attached to, or nil.
+ */
+- (IRCBouncerUpstream *)upstream;
+@end
+
+/**
+ * Multiplexes IRC connections: many clients connect to the bouncer on a
+ * [TCPPort] and share one [IRCBouncerUpstream] per identity (usually a
+ * nickname on a network), instead of each holding its own connection to
+ * the server.
+ */
+@interface IRCBouncer : NSObject
+	{
+		NSMutableDictionary *upstreams;
+		TCPPort *listener;
+	}
+/**
+ * Makes <var>anUpstream</var> available to clients that register with
+ * <var>anIdentity</var> as their password.
+ */
+- addUpstream: (IRCBouncerUpstream *)anUpstream
+   forIdentity: (NSString *)anIdentity;
+/**
+ * Removes the upstream for <var>anIdentity</var>.  Its clients are
+ * disconnected.
+ */
+- removeUpstreamForIdentity: (NSString *)anIdentity;
+/**
+ * Returns the upstream for <var>anIdentity</var>.  If
+ * <var>anIdentity</var> is nil and there is only one upstream, returns
+ * that one.
+ */
+- (IRCBouncerUpstream *)upstreamForIdentity: (NSString *)anIdentity;
+/**
+ * Returns the identities with an upstream.
+ */
+- (NSArray *)identities;
+/**
+ * Listens for clients on port <var>aPort</var> of <var>aHost</var> (all
+ * addresses if nil, any free port if zero).  Returns nil and sets the
+ * [TCPSystem] error string if an error occurs.
+ */
+- listenOnHost: (NSHost *)aHost onPort: (uint16_t)aPort;
+/**
+ * Returns the port being listened on, or zero.
+ */
+- (uint16_t)port;
+/**
+ * Stops listening for clients.  Attached clients stay connected.
+ */
+- stopListening;
+@end
+
+#endif
@@ -15,7 +15,7 @@
  *                                                                         *
  ***************************************************************************/
 
-@class IRCObject, DCCObject, DCCReceiveObject, DCCSendObject;
+@class IRCObject, IRCNameList, IRCModeChanges, DCCObject, DCCReceiveObject, DCCSendObject;
 
 #ifndef IRC_OBJECT_H
 #define IRC_OBJECT_H
@@ -94,6 +94,160 @@ NSString *ExtractIRCHost(NSString *prefix);
  */
 NSArray *SeparateIRCNickAndHost(NSString *prefix);
 
+/**
+ * The members of a channel, as collected by [IRCObject] from the
+ * <var>RPL_NAMREPLY</var> replies to a NAMES request and passed to
+ * [IRCObject(Callbacks)-namesReceived:forChannel:].  The nicknames are
+ * kept packed in one buffer as they arrived, so a list of tens of thousands
+ * of members costs no more than a few objects until its members are asked
+ * for.
+ * <p>
+ * Each member has the status prefixes the server sent with it (such as
+ * @ or +); there are several if the server has the multi-prefix
+ * capability.  The prefixes are those in the PREFIX parameter of
+ * <var>RPL_ISUPPORT</var>, or ~&amp;@%+ if the server did not send one.  If
+ * the server sent nickname!user@host (userhost-in-names), only the
+ * nickname is kept.
+ * </p>
+ */
+@interface IRCNameList : NSObject
+	{
+		NSMutableData *names;
+		NSMutableData *entries;
+		NSStringEncoding encoding;
+	}
+/**
+ * Returns the number of members.
+ */
+- (unsigned)count;
+/**
+ * Returns the nickname of the member at <var>anIndex</var>.
+ */
+- (NSString *)nickAtIndex: (unsigned)anIndex;
+/**
+ * Returns the status prefixes of the member at <var>anIndex</var>, or an
+ * empty string if it has none.
+ */
+- (NSString *)prefixesAtIndex: (unsigned)anIndex;
+/**
+ * Returns YES if the member at <var>anIndex</var> has the status prefix
+ * <var>aPrefix</var>.
+ */
+- (BOOL)member: (unsigned)anIndex hasPrefix: (char)aPrefix;
+/**
+ * Returns the nicknames of all members.
+ */
+- (NSArray *)nicks;
+/**
+ * Returns all members as sent by the server, each with its prefixes.
+ */
+- (NSArray *)members;
+@end
+
+/**
+ * The most TARGMAX entries kept in [IRCServerSupport].
+ */
+#define IRC_TARGMAX_ENTRIES 16
+
+/**
+ * What the server supports, from the parameters of its
+ * <var>RPL_ISUPPORT</var> replies (see [IRCObject-serverSupport]).  Until
+ * the server sends a parameter, and after it withdraws one with
+ * <code>-PARAMETER</code>, the field holds the value usual on servers
+ * that do not send it.  The mode fields are the letters of the
+ * four groups of CHANMODES: list modes, which always take an argument,
+ * modes that always take one, modes that take one only when set, and
+ * modes that never do.  A count of zero means the server set no limit.
+ */
+typedef struct
+{
+	char channelTypes[8];
+	char prefixModes[16];
+	char prefixChars[16];
+	char listModes[32];
+	char argumentModes[32];
+	char setArgumentModes[32];
+	char flagModes[32];
+	unsigned modes;
+	unsigned maxTargets;
+	unsigned nickLength;
+	unsigned channelLength;
+	unsigned topicLength;
+	unsigned targmaxCount;
+	struct
+	{
+		char command[12];
+		unsigned maximum;
+	} targmax[IRC_TARGMAX_ENTRIES];
+} IRCServerSupport;
+
+/**
+ * One change in a MODE line, as decoded by IRCDecodeModes().  The
+ * argument is the index of the word after the modes that the mode takes,
+ * or -1 if it takes none.  IRCDecodeModes() also gives it as a range of
+ * the bytes of the line, whose length is zero if the line ends first.
+ */
+typedef struct
+{
+	char sign;
+	char mode;
+	int16_t argument;
+	uint16_t argumentLocation;
+	uint16_t argumentLength;
+} IRCModeChange;
+
+/**
+ * Decodes the <var>length</var> bytes of <var>line</var>, the modes and
+ * arguments of a MODE line such as "+ov-b nick nick *!*@host", into at
+ * most <var>maxChanges</var> entries of <var>changes</var>.  Which modes
+ * take an argument is decided by <var>support</var>; for a user's modes
+ * (<var>onChannel</var> NO) none do.  Returns the number of changes in
+ * the line, which may be more than were stored.  Nothing is allocated.
+ */
+unsigned IRCDecodeModes(const IRCServerSupport *support, BOOL onChannel,
+  const char *line, unsigned length, IRCModeChange *changes,
+  unsigned maxChanges);
+
+/**
+ * The changes of one MODE line, decoded with IRCDecodeModes() and passed
+ * to [IRCObject(Callbacks)-modesChanged:on:from:].  It holds a flat array
+ * of changes and the arguments of the line as they were parsed.
+ */
+@interface IRCModeChanges : NSObject
+	{
+		NSArray *arguments;
+		NSData *changes;
+	}
+/**
+ * Returns the number of changes.
+ */
+- (unsigned)count;
+/**
+ * Returns the changes as a C array of -count entries, valid as long as
+ * the receiver is.  Their arguments are indexes into -arguments; the
+ * argument ranges are not set.
+ */
+- (const IRCModeChange *)changes;
+/**
+ * Returns the parameters of the line after the modes.
+ */
+- (NSArray *)arguments;
+/**
+ * Returns YES if the change at <var>anIndex</var> sets its mode, NO if it
+ * removes it.
+ */
+- (BOOL)isSettingAtIndex: (unsigned)anIndex;
+/**
+ * Returns the mode letter of the change at <var>anIndex</var>.
+ */
+- (char)modeAtIndex: (unsigned)anIndex;
+/**
+ * Returns the argument of the change at <var>anIndex</var>, or nil if it
+ * has none.
+ */
+- (NSString *)argumentAtIndex: (unsigned)anIndex;
+@end
+
 /**
  * <p>
  * IRCObject handles all aspects of an IRC connection.  In almost all
@@ -126,6 +280,24 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
 		NSMutableDictionary *targetToOriginalTarget;
 
 		SEL lowercasingSelector;
+
+		unsigned long long linesIn;
+		unsigned long long linesOut;
+		struct NetCommandCounters *commandCounters;
+
+		NSMutableDictionary *pendingNames;
+		BOOL suppressesNamesNumerics;
+
+		IRCServerSupport serverSupport;
+
+		void *listFilter;
+		NSMutableArray *listBatch;
+
+		NSMutableData *subscriptions;
+		unsigned long long linesSkipped;
+
+		BOOL decodesModes;
+		unsigned ownPrefixLength;
 	}
 /**
  * <init />
@@ -258,6 +430,85 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
  */
 - (NSArray *)targetsWithEncodings;
 
+/**
+ * Returns a snapshot of the counters kept for the current connection.
+ * The dictionary contains NSNumbers for the keys LinesIn, LinesOut and
+ * LinesSkipped (lines dropped because nothing subscribed to them, which
+ * are counted in LinesIn but not by command), and dictionaries of
+ * NSNumbers keyed by command for the keys LinesInByCommand and
+ * LinesOutByCommand.  Commands are counted by name only if they are well
+ * known (see NetCommandCounters in NetMetrics.h); the rest are counted
+ * under <code>other</code>.  If the transport keeps
+ * statistics of its own (see [TCPTransport-statistics]), they are
+ * included under the key Transport.  The counters are reset when a
+ * new connection is established.
+ */
+- (NSDictionary *)statistics;
+
+/**
+ * Returns what the server supports, from its <var>RPL_ISUPPORT</var>
+ * replies.  It is reset when a new connection is established.
+ */
+- (const IRCServerSupport *)serverSupport;
+/**
+ * Returns the most targets the server accepts in one <var>aCommand</var>,
+ * from TARGMAX, or from MAXTARGETS for PRIVMSG and NOTICE.  Returns zero
+ * if the server gave no limit, and 1 if it did not say.
+ */
+- (unsigned)maximumTargetsForCommand: (NSString *)aCommand;
+
+/**
+ * If <var>aBool</var> is YES, the <var>RPL_NAMREPLY</var> and
+ * <var>RPL_ENDOFNAMES</var> replies are not passed to
+ * [IRCObject(Callbacks)-numericCommandReceived:withParams:from:]; the
+ * members only arrive through [IRCObject(Callbacks)-namesReceived:forChannel:],
+ * and the <var>RPL_NAMREPLY</var> lines are not turned into strings at
+ * all.  The default is NO.
+ */
+- setSuppressesNamesNumerics: (BOOL)aBool;
+/**
+ * Returns YES if the NAMES replies are not passed to
+ * [IRCObject(Callbacks)-numericCommandReceived:withParams:from:].
+ */
+- (BOOL)suppressesNamesNumerics;
+
+/**
+ * Subscribes to <var>aCommand</var> (such as PRIVMSG, or a numeric such
+ * as 332) from any target.  By default an IRCObject handles every line
+ * it receives, but once it has any subscription it only handles the
+ * commands it is subscribed to: other lines are dropped after reading
+ * only their command, or their command and first parameter, without
+ * building any objects or calling any callbacks.  Use this when only a
+ * few kinds of message are of interest, so the cost of a connection
+ * follows the traffic it handles rather than the traffic it receives.
+ * <p>
+ * Lines that IRCObject needs itself are always handled: PING, ERROR,
+ * NICK, the registration replies and errors, <var>RPL_ISUPPORT</var>,
+ * and the NAMES replies (353 and 366).  So are the LIST replies while
+ * -listChannelsWithMinimumUsers:nameMatching:topicContaining:batchSize:
+ * is listing.
+ * </p>
+ */
+- subscribeToCommand: (NSString *)aCommand;
+/**
+ * Subscribes to <var>aCommand</var> when its first parameter is
+ * <var>aTarget</var>, for example PRIVMSG to one channel.  Targets are
+ * compared by the casemapping of -lowercasingSelector, so they
+ * follow the CASEMAPPING the server advertises.  Can be called for several
+ * targets of the same command; it has no effect if already subscribed
+ * to <var>aCommand</var> from any target.  Numerics are always sent to
+ * the nickname, so subscribe to them with -subscribeToCommand:.
+ */
+- subscribeToCommand: (NSString *)aCommand target: (NSString *)aTarget;
+/**
+ * Removes the subscription to <var>aCommand</var> and all its targets.
+ */
+- unsubscribeFromCommand: (NSString *)aCommand;
+/**
+ * Removes every subscription, so that every line is handled again.
+ */
+- removeAllSubscriptions;
+
 // IRC Operations
 /**
  * Sets the nickname to the <var>aNick</var>.  This method is quite similar
@@ -296,6 +547,25 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
  */
 - joinChannel: (NSString *)aChannel withPassword: (NSString *)aPassword;
 
+/**
+ * Joins every channel in <var>channels</var> with as few JOIN lines as
+ * possible: channels are combined into comma separated lists of at most
+ * the number the server allows (see -maximumTargetsForCommand:; one if
+ * it does not say) and at most 512 bytes a line, leaving room for the
+ * nick!user@host the server puts in front of lines it relays.
+ * <var>passwords</var> may be nil, or hold the key of the channel at the same index, with NSNull or an empty string
+ * for channels without one.  Channels with keys are sent first, so each
+ * key goes with its channel.
+ */
+- joinChannels: (NSArray *)channels withPasswords: (NSArray *)passwords;
+
+/**
+ * Leaves every channel in <var>channels</var> with the optional message
+ * <var>aMessage</var>, combining them into as few PART lines as possible
+ * like -joinChannels:withPasswords:.
+ */
+- partChannels: (NSArray *)channels withMessage: (NSString *)aMessage;
+
 /**
  * Sends a CTCP <var>aCTCP</var> reply to <var>aPerson</var> with the 
  * argument <var>args</var>.  <var>args</var> may contain spaces and is
@@ -316,6 +586,34 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
 - sendCTCPRequest: (NSString *)aCTCP withArgument: (NSString *)args
    to: (NSString *)aPerson;
 
+/**
+ * Offers the file <var>aFileName</var> of <var>aSize</var> bytes to
+ * <var>aPerson</var> with a DCC SEND request.  The file is available for
+ * connection on port <var>aPort</var> of <var>aHost</var>, usually a
+ * listening [DCCSendObject].  <var>aHost</var> must be an IPv4 address.
+ * See [DCCSendObject-listenOnHost:onPort:].
+ */
+- sendDCCSendRequest: (NSString *)aFileName fromHost: (NSHost *)aHost
+   onPort: (uint16_t)aPort withSize: (unsigned long long)aSize
+   to: (NSString *)aPerson;
+
+/**
+ * Asks <var>aPerson</var>, who offered <var>aFileName</var> on port
+ * <var>aPort</var>, to send it starting at <var>aPosition</var> instead of
+ * from the beginning.  The transfer should only be started once the
+ * matching DCC ACCEPT is received with -DCCAcceptReceived:from:.
+ */
+- sendDCCResumeRequest: (NSString *)aFileName onPort: (uint16_t)aPort
+   atPosition: (unsigned long long)aPosition to: (NSString *)aPerson;
+
+/**
+ * Agrees to a DCC RESUME request from <var>aPerson</var>.  The arguments
+ * should be the ones given in the request.  See
+ * -DCCResumeRequestReceived:from:.
+ */
+- sendDCCAccept: (NSString *)aFileName onPort: (uint16_t)aPort
+   atPosition: (unsigned long long)aPosition to: (NSString *)aPerson;
+
 /**
  * Sends a message <var>aMessage</var> to <var>aReceiver</var>.
  * <var>aReceiver</var> may be a nickname or a channel name.  
@@ -334,6 +632,23 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
  */
 - sendNotice: (NSString *)aNotice to: (NSString *)aReceiver;
 
+/**
+ * Sends <var>aMessage</var> to every receiver in <var>receivers</var>,
+ * combining them into as few PRIVMSG lines as the server's TARGMAX or
+ * MAXTARGETS and the 512 byte line limit allow.  The limit is kept with
+ * room for the nick!user@host the server puts in front of the message
+ * when it relays it, taken from our own JOIN lines, or the longest it
+ * can be until one is seen.  If the server gives neither TARGMAX nor
+ * MAXTARGETS, each receiver gets a line of its own.
+ */
+- sendMessage: (NSString *)aMessage toReceivers: (NSArray *)receivers;
+
+/**
+ * Sends <var>aNotice</var> to every receiver in <var>receivers</var>, like
+ * -sendMessage:toReceivers:.
+ */
+- sendNotice: (NSString *)aNotice toReceivers: (NSArray *)receivers;
+
 /**
  * Sends an action <var>anAction</var> to the receiver <var>aReceiver</var>.
  * This is similar to a message but will often be displayed such as:<br /><br />
@@ -548,6 +863,40 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
  */
 - listChannel: (NSString *)aChannel onServer: (NSString *)aServer;
 
+/**
+ * Lists the channels on the server that have at least <var>aCount</var>
+ * users, a name matching <var>aPattern</var> and a topic containing
+ * <var>aString</var>.  <var>aPattern</var> may use * and ?, and it and
+ * <var>aString</var> are compared without regard to case; either may be
+ * nil to accept any channel.
+ * <p>
+ * The <var>RPL_LIST</var> replies are checked against the filter on the
+ * bytes as they arrive, so channels that do not match cost no objects at
+ * all, and none of the replies of the listing are passed to
+ * [IRCObject(Callbacks)-numericCommandReceived:withParams:from:].  The
+ * channels that match are passed to
+ * [IRCObject(Callbacks)-listEntriesReceived:] in batches of
+ * <var>aSize</var>, and [IRCObject(Callbacks)-listEnded] is called at
+ * the end.  To keep memory bounded on a large network, a subclass that
+ * cannot keep up calls [LineObject-pauseReading] from
+ * -listEntriesReceived: and [LineObject-resumeReading] once it is ready
+ * for more; the rest of the listing then waits in the socket.
+ * </p>
+ * <p>
+ * Throws an IRCException if a listing is already in progress.
+ * </p>
+ */
+- listChannelsWithMinimumUsers: (unsigned)aCount
+   nameMatching: (NSString *)aPattern topicContaining: (NSString *)aString
+   batchSize: (unsigned)aSize;
+
+/**
+ * Returns YES while a listing started with
+ * -listChannelsWithMinimumUsers:nameMatching:topicContaining:batchSize:
+ * is in progress.
+ */
+- (BOOL)isListing;
+
 /**
  * This message will invite <var>aPerson</var> to the channel specified by
  * <var>aChannel</var>.  Neither may contain spaces and both are required.
@@ -640,6 +989,33 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
    withArgument: (NSString *)anArgument to: (NSString *)aReceiver
    from: (NSString *)aPerson;
 
+/**
+ * Called when <var>aPerson</var> offers a file with a DCC SEND request.
+ * <var>fileInfo</var> contains the keys FileName (the name given by the
+ * sender, which should never be used as a path without checking it), Host
+ * (a NSHost), Port and, when the sender gave them, Size and Token.  Use a
+ * [DCCReceiveObject] to accept it.  Other DCC requests are passed to
+ * -CTCPRequestReceived:withArgument:to:from: as before.
+ */
+- DCCSendRequestReceived: (NSDictionary *)fileInfo from: (NSString *)aPerson;
+
+/**
+ * Called when <var>aPerson</var> asks to resume a file offered earlier.
+ * <var>fileInfo</var> contains the keys FileName, Port and Position.  To
+ * agree, set the start position of the [DCCSendObject] listening on that
+ * port with [DCCSendObject-setStartPosition:] and reply with
+ * -sendDCCAccept:onPort:atPosition:to:.
+ */
+- DCCResumeRequestReceived: (NSDictionary *)fileInfo 
+   from: (NSString *)aPerson;
+
+/**
+ * Called when <var>aPerson</var> agrees to a resume requested with
+ * -sendDCCResumeRequest:onPort:atPosition:to:.  <var>fileInfo</var>
+ * contains the keys FileName, Port and Position.
+ */
+- DCCAcceptReceived: (NSDictionary *)fileInfo from: (NSString *)aPerson;
+
 /**
  * Called when an IRC error has occurred.  This is a message sent by the server
  * and its argument is stored in <var>anError</var>.  Typically you will be 
@@ -679,6 +1055,15 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
  */
 - modeChanged: (NSString *)aMode on: (NSString *)anObject 
    withParams: (NSArray *)paramList from: (NSString *)aPerson;
+
+/**
+ * Called after -modeChanged:on:withParams:from: with the same change
+ * already decoded, using the CHANMODES and PREFIX the server sent, into
+ * one entry per mode in <var>changes</var>.  MODE lines are only decoded
+ * for subclasses that override this method.
+ */
+- modesChanged: (IRCModeChanges *)changes on: (NSString *)anObject
+   from: (NSString *)aPerson;
    
 /**
  * Called when a numeric command has been received.  These are 3 digit numerical
@@ -690,6 +1075,30 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
 - numericCommandReceived: (NSString *)aCommand withParams: (NSArray *)paramList 
                       from: (NSString *)aSender;
 
+/**
+ * Called once the server has sent all the members of <var>aChannel</var>,
+ * in reply to a NAMES request or on joining it, with the members in
+ * <var>aList</var>.  The replies are collected as they arrive, so this
+ * is called once however many <var>RPL_NAMREPLY</var> lines there were.
+ */
+- namesReceived: (IRCNameList *)aList forChannel: (NSString *)aChannel;
+
+/**
+ * Called with the next batch of channels from a listing started with
+ * -listChannelsWithMinimumUsers:nameMatching:topicContaining:batchSize:.
+ * Each entry of <var>entries</var> is a dictionary with the keys Channel,
+ * Users (an NSNumber) and Topic.
+ */
+- listEntriesReceived: (NSArray *)entries;
+
+/**
+ * Called when a listing started with
+ * -listChannelsWithMinimumUsers:nameMatching:topicContaining:batchSize:
+ * has ended, after the last batch has been passed to
+ * -listEntriesReceived:.
+ */
+- listEnded;
+
 /**
  * Called when someone changes his/her nickname.  The new nickname is stored in
  * <var>newName</var> and the old name will be stored in <var>aPerson</var>.
@@ -791,6 +1200,13 @@ NSArray *SeparateIRCNickAndHost(NSString *prefix);
  * will not pass through any of the callbacks.
  */
 - writeString: (NSString *)format, ...;
+/**
+ * Writes <var>aString</var> with -writeString: on the run loop thread.
+ * This can be called from any thread; see
+ * [NetApplication-postMessage:to:withObject:].  The line is dropped if the
+ * connection is gone by then.
+ */
+- postString: (NSString *)aString;
 @end
 
 /* Below is all the numeric commands that you can receive as listed
@@ -36,6 +36,8 @@
 	{
 		id <NetTransport>transport;
 		NSMutableData *_readData;
+		BOOL _readingPaused;
+		unsigned _peakReadLength;
 	}
 /**
  * Cleans up the instance variables and releases the transport.
@@ -58,6 +60,23 @@
  * Returns the transport
  */
 - (id <NetTransport>)transport;
+/**
+ * Stops passing lines to -lineReceived: and stops [NetApplication]
+ * reading from the connection until -resumeReading is called.  Lines
+ * already read stay buffered.  Use this when lines arrive faster than
+ * they can be dealt with, so they wait in the socket buffer and slow the
+ * other end down rather than piling up in memory.
+ */
+- pauseReading;
+/**
+ * Undoes -pauseReading, passing any buffered lines to -lineReceived:
+ * before returning.
+ */
+- resumeReading;
+/**
+ * Returns YES if reading is paused.
+ */
+- (BOOL)isReadingPaused;
 
 /**
  * <override-subclass />
@@ -26,10 +26,13 @@
 
 #include <sys/time.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <unistd.h>
+#include <pthread.h>
 
 @class NSData, NSNumber, NSMutableDictionary, NSDictionary, NSArray;
-@class NSMutableArray, NSString;
+@class NSMutableArray, NSString, NSTimer, NetHistogram, NetUring;
+@class TCPTransport;
 
 /**
  * A protocol used for the actual transport class of a connection.  A
@@ -142,6 +145,76 @@
 - (id <NetTransport>)transport;
 @end
 
+/**
+ * Implemented by net objects that need to know when everything written
+ * to their transport has gone out, for example to close the connection
+ * once a response is sent.
+ */
+@protocol NetWritingObject <NetObject>
+/**
+ * Called by [NetApplication] when the transport has written all the data
+ * it was waiting to write, either once the descriptor became writable or
+ * when a send of the [NetUring] completed.  Data written without having
+ * to wait, as with NetWriteImmediate, does not lead to a call.
+ */
+- writingFinished;
+@end
+
+struct sockaddr_in;
+
+/**
+ * Implemented by net objects that receive datagrams rather than a stream
+ * of data.  Their transport should implement [(NetDatagramTransport)].
+ */
+@protocol NetDatagramObject <NetObject>
+/**
+ * Called for every datagram received.  <var>bytes</var> points to the
+ * <var>length</var> bytes of the datagram and <var>anAddress</var> to the
+ * address it came from.  Both are only valid until this method returns and
+ * must be copied if they are needed later.
+ */
+- datagramReceived: (const char *)bytes length: (unsigned)length
+   from: (const struct sockaddr_in *)anAddress;
+@end
+
+/**
+ * Implemented by transports carrying datagrams.  When such a transport
+ * becomes readable, [NetApplication] calls -receiveDatagramsFor: instead
+ * of [(NetTransport)-readData:] and [(NetObject)-dataReceived:].
+ */
+@protocol NetDatagramTransport <NetTransport>
+/**
+ * Receives the datagrams waiting on the transport and passes each of them
+ * to [(NetDatagramObject)-datagramReceived:length:from:] of
+ * <var>anObject</var>.  Returns the number of datagrams received.
+ */
+- (int)receiveDatagramsFor: (id <NetDatagramObject>)anObject;
+@end
+
+/**
+ * Implemented by transports that can pass their data through a stack of
+ * filters, such as [TCPTransport] with [TCPTransport-pushFilter:].  When
+ * -hasFilters returns YES, [NetApplication] hands what it reads to
+ * -deliverData:toObject: instead of [(NetObject)-dataReceived:] and calls
+ * -flushFilters at the end of every event it dispatches for the
+ * transport.
+ */
+@protocol NetFilteredTransport <NetTransport>
+/**
+ * Returns YES if any filters are in use.
+ */
+- (BOOL)hasFilters;
+/**
+ * Passes <var>data</var>, as read from the transport, up through the
+ * filters to <var>anObject</var>.
+ */
+- deliverData: (NSData *)data toObject: (id <NetObject>)anObject;
+/**
+ * Lets every filter pass on data it has been holding back.
+ */
+- flushFilters;
+@end
+
 /**
  * Thrown when a recoverable exception occurs on a connection or otherwise.
  */
@@ -183,12 +256,64 @@ typedef enum { ET_RDESC, ET_WDESC, ET_RPORT, ET_EDESC } RunLoopEventType;
 @end
 #endif
 
+/**
+ * The number of slots kept by [NetApplication] for counting dispatched
+ * events by their RunLoopEventType.
+ */
+#define NET_EVENT_TYPE_COUNT 8
+
+/**
+ * The ways [NetApplication] can do the I/O of ports and connections,
+ * selected with [NetApplication-setIOBackend:].
+ */
+typedef enum { NetReadinessBackend, NetUringBackend } NetIOBackend;
+
 @interface NetApplication : NSObject < RunLoopEvents >
 	{
 		NSMutableArray *portArray;
 		NSMutableArray *netObjectArray;
 		NSMutableArray *badDescs;
 		NSMapTable *descTable;
+		NSMapTable *kindTable;
+		NSMapTable *transportTable;
+		NSMapTable *pausedTable;
+
+		unsigned long long eventCounts[NET_EVENT_TYPE_COUNT];
+		unsigned long long totalConnections;
+		unsigned long long totalAccepts;
+		time_t acceptSecond;
+		unsigned acceptsThisSecond;
+		unsigned acceptsLastSecond;
+		struct timeval startTime;
+
+		BOOL instrumented;
+		NetHistogram *handlerHistogram;
+		NetHistogram *lagHistogram;
+		NSMapTable *classHistograms;
+		NSTimer *lagTimer;
+		uint64_t lagTimerFired;
+		uint64_t slowThreshold;
+		id slowTarget;
+		SEL slowSelector;
+
+		NSMapTable *poolTable;
+		pthread_t runLoopThread;
+
+		int postDescs[2];
+		void *postHead;
+		void *postBatch;
+		int postWakeupPending;
+		unsigned long long postsDelivered;
+		unsigned long long postWakeups;
+
+		NetUring *uring;
+		NetIOBackend ioBackend;
+
+		NSMapTable *writerTable;
+
+		NSMutableArray *flushQueue;
+		BOOL dispatching;
+		BOOL flushPerformPending;
 	}
 /**
  * Return the minor version number of the netclasses framework.  If the 
@@ -234,6 +359,40 @@ typedef enum { ET_RDESC, ET_WDESC, ET_RPORT, ET_EDESC } RunLoopEventType;
  * nil argument when it can write.
  */
 - transportNeedsToWrite: (id <NetTransport>)aTransport;
+/**
+ * Sends [TCPTransport-flushWrites] to <var>aTransport</var> as soon as
+ * the event being dispatched (a read, a write, a completion of the
+ * [NetUring] or the delivery of posted messages) has been handled, before
+ * the run loop waits again.  Called outside of a dispatch, for example
+ * from a timer, the flush happens on the next run loop iteration.
+ */
+- flushTransportAfterDispatch: (TCPTransport *)aTransport;
+/**
+ * Called when <var>aTransport</var>, which had data waiting to be written,
+ * has written all of it.  Sends [(NetWritingObject)-writingFinished] to
+ * its net object if that conforms to [(NetWritingObject)].  Called by
+ * [NetApplication] itself and by the [NetUring].
+ */
+- transportFinishedWriting: (id <NetTransport>)aTransport;
+/**
+ * Stops reading from the transport of <var>anObject</var> until
+ * -resumeReadingObject: is called, so data waits in the socket buffer and
+ * the other end is eventually slowed down.  Calls nest: reading resumes
+ * once -resumeReadingObject: has been called as many times as this.
+ * <p>
+ * Called off the run loop thread, for example by a handler running on a
+ * [NetWorkerPool], the call is posted to the run loop thread and this
+ * returns at once, before reading has stopped: data already read may
+ * still be delivered after it returns.
+ * </p>
+ */
+- pauseReadingObject: (id <NetObject>)anObject;
+/**
+ * Undoes one -pauseReadingObject: for <var>anObject</var>.  Like
+ * -pauseReadingObject:, this can be called from any thread, and off the
+ * run loop thread it returns before reading has resumed.
+ */
+- resumeReadingObject: (id <NetObject>)anObject;
 
 /** 
  * Inserts <var>anObject</var> into the runloop (and retains it).  
@@ -242,7 +401,9 @@ typedef enum { ET_RDESC, ET_WDESC, ET_RPORT, ET_EDESC } RunLoopEventType;
  * class follows neither protocol.  After connecting <var>anObject</var>,
  * it will begin to receive the methods designated by its respective
  * protocol.  <var>anObject</var> should only be connected with this
- * after its transport is set.
+ * after its transport is set.  A net object whose transport returns a
+ * negative descriptor (such as a [MemoryTransport]) is tracked but not
+ * added to the runloop; whatever drives that transport delivers its data.
  */
 - connectObject: anObject;
 /**
@@ -258,12 +419,93 @@ typedef enum { ET_RDESC, ET_WDESC, ET_RPORT, ET_EDESC } RunLoopEventType;
  * If any object should lose its connection, this will
  * automatically be called with that object as its argument.
  * </p>
+ * <p>
+ * The [(NetObject)-connectionLost] of an object with a worker pool is
+ * sent on the pool, after the data it has not handled yet.
+ * </p>
+ * <p>
+ * Called off the run loop thread, this method is posted to the run loop
+ * thread and returns at once.  The object is still connected when it
+ * returns, and may still be sent data; it is disconnected, and sent
+ * -connectionLost, once the run loop thread gets to the post.
+ * </p>
  */
 - disconnectObject: anObject;
 /** 
  * Calls -disconnectObject: on every object currently in the runloop.
  */
 - closeEverything;
+/**
+ * Queues <var>data</var> to be written to <var>aTransport</var> with
+ * [(NetTransport)-writeData:] on the run loop thread.  Unlike every other
+ * method of netclasses, this can be called from any thread, so work done
+ * on other threads can send its results without waiting for the run loop.
+ * <var>data</var> and <var>aTransport</var> are retained until the write
+ * is done.  The data is dropped if the transport is no longer connected
+ * by then.  Posts from one thread are handled in the order they were
+ * made.
+ * <p>
+ * Posting pushes onto a lock-free queue and, only when the run loop is
+ * not already due to drain it, wakes the run loop with an eventfd (a pipe
+ * where there is none).  The run loop drains everything posted since the
+ * last wakeup in one event.
+ * </p>
+ * <p>
+ * [NetApplication] must have been created on the run loop thread before
+ * anything is posted.
+ * </p>
+ */
+- postWriteData: (NSData *)data toTransport: (id <NetTransport>)aTransport;
+/**
+ * Queues <var>aSelector</var> to be sent to <var>aTarget</var> with
+ * <var>anObject</var> as its argument on the run loop thread, in order
+ * with the writes posted by -postWriteData:toTransport:.  Can be called
+ * from any thread.  <var>aTarget</var> and <var>anObject</var> are
+ * retained until the message is sent.  A NetException or
+ * FatalNetException raised by a net object disconnects it, as it would
+ * from any other event.
+ */
+- postMessage: (SEL)aSelector to: (id)aTarget withObject: (id)anObject;
+/**
+ * Returns YES if called on the thread running the run loop, the thread
+ * [NetApplication] was created on.
+ */
+- (BOOL)isRunLoopThread;
+/**
+ * Selects how ports and connections connected from now on are read and
+ * written.  NetReadinessBackend, the default, waits for descriptors to be
+ * ready with the run loop and then reads, writes or accepts.
+ * NetUringBackend hands the [TCPPort] and [TCPTransport] objects it can
+ * to a [NetUring], which accepts, receives and sends with io_uring; the
+ * rest stay on the readiness backend.  Objects already connected keep
+ * the backend they were connected with.  Returns NO, and keeps the
+ * readiness backend, if io_uring is not available.  Setting the
+ * environment variable NETCLASSES_IO_BACKEND to <code>uring</code>
+ * selects NetUringBackend when [NetApplication] is created.
+ */
+- (BOOL)setIOBackend: (NetIOBackend)aBackend;
+/**
+ * Returns the backend selected with -setIOBackend:.
+ */
+- (NetIOBackend)ioBackend;
+/**
+ * Returns the number of bytes waiting in the write buffers of the
+ * [TCPTransport] objects that are waiting to write, and stores how many
+ * transports that is in <var>aCount</var> if it is not NULL.  Only the
+ * transports that asked to write since they were last done writing are
+ * visited.
+ */
+- (unsigned long long)pendingWriteBytes: (unsigned *)aCount;
+/**
+ * Should not be called.  Used internally by the ports, and by [NetUring],
+ * to count each connection they accept.
+ */
+- (void)connectionAccepted;
+/**
+ * Returns the connected net object using <var>aTransport</var>, or nil
+ * if there is none.
+ */
+- (id <NetObject>)netObjectForTransport: (id <NetTransport>)aTransport;
 /**
  * Return an array of all net objects currently being handled by netclasses
  */
@@ -272,6 +514,75 @@ typedef enum { ET_RDESC, ET_WDESC, ET_RPORT, ET_EDESC } RunLoopEventType;
  * Return an array of all port objects currently being handled by netclasses
  */
 - (NSArray *)portArray;
+/**
+ * Returns a snapshot of the counters kept by [NetApplication].  The
+ * counters are plain integers updated on the run loop thread, so they
+ * are always on.  The dictionary contains the following keys:
+ * <deflist>
+ * <term>Connections</term><desc>net objects currently connected</desc>
+ * <term>Ports</term><desc>ports currently connected</desc>
+ * <term>TotalConnections</term><desc>net objects connected since
+ * startup</desc>
+ * <term>Accepts</term><desc>connections accepted by all ports</desc>
+ * <term>AcceptsPerSecond</term><desc>connections accepted during the
+ * last full second</desc>
+ * <term>Events</term><desc>a dictionary of dispatched event counts keyed
+ * by event type (ET_RDESC, ET_WDESC, ET_RPORT, ET_EDESC)</desc>
+ * <term>Uptime</term><desc>seconds since [NetApplication] was
+ * created</desc>
+ * <term>Posted</term><desc>writes and messages posted from other threads
+ * that have been handled</desc>
+ * <term>PostWakeups</term><desc>times the run loop was woken to handle
+ * them</desc>
+ * <term>Uring</term><desc>the [NetUring-statistics] of the ring, once
+ * NetUringBackend has been selected</desc>
+ * <term>BufferPool</term><desc>the [NetBufferPool-statistics] of the
+ * shared buffer pool</desc>
+ * <term>ObjectPools</term><desc>the [NetObjectPool+statistics] of the
+ * pooled classes, such as [TCPTransport]</desc>
+ * </deflist>
+ * All other values are NSNumbers.
+ */
+- (NSDictionary *)statistics;
+/**
+ * Turns the dispatch instrumentation on or off.  While instrumentation is
+ * on, every event handled by -receivedEvent:type:extra:forMode: is timed
+ * with a monotonic clock and recorded in -handlerHistogram and in a
+ * histogram for the class of the object handling it.  A timer also
+ * measures how late the run loop is in servicing it and records that in
+ * -lagHistogram.  All durations are in microseconds.  Instrumentation is
+ * off by default.  Turning it off invalidates the timer straight away.
+ */
+- setInstrumentationEnabled: (BOOL)aFlag;
+/**
+ * Returns YES if the dispatch instrumentation is turned on.
+ */
+- (BOOL)instrumentationEnabled;
+/**
+ * Returns the histogram of the time taken by every handler dispatched
+ * while instrumentation was enabled.
+ */
+- (NetHistogram *)handlerHistogram;
+/**
+ * Returns the histogram of the run loop lag, that is how much later than
+ * scheduled the instrumentation timer was able to run.
+ */
+- (NetHistogram *)lagHistogram;
+/**
+ * Returns a dictionary of [NetHistogram] objects keyed by class name, each
+ * holding the handler durations of the objects of that class.
+ */
+- (NSDictionary *)handlerHistogramsByClass;
+/**
+ * Sets a hook that fires when a single dispatch takes longer than
+ * <var>seconds</var> while instrumentation is enabled.  <var>aTarget</var>
+ * is sent <var>aSelector</var> with two arguments: the object whose handler
+ * was slow and an NSNumber holding the duration in seconds.  The hook fires
+ * after the handler returns.  A <var>seconds</var> of zero or a nil
+ * <var>aTarget</var> disables the hook.  <var>aTarget</var> is not retained.
+ */
+- setSlowHandlerThreshold: (double)seconds target: (id)aTarget
+   selector: (SEL)aSelector;
 @end
 
 #endif
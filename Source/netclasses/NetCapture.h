@@ -0,0 +1,139 @@
+/***************************************************************************
+                                NetCapture.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class NetCapture;
+
+#ifndef NET_CAPTURE_H
+#define NET_CAPTURE_H
+
+#import <Foundation/NSObject.h>
+
+#include <stdint.h>
+
+@class NSString, NSArray, NSDictionary;
+
+/**
+ * The kinds of record kept by [NetCapture].
+ */
+typedef enum
+{
+	NetCaptureOpen = 1,     /** A connection was opened; the data is the
+	                            remote address, if known. */
+	NetCaptureInbound = 2,  /** Data read from a connection. */
+	NetCaptureOutbound = 3, /** Data written to a connection. */
+	NetCaptureClose = 4     /** A connection was closed. */
+} NetCaptureType;
+
+/**
+ * The capture every [TCPTransport] records into, or nil (the default) if
+ * nothing is captured.  Set it with [NetCapture+setActiveCapture:].
+ */
+extern NetCapture *NetActiveCapture;
+
+/**
+ * Adds a record of <var>type</var> for the connection
+ * <var>connection</var> with <var>length</var> bytes of data to
+ * <var>aCapture</var>.  This is what [TCPTransport] calls; it does not
+ * allocate or make system calls.
+ */
+void NetCaptureRecord(NetCapture *aCapture, uint32_t connection,
+  NetCaptureType type, const void *bytes, unsigned length);
+
+/**
+ * Returns a new number identifying a connection in capture records.
+ */
+uint32_t NetCaptureNextConnection(void);
+
+/**
+ * Records the traffic of every connection into a fixed-size ring in a
+ * memory-mapped file, so it can be left on in production and the last
+ * few megabytes looked at when something goes wrong.  Each record holds a
+ * timestamp, the connection number, whether the data was read or written
+ * and the raw bytes.  When the ring is full, the oldest records are
+ * overwritten.
+ * <p>
+ * Records are added by the one thread running [NetApplication] without
+ * locks: the data is copied into the ring and then the end of the ring is
+ * moved with an atomic store, so another process can map the same file
+ * and read it while it is being written.  Nothing is written to the file
+ * with system calls; the kernel writes the mapped pages back on its own.
+ * </p>
+ * <p>
+ * The testsuite tool netcapture dumps a capture as lines or as a pcap
+ * file, and benchmark replays the inbound data of a capture through
+ * [LineObject] and [IRCObject].
+ * </p>
+ */
+@interface NetCapture : NSObject
+	{
+		NSString *path;
+		void *map;
+		unsigned long long mapLength;
+		BOOL writable;
+		unsigned long long cursor;
+	}
+/**
+ * Makes <var>aCapture</var> the capture recorded into by every
+ * [TCPTransport], or stops capturing if it is nil.
+ */
++ (void)setActiveCapture: (NetCapture *)aCapture;
+/**
+ * Returns the active capture, or nil.
+ */
++ (NetCapture *)activeCapture;
+/**
+ * Creates (or replaces) the capture file at <var>aPath</var> with a ring
+ * of <var>aSize</var> bytes and maps it for writing.  Returns nil if the
+ * file can not be created.
+ */
+- initWithFile: (NSString *)aPath size: (unsigned long long)aSize;
+/**
+ * Maps the capture file at <var>aPath</var> for reading.  Returns nil if
+ * it can not be read or is not a capture file.
+ */
+- initForReadingFile: (NSString *)aPath;
+/**
+ * Returns the path of the capture file.
+ */
+- (NSString *)path;
+/**
+ * Returns the size of the ring in bytes.
+ */
+- (unsigned long long)capacity;
+/**
+ * Moves the read cursor to the oldest record in the ring.
+ */
+- rewind;
+/**
+ * Returns the record at the read cursor and moves the cursor past it, or
+ * returns nil once there are no more.  The dictionary contains NSNumbers
+ * for the keys Time (microseconds since 1970), Connection and Type (a
+ * NetCaptureType), and a NSData for the key Data.  If the writer overwrote
+ * the record while it was being read, the cursor skips to the oldest
+ * record still in the ring.
+ */
+- (NSDictionary *)nextRecord;
+/**
+ * Returns the counters of the capture.  The dictionary contains
+ * NSNumbers for the keys Records (records ever written), Bytes (bytes
+ * of data ever written), Overwritten (records lost to newer ones),
+ * Truncated (records whose data did not fit) and Capacity.
+ */
+- (NSDictionary *)statistics;
+@end
+
+#endif
@@ -0,0 +1,111 @@
+/***************************************************************************
+                                NetCompress.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class CompressedTransport;
+
+#ifndef NET_COMPRESS_H
+#define NET_COMPRESS_H
+
+#import "NetTCP.h"
+
+@class NSString, NSDictionary, NSMutableData;
+
+/**
+ * The compression methods of [CompressedTransport].  They are single bits
+ * so that a set of them can be given as a mask.
+ */
+typedef enum
+{
+	NetCompressionNone = 0,
+	NetCompressionZlib = 1,
+	NetCompressionZstd = 2
+} NetCompressionMethod;
+
+/**
+ * A [TCPTransport] that compresses the connection with zlib or zstd.
+ * Use it by passing [CompressedTransport] as the transport class to
+ * [TCPSystem-connectNetObject:toHost:onPort:withTimeout:transportClass:]
+ * or [TCPPort-setTransportClass:]; both ends of the connection must use it.
+ * <p>
+ * Each end starts by sending a short hello listing the methods it offers
+ * (see +setDefaultMethods:), and both then use the best method offered by
+ * both, zstd before zlib.  If they have none in common, the data is sent
+ * as it is.  Data written before the hello of the other end has arrived
+ * is held back until it has.
+ * </p>
+ * <p>
+ * Writing only copies the data into a buffer.  It is compressed and
+ * flushed when [NetApplication] next reports the socket writable, which
+ * is after the current event has been dispatched, so everything written
+ * while handling one event is compressed together and nothing waits
+ * longer than that.  Received data is decompressed as it arrives.
+ * </p>
+ * <p>
+ * The statistics of [TCPTransport] count bytes on the wire; the
+ * uncompressed amounts are added by -statistics.
+ * </p>
+ */
+@interface CompressedTransport : TCPTransport
+	{
+		void *compressor;
+		void *decompressor;
+		NSMutableData *plainBuffer;
+		NSMutableData *hello;
+		unsigned offered;
+		NetCompressionMethod method;
+		BOOL negotiated;
+		unsigned long long plainBytesRead;
+		unsigned long long plainBytesWritten;
+	}
+/**
+ * Returns the mask of methods netclasses was built with.
+ */
++ (unsigned)availableMethods;
+/**
+ * Sets the mask of methods offered by transports created from now on.
+ * Methods that are not available are ignored.  By default every
+ * available method is offered.
+ */
++ (void)setDefaultMethods: (unsigned)aMask;
+/**
+ * Returns the mask of methods offered by new transports.
+ */
++ (unsigned)defaultMethods;
+/**
+ * Sets the compression level used by transports created from now on.
+ * Zero (the default) uses the default level of the method.
+ */
++ (void)setCompressionLevel: (int)aLevel;
+/**
+ * Returns YES once the hello of the other end has been received.
+ */
+- (BOOL)isNegotiated;
+/**
+ * Returns the method in use, or NetCompressionNone if there is none or it
+ * has not been negotiated yet.
+ */
+- (NetCompressionMethod)method;
+/**
+ * Returns the statistics of [TCPTransport] with the keys Method (zlib,
+ * zstd or none), UncompressedBytesRead, UncompressedBytesWritten and
+ * CompressionRatio (uncompressed bytes per byte on the wire, both
+ * directions together) added.
+ */
+- (NSDictionary *)statistics;
+@end
+
+#endif
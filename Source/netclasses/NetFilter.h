@@ -0,0 +1,163 @@
+/***************************************************************************
+                                NetFilter.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class NetFilter, NetRateFilter;
+
+#ifndef NET_FILTER_H
+#define NET_FILTER_H
+
+#import "NetTCP.h"
+
+@class NSArray, NSMutableData, NSTimer;
+
+/**
+ * One stage of the filter stack of a [TCPTransport].  Data read from the
+ * connection goes up the stack from the filter nearest the connection to
+ * the net object, and data written by the net object goes down it, so
+ * filters can change, hold back or count the data without the net object
+ * knowing about them.
+ * <p>
+ * Data is passed between filters as a pointer and a length that are only
+ * valid during the call, never as a new NSData.  A filter that passes the
+ * data on unchanged costs no copy; one that changes it passes on its own
+ * buffer.  Data going up is copied once, into the NSData given to
+ * [(NetObject)-dataReceived:] (and not at all if no filter changed it),
+ * and data going down is copied once, into the write buffer of the
+ * transport.  A filter that holds data back must copy it.
+ * </p>
+ * <p>
+ * NetFilter itself passes everything on unchanged.  Subclasses override
+ * -receiveBytes:length: and -sendBytes:length: and call
+ * -passUpBytes:length: and -passDownBytes:length: with the result.
+ * [NetApplication] calls -flush on every filter, from the top down, at
+ * the end of each event it dispatches for the transport.
+ * </p>
+ */
+@interface NetFilter : NSObject
+	{
+		TCPTransport *transport;
+		NetFilter *above;
+		NetFilter *below;
+		BOOL readingPaused;
+	}
+/**
+ * Returns the transport the filter is in, or nil.
+ */
+- (TCPTransport *)transport;
+/**
+ * Called with data coming up from the connection.  Passes it on with
+ * -passUpBytes:length: by default.
+ */
+- receiveBytes: (const char *)bytes length: (unsigned)length;
+/**
+ * Called with data going down to the connection.  Passes it on with
+ * -passDownBytes:length: by default.
+ */
+- sendBytes: (const char *)bytes length: (unsigned)length;
+/**
+ * Passes data up to the filter above, or to the net object if this is
+ * the top filter.
+ */
+- passUpBytes: (const char *)bytes length: (unsigned)length;
+/**
+ * Passes data down to the filter below, or into the write buffer of the
+ * transport if this is the bottom filter.
+ */
+- passDownBytes: (const char *)bytes length: (unsigned)length;
+/**
+ * Called at the end of each event dispatched for the transport.  A filter
+ * holding back data it may now pass on does so here.  Does nothing by
+ * default.
+ */
+- flush;
+/**
+ * Signals backpressure: stops [NetApplication] reading from the
+ * connection until -resumeReading is called, for example while the
+ * filter holds too much data.  Each filter pauses reading at most once.
+ */
+- pauseReading;
+/**
+ * Undoes -pauseReading.
+ */
+- resumeReading;
+/**
+ * Returns YES if the filter has paused reading.
+ */
+- (BOOL)isReadingPaused;
+/**
+ * Called when the filter is removed from its transport or the transport
+ * is closed.  Subclasses stop their timers here and must call the
+ * implementation of NetFilter, which resumes reading if it was paused.
+ */
+- removedFromTransport;
+@end
+
+/**
+ * Manages the filter stack of a [TCPTransport].
+ */
+@interface TCPTransport (Filters) < NetFilteredTransport >
+/**
+ * Adds <var>aFilter</var> to the top of the stack, nearest the net
+ * object.  Throws a NetException if it is already in a stack.
+ */
+- pushFilter: (NetFilter *)aFilter;
+/**
+ * Removes <var>aFilter</var> from the stack.
+ */
+- removeFilter: (NetFilter *)aFilter;
+/**
+ * Returns the filters from the bottom (nearest the connection) to the top,
+ * or nil if there are none.
+ */
+- (NSArray *)filters;
+- (BOOL)hasFilters;
+- deliverData: (NSData *)data toObject: (id <NetObject>)anObject;
+- flushFilters;
+@end
+
+/**
+ * A filter that limits the data written to the connection to a number of
+ * bytes per second.  Data over the limit is held back and passed on by a
+ * timer.  While more than the high water mark is held, reading from the
+ * connection is paused, so a net object that writes in response to what
+ * it reads is slowed down too.
+ */
+@interface NetRateFilter : NetFilter
+	{
+		double rate;
+		double credit;
+		uint64_t refilled;
+		NSMutableData *held;
+		unsigned highWaterMark;
+		NSTimer *timer;
+	}
+/**
+ * Initializes the filter to pass on at most <var>bytesPerSecond</var>.
+ */
+- initWithBytesPerSecond: (double)bytesPerSecond;
+/**
+ * Sets the amount of held data over which reading is paused.  The default
+ * is one second of data.  Reading resumes once half of it is left.
+ */
+- setHighWaterMark: (unsigned)aLength;
+/**
+ * Returns the number of bytes held back.
+ */
+- (unsigned)heldLength;
+@end
+
+#endif
@@ -0,0 +1,99 @@
+/***************************************************************************
+                                NetHistogram.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class NetHistogram;
+
+#ifndef NET_HISTOGRAM_H
+#define NET_HISTOGRAM_H
+
+#import <Foundation/NSObject.h>
+
+#include <stdint.h>
+
+@class NSDictionary;
+
+/**
+ * The number of linear sub-buckets in each power of two range of a
+ * [NetHistogram].  Sixteen sub-buckets keep the relative error of any
+ * recorded value below 6.25%.
+ */
+#define NET_HISTOGRAM_SUB_BUCKETS 16
+/**
+ * The total number of buckets in a [NetHistogram].  This covers values
+ * up to 2^40 which, in microseconds, is well over a week.
+ */
+#define NET_HISTOGRAM_BUCKETS (NET_HISTOGRAM_SUB_BUCKETS * 38)
+
+/**
+ * Returns the current time of the monotonic clock in microseconds.  This
+ * clock is not affected by changes to the system time and is used to
+ * timestamp dispatches in [NetApplication].
+ */
+uint64_t NetMonotonicMicroseconds(void);
+
+/**
+ * NetHistogram records integer values (typically durations in microseconds)
+ * into a fixed number of logarithmically sized buckets in the style of
+ * an HDR histogram.  Recording a value never allocates memory, so a
+ * histogram can be left enabled on busy connections.
+ */
+@interface NetHistogram : NSObject
+	{
+		uint64_t counts[NET_HISTOGRAM_BUCKETS];
+		uint64_t total;
+		uint64_t minValue;
+		uint64_t maxValue;
+		double sum;
+	}
+/**
+ * Records one occurrence of <var>aValue</var>.
+ */
+- (void)recordValue: (uint64_t)aValue;
+/**
+ * Returns the number of values recorded.
+ */
+- (uint64_t)count;
+/**
+ * Returns the smallest value recorded, or zero if nothing was recorded.
+ */
+- (uint64_t)minValue;
+/**
+ * Returns the largest value recorded, or zero if nothing was recorded.
+ */
+- (uint64_t)maxValue;
+/**
+ * Returns the arithmetic mean of the recorded values.
+ */
+- (double)mean;
+/**
+ * Returns the value below which <var>aPercentile</var> percent of the
+ * recorded values fall.  <var>aPercentile</var> should be between 0 and
+ * 100.  The result is the upper bound of the bucket holding that value.
+ */
+- (uint64_t)valueAtPercentile: (double)aPercentile;
+/**
+ * Discards all recorded values.
+ */
+- (void)reset;
+/**
+ * Returns a dictionary of NSNumbers with the keys Count, Min, Max, Mean,
+ * P50, P90, P99 and P999.
+ */
+- (NSDictionary *)summary;
+@end
+
+#endif
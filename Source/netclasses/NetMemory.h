@@ -0,0 +1,166 @@
+/***************************************************************************
+                                NetMemory.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class MemoryTransport, MemoryDriver;
+
+#ifndef NET_MEMORY_H
+#define NET_MEMORY_H
+
+#import "NetBase.h"
+#import <Foundation/NSObject.h>
+
+#include <stdint.h>
+
+@class NSMutableArray, NSMutableData, NSString, NSArray, NSData;
+
+/**
+ * A MemoryTransport is one end of an in-memory connection created by
+ * [MemoryDriver-createTransportPair].  Whatever is written to one end
+ * is read from the other without any sockets or system calls.  The
+ * settings of a transport (chunk size, latency, bandwidth and window)
+ * apply to the data it sends.  All times are in microseconds of the
+ * virtual clock kept by its [MemoryDriver].
+ *
+ * A MemoryTransport has no descriptor, so -desc returns -1 and
+ * [NetApplication] leaves it to the [MemoryDriver] to deliver data.
+ */
+@interface MemoryTransport : NSObject < NetTransport >
+	{
+		MemoryDriver *driver;
+		MemoryTransport *peer;
+		NSString *name;
+		NSMutableArray *segments;
+		NSMutableData *writeBuffer;
+		unsigned chunkSize;
+		unsigned window;
+		unsigned inFlight;
+		uint64_t latency;
+		double bandwidth;
+		uint64_t linkFree;
+		BOOL connected;
+		BOOL peerClosed;
+	}
+/**
+ * Splits the data sent through this transport into pieces of at most
+ * <var>aSize</var> bytes, each arriving (and being read) separately.  A
+ * <var>aSize</var> of zero sends each -writeData: in one piece, which is
+ * the default.
+ */
+- setChunkSize: (unsigned)aSize;
+- (unsigned)chunkSize;
+/**
+ * Delays the arrival of every piece of data sent through this transport
+ * by <var>microseconds</var>.
+ */
+- setLatency: (uint64_t)microseconds;
+- (uint64_t)latency;
+/**
+ * Limits the data sent through this transport to
+ * <var>bytesPerSecond</var>.  Zero, the default, means unlimited.
+ */
+- setBandwidth: (double)bytesPerSecond;
+- (double)bandwidth;
+/**
+ * Limits the data sent through this transport and not yet read by the
+ * other end to <var>aSize</var> bytes.  Anything more waits in the write
+ * buffer of this transport, as it would if the socket buffer of a real
+ * connection were full, and -isDoneWriting returns NO.  Zero, the default,
+ * means unlimited.
+ */
+- setWindow: (unsigned)aSize;
+- (unsigned)window;
+/**
+ * Returns the other end of the connection.
+ */
+- (MemoryTransport *)peer;
+/**
+ * Returns the number of bytes waiting in the write buffer because of the
+ * window.
+ */
+- (unsigned)writeBufferLength;
+/**
+ * Returns YES if data has arrived and can be read with -readData:.
+ */
+- (BOOL)hasDataAvailable;
+/**
+ * Returns YES if the other end is closed and everything it sent has been
+ * read.
+ */
+- (BOOL)isAtEnd;
+/**
+ * Returns the time at which the next piece of data in flight will
+ * arrive, or zero if there is none.
+ */
+- (uint64_t)nextArrival;
+@end
+
+/**
+ * A MemoryDriver creates pairs of [MemoryTransport] objects and delivers
+ * their data to the net objects using them in place of the run loop.  It
+ * keeps a virtual clock that only moves when told to, so latency and
+ * bandwidth limits behave exactly the same way on every run.
+ *
+ * To use it, create a pair with -createTransportPair, give each end to a
+ * net object with [(NetObject)-connectionEstablished:], then call
+ * -runUntilIdle or -runUntilQuiet.  Net objects receive data, are
+ * disconnected and have exceptions handled the same way as with
+ * [NetApplication].
+ */
+@interface MemoryDriver : NSObject
+	{
+		NSMutableArray *transports;
+		uint64_t now;
+		unsigned pairs;
+		unsigned long long dispatches;
+	}
+/**
+ * Returns an array holding two connected [MemoryTransport] objects.
+ */
+- (NSArray *)createTransportPair;
+/**
+ * Returns the current time of the virtual clock in microseconds.  The
+ * clock starts at zero.
+ */
+- (uint64_t)currentTime;
+/**
+ * Makes a single pass over every transport: flushes write buffers,
+ * delivers one piece of arrived data to the net object of each transport
+ * and disconnects net objects whose other end has closed.  Returns YES if
+ * anything was done.
+ */
+- (BOOL)pump;
+/**
+ * Calls -pump until nothing more can be done without moving the clock.
+ */
+- runUntilIdle;
+/**
+ * Moves the clock forward by <var>microseconds</var>, running until idle
+ * each time a piece of data arrives on the way.
+ */
+- advanceTime: (uint64_t)microseconds;
+/**
+ * Runs until idle and moves the clock to each following arrival until
+ * there is no data left in flight.
+ */
+- runUntilQuiet;
+/**
+ * Returns the number of -dataReceived: messages sent so far.
+ */
+- (unsigned long long)dispatchCount;
+@end
+
+#endif
@@ -0,0 +1,142 @@
+/***************************************************************************
+                                NetMetrics.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class NetMetricsServer, NetMetricsConnection;
+
+#ifndef NET_METRICS_H
+#define NET_METRICS_H
+
+#import "NetBase.h"
+#import "NetTCP.h"
+#import <Foundation/NSObject.h>
+
+@class NSString, NSDictionary, NSMutableData, NSTimer;
+
+/**
+ * Counters summed over every [TCPTransport], kept up to date as the
+ * transports read and write so that they can be reported without
+ * visiting every connection.  Updated on the run loop thread.
+ */
+typedef struct
+{
+	unsigned long long bytesRead;
+	unsigned long long bytesWritten;
+	unsigned long long readCalls;
+	unsigned long long writeCalls;
+} NetTransportCounters;
+
+/**
+ * The totals of every [TCPTransport] since startup.
+ */
+extern NetTransportCounters NetTransportTotals;
+
+/**
+ * YES while the command counters of every [IRCObject] are added to the
+ * metrics.  Each [NetMetricsServer] turns it on, and releasing the last
+ * one turns it off again.  Off by default, so counters are only summed
+ * while they can be reported.
+ */
+extern BOOL NetMetricsCountsCommands;
+
+/**
+ * The lines of one connection counted by command.  Only a fixed set of
+ * well known commands and numerics is counted by name; every other
+ * command, whatever the other end sends, is counted as
+ * <code>other</code>, so the counters never grow.
+ */
+typedef struct NetCommandCounters NetCommandCounters;
+
+/**
+ * Returns new counters, all zero.  Can be called from any thread.
+ */
+NetCommandCounters *NetMetricsNewCommandCounters(void);
+
+/**
+ * Frees <var>counters</var>, adding what they counted to the metrics
+ * totals if they were included in the metrics.  Can be called from any
+ * thread.
+ */
+void NetMetricsFreeCommandCounters(NetCommandCounters *counters);
+
+/**
+ * Counts one line in <var>counters</var>, received if
+ * <var>inbound</var> is YES and sent otherwise.  The command is the
+ * first word of the <var>length</var> bytes at <var>command</var>.
+ * While NetMetricsCountsCommands is YES the counters are also included
+ * in the metrics from then on.  The count is atomic, so lines can be
+ * counted from any thread, such as the threads of a [NetWorkerPool].
+ */
+void NetMetricsCountCommand(NetCommandCounters *counters,
+  const char *command, unsigned length, BOOL inbound);
+
+/**
+ * Returns the lines counted in <var>counters</var> as NSNumbers keyed by
+ * command, with <code>other</code> for the rest, received if
+ * <var>inbound</var> is YES and sent otherwise.  Commands never counted
+ * are left out.
+ */
+NSDictionary *NetMetricsCommandCounts(NetCommandCounters *counters,
+  BOOL inbound);
+
+/**
+ * A port serving the counters of netclasses over HTTP/1.0 in the
+ * Prometheus text format, for a metrics scraper.  A GET of
+ * <code>/metrics</code> (or of <code>/</code>) returns +renderMetrics;
+ * anything else gets an error.  Each request gets one response, after
+ * which the connection is closed.
+ * <p>
+ * Every value comes from a counter that is kept up to date as it
+ * changes: the [NetApplication-statistics], the NetTransportTotals, the
+ * write buffers of connections waiting to write, the histograms of the
+ * [NetApplication] instrumentation (the loop lag and handler durations,
+ * once [NetApplication-setInstrumentationEnabled:] turns it on), the
+ * [NetBufferPool] and [NetObjectPool] counters and the lines of every
+ * [IRCObject] by command, summed from the counters of each connection.
+ * Apart from those sums, rendering never visits the connections that
+ * have nothing waiting to be written, so it stays cheap with tens of
+ * thousands of them.
+ * </p>
+ * <p>
+ * The server is an ordinary [TCPPort], so -initOnHost:onPort: binds it,
+ * usually to the loopback address.  While any server exists the lines
+ * of every [IRCObject] are counted by command; releasing the last one
+ * stops that.
+ * </p>
+ */
+@interface NetMetricsServer : TCPPort
+	{
+		BOOL countsCommands;
+	}
+/**
+ * Returns the metrics in the Prometheus text exposition format.
+ */
++ (NSString *)renderMetrics;
+@end
+
+/**
+ * One HTTP/1.0 connection to a [NetMetricsServer].  Created by the
+ * server for each connection; applications do not create these.
+ */
+@interface NetMetricsConnection : NSObject < NetWritingObject >
+	{
+		id <NetTransport> transport;
+		NSMutableData *request;
+		NSTimer *closeTimer;
+	}
+@end
+
+#endif
@@ -0,0 +1,202 @@
+/***************************************************************************
+                                NetPool.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class NetBufferPool, NetObjectPool;
+
+#ifndef NET_POOL_H
+#define NET_POOL_H
+
+#import <Foundation/NSObject.h>
+
+#include <pthread.h>
+
+@class NSMutableArray, NSMutableData, NSDictionary;
+
+/**
+ * The number of size classes of a [NetBufferPool].
+ */
+#define NET_BUFFER_CLASSES 3
+
+/**
+ * A class whose instances can be handed back to a [NetObjectPool] once
+ * their owner is done with them and initialized again in place of new
+ * ones.
+ */
+@protocol NetRecycling
+/**
+ * Returns YES if instances of this class are recycled.  A subclass with
+ * state of its own should return NO unless its -prepareForReuse resets
+ * that state too.
+ */
++ (BOOL)recyclesInstances;
+/**
+ * Called by the pool when the object is handed back, before it is kept.
+ * Closes and releases everything the object holds and puts it back in
+ * the state it had straight after +alloc, apart from anything the init
+ * method sets anyway, so the next init starts from scratch.
+ */
+- (void)prepareForReuse;
+@end
+
+/**
+ * A pool of NSMutableData buffers in a few size classes (2KB, 16KB and
+ * 128KB).  Buffers are returned with -recycleBuffer:capacity: once their
+ * owner is done with them (a [TCPTransport] returns its write buffer when
+ * it is closed) and handed out again by -newBufferWithCapacity:, so
+ * connection churn reuses the same few allocations instead of
+ * fragmenting the heap.
+ * <p>
+ * Each class keeps at most -limit buffers.  A buffer is kept in the
+ * smallest class that covers its capacity; buffers beyond the limit, and
+ * buffers grown past the largest class, are freed, so idle buffers never
+ * hold more than their class.  The pool can be used from any thread.
+ * </p>
+ */
+@interface NetBufferPool : NSObject
+	{
+		pthread_mutex_t lock;
+		NSMutableArray *idle[NET_BUFFER_CLASSES];
+		unsigned limit;
+		unsigned long long hits;
+		unsigned long long misses;
+		unsigned long long recycled;
+		unsigned long long discarded;
+	}
+/**
+ * Returns the pool used by netclasses.
+ */
++ (NetBufferPool *)sharedPool;
+/**
+ * Returns an empty buffer that can hold at least <var>aCapacity</var>
+ * bytes without growing, from the pool if it has one.  The buffer is
+ * retained, as with +new; pass it to -recycleBuffer:capacity: instead of
+ * releasing it.
+ */
+- (NSMutableData *)newBufferWithCapacity: (unsigned)aCapacity;
+/**
+ * Takes over <var>aBuffer</var>, which may hold up to
+ * <var>aCapacity</var> bytes without growing (for a buffer from
+ * -newBufferWithCapacity:, the larger of the capacity asked for and the
+ * most it has held).  Its contents are discarded.
+ */
+- (void)recycleBuffer: (NSMutableData *)aBuffer capacity: (unsigned)aCapacity;
+/**
+ * Sets the most buffers kept in each size class.  The default is 256.
+ */
+- setLimit: (unsigned)aLimit;
+/**
+ * Returns the most buffers kept in each size class.
+ */
+- (unsigned)limit;
+/**
+ * Returns a dictionary of NSNumbers with the keys Hits (buffers handed
+ * out from the pool), Misses (buffers allocated), HitRate (hits as a
+ * fraction of both), Recycled, Discarded (buffers freed instead of
+ * kept), Idle (buffers in the pool), IdleBytes (their combined size
+ * classes) and Limit.
+ */
+- (NSDictionary *)statistics;
+@end
+
+/**
+ * A pool of the instances of one class conforming to
+ * <code>NetRecycling</code>.  Objects are allocated with
+ * +allocInstanceOfClass:, and the owner of an object hands it back with
+ * +recycleInstance: once it is done with it, so under churn the same
+ * objects are used over and over.  No class of netclasses recycles its
+ * instances: transports and net objects are reachable from posted writes
+ * and worker pool queues long after their connection is lost.  Classes
+ * whose owner knows when the last use has passed can opt in by
+ * implementing the protocol.
+ * <p>
+ * Handing an object back gives up the reference of the caller, which
+ * must be the last one: nothing may use the object afterwards.  It is
+ * emptied with [(NetRecycling)-prepareForReuse] straight away.  At most
+ * -limit objects are kept; beyond that they are released and freed as
+ * usual.  The pool can be used from any thread.
+ * </p>
+ */
+@interface NetObjectPool : NSObject
+	{
+		pthread_mutex_t lock;
+		Class objectClass;
+		NSMutableArray *objects;
+		unsigned limit;
+		unsigned long long hits;
+		unsigned long long misses;
+		unsigned long long recycled;
+		unsigned long long discarded;
+	}
+/**
+ * Returns the pool of <var>aClass</var>, creating it if needed.
+ */
++ (NetObjectPool *)poolForClass: (Class)aClass;
+/**
+ * Returns YES if <var>aClass</var> conforms to
+ * <code>NetRecycling</code> and its +recyclesInstances returns YES.
+ */
++ (BOOL)recyclesInstancesOfClass: (Class)aClass;
+/**
+ * Returns an uninitialized instance of <var>aClass</var>, as +alloc
+ * does, taken from its pool if <var>aClass</var> recycles its instances.
+ */
++ (id)allocInstanceOfClass: (Class)aClass;
+/**
+ * Hands <var>anObject</var> back to the pool of its class if the class
+ * recycles its instances, and releases it otherwise.  Either way the
+ * reference of the caller is given up; it must be the last one.
+ */
++ (void)recycleInstance: (id)anObject;
+/**
+ * Returns a dictionary of the -statistics of every pool, keyed by the
+ * name of its class.
+ */
++ (NSDictionary *)statistics;
+/**
+ * Initializes a pool for the instances of <var>aClass</var>.
+ */
+- initWithClass: (Class)aClass;
+/**
+ * Returns an uninitialized instance, either one handed back with
+ * -recycleObject: or a new one from +alloc.  Send it an init method as
+ * usual.
+ */
+- (id)allocObject;
+/**
+ * Takes over the last reference to <var>anObject</var>, calls its
+ * [(NetRecycling)-prepareForReuse] and keeps it for -allocObject, or
+ * releases it if -limit objects are already kept.
+ */
+- (void)recycleObject: (id)anObject;
+/**
+ * Sets the most objects kept.  The default is 256.
+ */
+- setLimit: (unsigned)aLimit;
+/**
+ * Returns the most objects kept.
+ */
+- (unsigned)limit;
+/**
+ * Returns a dictionary of NSNumbers with the keys Hits (objects reused),
+ * Misses (objects allocated), HitRate (hits as a fraction of both),
+ * Recycled, Discarded (objects released instead of kept), Kept (objects
+ * in the pool) and Limit.
+ */
+- (NSDictionary *)statistics;
+@end
+
+#endif
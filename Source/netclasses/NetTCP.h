@@ -15,7 +15,7 @@
  *                                                                         *
  ***************************************************************************/
 
-@class TCPSystem, TCPConnecting, TCPPort, TCPTransport;
+@class TCPSystem, TCPConnecting, TCPPort, TCPTransport, TCPSocketOptions;
 
 #ifndef NET_TCP_H
 #define NET_TCP_H
@@ -66,6 +66,147 @@ extern NSString *NetclassesErrorAborted;
 - connectingStarted: (TCPConnecting *)aConnection;
 @end
 
+/**
+ * A set of socket options for [TCPPort] and [TCPTransport].  Every option
+ * starts out unset, and an unset option is left as the system has it, so
+ * one set of options can be applied over another to change only what it
+ * sets.  The getters return -1 for an unset option.
+ * <p>
+ * Ports pass their options on to the connections they accept, which can
+ * then override them with [TCPTransport-setSocketOptions:].
+ * -setDeferAccept: and -setFastOpen: only apply to ports.  Options the
+ * system does not have fail with ENOPROTOOPT when applied.
+ * </p>
+ */
+@interface TCPSocketOptions : NSObject < NSCopying >
+	{
+		int noDelay;
+		int sendBufferSize;
+		int receiveBufferSize;
+		int notSentLowWater;
+		int keepAlive;
+		int keepAliveIdle;
+		int keepAliveInterval;
+		int keepAliveCount;
+		int userTimeout;
+		int deferAccept;
+		int fastOpen;
+	}
+/**
+ * Returns a new autoreleased set of options with nothing set.
+ */
++ (TCPSocketOptions *)options;
+/**
+ * Turns Nagle's algorithm off (TCP_NODELAY) if <var>aFlag</var> is YES,
+ * so small writes go out without waiting for the data before them to be
+ * acknowledged.  Interactive traffic such as IRC wants this.
+ */
+- setNoDelay: (BOOL)aFlag;
+/**
+ * Returns 1 if TCP_NODELAY is turned on, 0 if it is turned off.
+ */
+- (int)noDelay;
+/**
+ * Sets the size in bytes of the kernel send buffer (SO_SNDBUF).
+ */
+- setSendBufferSize: (int)aSize;
+/**
+ * Returns the size set with -setSendBufferSize:.
+ */
+- (int)sendBufferSize;
+/**
+ * Sets the size in bytes of the kernel receive buffer (SO_RCVBUF).  On a
+ * port this is set before it listens, so that accepted connections can
+ * use a matching window.
+ */
+- setReceiveBufferSize: (int)aSize;
+/**
+ * Returns the size set with -setReceiveBufferSize:.
+ */
+- (int)receiveBufferSize;
+/**
+ * Sets how many bytes may wait unsent in the send buffer before the
+ * socket stops being writable (TCP_NOTSENT_LOWAT), which keeps data queued
+ * in netclasses, where it can still be batched, rather than in the kernel.
+ */
+- setNotSentLowWater: (int)aCount;
+/**
+ * Returns the count set with -setNotSentLowWater:.
+ */
+- (int)notSentLowWater;
+/**
+ * Turns keepalive probes (SO_KEEPALIVE) on or off.  Ports turn them on
+ * unless this turns them off.
+ */
+- setKeepAlive: (BOOL)aFlag;
+/**
+ * Returns 1 if keepalive probes are turned on, 0 if they are turned off.
+ */
+- (int)keepAlive;
+/**
+ * Sets the seconds a connection is idle before the first keepalive probe
+ * (TCP_KEEPIDLE), the seconds between probes (TCP_KEEPINTVL) and the
+ * number of unanswered probes after which the connection is dropped
+ * (TCP_KEEPCNT).  Arguments of -1 are left unset.
+ */
+- setKeepAliveIdle: (int)idle interval: (int)interval count: (int)count;
+/**
+ * Returns the idle time set with -setKeepAliveIdle:interval:count:.
+ */
+- (int)keepAliveIdle;
+/**
+ * Returns the interval set with -setKeepAliveIdle:interval:count:.
+ */
+- (int)keepAliveInterval;
+/**
+ * Returns the count set with -setKeepAliveIdle:interval:count:.
+ */
+- (int)keepAliveCount;
+/**
+ * Sets the milliseconds written data may stay unacknowledged before the
+ * connection is dropped (TCP_USER_TIMEOUT).
+ */
+- setUserTimeout: (int)milliseconds;
+/**
+ * Returns the timeout set with -setUserTimeout:.
+ */
+- (int)userTimeout;
+/**
+ * Lets a port hold back accepting a connection until data arrives on it,
+ * for up to <var>seconds</var> (TCP_DEFER_ACCEPT).
+ */
+- setDeferAccept: (int)seconds;
+/**
+ * Returns the time set with -setDeferAccept:.
+ */
+- (int)deferAccept;
+/**
+ * Lets a port accept data in the SYN of up to <var>aLength</var> pending
+ * TCP Fast Open connections (TCP_FASTOPEN).
+ */
+- setFastOpen: (int)aLength;
+/**
+ * Returns the length set with -setFastOpen:.
+ */
+- (int)fastOpen;
+/**
+ * Returns a new autoreleased set of options with the options set in
+ * <var>overrides</var> and, for the rest, those set in the receiver.
+ */
+- (TCPSocketOptions *)optionsOverriddenBy: (TCPSocketOptions *)overrides;
+/**
+ * Sets the options that apply to a connection on the socket
+ * <var>aDesc</var>.  Returns NO, with the error string and error number
+ * of [TCPSystem] set, if one of them cannot be set.
+ */
+- (BOOL)applyToDesc: (int)aDesc;
+/**
+ * Like -applyToDesc:, but also sets the options that only apply to
+ * listening sockets.
+ */
+- (BOOL)applyToListeningDesc: (int)aDesc;
+@end
+
 /** 
  * Used for certain operations in the TCP/IP system.  There is only one
  * instance of this class at a time, used +sharedInstance to get this
@@ -75,6 +216,7 @@ extern NSString *NetclassesErrorAborted;
 	{
 		NSString *errorString;
 		int errorNumber;
+		TCPSocketOptions *defaultOptions;
 	}
 /**
  * Returns the one instance of TCPSystem currently in existence.
@@ -91,6 +233,19 @@ extern NSString *NetclassesErrorAborted;
  * accordingly.
  */
 - (int)errorNumber;
+/**
+ * Sets the options of every connection made with
+ * -connectNetObject:toHost:onPort:withTimeout: and the methods like it
+ * from now on, set before connecting, and the initial options of every
+ * [TCPPort] created with -initOnHost:onPort:.  A nil
+ * <var>options</var> (the default) leaves every socket as the system
+ * makes it.
+ */
+- setDefaultSocketOptions: (TCPSocketOptions *)options;
+/**
+ * Returns the options set with -setDefaultSocketOptions:.
+ */
+- (TCPSocketOptions *)defaultSocketOptions;
 
 /** 
  * Will connect the object <var>netObject</var> to host <var>aHost</var>
@@ -112,6 +267,44 @@ extern NSString *NetclassesErrorAborted;
 - (TCPConnecting *)connectNetObjectInBackground: (id <NetObject>)netObject
     toHost: (NSHost *)aHost onPort: (uint16_t)aPort withTimeout: (int)aTimeout;
 
+/**
+ * Like -connectNetObject:toHost:onPort:withTimeout: but the connection
+ * uses a transport of class <var>aClass</var>, which must be
+ * [TCPTransport] or a subclass of it (such as [TLSTransport]).
+ */
+- (id <NetObject>)connectNetObject: (id <NetObject>)netObject 
+    toHost: (NSHost *)aHost onPort: (uint16_t)aPort 
+    withTimeout: (int)aTimeout transportClass: (Class)aClass;
+
+/**
+ * Like -connectNetObjectInBackground:toHost:onPort:withTimeout: but the
+ * connection uses a transport of class <var>aClass</var>, which must be
+ * [TCPTransport] or a subclass of it.
+ */
+- (TCPConnecting *)connectNetObjectInBackground: (id <NetObject>)netObject
+    toHost: (NSHost *)aHost onPort: (uint16_t)aPort 
+    withTimeout: (int)aTimeout transportClass: (Class)aClass;
+
+/**
+ * Calls -adoptDescriptor:withNetObjectClass:transportClass: with
+ * [TCPTransport] as the transport class.
+ */
+- (id <NetObject>)adoptDescriptor: (int)aDesc 
+    withNetObjectClass: (Class)aClass;
+
+/**
+ * Takes over the connected socket <var>aDesc</var>, such as one accepted
+ * by another process and received with
+ * [UnixTransport-takeReceivedDescriptor].  A transport of class
+ * <var>transportClass</var> (which must be [TCPTransport] or a subclass of
+ * it) is created for it as if it had been accepted by a [TCPPort], and a
+ * new instance of <var>aClass</var> is connected to it.  Returns the new
+ * object, or nil if an error occurs, in which case the error string and
+ * error number are set and <var>aDesc</var> is left open.
+ */
+- (id <NetObject>)adoptDescriptor: (int)aDesc 
+    withNetObjectClass: (Class)aClass transportClass: (Class)transportClass;
+
 /**
  * Returns a host order 32-bit integer from a host
  * Returns YES on success and NO on failure, the result is stored in the
@@ -147,6 +340,7 @@ extern NSString *NetclassesErrorAborted;
 		id <NetTransport>transport;
 		id netObject;
 		NSTimer *timeout;
+		Class transportClass;
 	}
 /**
  * Returns the object that will be connected by this placeholder object.
@@ -194,13 +388,22 @@ extern NSString *NetclassesErrorAborted;
     {
 		int desc;
 		Class netObjectClass;
+		Class transportClass;
 		uint16_t port;
 		BOOL connected;
+		TCPSocketOptions *socketOptions;
 	}
 /**
  * Calls -initOnHost:onPort: with a nil argument for the host.
  */
 - initOnPort: (uint16_t)aPort;
+/**
+ * Like -initOnHost:onPort:, but the port is set up with
+ * <var>options</var> instead of the [TCPSystem-defaultSocketOptions]
+ * before it starts listening.  Returns nil if an option cannot be set.
+ */
+- initOnHost: (NSHost *)aHost onPort: (uint16_t)aPort
+   socketOptions: (TCPSocketOptions *)options;
 /** 
  * Initializes a port on <var>aHost</var> and binds it to port <var>aPort</var>.
  * If <var>aHost</var> is nil, it will set it up on all addresses on the local
@@ -220,6 +423,28 @@ extern NSString *NetclassesErrorAborted;
  * protocol, will throw a FatalNetException.
  */
 - setNetObject: (Class)aClass;
+/**
+ * Sets the class of the transport created for each new connection on this
+ * port.  <var>aClass</var> must be [TCPTransport] (the default) or a
+ * subclass of it, otherwise a FatalNetException is thrown.  Each
+ * transport is created with [TCPTransport-initWithAcceptedDesc:withRemoteHost:].
+ */
+- setTransportClass: (Class)aClass;
+/**
+ * Returns the class of the transport created for new connections.
+ */
+- (Class)transportClass;
+/**
+ * Sets the options of the port and of the connections it accepts from
+ * now on, which get them with [TCPTransport-setSocketOptions:] before
+ * they are handed to their net object.  Returns NO, with the error of
+ * [TCPSystem] set, if one cannot be set on the port.
+ */
+- (BOOL)setSocketOptions: (TCPSocketOptions *)options;
+/**
+ * Returns the options of the port, or nil if it has none.
+ */
+- (TCPSocketOptions *)socketOptions;
 /**
  * Returns the low-level file descriptor for the port.
  */
@@ -237,12 +462,43 @@ extern NSString *NetclassesErrorAborted;
  * of the class set with -setNetObject: with the new connection.
  */
 - newConnection;
+/**
+ * Sets up the connection <var>aDesc</var> already accepted on the port,
+ * as -newConnection does once it has accepted it.  <var>anAddress</var>
+ * is the address of the other end, or NULL to look it up.  Used by the
+ * io_uring backend of [NetApplication], which accepts on its own.
+ */
+- newConnectionWithDesc: (int)aDesc
+   fromAddress: (const struct sockaddr_in *)anAddress;
 @end
 
+/**
+ * When a [TCPTransport] sends data written to it while nothing is waiting
+ * to be sent, set with [TCPTransport-setWriteStrategy:].
+ * <deflist>
+ * <term>NetWriteDeferred</term><desc>on a later run loop iteration, once
+ * the run loop reports the socket writable (the default)</desc>
+ * <term>NetWriteImmediate</term><desc>right away, with a non-blocking
+ * send</desc>
+ * <term>NetWriteEndOfDispatch</term><desc>with one non-blocking send once
+ * [NetApplication] has handled the event being dispatched, so every
+ * write made while handling it goes out together (see
+ * [NetApplication-flushTransportAfterDispatch:])</desc>
+ * </deflist>
+ * Whatever cannot be sent right away waits for the socket to become
+ * writable, as with NetWriteDeferred.
+ */
+typedef enum { NetWriteDeferred, NetWriteImmediate, NetWriteEndOfDispatch }
+  NetWriteStrategy;
+
 /**
  * Handles the actual TCP/IP transfer of data.  When an instance of this
  * object is deallocated, the descriptor will be closed if not already
  * closed.
+ * <p>
+ * The write buffer comes from the [NetBufferPool] and goes back to it
+ * when the transport is closed.
+ * </p>
  */
 @interface TCPTransport : NSObject < NetTransport >
     {
@@ -251,13 +507,51 @@ extern NSString *NetclassesErrorAborted;
 		NSMutableData *writeBuffer;
 		NSHost *remoteHost;
 		NSHost *localHost;
+
+		unsigned long long bytesRead;
+		unsigned long long bytesWritten;
+		unsigned long long readCalls;
+		unsigned long long writeCalls;
+		unsigned long long eventsDispatched;
+		unsigned peakWriteBufferLength;
+		struct timeval connectTime;
+		uint32_t captureConnection;
+
+		NSMutableArray *filters;
+		id filterObject;
+		NSData *filterInput;
+
+		TCPSocketOptions *socketOptions;
+
+		NetWriteStrategy writeStrategy;
+		BOOL corksWrites;
+		BOOL corked;
+		BOOL flushScheduled;
+		BOOL writeInFlight;
+		unsigned bytesInFlight;
 	}
+/**
+ * Sets the write strategy of transports created from now on.  The
+ * default is NetWriteDeferred.
+ */
++ (void)setDefaultWriteStrategy: (NetWriteStrategy)aStrategy;
+/**
+ * Returns the strategy set with +setDefaultWriteStrategy:.
+ */
++ (NetWriteStrategy)defaultWriteStrategy;
 /** 
  * Initializes the transport with the file descriptor <var>aDesc</var>.
  * <var>theAddress</var> is the host that the flie descriptor is connected
  * to.
  */
 - initWithDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress;
+/**
+ * Initializes the transport with the file descriptor <var>aDesc</var> of
+ * a connection accepted by a [TCPPort].  This is the same as 
+ * -initWithDesc:withRemoteHost: but lets subclasses tell the server side
+ * of a connection from the client side.
+ */
+- initWithAcceptedDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress;
 /**
  * Handles the actual reading of data from the connection.
  * Throws an exception if an error occurs while reading data.
@@ -270,15 +564,74 @@ extern NSString *NetclassesErrorAborted;
 - (NSData *)readData: (int)maxDataSize;
 /**
  * Returns YES if there is no more data to write in the buffer and NO if 
- * there is.
+ * there is, or if a send of the io_uring backend has not completed yet.
  */
 - (BOOL)isDoneWriting;
 /**
  * If <var>aData</var> is nil, this will physically transport the data
  * to the connected end.  Otherwise this will put the data in the buffer of 
  * data that needs to be written to the connection when next possible.
+ * If filters have been pushed with [TCPTransport(Filters)-pushFilter:],
+ * the data goes down through them first.  Data written off the run loop
+ * thread, such as by a handler on a [NetWorkerPool], is posted with
+ * [NetApplication-postWriteData:toTransport:].
  */
 - writeData: (NSData *)aData;
+/**
+ * Puts <var>length</var> bytes at <var>bytes</var> in the buffer of data
+ * that needs to be written to the connection.  This is where
+ * -writeData: puts data, after any filters.  Subclasses that keep
+ * outgoing data somewhere else override this rather than -writeData:.
+ * Raises a FatalNetException if the transport is closed.
+ */
+- bufferBytes: (const char *)bytes length: (unsigned)length;
+/**
+ * Applies the options set in <var>options</var> to the connection,
+ * leaving the others as they are.  A connection accepted by a [TCPPort]
+ * already has the options of the port, so this is where a net object
+ * overrides them for its own connection, typically in
+ * [(NetObject)-connectionEstablished:].  Returns NO, with the error of
+ * [TCPSystem] set, if an option cannot be set.
+ */
+- (BOOL)setSocketOptions: (TCPSocketOptions *)options;
+/**
+ * Returns every option set with -setSocketOptions:, or nil if there were
+ * none.
+ */
+- (TCPSocketOptions *)socketOptions;
+/**
+ * Returns the number of bytes in the write buffer, plus those of a send
+ * of the io_uring backend that has not completed yet.
+ */
+- (unsigned)writeBufferLength;
+/**
+ * Sets when data written to the transport is sent.  Transports on the
+ * io_uring backend of [NetApplication] already send everything written
+ * during a run loop iteration together, and only send right away, with
+ * NetWriteImmediate, when no send of theirs is in flight.
+ */
+- setWriteStrategy: (NetWriteStrategy)aStrategy;
+/**
+ * Returns the strategy set with -setWriteStrategy:.
+ */
+- (NetWriteStrategy)writeStrategy;
+/**
+ * With NetWriteEndOfDispatch, corks the socket (TCP_CORK) from the first
+ * write of an iteration until the data is sent, so the kernel sends full
+ * segments even if the data takes more than one send.  Off by default;
+ * does nothing where TCP_CORK is missing.
+ */
+- setCorksWrites: (BOOL)aFlag;
+/**
+ * Returns YES if -setCorksWrites: turned corking on.
+ */
+- (BOOL)corksWrites;
+/**
+ * Sends what is waiting with one non-blocking send and leaves the rest
+ * for the socket to become writable.  With NetWriteEndOfDispatch,
+ * [NetApplication] calls this once the current dispatch is handled.
+ */
+- flushWrites;
 /**
  * Returns a NSHost of the local side of a connection.
  */
@@ -293,9 +646,18 @@ extern NSString *NetclassesErrorAborted;
 - (int)desc;
 /**
  * Closes the transport and makes sure there is no more incoming or outgoing
- * data on the connection.
+ * data on the connection.  Anything still waiting in the write buffer is
+ * discarded and the buffer is returned to the [NetBufferPool].
  */
 - (void)close;
+/**
+ * Returns a snapshot of the counters kept for this connection.  The
+ * dictionary contains NSNumbers for the keys BytesRead, BytesWritten,
+ * ReadCalls and WriteCalls (the number of read(2) and write(2) system 
+ * calls), EventsDispatched (reads and writes requested by [NetApplication]),
+ * WriteBufferLength, PeakWriteBufferLength and TimeConnected (in seconds).
+ */
+- (NSDictionary *)statistics;
 @end
 
 #endif
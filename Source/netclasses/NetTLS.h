@@ -0,0 +1,129 @@
+/***************************************************************************
+                                NetTLS.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class TLSTransport;
+
+#ifndef NET_TLS_H
+#define NET_TLS_H
+
+#import "NetTCP.h"
+
+@class NSString, NSDictionary;
+
+/**
+ * The error message used when netclasses was built without TLS support.
+ */
+extern NSString *NetclassesErrorNoTLS;
+
+/**
+ * A [TCPTransport] that encrypts the connection with TLS using OpenSSL.
+ * Use it by passing [TLSTransport] as the transport class to
+ * [TCPSystem-connectNetObject:toHost:onPort:withTimeout:transportClass:],
+ * [TCPSystem-connectNetObjectInBackground:toHost:onPort:withTimeout:transportClass:]
+ * or [TCPPort-setTransportClass:].  Transports created with
+ * -initWithDesc:withRemoteHost: are clients and those created with
+ * -initWithAcceptedDesc:withRemoteHost: are servers.
+ * <p>
+ * The socket is made non-blocking and the handshake is carried out as
+ * [NetApplication] reports the socket readable or writable, so it never
+ * blocks the run loop.  Data written before the handshake finishes is
+ * kept in the write buffer and sent once it does.  Data is decrypted
+ * straight into the returned NSData and encrypted straight from the
+ * write buffer.
+ * </p>
+ * <p>
+ * Client sessions are kept in a cache shared by all client transports and
+ * keyed by the remote address and port, so reconnecting to the same server
+ * resumes the session instead of doing a full handshake.  Servers issue
+ * session tickets and keep the usual OpenSSL session cache.
+ * </p>
+ * <p>
+ * If netclasses was built without OpenSSL, the initializers return nil
+ * and set the [TCPSystem] error string to NetclassesErrorNoTLS.
+ * </p>
+ */
+@interface TLSTransport : TCPTransport
+	{
+		void *ssl;
+		NSString *sessionKey;
+		BOOL server;
+		BOOL handshaking;
+		BOOL handshakeWantsWrite;
+		BOOL writeWantsRead;
+		uint64_t handshakeStarted;
+		uint64_t handshakeTime;
+	}
+/**
+ * Sets the certificate chain and private key (both PEM files) used by
+ * server transports.  Returns NO and sets the [TCPSystem] error string if
+ * they cannot be loaded.  This must be called before a [TCPPort] using
+ * [TLSTransport] accepts a connection.
+ */
++ (BOOL)setCertificateFile: (NSString *)aCertFile
+   privateKeyFile: (NSString *)aKeyFile;
+/**
+ * Sets the PEM file of trusted certificates used by client transports to
+ * verify servers.  If <var>verify</var> is YES, connections to servers
+ * whose certificate cannot be verified fail during the handshake.  By
+ * default, certificates are not verified.  Returns NO and sets the
+ * [TCPSystem] error string if the file cannot be loaded.
+ */
++ (BOOL)setCAFile: (NSString *)aFile verifyPeer: (BOOL)verify;
+/**
+ * Forgets every cached client session.
+ */
++ (void)flushSessionCache;
+/**
+ * Returns the number of client sessions in the cache.
+ */
++ (unsigned)sessionCacheCount;
+
+/**
+ * Initializes the server side of a TLS connection on <var>aDesc</var>.
+ */
+- initWithAcceptedDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress;
+/**
+ * Initializes the client side of a TLS connection on <var>aDesc</var>.
+ */
+- initWithDesc: (int)aDesc withRemoteHost: (NSHost *)theAddress;
+/**
+ * Returns YES once the handshake has finished.
+ */
+- (BOOL)isHandshakeComplete;
+/**
+ * Returns YES if the handshake resumed a previous session.
+ */
+- (BOOL)isSessionReused;
+/**
+ * Returns the name of the cipher in use, or nil before the handshake
+ * finishes.
+ */
+- (NSString *)cipherName;
+/**
+ * Returns the name of the protocol version in use, such as TLSv1.3, or nil
+ * before the handshake finishes.
+ */
+- (NSString *)protocolVersion;
+/**
+ * Returns the statistics of [TCPTransport] with the keys Cipher,
+ * Protocol, SessionReused and HandshakeTime (in seconds) added once the
+ * handshake has finished.
+ */
+- (NSDictionary *)statistics;
+@end
+
+#endif
@@ -0,0 +1,178 @@
+/***************************************************************************
+                                NetUDP.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class UDPSystem, UDPTransport;
+
+#ifndef NET_UDP_H
+#define NET_UDP_H
+
+#import "NetBase.h"
+#import <Foundation/NSObject.h>
+
+#include <netinet/in.h>
+#include <stdint.h>
+
+@class NSString, NSData, NSHost, NSDictionary;
+
+/**
+ * The largest datagram [UDPTransport] will receive.  Longer datagrams are
+ * truncated.
+ */
+#define NET_UDP_MAX_DATAGRAM 65536
+/**
+ * The number of datagrams [UDPTransport] receives or sends with a single
+ * system call.
+ */
+#define NET_UDP_BATCH 32
+
+/**
+ * Used to create datagram sockets.  There is only one instance of this
+ * class, use +sharedInstance to get it.
+ */
+@interface UDPSystem : NSObject
+	{
+		NSString *errorString;
+		int errorNumber;
+	}
+/**
+ * Returns the one instance of UDPSystem.
+ */
++ sharedInstance;
+/**
+ * Returns the error string of the last error that occurred.
+ */
+- (NSString *)errorString;
+/**
+ * Returns the errno of the last error that occurred, or zero if it was not
+ * a system error.
+ */
+- (int)errorNumber;
+/**
+ * Binds a UDP socket to port <var>aPort</var> of <var>aHost</var> (all
+ * addresses if <var>aHost</var> is nil, any free port if <var>aPort</var>
+ * is zero) and connects <var>netObject</var> to it with
+ * [(NetObject)-connectionEstablished:].  Returns <var>netObject</var>, or
+ * nil if an error occurs.
+ */
+- (id <NetDatagramObject>)bindNetObject: (id <NetDatagramObject>)netObject
+    onHost: (NSHost *)aHost onPort: (uint16_t)aPort;
+/**
+ * Like -bindNetObject:onHost:onPort: with any local port, but also sets
+ * <var>aHost</var> and <var>aPort</var> as the default destination so
+ * [(NetTransport)-writeData:] can be used.  Only datagrams from that
+ * address will be received.
+ */
+- (id <NetDatagramObject>)connectNetObject: (id <NetDatagramObject>)netObject
+    toHost: (NSHost *)aHost onPort: (uint16_t)aPort;
+/**
+ * Fills in <var>anAddress</var> for port <var>aPort</var> of
+ * <var>aHost</var>.  Returns NO if <var>aHost</var> has no usable address.
+ */
+- (BOOL)getAddress: (struct sockaddr_in *)anAddress
+    forHost: (NSHost *)aHost onPort: (uint16_t)aPort;
+@end
+
+/**
+ * A datagram socket.  Datagrams are received in batches of up to
+ * NET_UDP_BATCH with recvmmsg(2) into buffers taken from a pool shared by
+ * all transports, and each one is passed to the net object together with
+ * its source address; no NSData or NSHost is created.  Datagrams queued
+ * with -sendData:to: or -writeData: are sent in batches with sendmmsg(2)
+ * when the socket is writable.  Where recvmmsg(2) and sendmmsg(2) are not
+ * available, recvfrom(2) and sendto(2) are called in a loop instead.
+ */
+@interface UDPTransport : NSObject < NetDatagramTransport >
+	{
+		int desc;
+		BOOL connected;
+		BOOL hasPeer;
+		struct sockaddr_in localAddress;
+		struct sockaddr_in peerAddress;
+		void *queue;
+		unsigned queueLength;
+		unsigned queueCapacity;
+
+		unsigned long long datagramsReceived;
+		unsigned long long datagramsSent;
+		unsigned long long bytesReceived;
+		unsigned long long bytesSent;
+		unsigned long long receiveCalls;
+		unsigned long long sendCalls;
+		unsigned long long sendErrors;
+	}
+/**
+ * Initializes the transport with the bound datagram socket
+ * <var>aDesc</var>.  The socket is made non-blocking.
+ */
+- initWithDesc: (int)aDesc;
+/**
+ * Queues <var>aData</var> to be sent as one datagram to
+ * <var>anAddress</var>.  The address is copied.
+ */
+- sendData: (NSData *)aData to: (const struct sockaddr_in *)anAddress;
+/**
+ * Queues <var>aData</var> to be sent as one datagram to the default
+ * destination set by [UDPSystem-connectNetObject:toHost:onPort:].  When
+ * <var>aData</var> is nil, sends as many queued datagrams as the socket
+ * will take.
+ */
+- writeData: (NSData *)aData;
+/**
+ * Returns YES if no datagrams are waiting to be sent.
+ */
+- (BOOL)isDoneWriting;
+/**
+ * Receives a single datagram and returns it, or returns an empty NSData if
+ * none is waiting.  [NetApplication] uses -receiveDatagramsFor: instead.
+ */
+- (NSData *)readData: (int)maxDataSize;
+/**
+ * Receives waiting datagrams in batches, passing each one to
+ * [(NetDatagramObject)-datagramReceived:length:from:] of
+ * <var>anObject</var>.  Stops when no more are waiting or after a few
+ * batches so other connections get a turn.
+ */
+- (int)receiveDatagramsFor: (id <NetDatagramObject>)anObject;
+/**
+ * Returns the local port of the socket.
+ */
+- (uint16_t)port;
+/**
+ * Returns the local address of the socket.
+ */
+- (const struct sockaddr_in *)localAddress;
+/**
+ * Returns a NSHost for the local address of the socket.
+ */
+- (id)localHost;
+/**
+ * Returns a NSHost for the default destination, or nil if there is none.
+ */
+- (id)remoteHost;
+- (int)desc;
+- (void)close;
+/**
+ * Returns a snapshot of the counters kept for this socket.  The dictionary
+ * contains NSNumbers for the keys DatagramsReceived, DatagramsSent,
+ * BytesReceived, BytesSent, ReceiveCalls, SendCalls (system calls made),
+ * SendErrors (datagrams dropped because they could not be sent) and
+ * QueueLength.
+ */
+- (NSDictionary *)statistics;
+@end
+
+#endif
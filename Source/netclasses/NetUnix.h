@@ -0,0 +1,165 @@
+/***************************************************************************
+                                NetUnix.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class UnixPort, UnixTransport;
+
+#ifndef NET_UNIX_H
+#define NET_UNIX_H
+
+#import "NetTCP.h"
+
+@class NSString, NSData, NSDictionary;
+
+/**
+ * Connecting to Unix domain sockets.  Errors are reported through the
+ * error string and error number of [TCPSystem].
+ */
+@interface TCPSystem (UnixSystem)
+/**
+ * Connects <var>netObject</var> to the Unix domain stream socket at
+ * <var>aPath</var> using a [UnixTransport].  Returns
+ * <var>netObject</var>, or nil if an error occurs.
+ */
+- (id <NetObject>)connectNetObject: (id <NetObject>)netObject
+    toPath: (NSString *)aPath;
+@end
+
+/**
+ * Listens for connections on a Unix domain stream socket.  It works like
+ * [TCPPort], but the transports it creates are [UnixTransport]s.  The
+ * socket file is removed when the port is closed.
+ */
+@interface UnixPort : NSObject < NetPort >
+	{
+		int desc;
+		Class netObjectClass;
+		Class transportClass;
+		NSString *path;
+		BOOL connected;
+	}
+/**
+ * Creates a socket at <var>aPath</var> and listens on it.  A socket left
+ * at <var>aPath</var> by an earlier process is replaced; any other kind of
+ * file there is an error.  Returns nil and sets the [TCPSystem] error
+ * string if an error occurs.
+ */
+- initWithPath: (NSString *)aPath;
+/**
+ * Returns the path of the socket.
+ */
+- (NSString *)path;
+/**
+ * Sets the class that will be initialized if a connection occurs on this
+ * port.  If <var>aClass</var> does not implement the [(NetObject)]
+ * protocol, will throw a FatalNetException.
+ */
+- setNetObject: (Class)aClass;
+/**
+ * Sets the class of the transport created for each new connection.
+ * <var>aClass</var> must be [UnixTransport] (the default) or a subclass of
+ * it, otherwise a FatalNetException is thrown.
+ */
+- setTransportClass: (Class)aClass;
+/**
+ * Returns the class of the transport created for new connections.
+ */
+- (Class)transportClass;
+/**
+ * Returns the low-level file descriptor for the port.
+ */
+- (int)desc;
+/**
+ * Closes the descriptor and removes the socket file.
+ */
+- (void)close;
+/**
+ * Called when the connection is closed.
+ */
+- (void)connectionLost;
+/**
+ * Called when a new connection occurs.  Will initialize a new object
+ * of the class set with -setNetObject: with the new connection.
+ */
+- newConnection;
+@end
+
+/**
+ * A [TCPTransport] for Unix domain stream sockets that can also pass
+ * file descriptors to the other end with SCM_RIGHTS.  Both -localHost and
+ * -remoteHost return the path of the socket (nil for a socketpair(2)).
+ * <p>
+ * A descriptor is sent together with data: it is attached to the first
+ * byte of the data given to -sendDescriptor:withData:, so it arrives with
+ * the -dataReceived: that contains that byte and can be taken with
+ * -takeReceivedDescriptor from there.  A typical use is a front process
+ * that accepts connections on a [TCPPort] and passes them to worker
+ * processes, which take them over with
+ * [TCPSystem-adoptDescriptor:withNetObjectClass:].
+ * </p>
+ */
+@interface UnixTransport : TCPTransport
+	{
+		NSString *path;
+		void *pendingDescriptors;
+		unsigned pendingCount;
+		unsigned pendingCapacity;
+		int *receivedDescriptors;
+		unsigned receivedCount;
+		unsigned receivedCapacity;
+		unsigned long long descriptorsSent;
+		unsigned long long descriptorsReceived;
+	}
+/**
+ * Initializes the transport with the connected Unix domain socket
+ * <var>aDesc</var>, which is bound to <var>aPath</var>.  Use this with
+ * the descriptors from socketpair(2), passing nil for <var>aPath</var>.
+ */
+- initWithDesc: (int)aDesc withPath: (NSString *)aPath;
+/**
+ * Queues <var>aData</var> to be written like [TCPTransport-writeData:] and
+ * a copy of the descriptor <var>aDesc</var> to be sent with its first
+ * byte.  <var>aDesc</var> may be closed as soon as this returns.
+ * <var>aData</var> must not be empty.
+ */
+- sendDescriptor: (int)aDesc withData: (NSData *)aData;
+/**
+ * Returns the oldest descriptor received and not yet taken, or -1 if there
+ * is none.  The caller owns the returned descriptor and must close it.
+ * Descriptors that are never taken are closed when the transport is
+ * deallocated.
+ */
+- (int)takeReceivedDescriptor;
+/**
+ * Returns the number of descriptors received and not yet taken.
+ */
+- (unsigned)receivedDescriptorCount;
+/**
+ * Returns the number of descriptors waiting to be sent.
+ */
+- (unsigned)pendingDescriptorCount;
+/**
+ * Returns the path of the socket, or nil.
+ */
+- (NSString *)path;
+/**
+ * Returns the statistics of [TCPTransport] with the keys DescriptorsSent
+ * and DescriptorsReceived added.
+ */
+- (NSDictionary *)statistics;
+@end
+
+#endif
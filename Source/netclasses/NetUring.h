@@ -0,0 +1,133 @@
+/***************************************************************************
+                                NetUring.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class NetUring;
+
+#ifndef NET_URING_H
+#define NET_URING_H
+
+#import "NetBase.h"
+#import "NetTCP.h"
+#import <Foundation/NSObject.h>
+#import <Foundation/NSMapTable.h>
+
+@class NSDictionary;
+
+/**
+ * The io_uring backend of [NetApplication], selected with
+ * [NetApplication-setIOBackend:].  Applications do not normally use it
+ * directly.
+ * <p>
+ * A [TCPPort] accepts with one multishot accept, and a [TCPTransport]
+ * receives with one multishot receive into a ring of buffers shared by
+ * every connection, so reading and accepting take no system call of
+ * their own.  Writes are sent as they would be written by -writeData:,
+ * but the sends of every transport are submitted together, once per run
+ * loop iteration.  The run loop watches one eventfd that the ring signals
+ * when operations complete.
+ * </p>
+ * <p>
+ * Only ports and transports whose reading and writing are those of
+ * TCPPort and TCPTransport use the ring; subclasses that change them
+ * (such as [TLSTransport]) and every other transport stay on the
+ * readiness-based path.
+ * </p>
+ */
+@interface NetUring : NSObject
+	{
+		void *ring;
+		void *buffers;
+		int eventDesc;
+		NSMapTable *entries;
+		NSMapTable *transportEntries;
+		void *sendQueue;
+		BOOL flushScheduled;
+		BOOL needsSubmit;
+		unsigned long long submits;
+		unsigned long long completions;
+		unsigned long long accepts;
+		unsigned long long receives;
+		unsigned long long sends;
+		unsigned long long bufferShortages;
+	}
+/**
+ * Returns YES if netclasses was built with liburing and the kernel
+ * lets a ring be set up and supports the operations it needs, including
+ * multishot receives and buffer rings (Linux 6.0 and later).  The kernel
+ * is only probed once.
+ */
++ (BOOL)isAvailable;
+/**
+ * Sets up the ring.  Returns nil if +isAvailable returns NO or the ring
+ * cannot be created.
+ */
+- init;
+/**
+ * Returns the eventfd signalled when operations complete.
+ */
+- (int)desc;
+/**
+ * Returns YES if <var>anObject</var>, a port or a net object, can use the
+ * ring.
+ */
+- (BOOL)canHandleObject: (id)anObject;
+/**
+ * Starts accepting or receiving for <var>anObject</var>.  Returns NO if it
+ * cannot use the ring.
+ */
+- (BOOL)addObject: (id)anObject;
+/**
+ * Stops accepting or receiving for <var>anObject</var>.  Operations still
+ * in flight are cancelled.
+ */
+- removeObject: (id)anObject;
+/**
+ * Returns YES if <var>anObject</var> was added with -addObject:.
+ */
+- (BOOL)handlesObject: (id)anObject;
+/**
+ * Sends the data buffered by <var>aTransport</var> with the next batch.
+ */
+- transportNeedsToWrite: (TCPTransport *)aTransport;
+/**
+ * Stops receiving for <var>anObject</var> until -resumeReadingObject:.
+ */
+- pauseReadingObject: (id <NetObject>)anObject;
+/**
+ * Undoes -pauseReadingObject:.
+ */
+- resumeReadingObject: (id <NetObject>)anObject;
+/**
+ * Handles every completed operation, then submits the operations queued
+ * since the last submission.  Called by [NetApplication] when -desc is
+ * readable.
+ */
+- handleCompletions;
+/**
+ * Submits the sends and other operations queued since the last
+ * submission.
+ */
+- flush;
+/**
+ * Returns a dictionary of NSNumbers with the keys Submits (calls into the
+ * kernel), Completions, Accepts, Receives, Sends and BufferShortages
+ * (receives stopped because every buffer was in use).
+ */
+- (NSDictionary *)statistics;
+@end
+
+#endif
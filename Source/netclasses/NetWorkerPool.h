@@ -0,0 +1,139 @@
+/***************************************************************************
+                                NetWorkerPool.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2.1 of the  *
+ *   License or (at your option) any later version.                        *
+ *                                                                         *
+ ***************************************************************************/
+
+@class NetWorkerPool;
+
+#ifndef NET_WORKER_POOL_H
+#define NET_WORKER_POOL_H
+
+#import "NetBase.h"
+#import <Foundation/NSObject.h>
+#import <Foundation/NSMapTable.h>
+
+#include <pthread.h>
+
+@class NSData, NSDictionary;
+
+/**
+ * A fixed set of threads running the handlers of net objects, so a slow
+ * handler does not hold up the run loop thread, which is left to read,
+ * write and accept.
+ * <p>
+ * Every target of -dispatch:to:withObject: has a queue of its own, and
+ * its messages are sent in order, one at a time, so a handler never runs
+ * on two threads at once.  Each thread has a list of queues ready to run
+ * and takes from the lists of the others when its own is empty.  A queue
+ * runs a few messages at a time before going to the back of the list, so
+ * one busy connection cannot starve the others.
+ * </p>
+ * <p>
+ * Give a net object a pool with
+ * [NetApplication-setWorkerPool:forObject:].  Its
+ * [(NetObject)-dataReceived:] (and so the framing and
+ * [LineObject-lineReceived:] of a [LineObject]) and
+ * [(NetObject)-connectionLost] then run on the pool.  Data written to a
+ * [TCPTransport] from the pool is posted back to the run loop thread with
+ * [NetApplication-postWriteData:toTransport:], and
+ * [NetApplication-disconnectObject:] and the pausing of reading are
+ * posted the same way, so handlers need no change.  Anything else the
+ * handler shares with the run loop thread must be locked or posted.
+ * </p>
+ * <p>
+ * The threads keep the pool alive until -stop is called.
+ * </p>
+ */
+@interface NetWorkerPool : NSObject
+	{
+		pthread_mutex_t lock;
+		pthread_cond_t wakeup;
+		pthread_cond_t finished;
+		NSMapTable *queues;
+		void *readyLists;
+		int threadCount;
+		int threadsRunning;
+		int threadsIdle;
+		unsigned nextList;
+		unsigned maximumPending;
+		BOOL stopping;
+		unsigned long long handled;
+		unsigned long long stolen;
+	}
+/**
+ * Initializes a pool of <var>aCount</var> threads, or one for each
+ * processor if <var>aCount</var> is zero.
+ */
+- initWithThreads: (int)aCount;
+/**
+ * Returns the number of threads.
+ */
+- (int)threadCount;
+/**
+ * Sets how many messages may wait in the queue of a net object before
+ * reading from it is paused with [NetApplication-pauseReadingObject:].
+ * Reading resumes once half of them are handled.  The default is 1024;
+ * zero never pauses.
+ */
+- setMaximumPending: (unsigned)aCount;
+/**
+ * Queues <var>aSelector</var> to be sent to <var>aTarget</var> with
+ * <var>anObject</var> on one of the threads, after every message queued
+ * for <var>aTarget</var> before it.  <var>aTarget</var> and
+ * <var>anObject</var> are retained until then.  A NetException or
+ * FatalNetException raised by a net object disconnects it; any other
+ * exception is raised again on the run loop thread, out of
+ * [NSRunLoop-run] as if the handler had run there.  Throws a
+ * NetException if the pool has been stopped.
+ */
+- dispatch: (SEL)aSelector to: (id)aTarget withObject: (id)anObject;
+/**
+ * Lets the threads finish every queued message and waits for them to
+ * exit.  Must not be called from one of the threads.
+ */
+- stop;
+/**
+ * Returns a dictionary of NSNumbers with the keys Threads, Handled
+ * (messages sent), Stolen (queues a thread took from another thread's
+ * list) and Queues (targets with messages waiting or running).
+ */
+- (NSDictionary *)statistics;
+@end
+
+/**
+ * Worker pools of [NetApplication].
+ */
+@interface NetApplication (WorkerPool)
+/**
+ * Runs the handlers of <var>anObject</var> on <var>aPool</var> from now
+ * on, or on the run loop thread again if <var>aPool</var> is nil.  Only
+ * stream transports are handed to a pool; datagram objects stay on the
+ * run loop thread.  The pool is retained until <var>anObject</var> is
+ * disconnected.
+ */
+- setWorkerPool: (NetWorkerPool *)aPool forObject: (id <NetObject>)anObject;
+/**
+ * Returns the worker pool of <var>anObject</var>, or nil.
+ */
+- (NetWorkerPool *)workerPoolForObject: (id <NetObject>)anObject;
+/**
+ * Sends [(NetObject)-dataReceived:] with <var>data</var> to
+ * <var>anObject</var>, on its worker pool if it has one.  Used by
+ * [NetApplication] and by the filter stack of [TCPTransport].
+ */
+- passData: (NSData *)data toObject: (id <NetObject>)anObject;
+@end
+
+#endif
@@ -0,0 +1,101 @@
+/***************************************************************************
+                                IRCSimServer.h
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef IRC_SIM_SERVER_H
+#define IRC_SIM_SERVER_H
+
+#import <netclasses/NetTCP.h>
+#import <netclasses/LineObject.h>
+
+@class NSMutableDictionary, NSMutableArray, NSTimer, NSData;
+
+/* A small stand-in for an IRC server used to load and soak test IRCObject
+ * without a real network.  It speaks enough of RFC 1459 for registration,
+ * JOIN, PART, PRIVMSG, NOTICE, NAMES, MODE, TOPIC, LIST, PING and QUIT, and
+ * it can generate synthetic load: channels with thousands of fake members,
+ * NAMES bursts, netsplit QUIT storms and message floods at a fixed rate.
+ *
+ * Flood messages carry the time they were sent as "t=<microseconds>" (on
+ * the monotonic clock) at the start of their text so in-process clients
+ * can measure callback latency.
+ */
+@interface IRCSimServer : NSObject
+	{
+		TCPPort *port;
+		NSString *serverName;
+		NSMutableDictionary *nicks;
+		NSMutableDictionary *channels;
+		NSMutableArray *floods;
+		unsigned long long linesIn;
+		unsigned long long linesOut;
+	}
+/* Returns the server currently accepting connections, if any. */
++ (IRCSimServer *)currentServer;
+
+/* Starts a server on the loopback address.  A port of zero picks any
+ * free port; use -port to find out which.
+ */
+- initOnPort: (uint16_t)aPort;
+- (uint16_t)port;
+- (NSString *)serverName;
+- (void)shutdown;
+
+/* Creates <var>aChannel</var> if needed and adds <var>count</var> fake
+ * members named user00000 and so on.
+ */
+- createChannel: (NSString *)aChannel withSyntheticMembers: (int)count;
+/* Creates <var>count</var> channels named #chan00000 and so on with a
+ * varying number of synthetic members and topics, for LIST.
+ */
+- createSyntheticChannels: (int)count;
+/* Sends the full NAMES reply for <var>aChannel</var> to each real member
+ * <var>times</var> times.
+ */
+- burstNamesOnChannel: (NSString *)aChannel times: (int)times;
+/* Makes <var>count</var> synthetic members of <var>aChannel</var> QUIT
+ * with a netsplit message.
+ */
+- netsplitChannel: (NSString *)aChannel quitCount: (int)count;
+/* Sends PRIVMSGs from synthetic members to <var>aChannel</var> at
+ * <var>rate</var> messages per second for <var>seconds</var> seconds.
+ */
+- floodChannel: (NSString *)aChannel rate: (double)rate
+   duration: (double)seconds;
+/* Returns YES while a flood started with -floodChannel:rate:duration: is
+ * still running.
+ */
+- (BOOL)isFlooding;
+
+- (unsigned long long)linesIn;
+- (unsigned long long)linesOut;
+@end
+
+/* One client connection to an IRCSimServer. */
+@interface IRCSimConnection : LineObject
+	{
+		IRCSimServer *server;
+		NSString *nick;
+		NSString *user;
+		BOOL registered;
+	}
+- (NSString *)nick;
+- (NSString *)mask;
+- sendData: (NSData *)aData;
+- sendLine: (NSString *)aLine;
+@end
+
+#endif
@@ -0,0 +1,1101 @@
+/***************************************************************************
+                                IRCSimServer.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "IRCSimServer.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/IRCObject.h>
+#import <netclasses/NetHistogram.h>
+
+#import <Foundation/Foundation.h>
+
+#include <string.h>
+
+#define NAMES_LINE_LENGTH 400
+
+static IRCSimServer *current_server = nil;
+static NSMapTable *command_to_function = 0;
+static NSData *new_line = nil;
+
+@interface IRCSimChannel : NSObject
+	{
+		@public
+		NSString *name;
+		NSString *topic;
+		NSMutableArray *members;
+		NSMutableArray *synthetic;
+		NSMutableSet *ops;
+	}
+- initWithName: (NSString *)aName;
+- (NSArray *)namesLines;
+- (int)userCount;
+@end
+
+@interface IRCSimFlood : NSObject
+	{
+		@public
+		NSString *channel;
+		double rate;
+		uint64_t start;
+		uint64_t end;
+		unsigned long long sent;
+	}
+@end
+
+@interface IRCSimServer (InternalIRCSimServer)
+- (IRCSimChannel *)channelNamed: (NSString *)aName create: (BOOL)create;
+- (IRCSimConnection *)connectionForNick: (NSString *)aNick;
+- (BOOL)setNick: (NSString *)aNick forConnection: (IRCSimConnection *)aConn;
+- removeConnection: (IRCSimConnection *)aConn withMessage: (NSString *)aMsg;
+- sendLine: (NSString *)aLine toChannel: (IRCSimChannel *)aChannel
+   except: (IRCSimConnection *)aConn;
+- sendData: (NSData *)aData toChannel: (IRCSimChannel *)aChannel
+   except: (IRCSimConnection *)aConn;
+- (NSArray *)channelsOf: (IRCSimConnection *)aConn;
+- (NSArray *)allChannels;
+- countLineIn;
+- countLineOut;
+- floodTimerFired: (NSTimer *)aTimer;
+@end
+
+@interface IRCSimConnection (InternalIRCSimConnection)
+- setNick: (NSString *)aNick;
+- setUser: (NSString *)aUser;
+- (BOOL)registered;
+- checkRegistration;
+- numeric: (NSString *)aNumeric text: (NSString *)aText;
+@end
+
+static NSData *line_data(NSString *aLine)
+{
+	NSMutableData *data;
+
+	data = [NSMutableData dataWithData:
+	  [aLine dataUsingEncoding: NSUTF8StringEncoding]];
+	[data appendData: new_line];
+
+	return data;
+}
+
+static NSArray *parse_line(NSString *line, NSString **command)
+{
+	NSMutableArray *params = [NSMutableArray array];
+	NSRange range;
+	NSString *word;
+
+	*command = nil;
+	if ([line hasPrefix: @":"])
+	{
+		range = [line rangeOfString: @" "];
+		if (range.location == NSNotFound) return params;
+		line = [line substringFromIndex: range.location + 1];
+	}
+
+	while ([line length])
+	{
+		if ([line hasPrefix: @" "])
+		{
+			line = [line substringFromIndex: 1];
+			continue;
+		}
+		if (*command && [line hasPrefix: @":"])
+		{
+			[params addObject: [line substringFromIndex: 1]];
+			break;
+		}
+		range = [line rangeOfString: @" "];
+		if (range.location == NSNotFound)
+		{
+			word = line;
+			line = @"";
+		}
+		else
+		{
+			word = [line substringToIndex: range.location];
+			line = [line substringFromIndex: range.location + 1];
+		}
+		if (*command)
+		{
+			[params addObject: word];
+		}
+		else
+		{
+			*command = [word uppercaseString];
+		}
+	}
+
+	return params;
+}
+
+static void send_names(IRCSimConnection *conn, IRCSimChannel *chan)
+{
+	NSEnumerator *iter;
+	NSString *line;
+
+	iter = [[chan namesLines] objectEnumerator];
+	while ((line = [iter nextObject]))
+	{
+		[conn numeric: RPL_NAMREPLY text: [NSString stringWithFormat:
+		  @"= %@ :%@", chan->name, line]];
+	}
+	[conn numeric: RPL_ENDOFNAMES text: [NSString stringWithFormat:
+	  @"%@ :End of /NAMES list.", chan->name]];
+}
+
+static void sim_nick(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+	NSString *old = [conn mask];
+	NSString *new;
+
+	if ([params count] < 1)
+	{
+		[conn numeric: ERR_NONICKNAMEGIVEN text: @":No nickname given"];
+		return;
+	}
+	new = [params objectAtIndex: 0];
+	if (![server setNick: new forConnection: conn])
+	{
+		[conn numeric: ERR_NICKNAMEINUSE text: [NSString stringWithFormat:
+		  @"%@ :Nickname is already in use", new]];
+		return;
+	}
+	if ([conn registered])
+	{
+		NSEnumerator *iter;
+		IRCSimChannel *chan;
+		NSString *line = [NSString stringWithFormat: @":%@ NICK :%@",
+		  old, new];
+
+		[conn sendLine: line];
+		iter = [[server channelsOf: conn] objectEnumerator];
+		while ((chan = [iter nextObject]))
+		{
+			[server sendLine: line toChannel: chan except: conn];
+		}
+	}
+	[conn checkRegistration];
+}
+
+static void sim_user(IRCSimConnection *conn, NSArray *params)
+{
+	if ([conn registered])
+	{
+		[conn numeric: ERR_ALREADYREGISTRED text:
+		  @":You may not reregister"];
+		return;
+	}
+	if ([params count] < 4)
+	{
+		[conn numeric: ERR_NEEDMOREPARAMS text: @"USER :Not enough parameters"];
+		return;
+	}
+	[conn setUser: [params objectAtIndex: 0]];
+	[conn checkRegistration];
+}
+
+static void sim_pass(IRCSimConnection *conn, NSArray *params)
+{
+}
+
+static void sim_ping(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+
+	[conn sendLine: [NSString stringWithFormat: @":%@ PONG %@ :%@",
+	  [server serverName], [server serverName],
+	  ([params count]) ? [params objectAtIndex: 0] : @""]];
+}
+
+static void sim_pong(IRCSimConnection *conn, NSArray *params)
+{
+}
+
+static void sim_join(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+	NSArray *names;
+	int x;
+
+	if ([params count] < 1)
+	{
+		[conn numeric: ERR_NEEDMOREPARAMS text: @"JOIN :Not enough parameters"];
+		return;
+	}
+
+	names = [[params objectAtIndex: 0] componentsSeparatedByString: @","];
+	for (x = 0; x < (int)[names count]; x++)
+	{
+		NSString *name = [names objectAtIndex: x];
+		IRCSimChannel *chan;
+
+		if (![name hasPrefix: @"#"])
+		{
+			[conn numeric: ERR_NOSUCHCHANNEL text: [NSString stringWithFormat:
+			  @"%@ :No such channel", name]];
+			continue;
+		}
+		chan = [server channelNamed: name create: YES];
+		if ([chan->members indexOfObjectIdenticalTo: conn] != NSNotFound)
+		{
+			continue;
+		}
+		if ([chan->members count] == 0)
+		{
+			[chan->ops addObject: [[conn nick] lowercaseIRCString]];
+		}
+		[chan->members addObject: conn];
+		[server sendLine: [NSString stringWithFormat: @":%@ JOIN :%@",
+		  [conn mask], chan->name] toChannel: chan except: nil];
+		if (chan->topic)
+		{
+			[conn numeric: RPL_TOPIC text: [NSString stringWithFormat:
+			  @"%@ :%@", chan->name, chan->topic]];
+		}
+		send_names(conn, chan);
+	}
+}
+
+static void sim_part(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+	NSArray *names;
+	NSString *message;
+	int x;
+
+	if ([params count] < 1)
+	{
+		[conn numeric: ERR_NEEDMOREPARAMS text: @"PART :Not enough parameters"];
+		return;
+	}
+
+	message = ([params count] > 1) ? [params objectAtIndex: 1] : @"";
+	names = [[params objectAtIndex: 0] componentsSeparatedByString: @","];
+	for (x = 0; x < (int)[names count]; x++)
+	{
+		IRCSimChannel *chan;
+
+		chan = [server channelNamed: [names objectAtIndex: x] create: NO];
+		if (!chan ||
+		  [chan->members indexOfObjectIdenticalTo: conn] == NSNotFound)
+		{
+			[conn numeric: ERR_NOTONCHANNEL text: [NSString stringWithFormat:
+			  @"%@ :You're not on that channel", [names objectAtIndex: x]]];
+			continue;
+		}
+		[server sendLine: [NSString stringWithFormat: @":%@ PART %@ :%@",
+		  [conn mask], chan->name, message] toChannel: chan except: nil];
+		[chan->members removeObjectIdenticalTo: conn];
+		[chan->ops removeObject: [[conn nick] lowercaseIRCString]];
+	}
+}
+
+static void sim_privmsg(IRCSimConnection *conn, NSArray *params,
+  NSString *command)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+	NSArray *targets;
+	int x;
+
+	if ([params count] < 2)
+	{
+		[conn numeric: ERR_NOTEXTTOSEND text: @":No text to send"];
+		return;
+	}
+
+	targets = [[params objectAtIndex: 0] componentsSeparatedByString: @","];
+	for (x = 0; x < (int)[targets count]; x++)
+	{
+		NSString *target = [targets objectAtIndex: x];
+		NSString *line = [NSString stringWithFormat: @":%@ %@ %@ :%@",
+		  [conn mask], command, target, [params objectAtIndex: 1]];
+
+		if ([target hasPrefix: @"#"])
+		{
+			IRCSimChannel *chan = [server channelNamed: target create: NO];
+
+			if (!chan)
+			{
+				[conn numeric: ERR_NOSUCHNICK text: [NSString stringWithFormat:
+				  @"%@ :No such nick/channel", target]];
+				continue;
+			}
+			[server sendLine: line toChannel: chan except: conn];
+		}
+		else
+		{
+			IRCSimConnection *other = [server connectionForNick: target];
+
+			if (!other)
+			{
+				[conn numeric: ERR_NOSUCHNICK text: [NSString stringWithFormat:
+				  @"%@ :No such nick/channel", target]];
+				continue;
+			}
+			[other sendLine: line];
+		}
+	}
+}
+
+static void sim_message(IRCSimConnection *conn, NSArray *params)
+{
+	sim_privmsg(conn, params, @"PRIVMSG");
+}
+
+static void sim_notice(IRCSimConnection *conn, NSArray *params)
+{
+	sim_privmsg(conn, params, @"NOTICE");
+}
+
+static void sim_names(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+	NSArray *names;
+	int x;
+
+	if ([params count] < 1)
+	{
+		[conn numeric: RPL_ENDOFNAMES text: @"* :End of /NAMES list."];
+		return;
+	}
+
+	names = [[params objectAtIndex: 0] componentsSeparatedByString: @","];
+	for (x = 0; x < (int)[names count]; x++)
+	{
+		IRCSimChannel *chan;
+
+		chan = [server channelNamed: [names objectAtIndex: x] create: NO];
+		if (chan)
+		{
+			send_names(conn, chan);
+		}
+		else
+		{
+			[conn numeric: RPL_ENDOFNAMES text: [NSString stringWithFormat:
+			  @"%@ :End of /NAMES list.", [names objectAtIndex: x]]];
+		}
+	}
+}
+
+static void sim_mode(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+	IRCSimChannel *chan;
+	NSString *modes;
+	NSMutableString *line;
+	BOOL adding = YES;
+	int arg = 2;
+	int x;
+
+	if ([params count] < 1)
+	{
+		[conn numeric: ERR_NEEDMOREPARAMS text: @"MODE :Not enough parameters"];
+		return;
+	}
+	if (![[params objectAtIndex: 0] hasPrefix: @"#"])
+	{
+		if ([params count] == 1)
+		{
+			[conn numeric: RPL_UMODEIS text: @"+i"];
+		}
+		else
+		{
+			[conn sendLine: [NSString stringWithFormat: @":%@ MODE %@ :%@",
+			  [conn nick], [conn nick], [params objectAtIndex: 1]]];
+		}
+		return;
+	}
+
+	chan = [server channelNamed: [params objectAtIndex: 0] create: NO];
+	if (!chan)
+	{
+		[conn numeric: ERR_NOSUCHCHANNEL text: [NSString stringWithFormat:
+		  @"%@ :No such channel", [params objectAtIndex: 0]]];
+		return;
+	}
+	if ([params count] == 1)
+	{
+		[conn numeric: RPL_CHANNELMODEIS text: [NSString stringWithFormat:
+		  @"%@ +nt", chan->name]];
+		return;
+	}
+
+	modes = [params objectAtIndex: 1];
+	for (x = 0; x < (int)[modes length]; x++)
+	{
+		unichar c = [modes characterAtIndex: x];
+
+		switch (c)
+		{
+			case '+': adding = YES; break;
+			case '-': adding = NO; break;
+			case 'o':
+				if (arg < (int)[params count])
+				{
+					NSString *who = [[params objectAtIndex: arg++]
+					  lowercaseIRCString];
+					if (adding)
+						[chan->ops addObject: who];
+					else
+						[chan->ops removeObject: who];
+				}
+				break;
+			case 'v': case 'b': case 'k':
+				arg++;
+				break;
+			case 'l':
+				if (adding) arg++;
+				break;
+			default:
+				break;
+		}
+	}
+
+	line = [NSMutableString stringWithFormat: @":%@ MODE %@",
+	  [conn mask], chan->name];
+	for (x = 1; x < (int)[params count]; x++)
+	{
+		[line appendFormat: @" %@", [params objectAtIndex: x]];
+	}
+	[server sendLine: line toChannel: chan except: nil];
+}
+
+static void sim_topic(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+	IRCSimChannel *chan;
+
+	if ([params count] < 1)
+	{
+		[conn numeric: ERR_NEEDMOREPARAMS text: @"TOPIC :Not enough parameters"];
+		return;
+	}
+	chan = [server channelNamed: [params objectAtIndex: 0] create: NO];
+	if (!chan)
+	{
+		[conn numeric: ERR_NOSUCHCHANNEL text: [NSString stringWithFormat:
+		  @"%@ :No such channel", [params objectAtIndex: 0]]];
+		return;
+	}
+	if ([params count] == 1)
+	{
+		if (chan->topic)
+		{
+			[conn numeric: RPL_TOPIC text: [NSString stringWithFormat:
+			  @"%@ :%@", chan->name, chan->topic]];
+		}
+		else
+		{
+			[conn numeric: RPL_NOTOPIC text: [NSString stringWithFormat:
+			  @"%@ :No topic is set", chan->name]];
+		}
+		return;
+	}
+	ASSIGN(chan->topic, [params objectAtIndex: 1]);
+	[server sendLine: [NSString stringWithFormat: @":%@ TOPIC %@ :%@",
+	  [conn mask], chan->name, chan->topic] toChannel: chan except: nil];
+}
+
+static void sim_list(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+	NSEnumerator *iter;
+	IRCSimChannel *chan;
+
+	[conn numeric: RPL_LISTSTART text: @"Channel :Users  Name"];
+	iter = [[server allChannels] objectEnumerator];
+	while ((chan = [iter nextObject]))
+	{
+		[conn numeric: RPL_LIST text: [NSString stringWithFormat:
+		  @"%@ %d :%@", chan->name, [chan userCount],
+		  (chan->topic) ? chan->topic : @""]];
+	}
+	[conn numeric: RPL_LISTEND text: @":End of /LIST"];
+}
+
+static void sim_quit(IRCSimConnection *conn, NSArray *params)
+{
+	IRCSimServer *server = [IRCSimServer currentServer];
+
+	[conn sendLine: @"ERROR :Closing Link"];
+	[server removeConnection: conn withMessage:
+	  ([params count]) ? [params objectAtIndex: 0] : @"Client Quit"];
+	[[NetApplication sharedInstance] disconnectObject: conn];
+}
+
+@implementation IRCSimChannel
+- initWithName: (NSString *)aName
+{
+	if (!(self = [super init])) return nil;
+
+	name = RETAIN(aName);
+	members = [NSMutableArray new];
+	synthetic = [NSMutableArray new];
+	ops = [NSMutableSet new];
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(name);
+	RELEASE(topic);
+	RELEASE(members);
+	RELEASE(synthetic);
+	RELEASE(ops);
+	[super dealloc];
+}
+- (int)userCount
+{
+	return [members count] + [synthetic count];
+}
+- (NSArray *)namesLines
+{
+	NSMutableArray *lines = [NSMutableArray array];
+	NSMutableString *line = [NSMutableString string];
+	NSEnumerator *iter;
+	NSString *who;
+	int x = 0;
+
+	iter = [members objectEnumerator];
+	while ((who = [(IRCSimConnection *)[iter nextObject] nick]))
+	{
+		if ([line length] > NAMES_LINE_LENGTH)
+		{
+			[lines addObject: line];
+			line = [NSMutableString string];
+		}
+		[line appendFormat: ([line length]) ? @" %@%@" : @"%@%@",
+		  [ops containsObject: [who lowercaseIRCString]] ? @"@" : @"", who];
+	}
+
+	iter = [synthetic objectEnumerator];
+	while ((who = [iter nextObject]))
+	{
+		if ([line length] > NAMES_LINE_LENGTH)
+		{
+			[lines addObject: line];
+			line = [NSMutableString string];
+		}
+		[line appendFormat: ([line length]) ? @" %@%@" : @"%@%@",
+		  (x % 50 == 0) ? @"@+" : ((x % 10 == 0) ? @"+" : @""), who];
+		x++;
+	}
+
+	if ([line length])
+	{
+		[lines addObject: line];
+	}
+
+	return lines;
+}
+@end
+
+@implementation IRCSimFlood
+- (void)dealloc
+{
+	RELEASE(channel);
+	[super dealloc];
+}
+@end
+
+@implementation IRCSimServer (InternalIRCSimServer)
+- (IRCSimChannel *)channelNamed: (NSString *)aName create: (BOOL)create
+{
+	NSString *key = [aName lowercaseIRCString];
+	IRCSimChannel *chan = [channels objectForKey: key];
+
+	if (!chan && create)
+	{
+		chan = AUTORELEASE([[IRCSimChannel alloc] initWithName: aName]);
+		[channels setObject: chan forKey: key];
+	}
+
+	return chan;
+}
+- (IRCSimConnection *)connectionForNick: (NSString *)aNick
+{
+	return [nicks objectForKey: [aNick lowercaseIRCString]];
+}
+- (BOOL)setNick: (NSString *)aNick forConnection: (IRCSimConnection *)aConn
+{
+	NSString *key = [aNick lowercaseIRCString];
+	IRCSimConnection *other = [nicks objectForKey: key];
+	NSEnumerator *iter;
+	IRCSimChannel *chan;
+
+	if (other && other != aConn)
+	{
+		return NO;
+	}
+	if ([aConn nick])
+	{
+		NSString *oldKey = [[aConn nick] lowercaseIRCString];
+
+		[nicks removeObjectForKey: oldKey];
+		iter = [channels objectEnumerator];
+		while ((chan = [iter nextObject]))
+		{
+			if ([chan->ops containsObject: oldKey])
+			{
+				[chan->ops removeObject: oldKey];
+				[chan->ops addObject: key];
+			}
+		}
+	}
+	[nicks setObject: aConn forKey: key];
+	[aConn setNick: aNick];
+
+	return YES;
+}
+- removeConnection: (IRCSimConnection *)aConn withMessage: (NSString *)aMsg
+{
+	NSMutableSet *told = [NSMutableSet set];
+	NSEnumerator *iter;
+	NSEnumerator *iter2;
+	IRCSimChannel *chan;
+	IRCSimConnection *other;
+	NSData *data;
+
+	if (![aConn nick] || [nicks objectForKey:
+	  [[aConn nick] lowercaseIRCString]] != aConn)
+	{
+		return self;
+	}
+
+	data = line_data([NSString stringWithFormat: @":%@ QUIT :%@",
+	  [aConn mask], aMsg]);
+	iter = [[self channelsOf: aConn] objectEnumerator];
+	while ((chan = [iter nextObject]))
+	{
+		[chan->members removeObjectIdenticalTo: aConn];
+		[chan->ops removeObject: [[aConn nick] lowercaseIRCString]];
+		iter2 = [chan->members objectEnumerator];
+		while ((other = [iter2 nextObject]))
+		{
+			if (![told containsObject: other])
+			{
+				[told addObject: other];
+				[other sendData: data];
+			}
+		}
+	}
+	[nicks removeObjectForKey: [[aConn nick] lowercaseIRCString]];
+
+	return self;
+}
+- sendLine: (NSString *)aLine toChannel: (IRCSimChannel *)aChannel
+   except: (IRCSimConnection *)aConn
+{
+	return [self sendData: line_data(aLine) toChannel: aChannel
+	  except: aConn];
+}
+- sendData: (NSData *)aData toChannel: (IRCSimChannel *)aChannel
+   except: (IRCSimConnection *)aConn
+{
+	NSEnumerator *iter = [aChannel->members objectEnumerator];
+	IRCSimConnection *other;
+
+	while ((other = [iter nextObject]))
+	{
+		if (other != aConn)
+		{
+			[other sendData: aData];
+		}
+	}
+	return self;
+}
+- (NSArray *)channelsOf: (IRCSimConnection *)aConn
+{
+	NSMutableArray *result = [NSMutableArray array];
+	NSEnumerator *iter = [channels objectEnumerator];
+	IRCSimChannel *chan;
+
+	while ((chan = [iter nextObject]))
+	{
+		if ([chan->members indexOfObjectIdenticalTo: aConn] != NSNotFound)
+		{
+			[result addObject: chan];
+		}
+	}
+	return result;
+}
+- (NSArray *)allChannels
+{
+	return [channels allValues];
+}
+- countLineIn
+{
+	linesIn++;
+	return self;
+}
+- countLineOut
+{
+	linesOut++;
+	return self;
+}
+- floodTimerFired: (NSTimer *)aTimer
+{
+	uint64_t now = NetMonotonicMicroseconds();
+	NSEnumerator *iter = [[NSArray arrayWithArray: floods] objectEnumerator];
+	IRCSimFlood *flood;
+
+	while ((flood = [iter nextObject]))
+	{
+		IRCSimChannel *chan = [self channelNamed: flood->channel create: NO];
+		unsigned long long due;
+		int count;
+
+		due = (unsigned long long)(flood->rate *
+		  ((now < flood->end ? now : flood->end) - flood->start) / 1000000.0);
+		count = (chan) ? [chan->synthetic count] : 0;
+
+		while (flood->sent < due && count > 0)
+		{
+			[self sendLine: [NSString stringWithFormat:
+			  @":%@!sim@flood.example PRIVMSG %@ :t=%llu flood message %llu",
+			  [chan->synthetic objectAtIndex: flood->sent % count],
+			  chan->name, (unsigned long long)NetMonotonicMicroseconds(),
+			  flood->sent]
+			  toChannel: chan except: nil];
+			flood->sent++;
+		}
+
+		if (now >= flood->end || count == 0)
+		{
+			[floods removeObjectIdenticalTo: flood];
+		}
+	}
+
+	if ([floods count] == 0)
+	{
+		[aTimer invalidate];
+	}
+
+	return self;
+}
+@end
+
+@implementation IRCSimServer
++ (void)initialize
+{
+	new_line = [[NSData alloc] initWithBytes: "\r\n" length: 2];
+
+	command_to_function = NSCreateMapTable(NSObjectMapKeyCallBacks,
+	  NSIntMapValueCallBacks, 16);
+
+	NSMapInsert(command_to_function, @"NICK", sim_nick);
+	NSMapInsert(command_to_function, @"USER", sim_user);
+	NSMapInsert(command_to_function, @"PASS", sim_pass);
+	NSMapInsert(command_to_function, @"PING", sim_ping);
+	NSMapInsert(command_to_function, @"PONG", sim_pong);
+	NSMapInsert(command_to_function, @"JOIN", sim_join);
+	NSMapInsert(command_to_function, @"PART", sim_part);
+	NSMapInsert(command_to_function, @"PRIVMSG", sim_message);
+	NSMapInsert(command_to_function, @"NOTICE", sim_notice);
+	NSMapInsert(command_to_function, @"NAMES", sim_names);
+	NSMapInsert(command_to_function, @"MODE", sim_mode);
+	NSMapInsert(command_to_function, @"TOPIC", sim_topic);
+	NSMapInsert(command_to_function, @"LIST", sim_list);
+	NSMapInsert(command_to_function, @"QUIT", sim_quit);
+}
++ (IRCSimServer *)currentServer
+{
+	return current_server;
+}
+- initOnPort: (uint16_t)aPort
+{
+	if (!(self = [super init])) return nil;
+
+	port = [[TCPPort alloc] initOnHost: [NSHost hostWithAddress: @"127.0.0.1"]
+	  onPort: aPort];
+	if (!port)
+	{
+		[self release];
+		return nil;
+	}
+	[port setNetObject: [IRCSimConnection class]];
+
+	serverName = RETAIN(@"sim.netclasses.example");
+	nicks = [NSMutableDictionary new];
+	channels = [NSMutableDictionary new];
+	floods = [NSMutableArray new];
+	current_server = self;
+
+	return self;
+}
+- (void)dealloc
+{
+	[self shutdown];
+	RELEASE(serverName);
+	RELEASE(nicks);
+	RELEASE(channels);
+	RELEASE(floods);
+	[super dealloc];
+}
+- (uint16_t)port
+{
+	return [port port];
+}
+- (NSString *)serverName
+{
+	return serverName;
+}
+- (void)shutdown
+{
+	NSEnumerator *iter;
+	id object;
+
+	if (port)
+	{
+		[[NetApplication sharedInstance] disconnectObject: port];
+		[port close];
+		DESTROY(port);
+	}
+	iter = [[nicks allValues] objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[[NetApplication sharedInstance] disconnectObject: object];
+	}
+	[nicks removeAllObjects];
+	[floods removeAllObjects];
+	if (current_server == self)
+	{
+		current_server = nil;
+	}
+}
+- createChannel: (NSString *)aChannel withSyntheticMembers: (int)count
+{
+	IRCSimChannel *chan = [self channelNamed: aChannel create: YES];
+	int base = [chan->synthetic count];
+	int x;
+
+	for (x = 0; x < count; x++)
+	{
+		[chan->synthetic addObject:
+		  [NSString stringWithFormat: @"user%05d", base + x]];
+	}
+	return self;
+}
+- createSyntheticChannels: (int)count
+{
+	int x;
+
+	for (x = 0; x < count; x++)
+	{
+		IRCSimChannel *chan = [self channelNamed:
+		  [NSString stringWithFormat: @"#chan%05d", x] create: YES];
+
+		[self createChannel: chan->name withSyntheticMembers:
+		  (x * 7919) % 200];
+		ASSIGN(chan->topic, ([chan->synthetic count] % 3) ?
+		  [NSString stringWithFormat: @"Topic of channel %d", x] :
+		  @"Welcome to netclasses");
+	}
+	return self;
+}
+- burstNamesOnChannel: (NSString *)aChannel times: (int)times
+{
+	IRCSimChannel *chan = [self channelNamed: aChannel create: NO];
+	NSEnumerator *iter;
+	IRCSimConnection *conn;
+	int x;
+
+	if (!chan) return self;
+
+	for (x = 0; x < times; x++)
+	{
+		iter = [chan->members objectEnumerator];
+		while ((conn = [iter nextObject]))
+		{
+			send_names(conn, chan);
+		}
+	}
+	return self;
+}
+- netsplitChannel: (NSString *)aChannel quitCount: (int)count
+{
+	IRCSimChannel *chan = [self channelNamed: aChannel create: NO];
+	NSString *who;
+
+	if (!chan) return self;
+
+	while (count-- > 0 && [chan->synthetic count] > 0)
+	{
+		who = [chan->synthetic lastObject];
+		[self sendLine: [NSString stringWithFormat:
+		  @":%@!sim@split.example QUIT :hub.example leaf.example", who]
+		  toChannel: chan except: nil];
+		[chan->synthetic removeLastObject];
+	}
+	return self;
+}
+- floodChannel: (NSString *)aChannel rate: (double)rate
+   duration: (double)seconds
+{
+	IRCSimFlood *flood = AUTORELEASE([IRCSimFlood new]);
+
+	flood->channel = RETAIN(aChannel);
+	flood->rate = rate;
+	flood->start = NetMonotonicMicroseconds();
+	flood->end = flood->start + (uint64_t)(seconds * 1000000);
+
+	if ([floods count] == 0)
+	{
+		[NSTimer scheduledTimerWithTimeInterval: 0.01 target: self
+		  selector: @selector(floodTimerFired:) userInfo: nil repeats: YES];
+	}
+	[floods addObject: flood];
+
+	return self;
+}
+- (BOOL)isFlooding
+{
+	return [floods count] != 0;
+}
+- (unsigned long long)linesIn
+{
+	return linesIn;
+}
+- (unsigned long long)linesOut
+{
+	return linesOut;
+}
+@end
+
+@implementation IRCSimConnection (InternalIRCSimConnection)
+- setNick: (NSString *)aNick
+{
+	ASSIGN(nick, aNick);
+	return self;
+}
+- setUser: (NSString *)aUser
+{
+	ASSIGN(user, aUser);
+	return self;
+}
+- (BOOL)registered
+{
+	return registered;
+}
+- checkRegistration
+{
+	NSString *name;
+
+	if (registered || !nick || !user)
+	{
+		return self;
+	}
+	registered = YES;
+	name = [server serverName];
+
+	[self numeric: RPL_WELCOME text: [NSString stringWithFormat:
+	  @":Welcome to the netclasses simulator %@", [self mask]]];
+	[self numeric: RPL_YOURHOST text: [NSString stringWithFormat:
+	  @":Your host is %@, running version ircsim-1.0", name]];
+	[self numeric: RPL_CREATED text: @":This server was created today"];
+	[self numeric: RPL_MYINFO text: [NSString stringWithFormat:
+	  @"%@ ircsim-1.0 io beIklmnopstv", name]];
+	[self numeric: RPL_ISUPPORT text: @"CHANTYPES=# PREFIX=(ov)@+ "
+	  @"CHANMODES=beI,k,l,imnpst MODES=4 NICKLEN=30 CHANNELLEN=50 "
+	  @"TOPICLEN=300 MAXTARGETS=4 TARGMAX=JOIN:,PART:,PRIVMSG:4,NOTICE:4 "
+	  @"CASEMAPPING=rfc1459 :are supported by this server"];
+	[self numeric: ERR_NOMOTD text: @":MOTD File is missing"];
+
+	return self;
+}
+- numeric: (NSString *)aNumeric text: (NSString *)aText
+{
+	return [self sendLine: [NSString stringWithFormat: @":%@ %@ %@ %@",
+	  [server serverName], aNumeric, (nick) ? nick : @"*", aText]];
+}
+@end
+
+@implementation IRCSimConnection
+- init
+{
+	if (!(self = [super init])) return nil;
+
+	server = [IRCSimServer currentServer];
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(nick);
+	RELEASE(user);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	[server removeConnection: self withMessage: @"Connection closed"];
+	[super connectionLost];
+}
+- (NSString *)nick
+{
+	return nick;
+}
+- (NSString *)mask
+{
+	return [NSString stringWithFormat: @"%@!%@@127.0.0.1",
+	  (nick) ? nick : @"*", (user) ? user : @"*"];
+}
+- sendData: (NSData *)aData
+{
+	[server countLineOut];
+	[transport writeData: aData];
+	return self;
+}
+- sendLine: (NSString *)aLine
+{
+	return [self sendData: line_data(aLine)];
+}
+- lineReceived: (NSData *)aLine
+{
+	NSString *line;
+	NSString *command;
+	NSArray *params;
+	void (*function)(IRCSimConnection *, NSArray *);
+
+	[server countLineIn];
+
+	line = AUTORELEASE([[NSString alloc] initWithData: aLine
+	  encoding: NSUTF8StringEncoding]);
+	params = parse_line(line, &command);
+	if (!command)
+	{
+		return self;
+	}
+
+	function = NSMapGet(command_to_function, command);
+	if (!function)
+	{
+		[self numeric: ERR_UNKNOWNCOMMAND text: [NSString stringWithFormat:
+		  @"%@ :Unknown command", command]];
+		return self;
+	}
+	if (!registered && function != sim_nick && function != sim_user &&
+	  function != sim_pass && function != sim_ping && function != sim_quit)
+	{
+		[self numeric: ERR_NOTREGISTERED text: @":You have not registered"];
+		return self;
+	}
+
+	function(self, params);
+
+	return self;
+}
+@end
@@ -0,0 +1,2667 @@
+/***************************************************************************
+                                benchmark.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Performance benchmarks for the transport stack.  Every benchmark adds
+ * one or more results, which are printed at the end as CSV (the default)
+ * or JSON so that the output of two builds can be compared with a script.
+ *
+ * Usage: benchmark [-format csv|json] [-only name] [-connections N]
+ *                  [-bytes N] [-lines N] [-fanout N] [-churn N]
+ *                  [-datagrams N] [-dcc-bytes N] [-capture file]
+ *                  [-bouncer-clients N] [-names N] [-list N]
+ *                  [-join-channels N] [-posts N] [-post-threads N]
+ *                  [-work-lines N] [-worker-threads N] [-backend uring]
+ *                  [-pings N] [-socket-buffer N]
+ *                  [-tls-cert file.pem -tls-key file.pem]
+ *
+ * The tls benchmark only runs when a certificate and key are given. The
+ * dcc benchmark writes a file of -dcc-bytes (4GB by default) to the
+ * temporary directory.  The replay benchmarks only run when a
+ * NetCapture file is given; the data received on each of its
+ * connections is fed through a LineObject and an IRCObject.  The
+ * compression benchmark echoes IRC traffic over a CompressedTransport
+ * with each available method and reports the bytes on the wire and the
+ * CPU time used.  The filters benchmark echoes with a stack of
+ * pass-through NetFilter stages on both ends to show what the stack
+ * costs.  The bouncer benchmark feeds IRC lines into one
+ * IRCBouncerUpstream with -bouncer-clients attached clients (100 by
+ * default) writing to null transports.  The names benchmark feeds a
+ * NAMES reply of -names members through an IRCObject, with and without
+ * the RPL_NAMREPLY numerics suppressed.  The list benchmark feeds a
+ * LIST reply of -list channels through an IRCObject, once as plain
+ * numerics and once through a filtered listing.  The ircobject
+ * benchmark runs a second time subscribed to PRIVMSG for a channel none
+ * of the lines are for. The modes benchmark decodes a channel burst of
+ * MODE lines with IRCDecodeModes() and through an IRCObject.  The join
+ * benchmark connects to a stand-in server that handles one line a
+ * millisecond, as flood control would, and times how long joining
+ * -join-channels channels takes with a JOIN per channel and with
+ * -joinChannels:withPasswords:.  The crossthread benchmark has
+ * -post-threads threads send -posts messages to the run loop thread,
+ * with [NetApplication-postMessage:to:withObject:] and with
+ * -performSelectorOnMainThread:, and then measures how long one post
+ * takes to wake an idle run loop.  The workers benchmark echoes
+ * -work-lines lines on each of -connections connections through a
+ * LineObject that hashes every line before replying, on the run loop
+ * thread and then on NetWorkerPools of up to -worker-threads threads
+ * (one per processor by default).  The sockopts benchmark times -pings
+ * round trips of a line written in two parts, as interactive traffic
+ * often is, with Nagle's algorithm on and with TCP_NODELAY, then echoes
+ * -bytes over one connection with the system's buffer sizes and with
+ * SO_SNDBUF and SO_RCVBUF set to -socket-buffer bytes (1MB by default).
+ * The writes benchmark times -pings round trips of a line with each
+ * write strategy of TCPTransport and counts the ET_WDESC events they
+ * take.  The metrics benchmark renders the NetMetricsServer metrics
+ * with -connections connections open.  The churn benchmarks also report
+ * how often buffers were reused from the buffer pool.  With -backend uring every benchmark runs on the io_uring
+ * backend of NetApplication where it is available, so the two backends
+ * are compared by running the benchmarks once with it and once without.
+ */
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/LineObject.h>
+#import <netclasses/IRCObject.h>
+#import <netclasses/NetHistogram.h>
+#import <netclasses/NetMemory.h>
+#import <netclasses/NetTLS.h>
+#import <netclasses/NetUDP.h>
+#import <netclasses/DCCObject.h>
+#import <netclasses/NetCapture.h>
+#import <netclasses/NetCompress.h>
+#import <netclasses/NetFilter.h>
+#import <netclasses/IRCBouncer.h>
+#import <netclasses/NetWorkerPool.h>
+#import <netclasses/NetMetrics.h>
+#import <netclasses/NetPool.h>
+
+#import <Foundation/Foundation.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define CHUNK_SIZE (16 * 1024)
+#define WINDOW_SIZE (256 * 1024)
+#define DATAGRAM_SIZE 64
+#define DATAGRAM_WINDOW 4096
+
+static NSMutableArray *results = nil;
+static NSMutableArray *servers = nil;
+static NSString *only = nil;
+
+static int numConnections = 16;
+static int numBytes = 64 * 1024 * 1024;
+static int numLines = 1000000;
+static int numFanout = 10000;
+static int numChurn = 2000;
+static int numDatagrams = 1000000;
+static int numBouncerClients = 100;
+static int numNames = 50000;
+static int numList = 50000;
+static int numJoinChannels = 300;
+static int numPosts = 1000000;
+static int numPostThreads = 4;
+static int numWorkLines = 2000;
+static int numWorkerThreads = 0;
+static int numPings = 200;
+static int socketBuffer = 1024 * 1024;
+static unsigned long long dccBytes = 4ULL * 1024 * 1024 * 1024;
+
+static int serversConnected = 0;
+static int serversLost = 0;
+static BOOL serversEcho = YES;
+static int numStages = 0;
+
+static NSHost *loopback = nil;
+static NSString *tlsCert = nil;
+static NSString *tlsKey = nil;
+static NSString *captureFile = nil;
+
+static void add_result(NSString *name, NSString *metric, double value,
+  NSString *unit, int param)
+{
+	[results addObject: [NSDictionary dictionaryWithObjectsAndKeys:
+	  name, @"benchmark",
+	  metric, @"metric",
+	  [NSNumber numberWithDouble: value], @"value",
+	  unit, @"unit",
+	  [NSNumber numberWithInt: param], @"param",
+	  nil]];
+}
+
+static BOOL wanted(NSString *name)
+{
+	return (only == nil) || [name isEqualToString: only];
+}
+
+static double seconds_since(uint64_t start)
+{
+	return (NetMonotonicMicroseconds() - start) / 1000000.0;
+}
+
+static BOOL run_until(BOOL (*condition)(void *), void *info, double timeout)
+{
+	uint64_t start = NetMonotonicMicroseconds();
+
+	while (!condition(info))
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+		  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.05]];
+		RELEASE(apr);
+		if (seconds_since(start) > timeout)
+		{
+			return NO;
+		}
+	}
+	return YES;
+}
+
+static BOOL servers_at_least(void *info)
+{
+	return serversConnected >= (int)(intptr_t)info;
+}
+
+static BOOL servers_lost_at_least(void *info)
+{
+	return serversLost >= (int)(intptr_t)info;
+}
+
+static void raise_descriptor_limit(int wanted)
+{
+	struct rlimit limit;
+
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+	{
+		return;
+	}
+	if (limit.rlim_cur >= (rlim_t)wanted)
+	{
+		return;
+	}
+	limit.rlim_cur = (limit.rlim_max == RLIM_INFINITY ||
+	  limit.rlim_max >= (rlim_t)wanted) ? (rlim_t)wanted : limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+static int descriptor_limit(void)
+{
+	struct rlimit limit;
+
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+	{
+		return 1024;
+	}
+	return (limit.rlim_cur > 1000000) ? 1000000 : (int)limit.rlim_cur;
+}
+
+/* A transport that goes nowhere.  Used to drive LineObject and IRCObject
+ * without any sockets.
+ */
+@interface NullTransport : NSObject < NetTransport >
+- (id)localHost;
+- (id)remoteHost;
+- writeData: (NSData *)data;
+- (BOOL)isDoneWriting;
+- (NSData *)readData: (int)maxReadSize;
+- (int)desc;
+- (void)close;
+@end
+
+@implementation NullTransport
+- (id)localHost
+{
+	return nil;
+}
+- (id)remoteHost
+{
+	return nil;
+}
+- writeData: (NSData *)data
+{
+	return self;
+}
+- (BOOL)isDoneWriting
+{
+	return YES;
+}
+- (NSData *)readData: (int)maxReadSize
+{
+	return nil;
+}
+- (int)desc
+{
+	return -1;
+}
+- (void)close
+{
+}
+@end
+
+/* Pushes numStages pass-through filters onto aTransport. */
+static void push_stages(id aTransport)
+{
+	int x;
+
+	for (x = 0; x < numStages; x++)
+	{
+		[(TCPTransport *)aTransport pushFilter:
+		  AUTORELEASE([NetFilter new])];
+	}
+}
+
+@interface BenchServer : NSObject < NetObject >
+	{
+		id <NetTransport> transport;
+	}
+@end
+
+@implementation BenchServer
+- (void)connectionLost
+{
+	serversLost++;
+	[servers removeObjectIdenticalTo: self];
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	push_stages(transport);
+	serversConnected++;
+	[servers addObject: self];
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	if (serversEcho)
+	{
+		[transport writeData: data];
+	}
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@interface BenchDatagram : NSObject < NetDatagramObject >
+	{
+		id <NetTransport> transport;
+		@public
+		int received;
+	}
+@end
+
+@implementation BenchDatagram
+- (void)dealloc
+{
+	RELEASE(transport);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	received++;
+	return self;
+}
+- datagramReceived: (const char *)bytes length: (unsigned)length
+   from: (const struct sockaddr_in *)anAddress
+{
+	received++;
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@interface BenchClient : NSObject < NetObject, TCPConnecting >
+	{
+		id <NetTransport> transport;
+		NSData *chunk;
+		unsigned long long toSend;
+		unsigned long long sent;
+		unsigned long long received;
+		uint64_t arrival;
+	}
+- setBytesToSend: (unsigned long long)aNumber chunk: (NSData *)aChunk;
+- (unsigned long long)received;
+- (uint64_t)arrival;
+- resetArrival;
+- sendMore;
+@end
+
+@implementation BenchClient
+- (void)dealloc
+{
+	RELEASE(chunk);
+	RELEASE(transport);
+	[super dealloc];
+}
+- setBytesToSend: (unsigned long long)aNumber chunk: (NSData *)aChunk
+{
+	ASSIGN(chunk, aChunk);
+	toSend = aNumber;
+	sent = received = 0;
+	return self;
+}
+- (unsigned long long)received
+{
+	return received;
+}
+- (uint64_t)arrival
+{
+	return arrival;
+}
+- resetArrival
+{
+	arrival = 0;
+	return self;
+}
+- sendMore
+{
+	while (sent < toSend && sent - received < WINDOW_SIZE)
+	{
+		[transport writeData: chunk];
+		sent += [chunk length];
+	}
+	return self;
+}
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	push_stages(transport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	if (!arrival)
+	{
+		arrival = NetMonotonicMicroseconds();
+	}
+	received += [data length];
+	if (sent < toSend)
+	{
+		[self sendMore];
+	}
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+- connectingFailed: (NSString *)aError
+{
+	NSLog(@"Connection failed: %@", aError);
+	return self;
+}
+- connectingStarted: (TCPConnecting *)aConnection
+{
+	return self;
+}
+@end
+
+@interface BenchLineObject : LineObject
+	{
+		unsigned long long lines;
+	}
+- attachTransport: (id <NetTransport>)aTransport;
+- (unsigned long long)lines;
+@end
+
+@implementation BenchLineObject
+- attachTransport: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	return self;
+}
+- (unsigned long long)lines
+{
+	return lines;
+}
+- lineReceived: (NSData *)aLine
+{
+	lines++;
+	return self;
+}
+@end
+
+@interface BenchIRCObject : IRCObject
+	{
+		unsigned namesCount;
+		unsigned listCount;
+	}
+- attachTransport: (id <NetTransport>)aTransport;
+- (unsigned)namesCount;
+- (unsigned)listCount;
+@end
+
+@implementation BenchIRCObject
+- attachTransport: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	return self;
+}
+- (unsigned)namesCount
+{
+	return namesCount;
+}
+- namesReceived: (IRCNameList *)aList forChannel: (NSString *)aChannel
+{
+	namesCount = [aList count];
+	return self;
+}
+- (unsigned)listCount
+{
+	return listCount;
+}
+- listEntriesReceived: (NSArray *)entries
+{
+	listCount += [entries count];
+	return self;
+}
+@end
+
+@interface BenchBouncerUpstream : IRCBouncerUpstream
+- attachTransport: (id <NetTransport>)aTransport;
+@end
+
+@implementation BenchBouncerUpstream
+- attachTransport: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	return self;
+}
+@end
+
+@interface BenchBouncerClient : IRCBouncerClient
+- attachTransport: (id <NetTransport>)aTransport;
+@end
+
+@implementation BenchBouncerClient
+- attachTransport: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	return self;
+}
+@end
+
+/* A stand-in IRC server that registers a client and answers JOINs,
+ * handling one line a millisecond.
+ */
+@interface BenchIRCServer : LineObject
+	{
+		NSMutableArray *pending;
+		NSTimer *timer;
+		NSString *nick;
+	}
+- processLine: (NSTimer *)aTimer;
+@end
+
+@implementation BenchIRCServer
+- init
+{
+	if (!(self = [super init])) return nil;
+
+	pending = [NSMutableArray new];
+
+	return self;
+}
+- (void)dealloc
+{
+	[timer invalidate];
+	RELEASE(timer);
+	RELEASE(pending);
+	RELEASE(nick);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	[timer invalidate];
+	DESTROY(timer);
+	[super connectionLost];
+}
+- lineReceived: (NSData *)aLine
+{
+	[pending addObject: aLine];
+	if (!timer)
+	{
+		timer = RETAIN([NSTimer scheduledTimerWithTimeInterval: 0.001
+		  target: self selector: @selector(processLine:) userInfo: nil
+		  repeats: YES]);
+	}
+	return self;
+}
+- writeLine: (NSString *)aLine
+{
+	[transport writeData: [[aLine stringByAppendingString: @"\r\n"]
+	  dataUsingEncoding: NSASCIIStringEncoding]];
+	return self;
+}
+- processLine: (NSTimer *)aTimer
+{
+	NSString *line;
+	NSArray *words;
+	NSString *command;
+	NSEnumerator *iter;
+	id object;
+
+	if ([pending count] == 0)
+	{
+		[timer invalidate];
+		DESTROY(timer);
+		return self;
+	}
+	line = AUTORELEASE([[NSString alloc] initWithData:
+	  [pending objectAtIndex: 0] encoding: NSASCIIStringEncoding]);
+	[pending removeObjectAtIndex: 0];
+
+	words = [line componentsSeparatedByString: @" "];
+	command = [words objectAtIndex: 0];
+	if ([command isEqualToString: @"NICK"] && [words count] > 1)
+	{
+		ASSIGN(nick, [words objectAtIndex: 1]);
+	}
+	else if ([command isEqualToString: @"USER"])
+	{
+		[self writeLine: [NSString stringWithFormat:
+		  @":bench.server 001 %@ :Welcome", nick]];
+		[self writeLine: [NSString stringWithFormat:
+		  @":bench.server 005 %@ TARGMAX=JOIN:,PART:,PRIVMSG:4 "
+		  @":are supported by this server", nick]];
+	}
+	else if ([command isEqualToString: @"JOIN"] && [words count] > 1)
+	{
+		iter = [[[words objectAtIndex: 1] componentsSeparatedByString: @","]
+		  objectEnumerator];
+		while ((object = [iter nextObject]))
+		{
+			[self writeLine: [NSString stringWithFormat:
+			  @":%@!user@host JOIN :%@", nick, object]];
+		}
+	}
+	return self;
+}
+@end
+
+@interface BenchJoinClient : IRCObject
+	{
+		NSArray *channels;
+		NSArray *keys;
+		BOOL batched;
+		int joined;
+	}
+- setChannels: (NSArray *)aChannels keys: (NSArray *)aKeys
+   batched: (BOOL)aBatched;
+- (int)joined;
+@end
+
+@implementation BenchJoinClient
+- (void)dealloc
+{
+	RELEASE(channels);
+	RELEASE(keys);
+	[super dealloc];
+}
+- setChannels: (NSArray *)aChannels keys: (NSArray *)aKeys
+   batched: (BOOL)aBatched
+{
+	ASSIGN(channels, aChannels);
+	ASSIGN(keys, aKeys);
+	batched = aBatched;
+	return self;
+}
+- (int)joined
+{
+	return joined;
+}
+- registeredWithServer
+{
+	id key;
+	int x;
+
+	if (batched)
+	{
+		return [self joinChannels: channels withPasswords: keys];
+	}
+	for (x = 0; x < (int)[channels count]; x++)
+	{
+		key = [keys objectAtIndex: x];
+		[self joinChannel: [channels objectAtIndex: x]
+		  withPassword: [key isKindOfClass: [NSString class]] ? key : nil];
+	}
+	return self;
+}
+- channelJoined: (NSString *)aChannel from: (NSString *)aJoiner
+{
+	joined++;
+	return self;
+}
+@end
+
+static NSArray *make_clients(int count, uint16_t portnum)
+{
+	NSMutableArray *clients = [NSMutableArray arrayWithCapacity: count];
+	BenchClient *client;
+	int x;
+
+	for (x = 0; x < count; x++)
+	{
+		client = AUTORELEASE([BenchClient new]);
+		if (![[TCPSystem sharedInstance] connectNetObject: client
+		  toHost: loopback onPort: portnum withTimeout: 4])
+		{
+			NSLog(@"Could only make %d connections: %@", x,
+			  [[TCPSystem sharedInstance] errorString]);
+			break;
+		}
+		[clients addObject: client];
+		if (!run_until(servers_at_least,
+		  (void *)(intptr_t)(serversConnected + 1), 5.0))
+		{
+			break;
+		}
+	}
+
+	return clients;
+}
+
+static void disconnect_all(NSArray *clients)
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	int target = serversLost + [servers count];
+	NSEnumerator *iter;
+	id object;
+
+	iter = [clients objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[net disconnectObject: object];
+	}
+	run_until(servers_lost_at_least, (void *)(intptr_t)target, 10.0);
+}
+
+static BOOL all_received(void *info)
+{
+	NSEnumerator *iter = [(NSArray *)info objectEnumerator];
+	BenchClient *client;
+
+	while ((client = [iter nextObject]))
+	{
+		if ([client received] < (unsigned long long)numBytes /
+		  [(NSArray *)info count])
+		{
+			return NO;
+		}
+	}
+	return YES;
+}
+
+/* Echoes -bytes split over the clients and returns the MB/s. */
+static double echo_throughput(NSArray *clients, NSString *name)
+{
+	NSData *chunk;
+	char bytes[CHUNK_SIZE];
+	NSEnumerator *iter;
+	BenchClient *client;
+	uint64_t start;
+	double elapsed;
+	unsigned long long perClient;
+
+	memset(bytes, 'x', sizeof(bytes));
+	chunk = [NSData dataWithBytes: bytes length: sizeof(bytes)];
+	perClient = numBytes / [clients count];
+
+	start = NetMonotonicMicroseconds();
+	iter = [clients objectEnumerator];
+	while ((client = [iter nextObject]))
+	{
+		[client setBytesToSend: perClient chunk: chunk];
+		[client sendMore];
+	}
+	if (!run_until(all_received, clients, 120.0))
+	{
+		NSLog(@"%@: timed out", name);
+	}
+	elapsed = seconds_since(start);
+
+	return ((double)perClient * [clients count]) / elapsed / (1024 * 1024);
+}
+
+static void bench_echo(TCPPort *port, int count)
+{
+	NSArray *clients;
+	NSString *name = (count == 1) ? @"echo_1" : @"echo_n";
+
+	serversEcho = YES;
+	clients = make_clients(count, [port port]);
+	if ([clients count] == 0)
+	{
+		return;
+	}
+
+	add_result(name, @"throughput", echo_throughput(clients, name),
+	  @"MB/s", [clients count]);
+
+	disconnect_all(clients);
+}
+
+static void bench_filters(TCPPort *port)
+{
+	NSArray *clients;
+	BenchClient *client;
+	char bytes[CHUNK_SIZE];
+	uint64_t start;
+	int stages[] = { 0, 4 };
+	int x;
+
+	serversEcho = YES;
+	memset(bytes, 'x', sizeof(bytes));
+	for (x = 0; x < (int)(sizeof(stages) / sizeof(stages[0])); x++)
+	{
+		numStages = stages[x];
+		clients = make_clients(1, [port port]);
+		if ([clients count] == 0)
+		{
+			break;
+		}
+		client = [clients objectAtIndex: 0];
+		[client setBytesToSend: numBytes
+		  chunk: [NSData dataWithBytes: bytes length: sizeof(bytes)]];
+
+		start = NetMonotonicMicroseconds();
+		[client sendMore];
+		if (!run_until(all_received, clients, 120.0))
+		{
+			NSLog(@"filters: timed out");
+		}
+		add_result(@"filters", @"throughput",
+		  (double)numBytes / seconds_since(start) / (1024 * 1024), @"MB/s",
+		  numStages);
+
+		disconnect_all(clients);
+	}
+	numStages = 0;
+}
+
+static BOOL has_transport(void *info)
+{
+	return [(id)info transport] != nil;
+}
+
+static void bench_churn(TCPPort *port)
+{
+	TCPSystem *tcp = [TCPSystem sharedInstance];
+	NetApplication *net = [NetApplication sharedInstance];
+	BenchClient *client;
+	uint64_t start;
+	int x;
+
+	serversEcho = NO;
+
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < numChurn; x++)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		client = AUTORELEASE([BenchClient new]);
+		if (![tcp connectNetObject: client toHost: loopback
+		  onPort: [port port] withTimeout: 4])
+		{
+			RELEASE(apr);
+			break;
+		}
+		run_until(servers_at_least,
+		  (void *)(intptr_t)(serversConnected + 1), 5.0);
+		[net disconnectObject: client];
+		run_until(servers_lost_at_least,
+		  (void *)(intptr_t)(serversLost + 1), 5.0);
+		RELEASE(apr);
+	}
+	add_result(@"churn_foreground", @"rate", x / seconds_since(start),
+	  @"conn/s", x);
+
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < numChurn; x++)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		int target = serversConnected + 1;
+
+		client = AUTORELEASE([BenchClient new]);
+		if (![tcp connectNetObjectInBackground: client toHost: loopback
+		  onPort: [port port] withTimeout: 4])
+		{
+			RELEASE(apr);
+			break;
+		}
+		run_until(servers_at_least, (void *)(intptr_t)target, 5.0);
+		if (!run_until(has_transport, client, 5.0))
+		{
+			RELEASE(apr);
+			break;
+		}
+		[net disconnectObject: client];
+		run_until(servers_lost_at_least,
+		  (void *)(intptr_t)(serversLost + 1), 5.0);
+		RELEASE(apr);
+	}
+	add_result(@"churn_background", @"rate", x / seconds_since(start),
+	  @"conn/s", x);
+
+	add_result(@"churn", @"buffer_reuse", [[[[net statistics]
+	  objectForKey: @"BufferPool"] objectForKey: @"HitRate"] doubleValue],
+	  @"ratio", numChurn);
+}
+
+static BOOL received_any(void *info)
+{
+	return [(BenchClient *)info received] > 0;
+}
+
+/* Connects, makes one round trip and disconnects numChurn / 10 times over
+ * TLS, once with the session cache flushed before every connection and
+ * once with it kept, then measures the throughput of one TLS connection.
+ */
+static int tls_connections(uint16_t portnum, int count, BOOL resume)
+{
+	TCPSystem *tcp = [TCPSystem sharedInstance];
+	NetApplication *net = [NetApplication sharedInstance];
+	NSData *ping = [NSData dataWithBytes: "x" length: 1];
+	BenchClient *client;
+	int x;
+
+	serversEcho = YES;
+	for (x = 0; x < count; x++)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+
+		if (!resume)
+		{
+			[TLSTransport flushSessionCache];
+		}
+		client = AUTORELEASE([BenchClient new]);
+		if (![tcp connectNetObject: client toHost: loopback
+		  onPort: portnum withTimeout: 4
+		  transportClass: [TLSTransport class]])
+		{
+			NSLog(@"tls: %@", [tcp errorString]);
+			RELEASE(apr);
+			break;
+		}
+		[client setBytesToSend: 1 chunk: ping];
+		[client sendMore];
+		if (!run_until(received_any, client, 5.0))
+		{
+			RELEASE(apr);
+			break;
+		}
+		[net disconnectObject: client];
+		run_until(servers_lost_at_least,
+		  (void *)(intptr_t)(serversLost + 1), 5.0);
+		RELEASE(apr);
+	}
+	return x;
+}
+
+static void bench_tls(void)
+{
+	TCPPort *port;
+	NSArray *clients;
+	BenchClient *client;
+	char bytes[CHUNK_SIZE];
+	uint64_t start;
+	int count = (numChurn / 10) ? numChurn / 10 : 1;
+	int made;
+
+	if (![TLSTransport setCertificateFile: tlsCert privateKeyFile: tlsKey])
+	{
+		NSLog(@"tls: %@", [[TCPSystem sharedInstance] errorString]);
+		return;
+	}
+	port = AUTORELEASE([[TCPPort alloc] initOnPort: 0]);
+	if (!port)
+	{
+		return;
+	}
+	[port setNetObject: [BenchServer class]];
+	[port setTransportClass: [TLSTransport class]];
+
+	start = NetMonotonicMicroseconds();
+	made = tls_connections([port port], count, NO);
+	add_result(@"tls_full", @"rate", made / seconds_since(start),
+	  @"conn/s", made);
+
+	start = NetMonotonicMicroseconds();
+	made = tls_connections([port port], count, YES);
+	add_result(@"tls_resumed", @"rate", made / seconds_since(start),
+	  @"conn/s", made);
+
+	client = AUTORELEASE([BenchClient new]);
+	if (![[TCPSystem sharedInstance] connectNetObject: client
+	  toHost: loopback onPort: [port port] withTimeout: 4
+	  transportClass: [TLSTransport class]])
+	{
+		[[NetApplication sharedInstance] disconnectObject: port];
+		return;
+	}
+	clients = [NSArray arrayWithObject: client];
+	memset(bytes, 'x', sizeof(bytes));
+	[client setBytesToSend: numBytes
+	  chunk: [NSData dataWithBytes: bytes length: sizeof(bytes)]];
+
+	start = NetMonotonicMicroseconds();
+	[client sendMore];
+	if (!run_until(all_received, clients, 120.0))
+	{
+		NSLog(@"tls: timed out");
+	}
+	add_result(@"tls_echo", @"throughput",
+	  (double)numBytes / seconds_since(start) / (1024 * 1024), @"MB/s", 1);
+
+	disconnect_all(clients);
+	[[NetApplication sharedInstance] disconnectObject: port];
+}
+
+static double cpu_seconds(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0 +
+	  usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+}
+
+static NSData *make_lines(NSArray *templates, int count, int *made);
+
+static void bench_compressed(TCPPort *port, NetCompressionMethod aMethod,
+  NSData *chunk)
+{
+	NSString *name;
+	NSArray *clients;
+	NSDictionary *statistics;
+	BenchClient *client;
+	uint64_t start;
+	double cpu;
+
+	name = [NSString stringWithFormat: @"compress_%@",
+	  (aMethod == NetCompressionZstd) ? @"zstd" :
+	  (aMethod == NetCompressionZlib) ? @"zlib" : @"none"];
+	[CompressedTransport setDefaultMethods: aMethod];
+
+	client = AUTORELEASE([BenchClient new]);
+	if (![[TCPSystem sharedInstance] connectNetObject: client
+	  toHost: loopback onPort: [port port] withTimeout: 4
+	  transportClass: [CompressedTransport class]])
+	{
+		NSLog(@"%@: %@", name, [[TCPSystem sharedInstance] errorString]);
+		return;
+	}
+	clients = [NSArray arrayWithObject: client];
+	[client setBytesToSend: numBytes chunk: chunk];
+
+	start = NetMonotonicMicroseconds();
+	cpu = cpu_seconds();
+	[client sendMore];
+	if (!run_until(all_received, clients, 120.0))
+	{
+		NSLog(@"%@: timed out", name);
+	}
+	cpu = cpu_seconds() - cpu;
+	statistics = [(CompressedTransport *)[client transport] statistics];
+
+	add_result(name, @"throughput",
+	  (double)numBytes / seconds_since(start) / (1024 * 1024), @"MB/s", 1);
+	add_result(name, @"wire", [[statistics objectForKey: @"BytesWritten"]
+	  doubleValue] / numBytes, @"bytes/byte", 1);
+	add_result(name, @"cpu", cpu / ((double)numBytes / (1024 * 1024)) * 1000,
+	  @"ms/MB", 1);
+
+	disconnect_all(clients);
+}
+
+static void bench_compression(void)
+{
+	TCPPort *port;
+	NSData *chunk;
+	unsigned available;
+	int made;
+
+	port = AUTORELEASE([[TCPPort alloc] initOnPort: 0]);
+	if (!port)
+	{
+		return;
+	}
+	[port setNetObject: [BenchServer class]];
+	[port setTransportClass: [CompressedTransport class]];
+
+	chunk = make_lines([NSArray arrayWithObjects:
+	  @":nick!user@host PRIVMSG #channel :hello there, this is a line\r\n",
+	  @":other!ident@some.host.example.com JOIN :#channel\r\n",
+	  @":irc.example.net 353 bench = #channel :@op +voice user1 user2\r\n",
+	  nil], 256, &made);
+
+	available = [CompressedTransport availableMethods];
+	bench_compressed(port, NetCompressionNone, chunk);
+	if (available & NetCompressionZlib)
+	{
+		bench_compressed(port, NetCompressionZlib, chunk);
+	}
+	if (available & NetCompressionZstd)
+	{
+		bench_compressed(port, NetCompressionZstd, chunk);
+	}
+	[CompressedTransport setDefaultMethods: available];
+
+	[[NetApplication sharedInstance] disconnectObject: port];
+}
+
+static NSData *make_lines(NSArray *templates, int count, int *made)
+{
+	NSMutableData *data = [NSMutableData data];
+	int x;
+
+	for (x = 0; x < count; x++)
+	{
+		[data appendData: [[templates objectAtIndex: x % [templates count]]
+		  dataUsingEncoding: NSASCIIStringEncoding]];
+	}
+	*made = count;
+	return data;
+}
+
+static void bench_lineobject(void)
+{
+	BenchLineObject *object = AUTORELEASE([BenchLineObject new]);
+	NSData *data;
+	const char *bytes;
+	uint64_t start;
+	unsigned offset;
+	int made;
+
+	data = make_lines([NSArray arrayWithObjects:
+	  @":nick!user@host PRIVMSG #channel :hello there, this is a line\r\n",
+	  @"PING :irc.example.net\r\n",
+	  @":irc.example.net 372 nick :- message of the day\n",
+	  nil], numLines, &made);
+	bytes = [data bytes];
+
+	[object attachTransport: AUTORELEASE([NullTransport new])];
+
+	start = NetMonotonicMicroseconds();
+	for (offset = 0; offset < [data length]; offset += 4096)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		unsigned length = [data length] - offset;
+
+		if (length > 4096) length = 4096;
+		[object dataReceived: [NSData dataWithBytesNoCopy:
+		  (void *)(bytes + offset) length: length freeWhenDone: NO]];
+		RELEASE(apr);
+	}
+	add_result(@"lineobject", @"rate", [object lines] / seconds_since(start),
+	  @"lines/s", made);
+}
+
+/* Feeds the same lines through a MemoryTransport pair chunked so that
+ * lines are split across reads, then checks that a window and latency
+ * limited link gives the throughput it should on the virtual clock.
+ */
+static void bench_memory(void)
+{
+	MemoryDriver *driver = AUTORELEASE([MemoryDriver new]);
+	BenchLineObject *object = AUTORELEASE([BenchLineObject new]);
+	MemoryTransport *sender;
+	NSArray *pair;
+	NSData *data;
+	const char *bytes;
+	uint64_t start;
+	unsigned offset;
+	unsigned length;
+	int made;
+
+	data = make_lines([NSArray arrayWithObjects:
+	  @":nick!user@host PRIVMSG #channel :hello there, this is a line\r\n",
+	  @"PING :irc.example.net\r\n",
+	  @":irc.example.net 372 nick :- message of the day\n",
+	  nil], numLines, &made);
+	bytes = [data bytes];
+
+	pair = [driver createTransportPair];
+	sender = [pair objectAtIndex: 0];
+	[sender setChunkSize: 1000];
+	[object connectionEstablished: [pair objectAtIndex: 1]];
+
+	start = NetMonotonicMicroseconds();
+	for (offset = 0; offset < [data length]; offset += 65536)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+
+		length = [data length] - offset;
+		if (length > 65536) length = 65536;
+		[sender writeData: [NSData dataWithBytesNoCopy:
+		  (void *)(bytes + offset) length: length freeWhenDone: NO]];
+		[driver runUntilIdle];
+		RELEASE(apr);
+	}
+	add_result(@"memory_lineobject", @"rate",
+	  [object lines] / seconds_since(start), @"lines/s", made);
+	[[NetApplication sharedInstance] disconnectObject: object];
+
+	/* 64KB window, 10ms latency and 100MB/s: the window is only opened
+	 * again when the data arrives, so this is limited to 64KB every
+	 * 10ms, or 6.25MB/s of virtual time.
+	 */
+	object = AUTORELEASE([BenchLineObject new]);
+	pair = [driver createTransportPair];
+	sender = [pair objectAtIndex: 0];
+	[sender setWindow: 65536];
+	[sender setLatency: 10000];
+	[sender setBandwidth: 100.0 * 1024 * 1024];
+	[object connectionEstablished: [pair objectAtIndex: 1]];
+
+	start = [driver currentTime];
+	[sender writeData: data];
+	[driver runUntilQuiet];
+	add_result(@"memory_window", @"virtual_throughput",
+	  [data length] / (([driver currentTime] - start) / 1000000.0) /
+	  (1024 * 1024), @"MB/s", 65536);
+	[[NetApplication sharedInstance] disconnectObject: object];
+}
+
+/* Sends small datagrams over loopback as fast as the receiver takes them,
+ * keeping at most DATAGRAM_WINDOW of them unaccounted for.  Datagrams the
+ * kernel drops are counted as lost once the receiver has been idle for a
+ * while, so a loss does not stall the benchmark.
+ */
+static void bench_udp(void)
+{
+	UDPSystem *system = [UDPSystem sharedInstance];
+	BenchDatagram *receiver = AUTORELEASE([BenchDatagram new]);
+	BenchDatagram *sender = AUTORELEASE([BenchDatagram new]);
+	NSData *payload;
+	char bytes[DATAGRAM_SIZE];
+	uint64_t start;
+	uint64_t lastProgress;
+	int lastReceived = 0;
+	int sent = 0;
+	int lost = 0;
+
+	if (![system bindNetObject: receiver onHost: loopback onPort: 0] ||
+	  ![system connectNetObject: sender toHost: loopback
+	  onPort: [(UDPTransport *)[receiver transport] port]])
+	{
+		NSLog(@"Could not open UDP socket: %@", [system errorString]);
+		return;
+	}
+
+	memset(bytes, 'x', sizeof(bytes));
+	payload = [NSData dataWithBytes: bytes length: sizeof(bytes)];
+
+	start = lastProgress = NetMonotonicMicroseconds();
+	while (receiver->received + lost < numDatagrams)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+
+		while (sent < numDatagrams &&
+		  sent - receiver->received - lost < DATAGRAM_WINDOW)
+		{
+			[[sender transport] writeData: payload];
+			sent++;
+		}
+		[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+		  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.01]];
+
+		if (receiver->received != lastReceived)
+		{
+			lastReceived = receiver->received;
+			lastProgress = NetMonotonicMicroseconds();
+		}
+		else if ([[sender transport] isDoneWriting] &&
+		  NetMonotonicMicroseconds() - lastProgress > 200000)
+		{
+			lost = sent - receiver->received;
+			lastProgress = NetMonotonicMicroseconds();
+		}
+		RELEASE(apr);
+	}
+	add_result(@"udp", @"rate", receiver->received / seconds_since(start),
+	  @"datagrams/s", DATAGRAM_SIZE);
+	add_result(@"udp", @"loss", 100.0 * lost / numDatagrams,
+	  @"%", DATAGRAM_SIZE);
+
+	[[NetApplication sharedInstance] disconnectObject: sender];
+	[[NetApplication sharedInstance] disconnectObject: receiver];
+}
+
+static BOOL transfers_finished(void *info)
+{
+	NSArray *transfers = info;
+	NSString *status;
+	int x;
+
+	for (x = 0; x < (int)[transfers count]; x++)
+	{
+		status = [[transfers objectAtIndex: x] status];
+		if (status != DCCStatusDone && status != DCCStatusError &&
+		  status != DCCStatusAborted)
+		{
+			return NO;
+		}
+	}
+	return YES;
+}
+
+/* Sends a sparse multi-GB file over DCC on loopback.  The file is sent
+ * with sendfile() and written with splice(), so this measures how fast the
+ * data moves through the kernel without passing through the process.
+ */
+static void bench_dcc(void)
+{
+	NSString *directory = NSTemporaryDirectory();
+	NSString *source;
+	NSString *destination;
+	DCCSendObject *sender;
+	DCCReceiveObject *receiver;
+	NSDictionary *info;
+	uint64_t start;
+	int desc;
+
+	source = [directory stringByAppendingPathComponent:
+	  [NSString stringWithFormat: @"netclasses-dcc-%d.src", (int)getpid()]];
+	destination = [directory stringByAppendingPathComponent:
+	  [NSString stringWithFormat: @"netclasses-dcc-%d.dst", (int)getpid()]];
+
+	desc = open([source fileSystemRepresentation],
+	  O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (desc == -1 || ftruncate(desc, dccBytes) == -1)
+	{
+		NSLog(@"Could not create %@", source);
+		if (desc != -1) close(desc);
+		return;
+	}
+	close(desc);
+
+	sender = AUTORELEASE([[DCCSendObject alloc] initWithFile: source]);
+	if (![sender listenOnHost: loopback onPort: 0])
+	{
+		NSLog(@"Could not listen: %@", 
+		  [[TCPSystem sharedInstance] errorString]);
+		unlink([source fileSystemRepresentation]);
+		return;
+	}
+	info = [NSDictionary dictionaryWithObjectsAndKeys:
+	  @"bench.bin", @"FileName",
+	  loopback, @"Host",
+	  [NSNumber numberWithInt: [sender port]], @"Port",
+	  [NSNumber numberWithUnsignedLongLong: dccBytes], @"Size",
+	  nil];
+	receiver = AUTORELEASE([[DCCReceiveObject alloc] initWithFileInfo: info
+	  toPath: destination resume: NO]);
+
+	start = NetMonotonicMicroseconds();
+	[receiver connect];
+	run_until(transfers_finished, [NSArray arrayWithObjects: sender,
+	  receiver, nil], 600.0);
+
+	if ([receiver status] == DCCStatusDone && [sender status] == DCCStatusDone)
+	{
+		add_result(@"dcc", @"throughput",
+		  dccBytes / seconds_since(start) / (1024 * 1024), @"MB/s",
+		  (int)(dccBytes / (1024 * 1024)));
+	}
+	else
+	{
+		NSLog(@"DCC transfer failed: sender %@, receiver %@ at %llu",
+		  [sender status], [receiver status], [receiver position]);
+		[sender abort];
+		[receiver abort];
+	}
+
+	unlink([source fileSystemRepresentation]);
+	unlink([destination fileSystemRepresentation]);
+}
+
+static void bench_ircobject_with(BOOL subscribed)
+{
+	BenchIRCObject *object;
+	NSArray *lines;
+	NSMutableArray *datas;
+	uint64_t start;
+	int x, count;
+
+	object = AUTORELEASE([[BenchIRCObject alloc] initWithNickname: @"bench"
+	  withUserName: nil withRealName: nil withPassword: nil]);
+	[object attachTransport: AUTORELEASE([NullTransport new])];
+	if (subscribed)
+	{
+		[object subscribeToCommand: @"PRIVMSG" target: @"#other"];
+	}
+
+	lines = [NSArray arrayWithObjects:
+	  @":nick!user@host PRIVMSG #channel :hello there, this is a line",
+	  @":nick!user@host JOIN :#channel",
+	  @":irc.example.net 353 bench = #channel :@op +voice user1 user2",
+	  @":nick!user@host MODE #channel +ov nick nick",
+	  @"PING :irc.example.net",
+	  @":nick!user@host NOTICE bench :\001VERSION\001",
+	  nil];
+	datas = [NSMutableArray arrayWithCapacity: [lines count]];
+	for (x = 0; x < (int)[lines count]; x++)
+	{
+		[datas addObject: [[lines objectAtIndex: x]
+		  dataUsingEncoding: NSASCIIStringEncoding]];
+	}
+
+	count = [datas count];
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < numLines;)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		int y;
+
+		for (y = 0; y < 256 && x < numLines; y++, x++)
+		{
+			[object lineReceived: [datas objectAtIndex: x % count]];
+		}
+		RELEASE(apr);
+	}
+	add_result(subscribed ? @"ircobject_subscribed" : @"ircobject", @"rate",
+	  numLines / seconds_since(start), @"lines/s", numLines);
+}
+
+static void bench_ircobject(void)
+{
+	bench_ircobject_with(NO);
+	bench_ircobject_with(YES);
+}
+
+static void bench_names_with(NSArray *datas, BOOL suppress)
+{
+	BenchIRCObject *object;
+	uint64_t start;
+	int x, count = [datas count];
+	int rounds = 10;
+
+	object = AUTORELEASE([[BenchIRCObject alloc] initWithNickname: @"bench"
+	  withUserName: nil withRealName: nil withPassword: nil]);
+	[object attachTransport: AUTORELEASE([NullTransport new])];
+	[object setSuppressesNamesNumerics: suppress];
+
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < rounds * count; x++)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		[object lineReceived: [datas objectAtIndex: x % count]];
+		RELEASE(apr);
+	}
+	add_result(suppress ? @"names_suppressed" : @"names", @"rate",
+	  rounds * numNames / seconds_since(start), @"members/s", numNames);
+	if ((int)[object namesCount] != numNames)
+	{
+		NSLog(@"names: got %u members, expected %d", [object namesCount],
+		  numNames);
+	}
+}
+
+static void bench_names(void)
+{
+	NSMutableArray *datas;
+	NSMutableString *line;
+	int x;
+
+	datas = [NSMutableArray array];
+	line = [NSMutableString string];
+	for (x = 0; x < numNames; x++)
+	{
+		if ([line length] == 0)
+		{
+			[line appendString: @":irc.example.net 353 bench = #big :"];
+		}
+		else
+		{
+			[line appendString: @" "];
+		}
+		[line appendFormat: (x % 50 == 0) ? @"@+user%d" :
+		  (x % 7 == 0) ? @"+user%d" : @"user%d", x];
+		if ([line length] > 450 || x == numNames - 1)
+		{
+			[datas addObject: [line dataUsingEncoding: NSASCIIStringEncoding]];
+			[line setString: @""];
+		}
+	}
+	[datas addObject: [@":irc.example.net 366 bench #big :End of /NAMES list."
+	  dataUsingEncoding: NSASCIIStringEncoding]];
+
+	bench_names_with(datas, NO);
+	bench_names_with(datas, YES);
+}
+
+static void bench_list_with(NSArray *datas, BOOL filtered)
+{
+	BenchIRCObject *object;
+	uint64_t start;
+	int x, count = [datas count];
+
+	object = AUTORELEASE([[BenchIRCObject alloc] initWithNickname: @"bench"
+	  withUserName: nil withRealName: nil withPassword: nil]);
+	[object attachTransport: AUTORELEASE([NullTransport new])];
+	if (filtered)
+	{
+		[object listChannelsWithMinimumUsers: 50 nameMatching: @"#chan*"
+		  topicContaining: @"netclasses" batchSize: 256];
+	}
+
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < count;)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		int y;
+
+		for (y = 0; y < 256 && x < count; y++, x++)
+		{
+			[object lineReceived: [datas objectAtIndex: x]];
+		}
+		RELEASE(apr);
+	}
+	add_result(filtered ? @"list_filtered" : @"list", @"rate",
+	  numList / seconds_since(start), @"channels/s", numList);
+	if (filtered)
+	{
+		add_result(@"list_filtered", @"matched", [object listCount],
+		  @"channels", numList);
+	}
+}
+
+static void bench_list(void)
+{
+	NSMutableArray *datas;
+	int x;
+
+	datas = [NSMutableArray arrayWithCapacity: numList + 2];
+	[datas addObject: [@":irc.example.net 321 bench Channel :Users  Name"
+	  dataUsingEncoding: NSASCIIStringEncoding]];
+	for (x = 0; x < numList; x++)
+	{
+		[datas addObject: [[NSString stringWithFormat:
+		  @":irc.example.net 322 bench #chan%d %d :[+nt] topic %d about %@",
+		  x, x % 200, x, (x % 10) ? @"nothing" : @"netclasses"]
+		  dataUsingEncoding: NSASCIIStringEncoding]];
+	}
+	[datas addObject: [@":irc.example.net 323 bench :End of /LIST"
+	  dataUsingEncoding: NSASCIIStringEncoding]];
+
+	bench_list_with(datas, NO);
+	bench_list_with(datas, YES);
+}
+
+static void bench_modes(void)
+{
+	BenchIRCObject *object;
+	IRCModeChange changes[32];
+	const char *modes = "+ooovvb-k+l nick1 nick2 nick3 nick4 nick5 *!*@bad "
+	  "key 50";
+	NSData *data;
+	unsigned long long total = 0;
+	uint64_t start;
+	int x;
+
+	object = AUTORELEASE([[BenchIRCObject alloc] initWithNickname: @"bench"
+	  withUserName: nil withRealName: nil withPassword: nil]);
+	[object attachTransport: AUTORELEASE([NullTransport new])];
+	[object lineReceived: [@":irc.example.net 005 bench PREFIX=(ov)@+ "
+	  @"CHANMODES=beI,k,l,imnpst :are supported by this server"
+	  dataUsingEncoding: NSASCIIStringEncoding]];
+
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < numLines; x++)
+	{
+		total += IRCDecodeModes([object serverSupport], YES, modes,
+		  strlen(modes), changes, 32);
+	}
+	add_result(@"modes_decode", @"rate", total / seconds_since(start),
+	  @"modes/s", numLines);
+
+	data = [[NSString stringWithFormat: @":op!user@host MODE #channel %s",
+	  modes] dataUsingEncoding: NSASCIIStringEncoding];
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < numLines;)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		int y;
+
+		for (y = 0; y < 256 && x < numLines; y++, x++)
+		{
+			[object lineReceived: data];
+		}
+		RELEASE(apr);
+	}
+	add_result(@"modes_ircobject", @"rate", numLines / seconds_since(start),
+	  @"lines/s", numLines);
+}
+
+static BOOL joined_all(void *info)
+{
+	return [(BenchJoinClient *)info joined] >= numJoinChannels;
+}
+
+static void bench_join(void)
+{
+	TCPPort *ircPort;
+	BenchJoinClient *client;
+	NSMutableArray *channels, *keys;
+	uint64_t start;
+	int x, batched;
+
+	ircPort = AUTORELEASE([[TCPPort alloc] initOnPort: 0]);
+	if (!ircPort)
+	{
+		return;
+	}
+	[ircPort setNetObject: [BenchIRCServer class]];
+
+	channels = [NSMutableArray arrayWithCapacity: numJoinChannels];
+	keys = [NSMutableArray arrayWithCapacity: numJoinChannels];
+	for (x = 0; x < numJoinChannels; x++)
+	{
+		[channels addObject: [NSString stringWithFormat: @"#channel%d", x]];
+		[keys addObject: (x % 10) ? (id)[NSNull null] :
+		  (id)[NSString stringWithFormat: @"key%d", x]];
+	}
+
+	for (batched = 0; batched < 2; batched++)
+	{
+		client = AUTORELEASE([[BenchJoinClient alloc] initWithNickname: @"bench"
+		  withUserName: @"bench" withRealName: @"bench" withPassword: nil]);
+		[client setChannels: channels keys: keys batched: batched];
+
+		start = NetMonotonicMicroseconds();
+		if (![[TCPSystem sharedInstance] connectNetObject: client
+		  toHost: loopback onPort: [ircPort port] withTimeout: 4])
+		{
+			NSLog(@"join: could not connect: %@",
+			  [[TCPSystem sharedInstance] errorString]);
+			break;
+		}
+		if (!run_until(joined_all, client, 120.0))
+		{
+			NSLog(@"join: timed out with %d channels joined", [client joined]);
+		}
+		add_result(batched ? @"join_batched" : @"join", @"time",
+		  seconds_since(start) * 1000, @"ms", numJoinChannels);
+		add_result(batched ? @"join_batched" : @"join", @"lines_out",
+		  [[[client statistics] objectForKey: @"LinesOut"] doubleValue],
+		  @"lines", numJoinChannels);
+		[[NetApplication sharedInstance] disconnectObject: client];
+	}
+
+	[[NetApplication sharedInstance] disconnectObject: ircPort];
+	[ircPort close];
+}
+
+#define NUM_WAKEUPS 2000
+
+enum { POST_MESSAGES, PERFORM_MESSAGES, POST_PINGS };
+
+@interface BenchPostReceiver : NSObject
+	{
+	@public
+		int received;
+		uint64_t posted;
+		int acknowledged;
+		NetHistogram *latency;
+	}
+- countPost: (id)anObject;
+- ping: (id)anObject;
+@end
+
+@implementation BenchPostReceiver
+- (void)dealloc
+{
+	RELEASE(latency);
+	[super dealloc];
+}
+- countPost: (id)anObject
+{
+	received++;
+	return self;
+}
+- ping: (id)anObject
+{
+	[latency recordValue: NetMonotonicMicroseconds() -
+	  __atomic_load_n(&posted, __ATOMIC_ACQUIRE)];
+	received++;
+	__atomic_store_n(&acknowledged, 1, __ATOMIC_RELEASE);
+	return self;
+}
+@end
+
+/* Sends messages to a BenchPostReceiver from a thread of its own. */
+@interface BenchPoster : NSObject
+	{
+		BenchPostReceiver *receiver;
+		int count;
+		int mode;
+	}
+- initWithReceiver: (BenchPostReceiver *)aReceiver count: (int)aCount
+   mode: (int)aMode;
+- run: (id)anObject;
+@end
+
+@implementation BenchPoster
+- initWithReceiver: (BenchPostReceiver *)aReceiver count: (int)aCount
+   mode: (int)aMode
+{
+	if (!(self = [super init])) return nil;
+
+	receiver = RETAIN(aReceiver);
+	count = aCount;
+	mode = aMode;
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(receiver);
+	[super dealloc];
+}
+- run: (id)anObject
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	int x;
+
+	for (x = 0; x < count; x++)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		switch (mode)
+		{
+			case POST_MESSAGES:
+				[net postMessage: @selector(countPost:) to: receiver
+				  withObject: nil];
+				break;
+			case PERFORM_MESSAGES:
+				[receiver performSelectorOnMainThread: @selector(countPost:)
+				  withObject: nil waitUntilDone: NO];
+				break;
+			case POST_PINGS:
+				/* Let the run loop go idle, then time one wakeup. */
+				usleep(200);
+				__atomic_store_n(&receiver->acknowledged, 0, __ATOMIC_RELAXED);
+				__atomic_store_n(&receiver->posted, NetMonotonicMicroseconds(),
+				  __ATOMIC_RELEASE);
+				[net postMessage: @selector(ping:) to: receiver withObject: nil];
+				while (!__atomic_load_n(&receiver->acknowledged,
+				  __ATOMIC_ACQUIRE))
+				{
+					usleep(1);
+				}
+				break;
+		}
+		RELEASE(apr);
+	}
+	return self;
+}
+@end
+
+static int postsExpected = 0;
+
+static BOOL all_posts_received(void *info)
+{
+	return ((BenchPostReceiver *)info)->received >= postsExpected;
+}
+
+static void run_posters(BenchPostReceiver *receiver, int threads, int count,
+  int mode)
+{
+	int x;
+
+	receiver->received = 0;
+	postsExpected = threads * count;
+	for (x = 0; x < threads; x++)
+	{
+		[NSThread detachNewThreadSelector: @selector(run:)
+		  toTarget: AUTORELEASE([[BenchPoster alloc] initWithReceiver: receiver
+		    count: count mode: mode])
+		  withObject: nil];
+	}
+	if (!run_until(all_posts_received, receiver, 120.0))
+	{
+		NSLog(@"crossthread: timed out with %d of %d messages",
+		  receiver->received, postsExpected);
+	}
+}
+
+static unsigned long long post_wakeups(void)
+{
+	return [[[[NetApplication sharedInstance] statistics]
+	  objectForKey: @"PostWakeups"] unsignedLongLongValue];
+}
+
+static void bench_crossthread(void)
+{
+	BenchPostReceiver *receiver;
+	int count = numPosts / numPostThreads;
+	unsigned long long wakeups;
+	uint64_t start;
+
+	receiver = AUTORELEASE([BenchPostReceiver new]);
+	receiver->latency = [NetHistogram new];
+
+	wakeups = post_wakeups();
+	start = NetMonotonicMicroseconds();
+	run_posters(receiver, numPostThreads, count, POST_MESSAGES);
+	add_result(@"crossthread_post", @"rate",
+	  receiver->received / seconds_since(start), @"msgs/s", numPostThreads);
+	add_result(@"crossthread_post", @"wakeups",
+	  post_wakeups() - wakeups, @"wakeups", numPostThreads);
+
+	start = NetMonotonicMicroseconds();
+	run_posters(receiver, numPostThreads, count, PERFORM_MESSAGES);
+	add_result(@"crossthread_perform", @"rate",
+	  receiver->received / seconds_since(start), @"msgs/s", numPostThreads);
+
+	run_posters(receiver, 1, NUM_WAKEUPS, POST_PINGS);
+	add_result(@"crossthread_wakeup", @"p50_latency",
+	  [receiver->latency valueAtPercentile: 50.0], @"us", NUM_WAKEUPS);
+	add_result(@"crossthread_wakeup", @"p99_latency",
+	  [receiver->latency valueAtPercentile: 99.0], @"us", NUM_WAKEUPS);
+}
+
+#define WORK_LINE_LENGTH 64
+#define WORK_ROUNDS 200
+
+static NetWorkerPool *workerPool = nil;
+static int workersConnected = 0;
+static int workersLost = 0;
+static volatile uint32_t workSink;
+
+/* A line handler that costs about as much as a lookup or a scoring pass,
+ * replying with the line it was given. */
+@interface BenchWorkLine : LineObject
+@end
+
+@implementation BenchWorkLine
+- (void)connectionLost
+{
+	__atomic_add_fetch(&workersLost, 1, __ATOMIC_RELAXED);
+	[super connectionLost];
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	[super connectionEstablished: aTransport];
+	if (workerPool)
+	{
+		[[NetApplication sharedInstance] setWorkerPool: workerPool
+		  forObject: self];
+	}
+	workersConnected++;
+	return self;
+}
+- lineReceived: (NSData *)aLine
+{
+	const unsigned char *bytes = [aLine bytes];
+	unsigned length = [aLine length];
+	NSMutableData *reply;
+	uint32_t hash = 2166136261U;
+	unsigned x, y;
+
+	for (x = 0; x < WORK_ROUNDS; x++)
+	{
+		for (y = 0; y < length; y++)
+		{
+			hash = (hash ^ bytes[y]) * 16777619U;
+		}
+	}
+	workSink = hash;
+
+	reply = [NSMutableData dataWithCapacity: length + 1];
+	[reply appendData: aLine];
+	[reply appendBytes: "\n" length: 1];
+	[transport writeData: reply];
+	return self;
+}
+@end
+
+static BOOL workers_at_least(void *info)
+{
+	return __atomic_load_n(&workersConnected, __ATOMIC_RELAXED) >=
+	  (int)(intptr_t)info;
+}
+
+static BOOL workers_lost_at_least(void *info)
+{
+	return __atomic_load_n(&workersLost, __ATOMIC_RELAXED) >=
+	  (int)(intptr_t)info;
+}
+
+static BOOL all_work_received(void *info)
+{
+	NSEnumerator *iter = [(NSArray *)info objectEnumerator];
+	BenchClient *client;
+
+	while ((client = [iter nextObject]))
+	{
+		if ([client received] <
+		  (unsigned long long)numWorkLines * WORK_LINE_LENGTH)
+		{
+			return NO;
+		}
+	}
+	return YES;
+}
+
+static void bench_workers_with(int threads, NSData *chunk)
+{
+	TCPPort *workPort;
+	NSMutableArray *clients;
+	BenchClient *client;
+	uint64_t start;
+	int x;
+
+	workPort = AUTORELEASE([[TCPPort alloc] initOnPort: 0]);
+	if (!workPort)
+	{
+		return;
+	}
+	[workPort setNetObject: [BenchWorkLine class]];
+	workerPool = (threads) ? [[NetWorkerPool alloc] initWithThreads: threads]
+	  : nil;
+	workersConnected = workersLost = 0;
+
+	clients = [NSMutableArray arrayWithCapacity: numConnections];
+	for (x = 0; x < numConnections; x++)
+	{
+		client = AUTORELEASE([BenchClient new]);
+		if (![[TCPSystem sharedInstance] connectNetObject: client
+		  toHost: loopback onPort: [workPort port] withTimeout: 4])
+		{
+			NSLog(@"workers: could only make %d connections: %@", x,
+			  [[TCPSystem sharedInstance] errorString]);
+			break;
+		}
+		[clients addObject: client];
+	}
+	run_until(workers_at_least, (void *)(intptr_t)[clients count], 5.0);
+
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < (int)[clients count]; x++)
+	{
+		[[clients objectAtIndex: x] setBytesToSend:
+		  (unsigned long long)numWorkLines * WORK_LINE_LENGTH chunk: chunk];
+		[[clients objectAtIndex: x] sendMore];
+	}
+	if (!run_until(all_work_received, clients, 120.0))
+	{
+		NSLog(@"workers: timed out with %d threads", threads);
+	}
+	add_result(threads ? @"workers_pool" : @"workers_runloop", @"rate",
+	  numWorkLines * [clients count] / seconds_since(start), @"lines/s",
+	  threads);
+
+	for (x = 0; x < (int)[clients count]; x++)
+	{
+		[[NetApplication sharedInstance]
+		  disconnectObject: [clients objectAtIndex: x]];
+	}
+	run_until(workers_lost_at_least, (void *)(intptr_t)[clients count], 10.0);
+	[[NetApplication sharedInstance] disconnectObject: workPort];
+	[workPort close];
+
+	[workerPool stop];
+	DESTROY(workerPool);
+}
+
+static void bench_workers(void)
+{
+	NSMutableData *chunk;
+	char line[WORK_LINE_LENGTH];
+	int threads, maximum, x;
+
+	memset(line, 'x', sizeof(line) - 1);
+	line[sizeof(line) - 1] = '\n';
+	chunk = [NSMutableData dataWithCapacity: sizeof(line) * 64];
+	for (x = 0; x < 64; x++)
+	{
+		[chunk appendBytes: line length: sizeof(line)];
+	}
+
+	maximum = numWorkerThreads;
+	if (maximum <= 0)
+	{
+		maximum = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	bench_workers_with(0, chunk);
+	for (threads = 1; threads < maximum; threads *= 2)
+	{
+		bench_workers_with(threads, chunk);
+	}
+	bench_workers_with(maximum, chunk);
+}
+
+@interface BenchPingServer : LineObject
+@end
+
+@implementation BenchPingServer
+- lineReceived: (NSData *)aLine
+{
+	NSMutableData *reply = [NSMutableData dataWithData: aLine];
+
+	[reply appendBytes: "\n" length: 1];
+	[transport writeData: reply];
+	return self;
+}
+@end
+
+@interface BenchPingClient : LineObject
+	{
+		NetHistogram *latency;
+		int remaining;
+		uint64_t sentAt;
+		BOOL split;
+	}
+- sendPing;
+- startPings: (int)aCount split: (BOOL)aFlag;
+- (int)remaining;
+- (NetHistogram *)latency;
+@end
+
+@implementation BenchPingClient
+- (void)dealloc
+{
+	RELEASE(latency);
+	[super dealloc];
+}
+- sendPing
+{
+	static NSData *head = nil, *tail = nil, *line = nil;
+
+	if (!head)
+	{
+		head = RETAIN([@"PING :sockopts" 
+		  dataUsingEncoding: NSASCIIStringEncoding]);
+		tail = RETAIN([@"\n" dataUsingEncoding: NSASCIIStringEncoding]);
+		line = RETAIN([@"PING :sockopts\n"
+		  dataUsingEncoding: NSASCIIStringEncoding]);
+	}
+	sentAt = NetMonotonicMicroseconds();
+	if (!split)
+	{
+		[transport writeData: line];
+		return self;
+	}
+	/* Two writes, each sent right away, so with Nagle's algorithm the
+	 * second waits for the first to be acknowledged. */
+	[transport writeData: head];
+	[transport writeData: nil];
+	[transport writeData: tail];
+	[transport writeData: nil];
+	return self;
+}
+- startPings: (int)aCount split: (BOOL)aFlag
+{
+	RELEASE(latency);
+	latency = [NetHistogram new];
+	remaining = aCount;
+	split = aFlag;
+	return [self sendPing];
+}
+- (int)remaining
+{
+	return remaining;
+}
+- (NetHistogram *)latency
+{
+	return latency;
+}
+- lineReceived: (NSData *)aLine
+{
+	[latency recordValue: NetMonotonicMicroseconds() - sentAt];
+	if (--remaining > 0)
+	{
+		[self sendPing];
+	}
+	return self;
+}
+@end
+
+static BOOL pings_done(void *info)
+{
+	return [(BenchPingClient *)info remaining] <= 0;
+}
+
+static void bench_sockopts(void)
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	TCPSocketOptions *options;
+	TCPPort *pingPort, *bulkPort;
+	BenchPingClient *client;
+	NSArray *clients;
+	NSString *name;
+	int nodelay, tuned;
+
+	for (nodelay = 0; nodelay < 2; nodelay++)
+	{
+		options = [[TCPSocketOptions options] setNoDelay: nodelay];
+		pingPort = AUTORELEASE([[TCPPort alloc] initOnHost: nil onPort: 0
+		  socketOptions: options]);
+		if (!pingPort)
+		{
+			return;
+		}
+		[pingPort setNetObject: [BenchPingServer class]];
+
+		client = AUTORELEASE([BenchPingClient new]);
+		if (![[TCPSystem sharedInstance] connectNetObject: client
+		  toHost: loopback onPort: [pingPort port] withTimeout: 4] ||
+		  ![(TCPTransport *)[client transport] setSocketOptions: options])
+		{
+			NSLog(@"sockopts: could not connect: %@",
+			  [[TCPSystem sharedInstance] errorString]);
+			[net disconnectObject: pingPort];
+			return;
+		}
+
+		name = nodelay ? @"sockopts_nodelay" : @"sockopts_nagle";
+		[client startPings: numPings split: YES];
+		if (!run_until(pings_done, client, 60.0))
+		{
+			NSLog(@"%@: timed out", name);
+		}
+		add_result(name, @"p50_latency",
+		  [[client latency] valueAtPercentile: 50.0], @"us", numPings);
+		add_result(name, @"p99_latency",
+		  [[client latency] valueAtPercentile: 99.0], @"us", numPings);
+
+		[net disconnectObject: client];
+		[net disconnectObject: pingPort];
+		[pingPort close];
+	}
+
+	serversEcho = YES;
+	for (tuned = 0; tuned < 2; tuned++)
+	{
+		options = [TCPSocketOptions options];
+		if (tuned)
+		{
+			[options setSendBufferSize: socketBuffer];
+			[options setReceiveBufferSize: socketBuffer];
+		}
+		bulkPort = AUTORELEASE([[TCPPort alloc] initOnHost: nil onPort: 0
+		  socketOptions: options]);
+		if (!bulkPort)
+		{
+			return;
+		}
+		[bulkPort setNetObject: [BenchServer class]];
+
+		clients = make_clients(1, [bulkPort port]);
+		if ([clients count] == 0 || ![(TCPTransport *)[[clients 
+		  objectAtIndex: 0] transport] setSocketOptions: options])
+		{
+			[net disconnectObject: bulkPort];
+			return;
+		}
+		name = tuned ? @"sockopts_buffers" : @"sockopts_default_buffers";
+		add_result(name, @"throughput", echo_throughput(clients, name),
+		  @"MB/s", tuned ? socketBuffer : 0);
+
+		disconnect_all(clients);
+		[net disconnectObject: bulkPort];
+		[bulkPort close];
+	}
+}
+
+static unsigned long long write_events(void)
+{
+	return [[[[[NetApplication sharedInstance] statistics]
+	  objectForKey: @"Events"] objectForKey: @"ET_WDESC"] 
+	  unsignedLongLongValue];
+}
+
+static void bench_writes(void)
+{
+	NSString *names[] = 
+	  { @"writes_deferred", @"writes_immediate", @"writes_end_of_dispatch" };
+	NetWriteStrategy strategies[] = 
+	  { NetWriteDeferred, NetWriteImmediate, NetWriteEndOfDispatch };
+	NetWriteStrategy original = [TCPTransport defaultWriteStrategy];
+	NetApplication *net = [NetApplication sharedInstance];
+	TCPPort *pingPort;
+	BenchPingClient *client;
+	unsigned long long events;
+	int x;
+
+	for (x = 0; x < 3; x++)
+	{
+		[TCPTransport setDefaultWriteStrategy: strategies[x]];
+		pingPort = AUTORELEASE([[TCPPort alloc] initOnPort: 0]);
+		if (!pingPort)
+		{
+			break;
+		}
+		[pingPort setNetObject: [BenchPingServer class]];
+
+		client = AUTORELEASE([BenchPingClient new]);
+		if (![[TCPSystem sharedInstance] connectNetObject: client
+		  toHost: loopback onPort: [pingPort port] withTimeout: 4])
+		{
+			NSLog(@"writes: could not connect: %@",
+			  [[TCPSystem sharedInstance] errorString]);
+			[net disconnectObject: pingPort];
+			break;
+		}
+
+		events = write_events();
+		[client startPings: numPings split: NO];
+		if (!run_until(pings_done, client, 60.0))
+		{
+			NSLog(@"%@: timed out", names[x]);
+		}
+		add_result(names[x], @"p50_latency",
+		  [[client latency] valueAtPercentile: 50.0], @"us", numPings);
+		add_result(names[x], @"p99_latency",
+		  [[client latency] valueAtPercentile: 99.0], @"us", numPings);
+		add_result(names[x], @"write_events", write_events() - events,
+		  @"events", numPings);
+
+		[net disconnectObject: client];
+		[net disconnectObject: pingPort];
+		[pingPort close];
+	}
+
+	[TCPTransport setDefaultWriteStrategy: original];
+}
+
+static void bench_metrics(TCPPort *port)
+{
+	NSArray *clients;
+	NSString *text = nil;
+	uint64_t start;
+	int rounds = 1000;
+	int x;
+
+	clients = make_clients(numConnections, [port port]);
+	[[NetApplication sharedInstance] setInstrumentationEnabled: YES];
+	NetMetricsCountsCommands = YES;
+
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < rounds; x++)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		text = RETAIN([NetMetricsServer renderMetrics]);
+		RELEASE(apr);
+		if (x < rounds - 1)
+		{
+			DESTROY(text);
+		}
+	}
+	add_result(@"metrics", @"render_time",
+	  seconds_since(start) * 1000000.0 / rounds, @"us", [clients count]);
+	add_result(@"metrics", @"size",
+	  [[text dataUsingEncoding: NSUTF8StringEncoding] length], @"bytes",
+	  [clients count]);
+	RELEASE(text);
+
+	NetMetricsCountsCommands = NO;
+	[[NetApplication sharedInstance] setInstrumentationEnabled: NO];
+	disconnect_all(clients);
+}
+
+static void bench_bouncer(void)
+{
+	IRCBouncer *bouncer;
+	BenchBouncerUpstream *upstream;
+	NSMutableArray *clients;
+	BenchBouncerClient *client;
+	NSArray *lines;
+	NSMutableArray *datas;
+	uint64_t start;
+	int x, count;
+
+	bouncer = AUTORELEASE([IRCBouncer new]);
+	upstream = AUTORELEASE([[BenchBouncerUpstream alloc]
+	  initWithNickname: @"bench" withUserName: nil withRealName: nil
+	  withPassword: nil]);
+	[upstream attachTransport: AUTORELEASE([NullTransport new])];
+	[bouncer addUpstream: upstream forIdentity: @"bench"];
+
+	[upstream lineReceived: [@":irc.example.net 001 bench :Welcome"
+	  dataUsingEncoding: NSASCIIStringEncoding]];
+	[upstream lineReceived: [@":bench!user@host JOIN :#channel"
+	  dataUsingEncoding: NSASCIIStringEncoding]];
+
+	clients = [NSMutableArray arrayWithCapacity: numBouncerClients];
+	for (x = 0; x < numBouncerClients; x++)
+	{
+		client = AUTORELEASE([[BenchBouncerClient alloc]
+		  initWithBouncer: bouncer]);
+		[client attachTransport: AUTORELEASE([NullTransport new])];
+		[client lineReceived: [@"NICK bench"
+		  dataUsingEncoding: NSASCIIStringEncoding]];
+		[client lineReceived: [@"USER bench localhost netclasses :bench"
+		  dataUsingEncoding: NSASCIIStringEncoding]];
+		[clients addObject: client];
+	}
+
+	lines = [NSArray arrayWithObjects:
+	  @":nick!user@host PRIVMSG #channel :hello there, this is a line",
+	  @":nick!user@host JOIN :#channel",
+	  @":nick!user@host MODE #channel +o nick",
+	  @":nick!user@host PART #channel :bye",
+	  @"PING :irc.example.net",
+	  @":nick!user@host NOTICE bench :a notice",
+	  nil];
+	datas = [NSMutableArray arrayWithCapacity: [lines count]];
+	for (x = 0; x < (int)[lines count]; x++)
+	{
+		[datas addObject: [[lines objectAtIndex: x]
+		  dataUsingEncoding: NSASCIIStringEncoding]];
+	}
+
+	count = [datas count];
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < numLines;)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		int y;
+
+		for (y = 0; y < 256 && x < numLines; y++, x++)
+		{
+			[upstream lineReceived: [datas objectAtIndex: x % count]];
+		}
+		RELEASE(apr);
+	}
+	add_result(@"bouncer", @"rate", numLines / seconds_since(start),
+	  @"lines/s", numBouncerClients);
+	add_result(@"bouncer", @"forward_rate",
+	  [upstream linesForwarded] / seconds_since(start), @"lines/s",
+	  numBouncerClients);
+
+	[bouncer removeUpstreamForIdentity: @"bench"];
+}
+
+static void bench_capture(void)
+{
+	NetCapture *capture;
+	NSString *path;
+	const char *line;
+	uint64_t start;
+	unsigned length;
+	int x;
+
+	path = [NSTemporaryDirectory() stringByAppendingPathComponent:
+	  [NSString stringWithFormat: @"netclasses-bench-%d.cap", (int)getpid()]];
+	capture = [[NetCapture alloc] initWithFile: path
+	  size: 16 * 1024 * 1024];
+	if (!capture)
+	{
+		NSLog(@"Could not create %@", path);
+		return;
+	}
+
+	line = ":nick!user@host PRIVMSG #channel :hello there, this is a line\r\n";
+	length = strlen(line);
+
+	start = NetMonotonicMicroseconds();
+	for (x = 0; x < numLines; x++)
+	{
+		NetCaptureRecord(capture, x % 64, NetCaptureInbound, line, length);
+	}
+	add_result(@"capture", @"rate", numLines / seconds_since(start),
+	  @"records/s", numLines);
+	add_result(@"capture", @"overwritten", [[[capture statistics]
+	  objectForKey: @"Overwritten"] doubleValue], @"records", numLines);
+
+	RELEASE(capture);
+	unlink([path fileSystemRepresentation]);
+}
+
+/* Returns the data received on each connection of captureFile, as arrays
+ * of NSData keyed by connection number. */
+static NSDictionary *load_capture(unsigned long long *total)
+{
+	NetCapture *capture;
+	NSMutableDictionary *connections;
+	NSMutableArray *datas;
+	NSDictionary *record;
+	NSNumber *connection;
+
+	capture = AUTORELEASE([[NetCapture alloc]
+	  initForReadingFile: captureFile]);
+	if (!capture)
+	{
+		NSLog(@"%@ is not a capture file", captureFile);
+		return nil;
+	}
+
+	*total = 0;
+	connections = [NSMutableDictionary dictionary];
+	while ((record = [capture nextRecord]))
+	{
+		if ([[record objectForKey: @"Type"] intValue] != NetCaptureInbound)
+		{
+			continue;
+		}
+		connection = [record objectForKey: @"Connection"];
+		datas = [connections objectForKey: connection];
+		if (!datas)
+		{
+			datas = [NSMutableArray array];
+			[connections setObject: datas forKey: connection];
+		}
+		[datas addObject: [record objectForKey: @"Data"]];
+		*total += [[record objectForKey: @"Data"] length];
+	}
+
+	return connections;
+}
+
+static void replay_capture(NSDictionary *connections, BOOL irc,
+  NSString *name, unsigned long long total)
+{
+	NSEnumerator *iter;
+	NSArray *datas;
+	id object;
+	uint64_t start;
+	double elapsed = 0;
+	int x;
+
+	iter = [connections objectEnumerator];
+	while ((datas = [iter nextObject]))
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+
+		if (irc)
+		{
+			object = [[BenchIRCObject alloc] initWithNickname: @"bench"
+			  withUserName: nil withRealName: nil withPassword: nil];
+		}
+		else
+		{
+			object = [BenchLineObject new];
+		}
+		[object attachTransport: AUTORELEASE([NullTransport new])];
+
+		start = NetMonotonicMicroseconds();
+		for (x = 0; x < (int)[datas count]; x++)
+		{
+			[object dataReceived: [datas objectAtIndex: x]];
+		}
+		elapsed += seconds_since(start);
+
+		RELEASE(object);
+		RELEASE(apr);
+	}
+	add_result(name, @"rate", total / elapsed / (1024 * 1024), @"MB/s",
+	  [connections count]);
+}
+
+static void bench_replay(void)
+{
+	NSDictionary *connections;
+	unsigned long long total;
+
+	connections = load_capture(&total);
+	if (!connections || total == 0)
+	{
+		return;
+	}
+
+	replay_capture(connections, NO,
+	  @"replay_lineobject", total);
+	replay_capture(connections, YES,
+	  @"replay_ircobject", total);
+}
+
+static BOOL all_arrived(void *info)
+{
+	NSEnumerator *iter = [(NSArray *)info objectEnumerator];
+	BenchClient *client;
+
+	while ((client = [iter nextObject]))
+	{
+		if (![client arrival])
+		{
+			return NO;
+		}
+	}
+	return YES;
+}
+
+static void bench_fanout(TCPPort *port)
+{
+	NSArray *clients;
+	NetHistogram *latency;
+	NSEnumerator *iter;
+	id object;
+	NSData *message;
+	uint64_t start;
+	int count = numFanout;
+
+	raise_descriptor_limit(2 * count + 64);
+	if (2 * count + 64 > descriptor_limit())
+	{
+		count = (descriptor_limit() - 64) / 2;
+		NSLog(@"fanout: limited to %d sockets by the descriptor limit",
+		  count);
+	}
+
+	serversEcho = NO;
+	clients = make_clients(count, [port port]);
+	if ([clients count] == 0)
+	{
+		return;
+	}
+
+	message = [@"PRIVMSG #fanout :the quick brown fox jumps over the dog\r\n"
+	  dataUsingEncoding: NSASCIIStringEncoding];
+	latency = AUTORELEASE([NetHistogram new]);
+
+	start = NetMonotonicMicroseconds();
+	iter = [[NSArray arrayWithArray: servers] objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[[object transport] writeData: message];
+	}
+	if (!run_until(all_arrived, clients, 60.0))
+	{
+		NSLog(@"fanout: timed out");
+	}
+
+	iter = [clients objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		if ([object arrival])
+		{
+			[latency recordValue: [object arrival] - start];
+		}
+	}
+
+	add_result(@"fanout", @"p50_latency", [latency valueAtPercentile: 50.0],
+	  @"us", [clients count]);
+	add_result(@"fanout", @"p99_latency", [latency valueAtPercentile: 99.0],
+	  @"us", [clients count]);
+	add_result(@"fanout", @"max_latency", [latency maxValue],
+	  @"us", [clients count]);
+
+	disconnect_all(clients);
+}
+
+static void print_results(BOOL json)
+{
+	NSEnumerator *iter = [results objectEnumerator];
+	NSDictionary *result;
+	BOOL first = YES;
+
+	if (json)
+	{
+		printf("[\n");
+	}
+	else
+	{
+		printf("benchmark,metric,value,unit,param\n");
+	}
+
+	while ((result = [iter nextObject]))
+	{
+		if (json)
+		{
+			printf("%s  {\"benchmark\": \"%s\", \"metric\": \"%s\", "
+			  "\"value\": %.3f, \"unit\": \"%s\", \"param\": %d}",
+			  first ? "" : ",\n",
+			  [[result objectForKey: @"benchmark"] cString],
+			  [[result objectForKey: @"metric"] cString],
+			  [[result objectForKey: @"value"] doubleValue],
+			  [[result objectForKey: @"unit"] cString],
+			  [[result objectForKey: @"param"] intValue]);
+		}
+		else
+		{
+			printf("%s,%s,%.3f,%s,%d\n",
+			  [[result objectForKey: @"benchmark"] cString],
+			  [[result objectForKey: @"metric"] cString],
+			  [[result objectForKey: @"value"] doubleValue],
+			  [[result objectForKey: @"unit"] cString],
+			  [[result objectForKey: @"param"] intValue]);
+		}
+		first = NO;
+	}
+
+	if (json)
+	{
+		printf("\n]\n");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NSUserDefaults *args;
+	TCPPort *port;
+	BOOL json;
+
+	args = [NSUserDefaults standardUserDefaults];
+	json = [[args stringForKey: @"format"] isEqualToString: @"json"];
+	only = [args stringForKey: @"only"];
+	if ([args integerForKey: @"connections"] > 0)
+		numConnections = [args integerForKey: @"connections"];
+	if ([args integerForKey: @"bytes"] > 0)
+		numBytes = [args integerForKey: @"bytes"];
+	if ([args integerForKey: @"lines"] > 0)
+		numLines = [args integerForKey: @"lines"];
+	if ([args integerForKey: @"fanout"] > 0)
+		numFanout = [args integerForKey: @"fanout"];
+	if ([args integerForKey: @"churn"] > 0)
+		numChurn = [args integerForKey: @"churn"];
+	if ([args integerForKey: @"datagrams"] > 0)
+		numDatagrams = [args integerForKey: @"datagrams"];
+	if ([args integerForKey: @"bouncer-clients"] > 0)
+		numBouncerClients = [args integerForKey: @"bouncer-clients"];
+	if ([args integerForKey: @"names"] > 0)
+		numNames = [args integerForKey: @"names"];
+	if ([args integerForKey: @"list"] > 0)
+		numList = [args integerForKey: @"list"];
+	if ([args integerForKey: @"join-channels"] > 0)
+		numJoinChannels = [args integerForKey: @"join-channels"];
+	if ([args integerForKey: @"posts"] > 0)
+		numPosts = [args integerForKey: @"posts"];
+	if ([args integerForKey: @"post-threads"] > 0)
+		numPostThreads = [args integerForKey: @"post-threads"];
+	if ([args integerForKey: @"work-lines"] > 0)
+		numWorkLines = [args integerForKey: @"work-lines"];
+	if ([args integerForKey: @"worker-threads"] > 0)
+		numWorkerThreads = [args integerForKey: @"worker-threads"];
+	if ([args integerForKey: @"pings"] > 0)
+		numPings = [args integerForKey: @"pings"];
+	if ([args integerForKey: @"socket-buffer"] > 0)
+		socketBuffer = [args integerForKey: @"socket-buffer"];
+	if ([[args stringForKey: @"dcc-bytes"] longLongValue] > 0)
+		dccBytes = [[args stringForKey: @"dcc-bytes"] longLongValue];
+	tlsCert = [args stringForKey: @"tls-cert"];
+	tlsKey = [args stringForKey: @"tls-key"];
+	captureFile = [args stringForKey: @"capture"];
+
+	results = [NSMutableArray new];
+	servers = [NSMutableArray new];
+	loopback = RETAIN([NSHost hostWithAddress: @"127.0.0.1"]);
+
+	[NetApplication sharedInstance];
+	if ([[args stringForKey: @"backend"] isEqualToString: @"uring"] &&
+	  ![[NetApplication sharedInstance] setIOBackend: NetUringBackend])
+	{
+		NSLog(@"io_uring is not available, using the readiness backend");
+	}
+	port = AUTORELEASE([[TCPPort alloc] initOnPort: 0]);
+	if (!port)
+	{
+		NSLog(@"Could not open port: %@",
+		  [[TCPSystem sharedInstance] errorString]);
+		return 1;
+	}
+	[port setNetObject: [BenchServer class]];
+
+	if (wanted(@"echo_1")) bench_echo(port, 1);
+	if (wanted(@"echo_n")) bench_echo(port, numConnections);
+	if (wanted(@"churn")) bench_churn(port);
+	if (wanted(@"filters")) bench_filters(port);
+	if (wanted(@"lineobject")) bench_lineobject();
+	if (wanted(@"ircobject")) bench_ircobject();
+	if (wanted(@"names")) bench_names();
+	if (wanted(@"list")) bench_list();
+	if (wanted(@"modes")) bench_modes();
+	if (wanted(@"join")) bench_join();
+	if (wanted(@"crossthread")) bench_crossthread();
+	if (wanted(@"workers")) bench_workers();
+	if (wanted(@"sockopts")) bench_sockopts();
+	if (wanted(@"writes")) bench_writes();
+	if (wanted(@"metrics")) bench_metrics(port);
+	if (wanted(@"bouncer")) bench_bouncer();
+	if (wanted(@"memory")) bench_memory();
+	if (wanted(@"udp")) bench_udp();
+	if (wanted(@"dcc")) bench_dcc();
+	if (wanted(@"compression")) bench_compression();
+	if (wanted(@"capture")) bench_capture();
+	if (wanted(@"replay") && captureFile) bench_replay();
+	if (wanted(@"tls") && tlsCert && tlsKey) bench_tls();
+	if (wanted(@"fanout")) bench_fanout(port);
+
+	[[NetApplication sharedInstance] disconnectObject: port];
+
+	print_results(json);
+
+	RELEASE(apr);
+	return 0;
+}
@@ -0,0 +1,437 @@
+/***************************************************************************
+                                ircsim.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Load tests IRCObject against an IRCSimServer.  By default the server
+ * runs in this process, a number of IRCObject clients connect to it and
+ * join one large channel, and the chosen scenario is run.  The results
+ * (throughput, memory and callback latency) are printed in the same CSV
+ * or JSON format as the benchmark program.
+ *
+ * With -serve YES only the server is started so that other clients can
+ * be pointed at it.
+ *
+ * Usage: ircsim [-format csv|json] [-serve YES] [-port N] [-clients N]
+ *               [-channel-size N] [-flood-rate N] [-duration N]
+ *               [-scenario flood|names|netsplit|all]
+ */
+
+#import "IRCSimServer.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/IRCObject.h>
+#import <netclasses/NetHistogram.h>
+
+#import <Foundation/Foundation.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#define SIM_CHANNEL @"#sim"
+#define NAMES_BURSTS 10
+
+static NSMutableArray *results = nil;
+static NetHistogram *latency = nil;
+
+static int numClients = 100;
+static int channelSize = 5000;
+static double floodRate = 2000.0;
+static double duration = 5.0;
+
+static int registered = 0;
+static int joined = 0;
+static unsigned long long messages = 0;
+static unsigned long long namesEnded = 0;
+static unsigned long long quits = 0;
+
+static void add_result(NSString *name, NSString *metric, double value,
+  NSString *unit, int param)
+{
+	[results addObject: [NSDictionary dictionaryWithObjectsAndKeys:
+	  name, @"benchmark",
+	  metric, @"metric",
+	  [NSNumber numberWithDouble: value], @"value",
+	  unit, @"unit",
+	  [NSNumber numberWithInt: param], @"param",
+	  nil]];
+}
+
+static double seconds_since(uint64_t start)
+{
+	return (NetMonotonicMicroseconds() - start) / 1000000.0;
+}
+
+static BOOL run_until(BOOL (*condition)(void *), void *info, double timeout)
+{
+	uint64_t start = NetMonotonicMicroseconds();
+
+	while (!condition(info))
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+		  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.05]];
+		RELEASE(apr);
+		if (seconds_since(start) > timeout)
+		{
+			return NO;
+		}
+	}
+	return YES;
+}
+
+static BOOL counter_at_least(void *info)
+{
+	return *(int *)info >= numClients;
+}
+
+static BOOL never(void *info)
+{
+	return NO;
+}
+
+static BOOL flood_drained(void *info)
+{
+	return ![(IRCSimServer *)info isFlooding];
+}
+
+static double max_rss_kilobytes(void)
+{
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0.0;
+	}
+	return (double)usage.ru_maxrss;
+}
+
+@interface SimClient : IRCObject
+@end
+
+@implementation SimClient
+- registeredWithServer
+{
+	registered++;
+	return self;
+}
+- channelJoined: (NSString *)aChannel from: (NSString *)aJoiner
+{
+	if ([ExtractIRCNick(aJoiner) caseInsensitiveCompare: [self nick]] ==
+	  NSOrderedSame)
+	{
+		joined++;
+	}
+	return self;
+}
+- messageReceived: (NSString *)aMessage to: (NSString *)aReceiver
+   from: (NSString *)aSender
+{
+	const char *text = [aMessage cString];
+
+	messages++;
+	if (strncmp(text, "t=", 2) == 0)
+	{
+		uint64_t sent = strtoull(text + 2, NULL, 10);
+		uint64_t now = NetMonotonicMicroseconds();
+
+		[latency recordValue: (now > sent) ? now - sent : 0];
+	}
+	return self;
+}
+- numericCommandReceived: (NSString *)aCommand withParams: (NSArray *)paramList
+   from: (NSString *)aSender
+{
+	if ([aCommand isEqualToString: RPL_ENDOFNAMES])
+	{
+		namesEnded++;
+	}
+	return self;
+}
+- quitIRCWithMessage: (NSString *)aMessage from: (NSString *)aQuitter
+{
+	quits++;
+	return self;
+}
+@end
+
+static NSArray *connect_clients(uint16_t portnum)
+{
+	NSMutableArray *clients = [NSMutableArray arrayWithCapacity: numClients];
+	NSHost *loopback = [NSHost hostWithAddress: @"127.0.0.1"];
+	SimClient *client;
+	int x;
+
+	for (x = 0; x < numClients; x++)
+	{
+		client = AUTORELEASE([[SimClient alloc] initWithNickname:
+		  [NSString stringWithFormat: @"sim%05d", x]
+		  withUserName: @"sim" withRealName: @"ircsim client"
+		  withPassword: nil]);
+		if (![[TCPSystem sharedInstance] connectNetObject: client
+		  toHost: loopback onPort: portnum withTimeout: 4])
+		{
+			NSLog(@"Could only make %d connections: %@", x,
+			  [[TCPSystem sharedInstance] errorString]);
+			break;
+		}
+		[clients addObject: client];
+	}
+	numClients = [clients count];
+
+	return clients;
+}
+
+static void run_flood(IRCSimServer *server)
+{
+	unsigned long long expected;
+	unsigned long long start_messages = messages;
+	uint64_t start;
+	double elapsed;
+
+	[latency reset];
+	start = NetMonotonicMicroseconds();
+	[server floodChannel: SIM_CHANNEL rate: floodRate duration: duration];
+	run_until(flood_drained, server, duration + 10.0);
+
+	expected = (unsigned long long)(floodRate * duration) * numClients;
+	while (messages - start_messages < expected && seconds_since(start) <
+	  duration + 30.0)
+	{
+		unsigned long long before = messages;
+
+		run_until(never, NULL, 0.5);
+		if (messages == before)
+		{
+			break;
+		}
+	}
+	elapsed = seconds_since(start);
+
+	add_result(@"flood", @"throughput",
+	  (messages - start_messages) / elapsed, @"msgs/s", numClients);
+	add_result(@"flood", @"delivered",
+	  (expected) ? 100.0 * (messages - start_messages) / expected : 0.0,
+	  @"%", numClients);
+	add_result(@"flood", @"p50_latency", [latency valueAtPercentile: 50.0],
+	  @"us", numClients);
+	add_result(@"flood", @"p99_latency", [latency valueAtPercentile: 99.0],
+	  @"us", numClients);
+	add_result(@"flood", @"max_latency", [latency maxValue],
+	  @"us", numClients);
+}
+
+static BOOL names_done(void *info)
+{
+	return namesEnded >= *(unsigned long long *)info;
+}
+
+static void run_names(IRCSimServer *server)
+{
+	unsigned long long target = namesEnded + NAMES_BURSTS * numClients;
+	uint64_t start;
+
+	start = NetMonotonicMicroseconds();
+	[server burstNamesOnChannel: SIM_CHANNEL times: NAMES_BURSTS];
+	if (!run_until(names_done, &target, 120.0))
+	{
+		NSLog(@"names: timed out");
+	}
+	add_result(@"names", @"rate",
+	  (channelSize * (double)NAMES_BURSTS * numClients) /
+	  seconds_since(start), @"names/s", channelSize);
+}
+
+static BOOL quits_done(void *info)
+{
+	return quits >= *(unsigned long long *)info;
+}
+
+static void run_netsplit(IRCSimServer *server)
+{
+	int count = channelSize / 2;
+	unsigned long long target = quits + (unsigned long long)count * numClients;
+	uint64_t start;
+
+	start = NetMonotonicMicroseconds();
+	[server netsplitChannel: SIM_CHANNEL quitCount: count];
+	if (!run_until(quits_done, &target, 120.0))
+	{
+		NSLog(@"netsplit: timed out");
+	}
+	add_result(@"netsplit", @"rate",
+	  ((double)count * numClients) / seconds_since(start), @"quits/s", count);
+}
+
+static void print_results(BOOL json)
+{
+	NSEnumerator *iter = [results objectEnumerator];
+	NSDictionary *result;
+	BOOL first = YES;
+
+	if (json)
+	{
+		printf("[\n");
+	}
+	else
+	{
+		printf("benchmark,metric,value,unit,param\n");
+	}
+
+	while ((result = [iter nextObject]))
+	{
+		if (json)
+		{
+			printf("%s  {\"benchmark\": \"%s\", \"metric\": \"%s\", "
+			  "\"value\": %.3f, \"unit\": \"%s\", \"param\": %d}",
+			  first ? "" : ",\n",
+			  [[result objectForKey: @"benchmark"] cString],
+			  [[result objectForKey: @"metric"] cString],
+			  [[result objectForKey: @"value"] doubleValue],
+			  [[result objectForKey: @"unit"] cString],
+			  [[result objectForKey: @"param"] intValue]);
+		}
+		else
+		{
+			printf("%s,%s,%.3f,%s,%d\n",
+			  [[result objectForKey: @"benchmark"] cString],
+			  [[result objectForKey: @"metric"] cString],
+			  [[result objectForKey: @"value"] doubleValue],
+			  [[result objectForKey: @"unit"] cString],
+			  [[result objectForKey: @"param"] intValue]);
+		}
+		first = NO;
+	}
+
+	if (json)
+	{
+		printf("\n]\n");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NSUserDefaults *args;
+	NSString *scenario;
+	IRCSimServer *server;
+	NSArray *clients;
+	NSEnumerator *iter;
+	id object;
+	uint64_t start;
+	double rss;
+	BOOL json;
+	BOOL all;
+	int portnum;
+
+	args = [NSUserDefaults standardUserDefaults];
+	json = [[args stringForKey: @"format"] isEqualToString: @"json"];
+	scenario = [args stringForKey: @"scenario"];
+	if (!scenario) scenario = @"flood";
+	all = [scenario isEqualToString: @"all"];
+	portnum = [args integerForKey: @"port"];
+	if ([args integerForKey: @"clients"] > 0)
+		numClients = [args integerForKey: @"clients"];
+	if ([args integerForKey: @"channel-size"] > 0)
+		channelSize = [args integerForKey: @"channel-size"];
+	if ([args floatForKey: @"flood-rate"] > 0)
+		floodRate = [args floatForKey: @"flood-rate"];
+	if ([args floatForKey: @"duration"] > 0)
+		duration = [args floatForKey: @"duration"];
+
+	results = [NSMutableArray new];
+	latency = [NetHistogram new];
+
+	[NetApplication sharedInstance];
+
+	if ([args boolForKey: @"serve"])
+	{
+		server = [[IRCSimServer alloc] initOnPort:
+		  (portnum) ? portnum : 6667];
+		if (!server)
+		{
+			NSLog(@"Could not open port: %@",
+			  [[TCPSystem sharedInstance] errorString]);
+			return 1;
+		}
+		[server createChannel: SIM_CHANNEL withSyntheticMembers: channelSize];
+		[server createSyntheticChannels: 1000];
+		NSLog(@"Serving %@ on port %d", [server serverName], [server port]);
+		[[NSRunLoop currentRunLoop] run];
+		RELEASE(apr);
+		return 0;
+	}
+
+	server = AUTORELEASE([[IRCSimServer alloc] initOnPort: portnum]);
+	if (!server)
+	{
+		NSLog(@"Could not open port: %@",
+		  [[TCPSystem sharedInstance] errorString]);
+		return 1;
+	}
+	[server createChannel: SIM_CHANNEL withSyntheticMembers: channelSize];
+
+	rss = max_rss_kilobytes();
+	start = NetMonotonicMicroseconds();
+	clients = connect_clients([server port]);
+	if (!run_until(counter_at_least, &registered, 60.0))
+	{
+		NSLog(@"Only %d of %d clients registered", registered, numClients);
+	}
+	add_result(@"register", @"rate", registered / seconds_since(start),
+	  @"clients/s", numClients);
+
+	start = NetMonotonicMicroseconds();
+	iter = [clients objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[object joinChannel: SIM_CHANNEL withPassword: nil];
+	}
+	if (!run_until(counter_at_least, &joined, 60.0))
+	{
+		NSLog(@"Only %d of %d clients joined", joined, numClients);
+	}
+	add_result(@"join", @"rate", joined / seconds_since(start),
+	  @"clients/s", channelSize);
+	add_result(@"clients", @"memory",
+	  (max_rss_kilobytes() - rss) / ((numClients) ? numClients : 1),
+	  @"KB/client", numClients);
+
+	if (all || [scenario isEqualToString: @"flood"]) run_flood(server);
+	if (all || [scenario isEqualToString: @"names"]) run_names(server);
+	if (all || [scenario isEqualToString: @"netsplit"]) run_netsplit(server);
+
+	add_result(@"server", @"lines_in", [server linesIn], @"lines",
+	  numClients);
+	add_result(@"server", @"lines_out", [server linesOut], @"lines",
+	  numClients);
+	add_result(@"process", @"max_rss", max_rss_kilobytes(), @"KB",
+	  numClients);
+
+	iter = [clients objectEnumerator];
+	while ((object = [iter nextObject]))
+	{
+		[[NetApplication sharedInstance] disconnectObject: object];
+	}
+	[server shutdown];
+
+	print_results(json);
+
+	RELEASE(apr);
+	return 0;
+}
@@ -0,0 +1,216 @@
+/***************************************************************************
+                                netcapture.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Dumps a NetCapture file to standard output.  The lines format prints
+ * one line per record:
+ *
+ *   <seconds>.<microseconds> <connection> open|in|out|close <length> <data>
+ *
+ * with the data escaped C-style.  The pcap format writes a pcap file with
+ * link type LINKTYPE_USER0 (147), each packet starting with an 8 byte
+ * pseudo header: the connection as a 32 bit big-endian number, the record
+ * type (1 open, 2 in, 3 out, 4 close) and three zero bytes.
+ *
+ * Usage: netcapture [-format lines|pcap] [-connection N] file
+ */
+
+#import <netclasses/NetCapture.h>
+
+#import <Foundation/Foundation.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#define LINKTYPE_USER0 147
+#define PSEUDO_HEADER_LENGTH 8
+
+static const char *type_name(int type)
+{
+	switch (type)
+	{
+		case NetCaptureOpen:
+			return "open";
+		case NetCaptureInbound:
+			return "in";
+		case NetCaptureOutbound:
+			return "out";
+		case NetCaptureClose:
+			return "close";
+	}
+	return "?";
+}
+
+static void print_line(NSDictionary *record)
+{
+	unsigned long long time;
+	NSData *data;
+	const unsigned char *bytes;
+	unsigned length, i;
+
+	time = [[record objectForKey: @"Time"] unsignedLongLongValue];
+	data = [record objectForKey: @"Data"];
+	bytes = [data bytes];
+	length = [data length];
+
+	printf("%llu.%06llu %u %s %u ", time / 1000000, time % 1000000,
+	  [[record objectForKey: @"Connection"] unsignedIntValue],
+	  type_name([[record objectForKey: @"Type"] intValue]), length);
+	for (i = 0; i < length; i++)
+	{
+		switch (bytes[i])
+		{
+			case '\r':
+				fputs("\\r", stdout);
+				break;
+			case '\n':
+				fputs("\\n", stdout);
+				break;
+			case '\\':
+				fputs("\\\\", stdout);
+				break;
+			default:
+				if (bytes[i] < 0x20 || bytes[i] >= 0x7f)
+				{
+					printf("\\x%02x", bytes[i]);
+				}
+				else
+				{
+					putchar(bytes[i]);
+				}
+		}
+	}
+	putchar('\n');
+}
+
+static void write_pcap_header(void)
+{
+	struct
+	{
+		uint32_t magic;
+		uint16_t major;
+		uint16_t minor;
+		int32_t zone;
+		uint32_t sigfigs;
+		uint32_t snaplen;
+		uint32_t network;
+	} header = { 0xa1b2c3d4, 2, 4, 0, 0, 65535 + PSEUDO_HEADER_LENGTH,
+	  LINKTYPE_USER0 };
+
+	fwrite(&header, sizeof(header), 1, stdout);
+}
+
+static void write_pcap_record(NSDictionary *record)
+{
+	unsigned long long time;
+	NSData *data;
+	unsigned char pseudo[PSEUDO_HEADER_LENGTH];
+	uint32_t connection;
+	struct
+	{
+		uint32_t seconds;
+		uint32_t microseconds;
+		uint32_t included;
+		uint32_t original;
+	} header;
+
+	time = [[record objectForKey: @"Time"] unsignedLongLongValue];
+	data = [record objectForKey: @"Data"];
+
+	header.seconds = time / 1000000;
+	header.microseconds = time % 1000000;
+	header.included = header.original = [data length] + PSEUDO_HEADER_LENGTH;
+
+	connection = htonl([[record objectForKey: @"Connection"]
+	  unsignedIntValue]);
+	memset(pseudo, 0, sizeof(pseudo));
+	memcpy(pseudo, &connection, sizeof(connection));
+	pseudo[4] = [[record objectForKey: @"Type"] intValue];
+
+	fwrite(&header, sizeof(header), 1, stdout);
+	fwrite(pseudo, sizeof(pseudo), 1, stdout);
+	fwrite([data bytes], [data length], 1, stdout);
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NSUserDefaults *defaults;
+	NSArray *arguments;
+	NSString *format;
+	NetCapture *capture;
+	NSDictionary *record;
+	int connection;
+	BOOL pcap;
+
+	defaults = [NSUserDefaults standardUserDefaults];
+	arguments = [[NSProcessInfo processInfo] arguments];
+	format = [defaults stringForKey: @"format"];
+	connection = [defaults integerForKey: @"connection"];
+	pcap = [format isEqualToString: @"pcap"];
+
+	if ([arguments count] < 2 || (format && !pcap &&
+	  ![format isEqualToString: @"lines"]))
+	{
+		fprintf(stderr,
+		  "Usage: netcapture [-format lines|pcap] [-connection N] file\n");
+		return 1;
+	}
+
+	capture = AUTORELEASE([[NetCapture alloc] initForReadingFile:
+	  [arguments lastObject]]);
+	if (!capture)
+	{
+		fprintf(stderr, "netcapture: %s is not a capture file\n",
+		  [[arguments lastObject] fileSystemRepresentation]);
+		return 1;
+	}
+
+	if (pcap)
+	{
+		write_pcap_header();
+	}
+
+	while (1)
+	{
+		CREATE_AUTORELEASE_POOL(loop);
+		if (!(record = [capture nextRecord]))
+		{
+			RELEASE(loop);
+			break;
+		}
+		if (connection == 0 || [[record objectForKey: @"Connection"]
+		  intValue] == connection)
+		{
+			if (pcap)
+			{
+				write_pcap_record(record);
+			}
+			else
+			{
+				print_line(record);
+			}
+		}
+		RELEASE(loop);
+	}
+	fflush(stdout);
+
+	RELEASE(apr);
+
+	return 0;
+}
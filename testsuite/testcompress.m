@@ -0,0 +1,213 @@
+/***************************************************************************
+                                testcompress.m
+                          -------------------
+    begin                : Mon Oct 19 13:24:05 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/NetCompress.h>
+
+#import <Foundation/Foundation.h>
+
+/* Echoes text through CompressedTransport connections with each method
+ * netclasses was built with. */
+
+#define NUM_LINES 2000
+
+@interface Peer : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+		NSMutableData *data;
+		BOOL echoes;
+	}
+- (NSData *)data;
+@end
+
+Peer *server = nil;
+
+@implementation Peer
+- init
+{
+	if (!(self = [super init])) return nil;
+	data = [NSMutableData new];
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(data);
+	RELEASE(transport);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)newData
+{
+	[data appendData: newData];
+	if (echoes)
+	{
+		[transport writeData: newData];
+	}
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+- (NSData *)data
+{
+	return data;
+}
+@end
+
+@interface EchoPeer : Peer
+@end
+
+@implementation EchoPeer
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	echoes = YES;
+	ASSIGN(server, self);
+	return [super connectionEstablished: aTransport];
+}
+@end
+
+static NSData *text = nil;
+
+static BOOL echoed(Peer *aClient)
+{
+	NSDate *limit = [NSDate dateWithTimeIntervalSinceNow: 10.0];
+
+	while ([[aClient data] length] < [text length] &&
+	  [limit timeIntervalSinceNow] > 0)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+		  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+		RELEASE(apr);
+	}
+	return [[aClient data] isEqual: text];
+}
+
+/* Connects with <var>clientMethods</var> offered by the client and
+ * <var>serverMethods</var> by the server, echoes the text and checks
+ * that <var>expected</var> was used. */
+static void test_methods(TCPPort *aPort, unsigned clientMethods,
+  unsigned serverMethods, NetCompressionMethod expected, NSString *aName)
+{
+	Peer *client = AUTORELEASE([Peer new]);
+	CompressedTransport *transport;
+	NSDictionary *stats;
+
+	DESTROY(server);
+	[CompressedTransport setDefaultMethods: clientMethods];
+	if (![[TCPSystem sharedInstance] connectNetObject: client
+	  toHost: [NSHost hostWithAddress: @"127.0.0.1"] onPort: [aPort port]
+	  withTimeout: 4 transportClass: [CompressedTransport class]])
+	{
+		FAIL([NSString stringWithFormat: @"%@: connected", aName]);
+		return;
+	}
+	/* The server end is only accepted once the run loop runs. */
+	[CompressedTransport setDefaultMethods: serverMethods];
+
+	transport = (CompressedTransport *)[client transport];
+	[transport writeData: text];
+	testTrue(([NSString stringWithFormat: @"%@: echoed", aName]),
+	  echoed(client));
+	testTrue(([NSString stringWithFormat: @"%@: negotiated", aName]),
+	  [transport isNegotiated] && [transport method] == expected &&
+	  [(CompressedTransport *)[server transport] method] == expected);
+
+	stats = [transport statistics];
+	testTrue(([NSString stringWithFormat: @"%@: uncompressed counted",
+	  aName]), [[stats objectForKey: @"UncompressedBytesWritten"]
+	  unsignedIntValue] == [text length] && [[stats objectForKey:
+	  @"UncompressedBytesRead"] unsignedIntValue] == [text length]);
+	if (expected == NetCompressionNone)
+	{
+		testEqual(([NSString stringWithFormat: @"%@: method", aName]),
+		  [stats objectForKey: @"Method"], @"none");
+	}
+	else
+	{
+		testTrue(([NSString stringWithFormat: @"%@: compressed", aName]),
+		  [[stats objectForKey: @"BytesWritten"] unsignedIntValue] <
+		  [text length] / 4 &&
+		  [[stats objectForKey: @"CompressionRatio"] doubleValue] > 4.0);
+	}
+
+	[[NetApplication sharedInstance] disconnectObject: client];
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NSMutableString *lines = [NSMutableString string];
+	TCPPort *port;
+	unsigned available;
+	int x;
+
+	[NetApplication sharedInstance];
+	available = [CompressedTransport availableMethods];
+	for (x = 0; x < NUM_LINES; x++)
+	{
+		[lines appendFormat: @":nick!user@host PRIVMSG #channel :line %d\r\n",
+		  x];
+	}
+	text = RETAIN([lines dataUsingEncoding: NSASCIIStringEncoding]);
+
+	port = AUTORELEASE([[TCPPort alloc] initOnHost:
+	  [NSHost hostWithAddress: @"127.0.0.1"] onPort: 0]);
+	testTrue(@"?Initialized port", port);
+	[port setNetObject: [EchoPeer class]];
+	[port setTransportClass: [CompressedTransport class]];
+
+	if (available & NetCompressionZstd)
+	{
+		test_methods(port, available, available, NetCompressionZstd,
+		  @"zstd preferred");
+	}
+	if (available & NetCompressionZlib)
+	{
+		test_methods(port, NetCompressionZlib, available, NetCompressionZlib,
+		  @"zlib");
+	}
+	if ((available & NetCompressionZstd) && (available & NetCompressionZlib))
+	{
+		test_methods(port, NetCompressionZlib, NetCompressionZstd,
+		  NetCompressionNone, @"nothing in common");
+	}
+	test_methods(port, NetCompressionNone, available, NetCompressionNone,
+	  @"none offered");
+
+	[[NetApplication sharedInstance] disconnectObject: port];
+	DESTROY(server);
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
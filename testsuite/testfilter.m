@@ -0,0 +1,266 @@
+/***************************************************************************
+                                testfilter.m
+                          -------------------
+    begin                : Mon Oct 19 13:05:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/NetFilter.h>
+
+#import <Foundation/Foundation.h>
+
+#include <ctype.h>
+#include <string.h>
+
+#define RATE 5000
+#define NUM_BYTES 20000
+
+/* Upper-cases what it receives. */
+@interface UpperFilter : NetFilter
+@end
+
+@implementation UpperFilter
+- receiveBytes: (const char *)bytes length: (unsigned)length
+{
+	NSMutableData *upper = [NSMutableData dataWithBytes: bytes
+	  length: length];
+	char *chars = [upper mutableBytes];
+	unsigned x;
+
+	for (x = 0; x < length; x++)
+	{
+		chars[x] = toupper(chars[x]);
+	}
+	return [self passUpBytes: chars length: length];
+}
+@end
+
+/* Counts what goes through it each way. */
+@interface CountFilter : NetFilter
+	{
+		unsigned received;
+		unsigned sent;
+	}
+- (unsigned)received;
+- (unsigned)sent;
+@end
+
+@implementation CountFilter
+- receiveBytes: (const char *)bytes length: (unsigned)length
+{
+	received += length;
+	return [self passUpBytes: bytes length: length];
+}
+- sendBytes: (const char *)bytes length: (unsigned)length
+{
+	sent += length;
+	return [self passDownBytes: bytes length: length];
+}
+- (unsigned)received
+{
+	return received;
+}
+- (unsigned)sent
+{
+	return sent;
+}
+@end
+
+@interface Peer : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+		NSMutableData *data;
+	}
+- (NSData *)data;
+@end
+
+Peer *server = nil;
+
+@implementation Peer
+- init
+{
+	if (!(self = [super init])) return nil;
+	data = [NSMutableData new];
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(data);
+	RELEASE(transport);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)newData
+{
+	[data appendData: newData];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+- (NSData *)data
+{
+	return data;
+}
+@end
+
+/* The end accepted by the port. */
+@interface ServerPeer : Peer
+@end
+
+@implementation ServerPeer
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(server, self);
+	return [super connectionEstablished: aTransport];
+}
+@end
+
+#define RUNABIT() \
+	[[NSRunLoop currentRunLoop] runUntilDate: \
+	[NSDate dateWithTimeIntervalSinceNow: 1.0]]
+
+static BOOL has_string(Peer *aPeer, const char *aString)
+{
+	return [[aPeer data] isEqual: [NSData dataWithBytes: aString
+	  length: strlen(aString)]];
+}
+
+static void test_stack(TCPTransport *serverSide, Peer *client)
+{
+	UpperFilter *upper = AUTORELEASE([UpperFilter new]);
+	CountFilter *counter = AUTORELEASE([CountFilter new]);
+	BOOL raised;
+
+	testFalse(@"?No filters at first", [serverSide hasFilters]);
+	[serverSide pushFilter: counter];
+	[serverSide pushFilter: upper];
+	testTrue(@"?Filters from the bottom up", [[serverSide filters] isEqual:
+	  [NSArray arrayWithObjects: counter, upper, nil]]);
+	testTrue(@"?Filter knows its transport", [upper transport] == serverSide);
+
+	raised = NO;
+	NS_DURING
+		[serverSide pushFilter: upper];
+	NS_HANDLER
+		raised = [[localException name] isEqualToString: NetException];
+	NS_ENDHANDLER
+	testTrue(@"?A filter is only in one stack", raised);
+
+	[[client transport] writeData: [NSData dataWithBytes: "hello" length: 5]];
+	RUNABIT();
+	testTrue(@"?Data changed on the way up", has_string(server, "HELLO"));
+	testTrue(@"?Data counted on the way up", [counter received] == 5);
+
+	[[server transport] writeData: [NSData dataWithBytes: "abc" length: 3]];
+	RUNABIT();
+	testTrue(@"?Data counted on the way down", [counter sent] == 3);
+	testTrue(@"?Data unchanged on the way down", has_string(client, "abc"));
+
+	[serverSide removeFilter: upper];
+	testTrue(@"?Filter removed", [[serverSide filters] count] == 1 &&
+	  [upper transport] == nil);
+	[[client transport] writeData: [NSData dataWithBytes: "hi" length: 2]];
+	RUNABIT();
+	testTrue(@"?Removed filter no longer applied",
+	  has_string(server, "HELLOhi") && [counter received] == 7);
+	[serverSide removeFilter: counter];
+}
+
+static BOOL all_arrived(void)
+{
+	return [[server data] length] == NUM_BYTES + 7;
+}
+
+static void test_rate(TCPTransport *clientSide)
+{
+	NetRateFilter *rate = AUTORELEASE([[NetRateFilter alloc]
+	  initWithBytesPerSecond: RATE]);
+	NSDate *start, *limit;
+
+	[clientSide pushFilter: rate];
+	start = [NSDate date];
+	[clientSide writeData: [NSMutableData dataWithLength: NUM_BYTES]];
+	testTrue(@"?Data over the rate held", [rate heldLength] > 0 &&
+	  [rate heldLength] <= NUM_BYTES);
+	testTrue(@"?Reading paused over the high water mark",
+	  [rate isReadingPaused]);
+
+	RUNABIT();
+	testTrue(@"?Held data passed on at the rate",
+	  [[server data] length] > 7 && !all_arrived());
+
+	limit = [NSDate dateWithTimeIntervalSinceNow: 20.0];
+	while (!all_arrived() && [limit timeIntervalSinceNow] > 0)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+		  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+		RELEASE(apr);
+	}
+	testTrue(@"?Everything arrived", all_arrived());
+	testTrue(@"?No faster than the rate",
+	  -[start timeIntervalSinceNow] >= 0.75 * NUM_BYTES / RATE);
+	testTrue(@"?Nothing left held", [rate heldLength] == 0);
+	testFalse(@"?Reading resumed", [rate isReadingPaused]);
+	[clientSide removeFilter: rate];
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NetApplication *net;
+	TCPPort *port;
+	Peer *client;
+	NSHost *host = [NSHost hostWithAddress: @"127.0.0.1"];
+
+	net = [NetApplication sharedInstance];
+
+	port = AUTORELEASE([[TCPPort alloc] initOnHost: host onPort: 0]);
+	testTrue(@"?Initialized port", port);
+	[port setNetObject: [ServerPeer class]];
+
+	client = AUTORELEASE([Peer new]);
+	testTrue(@"?Made connection", [[TCPSystem sharedInstance]
+	  connectNetObject: client toHost: host onPort: [port port]
+	  withTimeout: 4]);
+	RUNABIT();
+	testTrue(@"?Server connected", server != nil);
+
+	test_stack((TCPTransport *)[server transport], client);
+	test_rate((TCPTransport *)[client transport]);
+
+	[net disconnectObject: client];
+	[net disconnectObject: port];
+	DESTROY(server);
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
@@ -0,0 +1,447 @@
+/***************************************************************************
+                                testirc.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/IRCObject.h>
+
+#import <Foundation/Foundation.h>
+
+#include <string.h>
+
+/* Keeps every line written to it, without the CRLF. */
+@interface CaptureTransport : NSObject < NetTransport >
+	{
+		NSMutableArray *lines;
+	}
+- (NSArray *)lines;
+- reset;
+@end
+
+@implementation CaptureTransport
+- init
+{
+	if (!(self = [super init])) return nil;
+
+	lines = [NSMutableArray new];
+
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(lines);
+	[super dealloc];
+}
+- (NSArray *)lines
+{
+	return lines;
+}
+- reset
+{
+	[lines removeAllObjects];
+	return self;
+}
+- (id)localHost
+{
+	return nil;
+}
+- (id)remoteHost
+{
+	return nil;
+}
+- writeData: (NSData *)data
+{
+	NSString *string;
+	NSEnumerator *iter;
+	NSString *line;
+
+	string = AUTORELEASE([[NSString alloc] initWithData: data
+	  encoding: NSASCIIStringEncoding]);
+	iter = [[string componentsSeparatedByString: @"\r\n"] objectEnumerator];
+	while ((line = [iter nextObject]))
+	{
+		if ([line length])
+		{
+			[lines addObject: line];
+		}
+	}
+	return self;
+}
+- (BOOL)isDoneWriting
+{
+	return YES;
+}
+- (NSData *)readData: (int)maxReadSize
+{
+	return nil;
+}
+- (int)desc
+{
+	return -1;
+}
+- (void)close
+{
+}
+@end
+
+@interface TestIRCObject : IRCObject
+	{
+		NSString *namesChannel;
+		NSArray *names;
+		NSString *message;
+		IRCModeChanges *modes;
+		NSString *modesTarget;
+	}
+- attachTransport: (id <NetTransport>)aTransport;
+- (NSString *)namesChannel;
+- (NSArray *)names;
+- (NSString *)message;
+- (IRCModeChanges *)modes;
+- (NSString *)modesTarget;
+@end
+
+@implementation TestIRCObject
+- (void)dealloc
+{
+	RELEASE(namesChannel);
+	RELEASE(names);
+	RELEASE(message);
+	RELEASE(modes);
+	RELEASE(modesTarget);
+	[super dealloc];
+}
+- attachTransport: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	return self;
+}
+- namesReceived: (IRCNameList *)aList forChannel: (NSString *)aChannel
+{
+	ASSIGN(namesChannel, aChannel);
+	ASSIGN(names, [aList nicks]);
+	return self;
+}
+- messageReceived: (NSString *)aMessage to: (NSString *)aReceiver
+   from: (NSString *)aSender
+{
+	ASSIGN(message, aMessage);
+	return self;
+}
+- modesChanged: (IRCModeChanges *)changes on: (NSString *)anObject
+   from: (NSString *)aPerson
+{
+	ASSIGN(modes, changes);
+	ASSIGN(modesTarget, anObject);
+	return self;
+}
+- (NSString *)namesChannel
+{
+	return namesChannel;
+}
+- (NSArray *)names
+{
+	return names;
+}
+- (NSString *)message
+{
+	return message;
+}
+- (IRCModeChanges *)modes
+{
+	return modes;
+}
+- (NSString *)modesTarget
+{
+	return modesTarget;
+}
+@end
+
+static TestIRCObject *new_object(CaptureTransport *aTransport)
+{
+	TestIRCObject *object;
+
+	object = AUTORELEASE([[TestIRCObject alloc] initWithNickname: @"test"
+	  withUserName: nil withRealName: nil withPassword: nil]);
+	[object attachTransport: aTransport];
+	return object;
+}
+
+static void feed(IRCObject *anObject, NSString *aLine)
+{
+	[anObject lineReceived: [aLine dataUsingEncoding:
+	  NSASCIIStringEncoding]];
+}
+
+static void test_names(void)
+{
+	TestIRCObject *object = new_object(AUTORELEASE([CaptureTransport new]));
+
+	feed(object, @":irc.example.net 353 test = #chan :@op +voice plain");
+	feed(object, @":irc.example.net 366 test #chan :End of /NAMES list.");
+	testEqual(@"NAMES channel", [object namesChannel], @"#chan");
+	testEqual(@"NAMES nicks", [object names], ([NSArray arrayWithObjects:
+	  @"op", @"voice", @"plain", nil]));
+
+	feed(object, @":irc.example.net 353 test = #solo alone");
+	feed(object, @":irc.example.net 366 test #solo :End of /NAMES list.");
+	testEqual(@"NAMES channel without a colon", [object namesChannel],
+	  @"#solo");
+	testEqual(@"NAMES single nick without a colon", [object names],
+	  [NSArray arrayWithObject: @"alone"]);
+}
+
+static void test_subscriptions(void)
+{
+	TestIRCObject *object = new_object(AUTORELEASE([CaptureTransport new]));
+
+	[object subscribeToCommand: @"PRIVMSG" target: @"#Chan[1]"];
+
+	feed(object, @":nick!user@host PRIVMSG #other :skipped");
+	testTrue(@"Unsubscribed target dropped", [object message] == nil);
+	feed(object, @":nick!user@host PRIVMSG #chan{1} :kept");
+	testEqual(@"Target matched by rfc1459 casemapping", [object message],
+	  @"kept");
+
+	[object setLowercasingSelector: @selector(lowercaseString)];
+	feed(object, @":nick!user@host PRIVMSG #chan{1} :ascii");
+	testEqual(@"Target not matched by ascii casemapping", [object message],
+	  @"kept");
+	feed(object, @":nick!user@host PRIVMSG #CHAN[1] :ascii");
+	testEqual(@"Target matched by ascii casemapping", [object message],
+	  @"ascii");
+
+	feed(object, @":irc.example.net 353 test = #chan :@op plain");
+	feed(object, @":irc.example.net 366 test #chan :End of /NAMES list.");
+	testEqual(@"NAMES handled while subscribed", [object names],
+	  ([NSArray arrayWithObjects: @"op", @"plain", nil]));
+}
+
+static void test_isupport(void)
+{
+	TestIRCObject *object = new_object(AUTORELEASE([CaptureTransport new]));
+	const IRCServerSupport *support = [object serverSupport];
+
+	testTrue(@"Default PREFIX", strcmp(support->prefixModes, "qaohv") == 0 &&
+	  strcmp(support->prefixChars, "~&@%+") == 0);
+	testTrue(@"Default CHANMODES", strcmp(support->listModes, "beI") == 0 &&
+	  strcmp(support->argumentModes, "k") == 0 &&
+	  strcmp(support->setArgumentModes, "l") == 0 &&
+	  strcmp(support->flagModes, "imnpst") == 0);
+
+	feed(object, @":irc.example.net 005 test PREFIX=(ov)@+ "
+	  @"CHANMODES=beq,k,fl,imnt :are supported by this server");
+	testTrue(@"PREFIX parsed", strcmp(support->prefixModes, "ov") == 0 &&
+	  strcmp(support->prefixChars, "@+") == 0);
+	testTrue(@"CHANMODES parsed", strcmp(support->listModes, "beq") == 0 &&
+	  strcmp(support->argumentModes, "k") == 0 &&
+	  strcmp(support->setArgumentModes, "fl") == 0 &&
+	  strcmp(support->flagModes, "imnt") == 0);
+
+	feed(object, @":irc.example.net 005 test PREFIX=(ov)@ CHANMODES=x,y "
+	  @":are supported by this server");
+	testTrue(@"Malformed PREFIX ignored",
+	  strcmp(support->prefixModes, "ov") == 0 &&
+	  strcmp(support->prefixChars, "@+") == 0);
+	testTrue(@"Short CHANMODES ignored",
+	  strcmp(support->listModes, "beq") == 0);
+
+	feed(object, @":irc.example.net 005 test PREFIX= "
+	  @":are supported by this server");
+	testTrue(@"Empty PREFIX clears the prefixes",
+	  support->prefixModes[0] == 0 && support->prefixChars[0] == 0);
+
+	feed(object, @":irc.example.net 005 test TARGMAX=JOIN:3 MAXTARGETS=4 "
+	  @":are supported by this server");
+	feed(object, @":irc.example.net 005 test -PREFIX -CHANMODES -TARGMAX "
+	  @"-maxtargets :are no longer supported");
+	testTrue(@"-PREFIX restores the default",
+	  strcmp(support->prefixModes, "qaohv") == 0 &&
+	  strcmp(support->prefixChars, "~&@%+") == 0);
+	testTrue(@"-CHANMODES restores the default",
+	  strcmp(support->listModes, "beI") == 0 &&
+	  strcmp(support->flagModes, "imnpst") == 0);
+	testTrue(@"-TARGMAX and -MAXTARGETS restore the defaults",
+	  support->targmaxCount == 0 && support->maxTargets == 1 &&
+	  [object maximumTargetsForCommand: @"JOIN"] == 1);
+
+	feed(object, @":irc.example.net 005 test CASEMAPPING=ascii "
+	  @":are supported by this server");
+	feed(object, @":irc.example.net 005 test -CASEMAPPING "
+	  @":is no longer supported");
+	testTrue(@"-CASEMAPPING restores rfc1459", sel_isEqual(
+	  [object lowercasingSelector], @selector(lowercaseIRCString)));
+}
+
+static void test_decode_modes(void)
+{
+	TestIRCObject *object = new_object(AUTORELEASE([CaptureTransport new]));
+	const char *line = "+ov-b+l-l nick1 nick2 *!*@bad 50";
+	IRCModeChange changes[8];
+	unsigned count;
+
+	feed(object, @":irc.example.net 005 test PREFIX=(ov)@+ "
+	  @"CHANMODES=b,k,l,imnt :are supported by this server");
+
+	count = IRCDecodeModes([object serverSupport], YES, line, strlen(line),
+	  changes, 8);
+	testEqual(@"Mode count", [NSNumber numberWithUnsignedInt: count],
+	  [NSNumber numberWithUnsignedInt: 5]);
+	testTrue(@"Signs and letters",
+	  changes[0].sign == '+' && changes[0].mode == 'o' &&
+	  changes[1].sign == '+' && changes[1].mode == 'v' &&
+	  changes[2].sign == '-' && changes[2].mode == 'b' &&
+	  changes[3].sign == '+' && changes[3].mode == 'l' &&
+	  changes[4].sign == '-' && changes[4].mode == 'l');
+	testTrue(@"Argument indexes", changes[0].argument == 0 &&
+	  changes[1].argument == 1 && changes[2].argument == 2 &&
+	  changes[3].argument == 3 && changes[4].argument == -1);
+	testTrue(@"Argument ranges",
+	  strncmp(line + changes[1].argumentLocation, "nick2",
+	  changes[1].argumentLength) == 0 && changes[1].argumentLength == 5 &&
+	  strncmp(line + changes[3].argumentLocation, "50",
+	  changes[3].argumentLength) == 0 && changes[4].argumentLength == 0);
+
+	count = IRCDecodeModes([object serverSupport], NO, "+iw", 3, changes, 1);
+	testEqual(@"User modes counted past the limit",
+	  [NSNumber numberWithUnsignedInt: count],
+	  [NSNumber numberWithUnsignedInt: 2]);
+	testTrue(@"User modes take no argument", changes[0].mode == 'i' &&
+	  changes[0].argument == -1);
+
+	feed(object, @":op!user@host MODE #chan +o-v+k nick1 nick2");
+	testEqual(@"Decoded target", [object modesTarget], @"#chan");
+	testEqual(@"Decoded count", [NSNumber numberWithUnsignedInt:
+	  [[object modes] count]], [NSNumber numberWithUnsignedInt: 3]);
+	testEqual(@"Decoded argument", [[object modes] argumentAtIndex: 1],
+	  @"nick2");
+	testTrue(@"Missing argument is nil",
+	  [[object modes] argumentAtIndex: 2] == nil &&
+	  [[object modes] modeAtIndex: 2] == 'k' &&
+	  [[object modes] isSettingAtIndex: 2]);
+}
+
+static void test_targets(void)
+{
+	CaptureTransport *capture = AUTORELEASE([CaptureTransport new]);
+	TestIRCObject *object = new_object(capture);
+	NSArray *channels = [NSArray arrayWithObjects: @"#a", @"#b", @"#c", @"#d",
+	  nil];
+	NSArray *keys = [NSArray arrayWithObjects: @"k1", [NSNull null], @"k3",
+	  @"", nil];
+
+	[object joinChannels: channels withPasswords: keys];
+	testEqual(@"One target a line by default", [capture lines],
+	  ([NSArray arrayWithObjects: @"JOIN #a k1", @"JOIN #c k3", @"JOIN #b",
+	  @"JOIN #d", nil]));
+
+	feed(object, @":irc.example.net 005 test TARGMAX=JOIN:3,PART: "
+	  @":are supported by this server");
+	[capture reset];
+	[object joinChannels: channels withPasswords: keys];
+	testEqual(@"JOIN split at TARGMAX with keys aligned", [capture lines],
+	  ([NSArray arrayWithObjects: @"JOIN #a,#c,#b k1,k3", @"JOIN #d", nil]));
+
+	[capture reset];
+	[object partChannels: channels withMessage: @"bye"];
+	testEqual(@"PART without a limit", [capture lines],
+	  [NSArray arrayWithObject: @"PART #a,#b,#c,#d :bye"]);
+
+	[capture reset];
+	[object sendMessage: @"hi" toReceivers: channels];
+	testEqual(@"PRIVMSG not in TARGMAX", [capture lines],
+	  ([NSArray arrayWithObjects: @"PRIVMSG #a :hi", @"PRIVMSG #b :hi",
+	  @"PRIVMSG #c :hi", @"PRIVMSG #d :hi", nil]));
+
+	feed(object, @":irc.example.net 005 test MAXTARGETS=3 "
+	  @":are supported by this server");
+	[capture reset];
+	[object sendMessage: @"hi" toReceivers: channels];
+	testEqual(@"PRIVMSG split at MAXTARGETS", [capture lines],
+	  ([NSArray arrayWithObjects: @"PRIVMSG #a,#b,#c :hi", @"PRIVMSG #d :hi",
+	  nil]));
+}
+
+static void test_relay_prefix(void)
+{
+	CaptureTransport *capture = AUTORELEASE([CaptureTransport new]);
+	TestIRCObject *object = new_object(capture);
+	NSMutableString *text = [NSMutableString string];
+
+	/* 24 bytes of ":test!user@host.example " leave 473 for the text of
+	 * "PRIVMSG #a :" but not of "PRIVMSG #a,#b :". */
+	while ([text length] < 473)
+	{
+		[text appendString: @"x"];
+	}
+	feed(object, @":irc.example.net 005 test MAXTARGETS= "
+	  @":are supported by this server");
+	feed(object, @":test!user@host.example JOIN #a");
+	[capture reset];
+	[object sendMessage: text toReceivers: [NSArray arrayWithObjects: @"#a",
+	  @"#b", nil]];
+	testEqual(@"Room kept for the relayed prefix", [NSNumber
+	  numberWithUnsignedInt: [[capture lines] count]],
+	  [NSNumber numberWithUnsignedInt: 2]);
+
+	[capture reset];
+	[text deleteCharactersInRange: NSMakeRange(0, 3)];
+	[object sendMessage: text toReceivers: [NSArray arrayWithObjects: @"#a",
+	  @"#b", nil]];
+	testEqual(@"Targets combined when the relayed line fits",
+	  [NSNumber numberWithUnsignedInt: [[capture lines] count]],
+	  [NSNumber numberWithUnsignedInt: 1]);
+}
+
+static void test_statistics(void)
+{
+	TestIRCObject *object = new_object(AUTORELEASE([CaptureTransport new]));
+	NSDictionary *stats;
+
+	feed(object, @":irc.example.net FOO test :one");
+	feed(object, @":irc.example.net BAR test :two");
+	feed(object, @":nick!user@host privmsg test :hi");
+	[object writeString: @"PING :irc.example.net"];
+
+	stats = [object statistics];
+	testEqual(@"Lines in by command", [stats objectForKey:
+	  @"LinesInByCommand"], ([NSDictionary dictionaryWithObjectsAndKeys:
+	  [NSNumber numberWithInt: 1], @"PRIVMSG",
+	  [NSNumber numberWithInt: 2], @"other", nil]));
+	testEqual(@"Lines out by command", [stats objectForKey:
+	  @"LinesOutByCommand"], [NSDictionary dictionaryWithObject:
+	  [NSNumber numberWithInt: 1] forKey: @"PING"]);
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+
+	test_names();
+	test_subscriptions();
+	test_isupport();
+	test_decode_modes();
+	test_targets();
+	test_relay_prefix();
+	test_statistics();
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+/***************************************************************************
+                                testmemory.m
+                          -------------------
+    begin                : Mon Oct 19 14:12:37 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/LineObject.h>
+#import <netclasses/NetMemory.h>
+
+#import <Foundation/Foundation.h>
+
+/* Everything here runs on the virtual clock of a MemoryDriver, so the
+ * times checked are exact. */
+
+@interface Recorder : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+		NSMutableData *data;
+		BOOL lost;
+	}
+- (NSData *)data;
+- (BOOL)lost;
+@end
+
+@implementation Recorder
+- init
+{
+	if (!(self = [super init])) return nil;
+	data = [NSMutableData new];
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(data);
+	RELEASE(transport);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	lost = YES;
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)newData
+{
+	[data appendData: newData];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+- (NSData *)data
+{
+	return data;
+}
+- (BOOL)lost
+{
+	return lost;
+}
+@end
+
+@interface Collector : LineObject
+	{
+		NSMutableArray *lines;
+	}
+- (NSArray *)lines;
+@end
+
+@implementation Collector
+- init
+{
+	if (!(self = [super init])) return nil;
+	lines = [NSMutableArray new];
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(lines);
+	[super dealloc];
+}
+- lineReceived: (NSData *)aLine
+{
+	[lines addObject: AUTORELEASE([[NSString alloc] initWithData: aLine
+	  encoding: NSASCIIStringEncoding])];
+	return self;
+}
+- (NSArray *)lines
+{
+	return lines;
+}
+@end
+
+static NSData *ascii(NSString *aString)
+{
+	return [aString dataUsingEncoding: NSASCIIStringEncoding];
+}
+
+/* Connects <var>anObject</var> to one end of a new pair and returns the
+ * other end. */
+static MemoryTransport *connect_pair(MemoryDriver *aDriver, id anObject)
+{
+	NSArray *pair = [aDriver createTransportPair];
+
+	[anObject connectionEstablished: [pair objectAtIndex: 1]];
+	return [pair objectAtIndex: 0];
+}
+
+static void test_framing(MemoryDriver *driver)
+{
+	Collector *collector = AUTORELEASE([Collector new]);
+	MemoryTransport *sender = connect_pair(driver, collector);
+	NSData *text = ascii(@"PING :a\r\nPRIVMSG #c :hello\nlast");
+	unsigned long long dispatches = [driver dispatchCount];
+
+	[sender setChunkSize: 1];
+	[sender writeData: text];
+	[driver runUntilIdle];
+	testTrue(@"?One byte per read", [driver dispatchCount] - dispatches ==
+	  [text length]);
+	testTrue(@"?Lines put back together", [[collector lines] isEqual:
+	  [NSArray arrayWithObjects: @"PING :a", @"PRIVMSG #c :hello", nil]]);
+
+	[sender writeData: ascii(@"\r\n")];
+	[driver runUntilIdle];
+	testEqual(@"Partial line finished", [[collector lines] lastObject],
+	  @"last");
+	[[NetApplication sharedInstance] disconnectObject: collector];
+}
+
+static void test_latency(MemoryDriver *driver)
+{
+	Recorder *recorder = AUTORELEASE([Recorder new]);
+	MemoryTransport *sender = connect_pair(driver, recorder);
+	uint64_t start = [driver currentTime];
+
+	[sender setLatency: 10000];
+	[sender writeData: ascii(@"hello")];
+	[driver runUntilIdle];
+	testTrue(@"?Nothing before the latency", [[recorder data] length] == 0 &&
+	  [[sender peer] nextArrival] == start + 10000);
+	[driver advanceTime: 9999];
+	testTrue(@"?Nothing a microsecond early", [[recorder data] length] == 0);
+	[driver advanceTime: 1];
+	testEqual(@"Arrived after the latency", [recorder data], ascii(@"hello"));
+	[[NetApplication sharedInstance] disconnectObject: recorder];
+}
+
+static void test_window(MemoryDriver *driver)
+{
+	Recorder *recorder = AUTORELEASE([Recorder new]);
+	MemoryTransport *sender = connect_pair(driver, recorder);
+	NSData *text = ascii(@"abcdefghijklmnopqrstuvwxy");
+	uint64_t start = [driver currentTime];
+
+	[sender setWindow: 10];
+	[sender setLatency: 1000];
+	[sender writeData: text];
+	testTrue(@"?Held back by the window", [sender writeBufferLength] == 15);
+	testFalse(@"?Not done writing", [sender isDoneWriting]);
+
+	[driver runUntilQuiet];
+	testEqual(@"Everything arrived", [recorder data], text);
+	testTrue(@"?One trip for each window", [driver currentTime] - start ==
+	  3000);
+	testTrue(@"?Done writing", [sender isDoneWriting]);
+	[[NetApplication sharedInstance] disconnectObject: recorder];
+}
+
+static void test_bandwidth(MemoryDriver *driver)
+{
+	Recorder *recorder = AUTORELEASE([Recorder new]);
+	MemoryTransport *sender = connect_pair(driver, recorder);
+	uint64_t start = [driver currentTime];
+
+	[sender setBandwidth: 1000.0];
+	[sender writeData: [NSMutableData dataWithLength: 500]];
+	[driver runUntilQuiet];
+	testTrue(@"?Arrived at the bandwidth", [[recorder data] length] == 500 &&
+	  [driver currentTime] - start == 500000);
+	[[NetApplication sharedInstance] disconnectObject: recorder];
+}
+
+static void test_close(MemoryDriver *driver)
+{
+	Recorder *recorder = AUTORELEASE([Recorder new]);
+	MemoryTransport *sender = connect_pair(driver, recorder);
+
+	[sender setLatency: 1000];
+	[sender writeData: ascii(@"bye")];
+	[sender close];
+	[driver runUntilIdle];
+	testFalse(@"?Data in flight still delivered first", [recorder lost]);
+	[driver runUntilQuiet];
+	testEqual(@"Data before the close read", [recorder data], ascii(@"bye"));
+	testTrue(@"?Connection lost after the close", [recorder lost]);
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	MemoryDriver *driver;
+
+	[NetApplication sharedInstance];
+	driver = AUTORELEASE([MemoryDriver new]);
+	testTrue(@"?Clock starts at zero", [driver currentTime] == 0);
+
+	test_framing(driver);
+	test_latency(driver);
+	test_window(driver);
+	test_bandwidth(driver);
+	test_close(driver);
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
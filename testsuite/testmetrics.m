@@ -0,0 +1,239 @@
+/***************************************************************************
+                                testmetrics.m
+                          -------------------
+    begin                : Mon Oct 19 11:20:41 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/NetMetrics.h>
+
+#import <Foundation/Foundation.h>
+
+#include <string.h>
+
+/* Keeps everything the server sends until the server closes. */
+@interface Scraper : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+		NSMutableData *response;
+		BOOL closed;
+	}
+- (NSString *)response;
+- (BOOL)closed;
+@end
+
+@implementation Scraper
+- init
+{
+	if (!(self = [super init])) return nil;
+	response = [NSMutableData new];
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(response);
+	RELEASE(transport);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	closed = YES;
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	[response appendData: data];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+- (NSString *)response
+{
+	return AUTORELEASE([[NSString alloc] initWithData: response
+	  encoding: NSUTF8StringEncoding]);
+}
+- (BOOL)closed
+{
+	return closed;
+}
+@end
+
+#define RUNABIT() \
+	[[NSRunLoop currentRunLoop] runUntilDate: \
+	[NSDate dateWithTimeIntervalSinceNow: 2.0]]
+
+static NSHost *loopback = nil;
+
+static NetMetricsServer *new_server(void)
+{
+	return [[NetMetricsServer alloc] initOnHost: loopback onPort: 0];
+}
+
+/* Closes <var>aServer</var> and lets go of the last reference to it. */
+static void close_server(NetMetricsServer *aServer)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+
+	[[NetApplication sharedInstance] disconnectObject: aServer];
+	RELEASE(aServer);
+	RELEASE(apr);
+}
+
+static BOOL has_line(NSString *aText, NSString *aLine)
+{
+	return [[aText componentsSeparatedByString: @"\n"]
+	  containsObject: aLine];
+}
+
+static void count(NetCommandCounters *counters, const char *line,
+  BOOL inbound)
+{
+	NetMetricsCountCommand(counters, line, strlen(line), inbound);
+}
+
+static void test_command_counts(void)
+{
+	NetCommandCounters *counters = NetMetricsNewCommandCounters();
+	NSDictionary *counts;
+
+	count(counters, "PRIVMSG #a :hello\r\n", YES);
+	count(counters, "privmsg #a :again\r\n", YES);
+	count(counters, "PING :server", YES);
+	count(counters, "XYZZY plugh", YES);
+	count(counters, "PONG :server", NO);
+	counts = NetMetricsCommandCounts(counters, YES);
+	testEqual(@"Commands counted by name", [counts objectForKey: @"PRIVMSG"],
+	  [NSNumber numberWithInt: 2]);
+	testEqual(@"Unknown commands counted as other",
+	  [counts objectForKey: @"other"], [NSNumber numberWithInt: 1]);
+	testTrue(@"?Only counted commands reported", [counts count] == 3);
+	testEqual(@"Directions counted apart",
+	  NetMetricsCommandCounts(counters, NO),
+	  [NSDictionary dictionaryWithObject: [NSNumber numberWithInt: 1]
+	  forKey: @"PONG"]);
+	NetMetricsFreeCommandCounters(counters);
+}
+
+static void test_flag(void)
+{
+	NetMetricsServer *s1, *s2;
+	NetCommandCounters *counters;
+	NSString *line = @"netclasses_irc_lines_total"
+	  @"{direction=\"in\",command=\"KICK\"} 1";
+
+	testFalse(@"?Commands not summed without a server",
+	  NetMetricsCountsCommands);
+	counters = NetMetricsNewCommandCounters();
+	count(counters, "KICK #a b", YES);
+	testFalse(@"?Counters not listed without a server",
+	  has_line([NetMetricsServer renderMetrics], line));
+	NetMetricsFreeCommandCounters(counters);
+
+	s1 = new_server();
+	s2 = new_server();
+	testTrue(@"?Servers bound", s1 && s2);
+	testTrue(@"?Server turns command counts on", NetMetricsCountsCommands);
+
+	counters = NetMetricsNewCommandCounters();
+	count(counters, "KICK #a b", YES);
+	testTrue(@"?Counters listed with a server",
+	  has_line([NetMetricsServer renderMetrics], line));
+	NetMetricsFreeCommandCounters(counters);
+	testTrue(@"?Freed counters kept in the totals",
+	  has_line([NetMetricsServer renderMetrics], line));
+
+	close_server(s1);
+	testTrue(@"?Still on while a server is left", NetMetricsCountsCommands);
+	close_server(s2);
+	testFalse(@"?Last server turns command counts off",
+	  NetMetricsCountsCommands);
+
+	counters = NetMetricsNewCommandCounters();
+	count(counters, "KICK #a b", YES);
+	testFalse(@"?New counters not listed once off",
+	  has_line([NetMetricsServer renderMetrics],
+	  @"netclasses_irc_lines_total{direction=\"in\",command=\"KICK\"} 2"));
+	NetMetricsFreeCommandCounters(counters);
+}
+
+static Scraper *scrape(NetMetricsServer *aServer, NSString *aRequest)
+{
+	Scraper *client = AUTORELEASE([Scraper new]);
+
+	if (![[TCPSystem sharedInstance] connectNetObject: client
+	  toHost: loopback onPort: [aServer port] withTimeout: 4])
+	{
+		return nil;
+	}
+	[[client transport] writeData:
+	  [aRequest dataUsingEncoding: NSASCIIStringEncoding]];
+	RUNABIT();
+	return client;
+}
+
+static void test_scrape(void)
+{
+	NetMetricsServer *server = new_server();
+	Scraper *client;
+	NSString *text;
+
+	client = scrape(server, @"GET /metrics HTTP/1.0\r\n\r\n");
+	text = [client response];
+	testTrue(@"?Scrape answered", [text hasPrefix: @"HTTP/1.0 200 OK\r\n"]);
+	testTrue(@"?Connection closed after the response", [client closed]);
+	testTrue(@"?Scrape counted", has_line(text,
+	  @"netclasses_metrics_scrapes_total 1"));
+	testTrue(@"?Accept counted", has_line(text,
+	  @"netclasses_accepts_total 1"));
+	testTrue(@"?Metric types given", has_line(text,
+	  @"# TYPE netclasses_connections gauge"));
+
+	client = scrape(server, @"GET /nothing HTTP/1.0\r\n\r\n");
+	testTrue(@"?Unknown path refused", [[client response]
+	  hasPrefix: @"HTTP/1.0 404 Not Found\r\n"]);
+	client = scrape(server, @"POST /metrics HTTP/1.0\r\n\r\n");
+	testTrue(@"?Other methods refused", [[client response]
+	  hasPrefix: @"HTTP/1.0 405 Method Not Allowed\r\n"]);
+
+	close_server(server);
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+
+	[NetApplication sharedInstance];
+	loopback = RETAIN([NSHost hostWithAddress: @"127.0.0.1"]);
+
+	test_command_counts();
+	test_flag();
+	test_scrape();
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
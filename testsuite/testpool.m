@@ -0,0 +1,216 @@
+/***************************************************************************
+                                testpool.m
+                          -------------------
+    begin                : Mon Oct 19 11:02:13 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/NetPool.h>
+
+#import <Foundation/Foundation.h>
+
+int numPrepared = 0;
+int numFreed = 0;
+
+@interface PooledThing : NSObject <NetRecycling>
+	{
+		int value;
+	}
+- initWithValue: (int)aValue;
+- (int)value;
+@end
+
+@implementation PooledThing
++ (BOOL)recyclesInstances
+{
+	return YES;
+}
+- initWithValue: (int)aValue
+{
+	if (!(self = [super init])) return nil;
+	value = aValue;
+	return self;
+}
+- (void)prepareForReuse
+{
+	numPrepared++;
+	value = 0;
+}
+- (void)dealloc
+{
+	numFreed++;
+	[super dealloc];
+}
+- (int)value
+{
+	return value;
+}
+@end
+
+@interface PlainThing : NSObject
+@end
+
+@implementation PlainThing
+- (void)dealloc
+{
+	numFreed++;
+	[super dealloc];
+}
+@end
+
+static unsigned pool_stat(NSDictionary *stats, NSString *key)
+{
+	return [[stats objectForKey: key] unsignedIntValue];
+}
+
+static void test_buffer_pool(void)
+{
+	NetBufferPool *pool = AUTORELEASE([NetBufferPool new]);
+	NSMutableData *b1, *b2, *b3;
+
+	b1 = [pool newBufferWithCapacity: 100];
+	testTrue(@"?Empty pool allocates",
+	  pool_stat([pool statistics], @"Misses") == 1 &&
+	  pool_stat([pool statistics], @"Hits") == 0);
+	[b1 appendBytes: "hello" length: 5];
+	[pool recycleBuffer: b1 capacity: 100];
+	testTrue(@"?Buffer kept", pool_stat([pool statistics], @"Idle") == 1 &&
+	  pool_stat([pool statistics], @"Recycled") == 1);
+	testTrue(@"?Kept in the 2KB class",
+	  pool_stat([pool statistics], @"IdleBytes") == 2048);
+
+	b2 = [pool newBufferWithCapacity: 1000];
+	testTrue(@"?Buffer reused", b2 == b1 &&
+	  pool_stat([pool statistics], @"Hits") == 1);
+	testTrue(@"?Reused buffer is empty", [b2 length] == 0);
+
+	/* A buffer that grew is kept in the class covering its growth, and
+	 * only handed out for a capacity that class covers. */
+	[pool recycleBuffer: b2 capacity: 5000];
+	testTrue(@"?Grown buffer in the 16KB class",
+	  pool_stat([pool statistics], @"IdleBytes") == 16384);
+	b3 = [pool newBufferWithCapacity: 100];
+	testTrue(@"?Small request not served by the 16KB class", b3 != b2 &&
+	  pool_stat([pool statistics], @"Misses") == 2);
+	b1 = [pool newBufferWithCapacity: 10000];
+	testTrue(@"?16KB class serves a 10000 byte request", b1 == b2);
+
+	/* A buffer grown past the largest class is freed, not kept. */
+	[pool recycleBuffer: b1 capacity: 200000];
+	testTrue(@"?Oversized buffer discarded",
+	  pool_stat([pool statistics], @"Discarded") == 1 &&
+	  pool_stat([pool statistics], @"Idle") == 0);
+	[pool recycleBuffer: b3 capacity: 2048];
+
+	[pool setLimit: 2];
+	[pool recycleBuffer: [pool newBufferWithCapacity: 10] capacity: 10];
+	[pool recycleBuffer: [[NSMutableData alloc] initWithCapacity: 10]
+	  capacity: 10];
+	[pool recycleBuffer: [[NSMutableData alloc] initWithCapacity: 10]
+	  capacity: 10];
+	testTrue(@"?Limit caps each class",
+	  pool_stat([pool statistics], @"Idle") == 2 &&
+	  pool_stat([pool statistics], @"Discarded") == 2);
+	[pool setLimit: 1];
+	testTrue(@"?Lowering the limit drops buffers",
+	  pool_stat([pool statistics], @"Idle") == 1 &&
+	  pool_stat([pool statistics], @"Discarded") == 3 &&
+	  pool_stat([pool statistics], @"Limit") == 1);
+}
+
+static void test_object_pool(void)
+{
+	NetObjectPool *pool;
+	PooledThing *a, *b, *c;
+	PlainThing *plain;
+
+	testTrue(@"?Recycling class is pooled",
+	  [NetObjectPool recyclesInstancesOfClass: [PooledThing class]]);
+	testFalse(@"?Plain class is not pooled",
+	  [NetObjectPool recyclesInstancesOfClass: [PlainThing class]]);
+	testFalse(@"?Transports are not pooled",
+	  [NetObjectPool recyclesInstancesOfClass: [TCPTransport class]]);
+
+	pool = AUTORELEASE([[NetObjectPool alloc]
+	  initWithClass: [PooledThing class]]);
+	a = [[pool allocObject] initWithValue: 1];
+	testTrue(@"?Empty pool allocates", [a value] == 1 &&
+	  pool_stat([pool statistics], @"Misses") == 1);
+
+	[pool recycleObject: a];
+	testTrue(@"?Object prepared when handed back", numPrepared == 1 &&
+	  [a value] == 0);
+	testTrue(@"?Object kept", pool_stat([pool statistics], @"Kept") == 1 &&
+	  numFreed == 0);
+
+	b = [[pool allocObject] initWithValue: 2];
+	testTrue(@"?Object reused", b == a && [b value] == 2 &&
+	  pool_stat([pool statistics], @"Hits") == 1);
+
+	/* Objects still in use are never handed out again. */
+	c = [[pool allocObject] initWithValue: 3];
+	testTrue(@"?Object in use not reused", c != b && [b value] == 2 &&
+	  pool_stat([pool statistics], @"Misses") == 2);
+
+	[pool setLimit: 1];
+	[pool recycleObject: b];
+	[pool recycleObject: c];
+	testTrue(@"?Limit caps the pool",
+	  pool_stat([pool statistics], @"Kept") == 1 &&
+	  pool_stat([pool statistics], @"Discarded") == 1 && numFreed == 1);
+	{
+		CREATE_AUTORELEASE_POOL(inner);
+		[pool setLimit: 0];
+		RELEASE(inner);
+	}
+	testTrue(@"?Lowering the limit frees objects",
+	  pool_stat([pool statistics], @"Kept") == 0 && numFreed == 2);
+
+	/* Handing back an object whose class is not pooled only gives up
+	 * the reference of the caller; other owners keep a working object. */
+	plain = [PlainThing new];
+	RETAIN(plain);
+	[NetObjectPool recycleInstance: plain];
+	testTrue(@"?Referenced object survives", numFreed == 2 &&
+	  [plain isKindOfClass: [PlainThing class]]);
+	RELEASE(plain);
+	testTrue(@"?Last reference frees it", numFreed == 3);
+
+	a = [[NetObjectPool allocInstanceOfClass: [PooledThing class]]
+	  initWithValue: 4];
+	[NetObjectPool recycleInstance: a];
+	b = [[NetObjectPool allocInstanceOfClass: [PooledThing class]]
+	  initWithValue: 5];
+	testTrue(@"?Shared pool reuses", a == b);
+	testTrue(@"?Shared pool reported", pool_stat([[NetObjectPool
+	  statistics] objectForKey: @"PooledThing"], @"Hits") == 1);
+	RELEASE(b);
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+
+	test_buffer_pool();
+	test_object_pool();
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
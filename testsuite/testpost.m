@@ -0,0 +1,283 @@
+/***************************************************************************
+                                testpost.m
+                          -------------------
+    begin                : Mon Oct 19 12:03:52 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/LineObject.h>
+
+#import <Foundation/Foundation.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/* Threads post writes and messages to the run loop thread, which runs
+ * them in the order each thread posted them. */
+
+#define NUM_THREADS 4
+#define NUM_POSTS 500
+
+int numThreadsDone = 0;
+int numMessages = 0;
+int numOffThread = 0;
+int numLost = 0;
+
+@class LineServer;
+LineServer *server = nil;
+
+@interface LineServer : LineObject
+	{
+		int next[NUM_THREADS];
+		int numLines;
+		BOOL inOrder;
+	}
+- (int)numLines;
+- (BOOL)inOrder;
+@end
+
+@implementation LineServer
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	inOrder = YES;
+	ASSIGN(server, self);
+	return [super connectionEstablished: aTransport];
+}
+- (void)connectionLost
+{
+	numLost++;
+	[super connectionLost];
+}
+- lineReceived: (NSData *)aLine
+{
+	char buffer[32];
+	unsigned length = [aLine length];
+	int thread, post;
+
+	if (length >= sizeof(buffer))
+	{
+		inOrder = NO;
+		return self;
+	}
+	memcpy(buffer, [aLine bytes], length);
+	buffer[length] = 0;
+	if (sscanf(buffer, "%d %d", &thread, &post) != 2 ||
+	  thread < 0 || thread >= NUM_THREADS || post != next[thread])
+	{
+		inOrder = NO;
+		return self;
+	}
+	next[thread]++;
+	numLines++;
+	return self;
+}
+- (int)numLines
+{
+	return numLines;
+}
+- (BOOL)inOrder
+{
+	return inOrder;
+}
+@end
+
+@interface Client : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation Client
+- (void)connectionLost
+{
+	numLost++;
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@interface Poster : NSObject
+	{
+		id<NetTransport> transport;
+		int thread;
+	}
+- initWithTransport: (id <NetTransport>)aTransport thread: (int)aThread;
+- run: (id)anObject;
+- countMessage: (id)anObject;
+@end
+
+@implementation Poster
+- initWithTransport: (id <NetTransport>)aTransport thread: (int)aThread
+{
+	if (!(self = [super init])) return nil;
+	transport = RETAIN(aTransport);
+	thread = aThread;
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(transport);
+	[super dealloc];
+}
+- run: (id)anObject
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NetApplication *net = [NetApplication sharedInstance];
+	NSString *line;
+	int x;
+
+	for (x = 0; x < NUM_POSTS; x++)
+	{
+		line = [NSString stringWithFormat: @"%d %d\r\n", thread, x];
+		[net postWriteData: [line dataUsingEncoding: NSASCIIStringEncoding]
+		  toTransport: transport];
+		[net postMessage: @selector(countMessage:) to: self withObject: nil];
+	}
+	__atomic_add_fetch(&numThreadsDone, 1, __ATOMIC_RELEASE);
+	RELEASE(apr);
+	return self;
+}
+- countMessage: (id)anObject
+{
+	numMessages++;
+	if (![[NetApplication sharedInstance] isRunLoopThread])
+	{
+		numOffThread++;
+	}
+	return self;
+}
+@end
+
+@interface Disconnecter : NSObject
+- run: (id)anObject;
+@end
+
+@implementation Disconnecter
+- run: (id)anObject
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NetApplication *net = [NetApplication sharedInstance];
+
+	[net disconnectObject: anObject];
+	[net postWriteData: [NSData dataWithBytes: "late\r\n" length: 6]
+	  toTransport: [anObject transport]];
+	__atomic_add_fetch(&numThreadsDone, 1, __ATOMIC_RELEASE);
+	RELEASE(apr);
+	return self;
+}
+@end
+
+static BOOL run_until(BOOL (*condition)(void *), void *info)
+{
+	NSDate *limit = [NSDate dateWithTimeIntervalSinceNow: 20.0];
+
+	while (!condition(info) && [limit timeIntervalSinceNow] > 0)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+		  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+		RELEASE(apr);
+	}
+	return condition(info);
+}
+
+static BOOL have_server(void *info)
+{
+	return server != nil;
+}
+
+static BOOL all_received(void *info)
+{
+	return __atomic_load_n(&numThreadsDone, __ATOMIC_ACQUIRE) ==
+	  NUM_THREADS && [server numLines] == NUM_THREADS * NUM_POSTS &&
+	  numMessages == NUM_THREADS * NUM_POSTS;
+}
+
+static BOOL both_lost(void *info)
+{
+	return numLost == 2;
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NetApplication *net;
+	TCPPort *port;
+	Client *client;
+	NSHost *host = [NSHost hostWithAddress: @"127.0.0.1"];
+	unsigned long long posted;
+	int x;
+
+	net = [NetApplication sharedInstance];
+	testTrue(@"?Main thread runs the loop", [net isRunLoopThread]);
+
+	port = AUTORELEASE([[TCPPort alloc] initOnHost: host onPort: 0]);
+	testTrue(@"?Initialized port", port);
+	[port setNetObject: [LineServer class]];
+
+	client = AUTORELEASE([Client new]);
+	testTrue(@"?Made connection", [[TCPSystem sharedInstance]
+	  connectNetObject: client toHost: host onPort: [port port]
+	  withTimeout: 4]);
+	testTrue(@"?Server connected", run_until(have_server, 0));
+
+	posted = [[[net statistics] objectForKey: @"Posted"]
+	  unsignedLongLongValue];
+	for (x = 0; x < NUM_THREADS; x++)
+	{
+		[NSThread detachNewThreadSelector: @selector(run:)
+		  toTarget: AUTORELEASE([[Poster alloc] initWithTransport:
+		  [client transport] thread: x]) withObject: nil];
+	}
+	testTrue(@"?Every posted write and message handled",
+	  run_until(all_received, 0));
+	testTrue(@"?Posted writes kept the order of each thread",
+	  [server inOrder]);
+	testTrue(@"?Posted messages ran on the run loop thread",
+	  numOffThread == 0);
+	testTrue(@"?Posts counted", [[[net statistics] objectForKey: @"Posted"]
+	  unsignedLongLongValue] - posted == 2 * NUM_THREADS * NUM_POSTS);
+
+	/* A disconnect posted from another thread happens on the run loop
+	 * thread, and a write posted after it is dropped. */
+	[NSThread detachNewThreadSelector: @selector(run:)
+	  toTarget: AUTORELEASE([Disconnecter new]) withObject: client];
+	testTrue(@"?Posted disconnect handled", run_until(both_lost, 0));
+	testTrue(@"?Write posted after the disconnect dropped",
+	  [server numLines] == NUM_THREADS * NUM_POSTS && [server inOrder]);
+
+	[net disconnectObject: port];
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+/***************************************************************************
+                                testtls.m
+                          -------------------
+    begin                : Mon Oct 19 13:58:12 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/NetTLS.h>
+
+#import <Foundation/Foundation.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* The same echo as testtcp, over TLSTransport.  The certificate and key
+ * are given with -tls-cert file.pem -tls-key file.pem or else made with
+ * the openssl command.  Without either, or without TLS support, only the
+ * refusal to connect is tested. */
+
+#define NUM_BYTES 65536
+
+int numBytes = 0;
+id server = nil;
+
+@interface EchoServer : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation EchoServer
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	ASSIGN(server, self);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	[transport writeData: data];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@interface Client : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation Client
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	numBytes += [data length];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+static BOOL run_until_echoed(void)
+{
+	NSDate *limit = [NSDate dateWithTimeIntervalSinceNow: 10.0];
+
+	while (numBytes < NUM_BYTES && [limit timeIntervalSinceNow] > 0)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+		  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+		RELEASE(apr);
+	}
+	return numBytes == NUM_BYTES;
+}
+
+/* Makes a self-signed certificate and key in the temporary directory. */
+static BOOL make_certificate(NSString **aCert, NSString **aKey)
+{
+	NSString *dir = NSTemporaryDirectory();
+	NSString *command;
+
+	*aCert = [dir stringByAppendingPathComponent: @"testtls-cert.pem"];
+	*aKey = [dir stringByAppendingPathComponent: @"testtls-key.pem"];
+	command = [NSString stringWithFormat: @"openssl req -x509 -batch "
+	  @"-newkey rsa:2048 -nodes -days 1 -subj /CN=localhost "
+	  @"-keyout '%@' -out '%@' >/dev/null 2>&1", *aKey, *aCert];
+
+	return system([command cString]) == 0;
+}
+
+/* Connects, echoes NUM_BYTES through the server and returns the client's
+ * transport, or nil if it could not connect. */
+static TLSTransport *echo(TCPPort *aPort, Client *client, NSString *aName)
+{
+	TLSTransport *transport;
+
+	numBytes = 0;
+	DESTROY(server);
+	if (![[TCPSystem sharedInstance] connectNetObject: client
+	  toHost: [NSHost hostWithAddress: @"127.0.0.1"] onPort: [aPort port]
+	  withTimeout: 4 transportClass: [TLSTransport class]])
+	{
+		FAIL([NSString stringWithFormat: @"%@: connected", aName]);
+		return nil;
+	}
+	transport = (TLSTransport *)[client transport];
+	testFalse(([NSString stringWithFormat: @"%@: handshake pending",
+	  aName]), [transport isHandshakeComplete]);
+
+	/* Written before the handshake finishes, sent once it does. */
+	[transport writeData: [NSMutableData dataWithLength: NUM_BYTES]];
+	testTrue(([NSString stringWithFormat: @"%@: echoed", aName]),
+	  run_until_echoed());
+	testTrue(([NSString stringWithFormat: @"%@: handshake complete",
+	  aName]), [transport isHandshakeComplete] &&
+	  [(TLSTransport *)[server transport] isHandshakeComplete]);
+	testTrue(([NSString stringWithFormat: @"%@: cipher and protocol",
+	  aName]), [transport cipherName] && [transport protocolVersion] &&
+	  [[transport statistics] objectForKey: @"HandshakeTime"]);
+
+	return transport;
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NSUserDefaults *args = [NSUserDefaults standardUserDefaults];
+	NetApplication *net;
+	TLSTransport *transport;
+	TCPPort *port;
+	Client *client;
+	NSString *cert, *key;
+	BOOL loaded;
+
+	net = [NetApplication sharedInstance];
+
+	cert = [args stringForKey: @"tls-cert"];
+	key = [args stringForKey: @"tls-key"];
+	if (!cert || !key)
+	{
+		loaded = make_certificate(&cert, &key) &&
+		  [TLSTransport setCertificateFile: cert privateKeyFile: key];
+	}
+	else
+	{
+		loaded = [TLSTransport setCertificateFile: cert privateKeyFile: key];
+	}
+
+	if (!loaded)
+	{
+		BOOL noTLS = [[[TCPSystem sharedInstance] errorString]
+		  isEqualToString: NetclassesErrorNoTLS];
+
+		client = AUTORELEASE([Client new]);
+		port = AUTORELEASE([[TCPPort alloc] initOnHost:
+		  [NSHost hostWithAddress: @"127.0.0.1"] onPort: 0]);
+		if (noTLS)
+		{
+			testFalse(@"?No TLS connection without TLS support",
+			  [[TCPSystem sharedInstance] connectNetObject: client
+			  toHost: [NSHost hostWithAddress: @"127.0.0.1"]
+			  onPort: [port port] withTimeout: 4
+			  transportClass: [TLSTransport class]]);
+		}
+		NSLog(@"No certificate could be loaded; skipping the TLS tests");
+		[net disconnectObject: port];
+		FINISH();
+	}
+
+	port = AUTORELEASE([[TCPPort alloc] initOnHost:
+	  [NSHost hostWithAddress: @"127.0.0.1"] onPort: 0]);
+	testTrue(@"?Initialized port", port);
+	[port setNetObject: [EchoServer class]];
+	[port setTransportClass: [TLSTransport class]];
+
+	[TLSTransport flushSessionCache];
+	client = AUTORELEASE([Client new]);
+	transport = echo(port, client, @"First connection");
+	testFalse(@"?First session is new", [transport isSessionReused]);
+	testTrue(@"?Session cached", [TLSTransport sessionCacheCount] == 1);
+	[net disconnectObject: client];
+
+	client = AUTORELEASE([Client new]);
+	transport = echo(port, client, @"Second connection");
+	testTrue(@"?Cached session resumed", [transport isSessionReused] &&
+	  [[[transport statistics] objectForKey: @"SessionReused"] boolValue]);
+	[net disconnectObject: client];
+
+	[TLSTransport flushSessionCache];
+	testTrue(@"?Session cache flushed", [TLSTransport sessionCacheCount] == 0);
+	client = AUTORELEASE([Client new]);
+	transport = echo(port, client, @"Third connection");
+	testFalse(@"?Full handshake after a flush", [transport isSessionReused]);
+	[net disconnectObject: client];
+
+	[net disconnectObject: port];
+	DESTROY(server);
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
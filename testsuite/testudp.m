@@ -0,0 +1,190 @@
+/***************************************************************************
+                                testudp.m
+                          -------------------
+    begin                : Mon Oct 19 13:41:26 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetUDP.h>
+
+#import <Foundation/Foundation.h>
+
+#include <string.h>
+
+/* Datagrams keep their boundaries: datagram x is x + 1 bytes of x. */
+
+#define NUM_DATAGRAMS 100
+
+@interface Endpoint : NSObject <NetDatagramObject>
+	{
+		id<NetTransport> transport;
+		int numDatagrams;
+		BOOL intact;
+		BOOL echoes;
+	}
+- initEchoing: (BOOL)aFlag;
+- (int)numDatagrams;
+- (BOOL)intact;
+@end
+
+@implementation Endpoint
+- initEchoing: (BOOL)aFlag
+{
+	if (!(self = [super init])) return nil;
+	echoes = aFlag;
+	intact = YES;
+	return self;
+}
+- (void)dealloc
+{
+	RELEASE(transport);
+	[super dealloc];
+}
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	return self;
+}
+- datagramReceived: (const char *)bytes length: (unsigned)length
+   from: (const struct sockaddr_in *)anAddress
+{
+	unsigned x;
+
+	if (length != (unsigned)numDatagrams + 1)
+	{
+		intact = NO;
+	}
+	for (x = 0; x < length; x++)
+	{
+		if ((unsigned char)bytes[x] != numDatagrams)
+		{
+			intact = NO;
+		}
+	}
+	numDatagrams++;
+	if (echoes)
+	{
+		[(UDPTransport *)transport sendData: [NSData dataWithBytes: bytes
+		  length: length] to: anAddress];
+	}
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+- (int)numDatagrams
+{
+	return numDatagrams;
+}
+- (BOOL)intact
+{
+	return intact;
+}
+@end
+
+#define RUNABIT() \
+	[[NSRunLoop currentRunLoop] runUntilDate: \
+	[NSDate dateWithTimeIntervalSinceNow: 2.0]]
+
+static unsigned long long udp_stat(Endpoint *anEndpoint, NSString *aKey)
+{
+	return [[[(UDPTransport *)[anEndpoint transport] statistics]
+	  objectForKey: aKey] unsignedLongLongValue];
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NetApplication *net;
+	UDPSystem *udp;
+	Endpoint *server, *client, *stranger;
+	NSHost *host = [NSHost hostWithAddress: @"127.0.0.1"];
+	struct sockaddr_in address;
+	char bytes[NUM_DATAGRAMS];
+	uint16_t port;
+	int x;
+
+	net = [NetApplication sharedInstance];
+	udp = [UDPSystem sharedInstance];
+
+	server = AUTORELEASE([[Endpoint alloc] initEchoing: YES]);
+	testTrue(@"?Bound server", [udp bindNetObject: server onHost: host
+	  onPort: 0]);
+	port = [(UDPTransport *)[server transport] port];
+	testTrue(@"?Bound to a port", port != 0);
+
+	client = AUTORELEASE([[Endpoint alloc] initEchoing: NO]);
+	testTrue(@"?Connected client", [udp connectNetObject: client toHost: host
+	  onPort: port]);
+	testTrue(@"?Client has a destination", [[client transport] remoteHost]
+	  != nil);
+
+	for (x = 0; x < NUM_DATAGRAMS; x++)
+	{
+		memset(bytes, x, x + 1);
+		[[client transport] writeData: [NSData dataWithBytes: bytes
+		  length: x + 1]];
+	}
+	testFalse(@"?Datagrams queued", [[client transport] isDoneWriting]);
+	RUNABIT();
+	testTrue(@"?Every datagram received", [server numDatagrams] ==
+	  NUM_DATAGRAMS);
+	testTrue(@"?Datagram boundaries kept", [server intact]);
+	testTrue(@"?Every datagram echoed", [client numDatagrams] ==
+	  NUM_DATAGRAMS && [client intact]);
+	testTrue(@"?Nothing left queued", [[client transport] isDoneWriting]);
+	testTrue(@"?Datagrams counted", udp_stat(client, @"DatagramsSent") ==
+	  NUM_DATAGRAMS && udp_stat(server, @"DatagramsReceived") ==
+	  NUM_DATAGRAMS);
+#ifdef __linux__
+	testTrue(@"?Sent in batches", udp_stat(client, @"SendCalls") <
+	  NUM_DATAGRAMS);
+	testTrue(@"?Received in batches", udp_stat(server, @"ReceiveCalls") <
+	  NUM_DATAGRAMS);
+#endif
+
+	/* A connected socket only receives from its destination. */
+	stranger = AUTORELEASE([[Endpoint alloc] initEchoing: NO]);
+	testTrue(@"?Bound stranger", [udp bindNetObject: stranger onHost: host
+	  onPort: 0]);
+	[udp getAddress: &address forHost: host
+	  onPort: [(UDPTransport *)[client transport] port]];
+	[(UDPTransport *)[stranger transport] sendData:
+	  [NSData dataWithBytes: "x" length: 1] to: &address];
+	RUNABIT();
+	testTrue(@"?Other sources ignored", [client numDatagrams] ==
+	  NUM_DATAGRAMS);
+
+	[net disconnectObject: stranger];
+	[net disconnectObject: client];
+	[net disconnectObject: server];
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
@@ -0,0 +1,239 @@
+/***************************************************************************
+                                testunix.m
+                          -------------------
+    begin                : Mon Oct 19 08:54:47 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/NetUnix.h>
+
+#import <Foundation/Foundation.h>
+
+#include <unistd.h>
+
+/* A TCPPort accepts connections as a front process would, and passes each
+ * of them over a UnixPort connection to a worker, which takes it over and
+ * echoes what it receives.  Both ends live in this one process.
+ */
+
+int numEchoes = 0;
+int numHandoffs = 0;
+id frontLink = nil;
+
+@interface EchoServer : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation EchoServer
+- (void)connectionLost
+{
+	numEchoes--;
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	numEchoes++;
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	[transport writeData: data];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@interface Worker : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation Worker
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	int desc;
+
+	while ((desc = [(UnixTransport *)transport takeReceivedDescriptor]) != -1)
+	{
+		if (![[TCPSystem sharedInstance] adoptDescriptor: desc
+		  withNetObjectClass: [EchoServer class]])
+		{
+			close(desc);
+		}
+	}
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@interface Front : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation Front
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	numHandoffs++;
+	[(UnixTransport *)[frontLink transport] sendDescriptor: [transport desc]
+	  withData: [NSData dataWithBytes: "fd\n" length: 3]];
+	[transport close];
+	DESTROY(transport);
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@interface Client : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+		int numBytes;
+	}
+- (int)numBytes;
+@end
+
+@implementation Client
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	numBytes += [data length];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+- (int)numBytes
+{
+	return numBytes;
+}
+@end
+
+#define RUNABIT() \
+	[[NSRunLoop currentRunLoop] runUntilDate: \
+	[NSDate dateWithTimeIntervalSinceNow: 2.0]]
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	TCPSystem *tcp;
+	NetApplication *net;
+	UnixPort *unixPort;
+	TCPPort *port;
+	NSString *path;
+	Client *c1, *c2;
+	NSHost *host = [NSHost hostWithAddress: @"127.0.0.1"];
+	NSData *data = [NSData dataWithBytes: "hello, worker\n" length: 14];
+
+	net = [NetApplication sharedInstance];
+	tcp = [TCPSystem sharedInstance];
+	path = [NSString stringWithFormat: @"/tmp/netclasses-testunix-%d",
+	  (int)getpid()];
+
+	unixPort = AUTORELEASE([[UnixPort alloc] initWithPath: path]);
+	testTrue(@"?Initialized unix port", unixPort);
+	[unixPort setNetObject: [Worker class]];
+
+	frontLink = [Client new];
+	testTrue(@"?Connected to unix port", [tcp connectNetObject: frontLink
+	  toPath: path]);
+	testTrue(@"?Unix transport", [[frontLink transport] isKindOfClass:
+	  [UnixTransport class]]);
+
+	port = AUTORELEASE([[TCPPort alloc] initOnPort: 0]);
+	testTrue(@"?Initialized tcp port", port);
+	[port setNetObject: [Front class]];
+
+	c1 = AUTORELEASE([Client new]);
+	c2 = AUTORELEASE([Client new]);
+	testTrue(@"?Made connection c1", [tcp connectNetObject: c1 toHost: host
+	  onPort: [port port] withTimeout: 4]);
+	testTrue(@"?Made connection c2", [tcp connectNetObject: c2 toHost: host
+	  onPort: [port port] withTimeout: 4]);
+	RUNABIT();
+	testTrue(@"?Front handed off both", numHandoffs == 2);
+	testTrue(@"?Worker adopted both", numEchoes == 2);
+	testTrue(@"?Descriptors sent", [[[(UnixTransport *)[frontLink transport]
+	  statistics] objectForKey: @"DescriptorsSent"] intValue] == 2);
+
+	[[c1 transport] writeData: data];
+	[[c2 transport] writeData: data];
+	RUNABIT();
+	testTrue(@"?Echo through worker c1", [c1 numBytes] == [data length]);
+	testTrue(@"?Echo through worker c2", [c2 numBytes] == [data length]);
+
+	[net disconnectObject: c1];
+	RUNABIT();
+	testTrue(@"?Worker lost c1", numEchoes == 1);
+
+	[net disconnectObject: c2];
+	[net disconnectObject: frontLink];
+	[net disconnectObject: port];
+	[net disconnectObject: unixPort];
+	[unixPort close];
+	testFalse(@"?Socket file removed", [[NSFileManager defaultManager]
+	  fileExistsAtPath: path]);
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
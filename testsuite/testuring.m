@@ -0,0 +1,174 @@
+/***************************************************************************
+                                testuring.m
+                          -------------------
+    begin                : Mon Oct 19 12:46:18 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/NetUring.h>
+
+#import <Foundation/Foundation.h>
+
+/* The same echo as testtcp, on the io_uring backend.  Where io_uring is
+ * missing only the fallback to the readiness backend is tested. */
+
+#define NUM_BYTES 65536
+
+int numBytes = 0;
+int numReceived = 0;
+id server = nil;
+
+@interface EchoServer : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation EchoServer
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	ASSIGN(server, self);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	numReceived += [data length];
+	[transport writeData: data];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+@interface Client : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation Client
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	numBytes += [data length];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+#define RUNABIT() \
+	[[NSRunLoop currentRunLoop] runUntilDate: \
+	[NSDate dateWithTimeIntervalSinceNow: 2.0]]
+
+static unsigned long long uring_stat(NSString *aKey)
+{
+	return [[[[[NetApplication sharedInstance] statistics]
+	  objectForKey: @"Uring"] objectForKey: aKey] unsignedLongLongValue];
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NetApplication *net;
+	TCPPort *port;
+	Client *client;
+	NSHost *host = [NSHost hostWithAddress: @"127.0.0.1"];
+	NSMutableData *data;
+	unsigned long long pending;
+	unsigned writers;
+
+	net = [NetApplication sharedInstance];
+	testTrue(@"?Readiness backend by default",
+	  [net ioBackend] == NetReadinessBackend);
+
+	if (![NetUring isAvailable])
+	{
+		testFalse(@"?Uring refused where missing",
+		  [net setIOBackend: NetUringBackend]);
+		testTrue(@"?Readiness backend kept",
+		  [net ioBackend] == NetReadinessBackend);
+		NSLog(@"io_uring is not available; skipping the uring tests");
+		FINISH();
+	}
+
+	testTrue(@"?Uring backend selected", [net setIOBackend: NetUringBackend]);
+	testTrue(@"?Uring backend in use", [net ioBackend] == NetUringBackend);
+
+	port = AUTORELEASE([[TCPPort alloc] initOnHost: host onPort: 0]);
+	testTrue(@"?Initialized port", port);
+	[port setNetObject: [EchoServer class]];
+
+	client = AUTORELEASE([Client new]);
+	testTrue(@"?Made connection", [[TCPSystem sharedInstance]
+	  connectNetObject: client toHost: host onPort: [port port]
+	  withTimeout: 4]);
+	RUNABIT();
+	testTrue(@"?Accepted on the ring", server && uring_stat(@"Accepts") == 1);
+
+	data = [NSMutableData dataWithLength: NUM_BYTES];
+	[[client transport] writeData: data];
+	pending = [net pendingWriteBytes: &writers];
+	testTrue(@"?Buffered write pending", pending == NUM_BYTES &&
+	  writers == 1);
+	testFalse(@"?Not done writing", [[client transport] isDoneWriting]);
+	RUNABIT();
+	testTrue(@"?Echoed on the ring", numBytes == NUM_BYTES);
+	testTrue(@"?Received and sent on the ring",
+	  uring_stat(@"Receives") > 0 && uring_stat(@"Sends") > 0);
+	testTrue(@"?Nothing left pending", [net pendingWriteBytes: NULL] == 0);
+	testTrue(@"?Done writing", [[client transport] isDoneWriting]);
+
+	/* Reading paused on the ring stops the data until it is resumed. */
+	[net pauseReadingObject: server];
+	numReceived = 0;
+	[[client transport] writeData: [NSData dataWithBytes: "paused" length: 6]];
+	RUNABIT();
+	testTrue(@"?Nothing received while paused", numReceived == 0);
+	[net resumeReadingObject: server];
+	RUNABIT();
+	testTrue(@"?Received once resumed", numReceived == 6);
+
+	[net disconnectObject: client];
+	[net disconnectObject: port];
+	DESTROY(server);
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
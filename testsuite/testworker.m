@@ -0,0 +1,321 @@
+/***************************************************************************
+                                testworker.m
+                          -------------------
+    begin                : Mon Oct 19 12:24:30 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+#import <netclasses/LineObject.h>
+#import <netclasses/NetWorkerPool.h>
+
+#import <Foundation/Foundation.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUM_TARGETS 8
+#define NUM_MESSAGES 250
+#define NUM_LINES 200
+
+/* Each target checks that its messages come in order and never two at a
+ * time. */
+@interface Target : NSObject
+	{
+		int next;
+		int running;
+		BOOL inOrder;
+		BOOL overlapped;
+	}
+- handle: (NSNumber *)aNumber;
+- fail: (id)anObject;
+- (BOOL)inOrder;
+- (BOOL)overlapped;
+- (int)handled;
+@end
+
+@implementation Target
+- init
+{
+	if (!(self = [super init])) return nil;
+	inOrder = YES;
+	return self;
+}
+- handle: (NSNumber *)aNumber
+{
+	if (__atomic_add_fetch(&running, 1, __ATOMIC_ACQ_REL) != 1)
+	{
+		overlapped = YES;
+	}
+	if ([aNumber intValue] != next)
+	{
+		inOrder = NO;
+	}
+	next++;
+	/* Long enough for another thread to find the queue if it could. */
+	if (next % 50 == 0)
+	{
+		usleep(1000);
+	}
+	__atomic_sub_fetch(&running, 1, __ATOMIC_ACQ_REL);
+	return self;
+}
+- fail: (id)anObject
+{
+	[NSException raise: NSGenericException format: @"Handler failed"];
+	return self;
+}
+- (BOOL)inOrder
+{
+	return inOrder;
+}
+- (BOOL)overlapped
+{
+	return overlapped;
+}
+- (int)handled
+{
+	return next;
+}
+@end
+
+int numLines = 0;
+int numOnLoop = 0;
+int numLostOffLoop = 0;
+NetWorkerPool *echoPool = nil;
+
+/* Echoes every line back from the worker pool. */
+@interface EchoServer : LineObject
+@end
+
+@implementation EchoServer
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	[super connectionEstablished: aTransport];
+	[[NetApplication sharedInstance] setWorkerPool: echoPool
+	  forObject: self];
+	return self;
+}
+- lineReceived: (NSData *)aLine
+{
+	NSMutableData *reply = [NSMutableData dataWithData: aLine];
+
+	if ([[NetApplication sharedInstance] isRunLoopThread])
+	{
+		__atomic_add_fetch(&numOnLoop, 1, __ATOMIC_RELAXED);
+	}
+	[reply appendBytes: "\r\n" length: 2];
+	[transport writeData: reply];
+	return self;
+}
+- (void)connectionLost
+{
+	if (![[NetApplication sharedInstance] isRunLoopThread])
+	{
+		__atomic_add_fetch(&numLostOffLoop, 1, __ATOMIC_RELAXED);
+	}
+	[super connectionLost];
+}
+@end
+
+@interface Client : LineObject
+	{
+		BOOL inOrder;
+	}
+- (BOOL)inOrder;
+@end
+
+@implementation Client
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	inOrder = YES;
+	return [super connectionEstablished: aTransport];
+}
+- lineReceived: (NSData *)aLine
+{
+	char buffer[16];
+	unsigned length = [aLine length];
+
+	if (length >= sizeof(buffer))
+	{
+		inOrder = NO;
+		return self;
+	}
+	memcpy(buffer, [aLine bytes], length);
+	buffer[length] = 0;
+	if (atoi(buffer) != numLines)
+	{
+		inOrder = NO;
+	}
+	numLines++;
+	return self;
+}
+- (BOOL)inOrder
+{
+	return inOrder;
+}
+@end
+
+static BOOL run_until(BOOL (*condition)(void *), void *info)
+{
+	NSDate *limit = [NSDate dateWithTimeIntervalSinceNow: 20.0];
+
+	while (!condition(info) && [limit timeIntervalSinceNow] > 0)
+	{
+		CREATE_AUTORELEASE_POOL(apr);
+		[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+		  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+		RELEASE(apr);
+	}
+	return condition(info);
+}
+
+static BOOL all_echoed(void *info)
+{
+	return numLines == NUM_LINES;
+}
+
+static BOOL lost_on_pool(void *info)
+{
+	return __atomic_load_n(&numLostOffLoop, __ATOMIC_RELAXED) == 1;
+}
+
+static void test_queues(void)
+{
+	NetWorkerPool *pool = AUTORELEASE([[NetWorkerPool alloc]
+	  initWithThreads: 4]);
+	Target *targets[NUM_TARGETS];
+	BOOL inOrder = YES, overlapped = NO, raised;
+	int x, y;
+
+	testTrue(@"?Pool threads", [pool threadCount] == 4);
+	for (x = 0; x < NUM_TARGETS; x++)
+	{
+		targets[x] = AUTORELEASE([Target new]);
+	}
+	for (y = 0; y < NUM_MESSAGES; y++)
+	{
+		for (x = 0; x < NUM_TARGETS; x++)
+		{
+			[pool dispatch: @selector(handle:) to: targets[x]
+			  withObject: [NSNumber numberWithInt: y]];
+		}
+	}
+	[pool stop];
+
+	for (x = 0; x < NUM_TARGETS; x++)
+	{
+		inOrder = inOrder && [targets[x] inOrder] &&
+		  [targets[x] handled] == NUM_MESSAGES;
+		overlapped = overlapped || [targets[x] overlapped];
+	}
+	testTrue(@"?Messages of each target in order", inOrder);
+	testFalse(@"?A target never runs on two threads at once", overlapped);
+	testTrue(@"?Every message handled", [[[pool statistics]
+	  objectForKey: @"Handled"] intValue] == NUM_TARGETS * NUM_MESSAGES);
+	testTrue(@"?No queues left", [[[pool statistics]
+	  objectForKey: @"Queues"] intValue] == 0);
+
+	raised = NO;
+	NS_DURING
+		[pool dispatch: @selector(handle:) to: targets[0]
+		  withObject: [NSNumber numberWithInt: 0]];
+	NS_HANDLER
+		raised = [[localException name] isEqualToString: NetException];
+	NS_ENDHANDLER
+	testTrue(@"?Stopped pool refuses work", raised);
+}
+
+/* An exception from a handler on the pool comes out of the run loop on
+ * the run loop thread, as it would have had the handler run there. */
+static void test_exception(void)
+{
+	NetWorkerPool *pool = AUTORELEASE([[NetWorkerPool alloc]
+	  initWithThreads: 2]);
+	NSString *name = nil;
+	int x;
+
+	[pool dispatch: @selector(fail:) to: AUTORELEASE([Target new])
+	  withObject: nil];
+	for (x = 0; x < 50 && !name; x++)
+	{
+		NS_DURING
+			[[NSRunLoop currentRunLoop] runMode: NSDefaultRunLoopMode
+			  beforeDate: [NSDate dateWithTimeIntervalSinceNow: 0.1]];
+		NS_HANDLER
+			name = [localException name];
+		NS_ENDHANDLER
+	}
+	testEqual(@"Handler exception raised on the run loop thread", name,
+	  NSGenericException);
+	[pool stop];
+}
+
+static void test_connection(void)
+{
+	NetApplication *net = [NetApplication sharedInstance];
+	NSHost *host = [NSHost hostWithAddress: @"127.0.0.1"];
+	NSMutableData *lines = [NSMutableData data];
+	TCPPort *port;
+	Client *client;
+	char line[16];
+	int x;
+
+	echoPool = [[NetWorkerPool alloc] initWithThreads: 4];
+	port = AUTORELEASE([[TCPPort alloc] initOnHost: host onPort: 0]);
+	testTrue(@"?Initialized port", port);
+	[port setNetObject: [EchoServer class]];
+
+	client = AUTORELEASE([Client new]);
+	testTrue(@"?Made connection", [[TCPSystem sharedInstance]
+	  connectNetObject: client toHost: host onPort: [port port]
+	  withTimeout: 4]);
+	for (x = 0; x < NUM_LINES; x++)
+	{
+		sprintf(line, "%d\r\n", x);
+		[lines appendBytes: line length: strlen(line)];
+	}
+	[[client transport] writeData: lines];
+
+	testTrue(@"?Every line echoed from the pool", run_until(all_echoed, 0));
+	testTrue(@"?Echoes in order", [client inOrder]);
+	testTrue(@"?Lines handled off the run loop thread", numOnLoop == 0);
+
+	[net disconnectObject: client];
+	testTrue(@"?Connection lost on the pool", run_until(lost_on_pool, 0));
+
+	[net disconnectObject: port];
+	[echoPool stop];
+	DESTROY(echoPool);
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+
+	[NetApplication sharedInstance];
+
+	test_queues();
+	test_exception();
+	test_connection();
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}
@@ -0,0 +1,183 @@
+/***************************************************************************
+                                testwrite.m
+                          -------------------
+    begin                : Mon Oct 19 11:41:09 UTC 2026
+    copyright            : (C) 2005 by Andrew Ruder
+    email                : aeruder@ksu.edu
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#import "testsuite.h"
+
+#import <netclasses/NetBase.h>
+#import <netclasses/NetTCP.h>
+
+#import <Foundation/Foundation.h>
+
+/* Every write strategy of TCPTransport sends the same bytes; they differ
+ * in when the sends are made and how many it takes. */
+
+int numBytes = 0;
+
+@interface Sink : NSObject <NetObject>
+	{
+		id<NetTransport> transport;
+	}
+@end
+
+@implementation Sink
+- (void)connectionLost
+{
+	DESTROY(transport);
+}
+- connectionEstablished: (id <NetTransport>)aTransport
+{
+	ASSIGN(transport, aTransport);
+	[[NetApplication sharedInstance] connectObject: self];
+	return self;
+}
+- dataReceived: (NSData *)data
+{
+	numBytes += [data length];
+	return self;
+}
+- (id <NetTransport>)transport
+{
+	return transport;
+}
+@end
+
+#define RUNABIT() \
+	[[NSRunLoop currentRunLoop] runUntilDate: \
+	[NSDate dateWithTimeIntervalSinceNow: 2.0]]
+
+static unsigned write_calls(TCPTransport *aTransport)
+{
+	return [[[aTransport statistics] objectForKey: @"WriteCalls"]
+	  unsignedIntValue];
+}
+
+/* Writes <var>aData</var> three times with <var>aStrategy</var> and
+ * returns the number of sends it took once everything arrived. */
+static unsigned write_three(TCPTransport *aTransport,
+  NetWriteStrategy aStrategy, NSData *aData)
+{
+	unsigned before = write_calls(aTransport);
+
+	numBytes = 0;
+	[aTransport setWriteStrategy: aStrategy];
+	[aTransport writeData: aData];
+	[aTransport writeData: aData];
+	[aTransport writeData: aData];
+	RUNABIT();
+	return write_calls(aTransport) - before;
+}
+
+int main(int argc, char **argv)
+{
+	CREATE_AUTORELEASE_POOL(apr);
+	NetApplication *net;
+	TCPPort *port;
+	Sink *client;
+	TCPTransport *transport;
+	NSData *data = [NSData dataWithBytes: "0123456789" length: 10];
+	NSHost *host = [NSHost hostWithAddress: @"127.0.0.1"];
+	BOOL raised;
+
+	net = [NetApplication sharedInstance];
+
+	testTrue(@"?Deferred by default", [TCPTransport defaultWriteStrategy] ==
+	  NetWriteDeferred);
+
+	port = AUTORELEASE([[TCPPort alloc] initOnHost: host onPort: 0]);
+	testTrue(@"?Initialized port", port);
+	[port setNetObject: [Sink class]];
+
+	client = AUTORELEASE([Sink new]);
+	testTrue(@"?Made connection", [[TCPSystem sharedInstance]
+	  connectNetObject: client toHost: host onPort: [port port]
+	  withTimeout: 4]);
+	transport = (TCPTransport *)[client transport];
+	testTrue(@"?Transport uses the default", [transport writeStrategy] ==
+	  NetWriteDeferred);
+	RUNABIT();
+
+	/* NetWriteImmediate sends each write straight away. */
+	[transport setWriteStrategy: NetWriteImmediate];
+	[transport writeData: data];
+	testTrue(@"?Immediate write sent at once", [transport isDoneWriting] &&
+	  [transport writeBufferLength] == 0);
+	RUNABIT();
+	testTrue(@"?Immediate write arrived", numBytes == 10);
+	testTrue(@"?Immediate sends each write",
+	  write_three(transport, NetWriteImmediate, data) == 3);
+	testTrue(@"?Immediate writes arrived", numBytes == 30);
+
+	/* The others buffer, and send everything buffered together. */
+	[transport setWriteStrategy: NetWriteDeferred];
+	[transport writeData: data];
+	testFalse(@"?Deferred write buffered", [transport isDoneWriting]);
+	testTrue(@"?Deferred write length", [transport writeBufferLength] == 10);
+	RUNABIT();
+	testTrue(@"?Deferred write sent", [transport isDoneWriting] &&
+	  numBytes == 10);
+	testTrue(@"?Deferred writes sent together",
+	  write_three(transport, NetWriteDeferred, data) == 1);
+	testTrue(@"?Deferred writes arrived", numBytes == 30);
+
+	[transport setWriteStrategy: NetWriteEndOfDispatch];
+	[transport writeData: data];
+	testFalse(@"?End of dispatch write buffered", [transport isDoneWriting]);
+	RUNABIT();
+	testTrue(@"?End of dispatch write sent", [transport isDoneWriting] &&
+	  numBytes == 10);
+	testTrue(@"?End of dispatch writes sent together",
+	  write_three(transport, NetWriteEndOfDispatch, data) == 1);
+	testTrue(@"?End of dispatch writes arrived", numBytes == 30);
+
+	[transport setCorksWrites: YES];
+	testTrue(@"?Corking on", [transport corksWrites]);
+	testTrue(@"?Corked writes sent together",
+	  write_three(transport, NetWriteEndOfDispatch, data) == 1);
+	testTrue(@"?Corked writes arrived", numBytes == 30);
+	[transport setCorksWrites: NO];
+
+	testTrue(@"?Peak write buffer kept", [[[transport statistics]
+	  objectForKey: @"PeakWriteBufferLength"] intValue] >= 30);
+
+	/* A closed transport refuses writes instead of buffering them. */
+	RETAIN(transport);
+	[net disconnectObject: client];
+	[transport close];
+	raised = NO;
+	NS_DURING
+		[transport writeData: data];
+	NS_HANDLER
+		raised = [[localException name] isEqualToString: FatalNetException];
+	NS_ENDHANDLER
+	testTrue(@"?Write to a closed transport raises", raised);
+	raised = NO;
+	NS_DURING
+		[transport writeData: nil];
+	NS_HANDLER
+		raised = [[localException name] isEqualToString: FatalNetException];
+	NS_ENDHANDLER
+	testTrue(@"?Flush of a closed transport raises", raised);
+	RELEASE(transport);
+
+	[net disconnectObject: port];
+
+	FINISH();
+
+	RELEASE(apr);
+
+	return 0;
+}